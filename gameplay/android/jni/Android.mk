@@ -26,6 +26,7 @@ LOCAL_SRC_FILES := \
     AnimationController.cpp \
     AnimationTarget.cpp \
     AnimationValue.cpp \
+    AsyncSceneLoader.cpp \
     AudioBuffer.cpp \
     AudioController.cpp \
     AudioListener.cpp \
@@ -55,6 +56,8 @@ LOCAL_SRC_FILES := \
     HeightField.cpp \
     Image.cpp \
     ImageControl.cpp \
+    InstancedModel.cpp \
+    JobSystem.cpp \
     Joint.cpp \
     JoystickControl.cpp \
     Label.cpp \
@@ -96,8 +99,10 @@ LOCAL_SRC_FILES := \
     Ray.cpp \
     Rectangle.cpp \
     Ref.cpp \
+    RenderQueue.cpp \
     RenderState.cpp \
     RenderTarget.cpp \
+    ResourceCache.cpp \
     Scene.cpp \
     SceneLoader.cpp \
     ScreenDisplayer.cpp \
@@ -105,6 +110,7 @@ LOCAL_SRC_FILES := \
     ScriptController.cpp \
     ScriptTarget.cpp \
     Slider.cpp \
+    SpatialIndex.cpp \
     Sprite.cpp \
     SpriteBatch.cpp \
     Technique.cpp \
@@ -117,6 +123,7 @@ LOCAL_SRC_FILES := \
     ThemeStyle.cpp \
     TileSet.cpp \
     Transform.cpp \
+    TransformStore.cpp \
     Vector2.cpp \
     Vector3.cpp \
     Vector4.cpp \
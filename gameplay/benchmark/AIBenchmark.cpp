@@ -0,0 +1,123 @@
+#include "../src/Base.h"
+#include "../src/AIController.h"
+#include "../src/AIMessage.h"
+#include "../src/Game.h"
+#include "../src/Node.h"
+#include "HeadlessGame.h"
+#include <chrono>
+
+using namespace gameplay;
+
+// 10,000 agents exchanging 100,000 delayed messages
+#define AGENT_COUNT             10000
+#define MESSAGES_IN_FLIGHT      100000
+
+// Maximum delay of the messages in milliseconds, short enough for many to be delivered every frame
+#define MESSAGE_DELAY_MAX       200
+
+// Number of agents looked up by ID every frame
+#define FIND_COUNT              10000
+
+// Default number of frames
+#define DEFAULT_FRAMES          200
+
+/**
+ * Counts the messages delivered to the agents.
+ */
+class MessageCounter : public AIAgent::Listener
+{
+public:
+
+    MessageCounter() : delivered(0)
+    {
+    }
+
+    bool messageReceived(AIMessage* message)
+    {
+        ++delivered;
+        return true;
+    }
+
+    unsigned int delivered;
+};
+
+static double getSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int frames = argc > 1 ? (unsigned int)atoi(argv[1]) : DEFAULT_FRAMES;
+    if (frames == 0)
+    {
+        printf("Usage: gameplay-ai-benchmark [frames]\n");
+        return 1;
+    }
+    printf("%u frames of %u agents with %u messages in flight.\n", frames, AGENT_COUNT, MESSAGES_IN_FLIGHT);
+
+    Game game;
+    if (!startHeadlessGame(&game))
+    {
+        printf("Failed to start the game.\n");
+        return 1;
+    }
+    AIController* aiController = game.getAIController();
+
+    MessageCounter counter;
+    char id[32];
+    std::vector<Node*> agentNodes;
+    agentNodes.reserve(AGENT_COUNT);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i)
+    {
+        sprintf(id, "agent%u", i);
+        Node* node = Node::create(id);
+        node->getAgent()->setListener(&counter);
+        agentNodes.push_back(node);
+    }
+
+    // Every frame tops up the delayed messages sent between random agents, looks up random
+    // agents by ID, then runs a frame of the game, which delivers the messages that are due.
+    double sendTime = 0;
+    double findTime = 0;
+    double frameTime = 0;
+    unsigned int sent = 0;
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        while (sent - counter.delivered < MESSAGES_IN_FLIGHT)
+        {
+            Node* sender = agentNodes[rand() % AGENT_COUNT];
+            Node* receiver = agentNodes[rand() % AGENT_COUNT];
+            AIMessage* message = AIMessage::create(0, sender->getId(), receiver->getId(), 0);
+            aiController->sendMessage(message, (float)(1 + rand() % MESSAGE_DELAY_MAX));
+            ++sent;
+        }
+        sendTime += getSeconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        for (unsigned int i = 0; i < FIND_COUNT; ++i)
+        {
+            aiController->findAgent(agentNodes[rand() % AGENT_COUNT]->getId());
+        }
+        findTime += getSeconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        game.frame();
+        frameTime += getSeconds(start);
+    }
+
+    printf("%-28s %8.3f ms/frame  %8u messages/frame\n", "Sending", sendTime * 1000.0 / frames, (sent - MESSAGES_IN_FLIGHT) / frames);
+    printf("%-28s %8.3f ms/frame  %8u messages/frame\n", "Delivering (game frame)", frameTime * 1000.0 / frames, counter.delivered / frames);
+    printf("%-28s %8.3f ms/frame  %8u lookups/frame\n", "Finding agents", findTime * 1000.0 / frames, FIND_COUNT);
+    printf("Message pool: %u hits, %u misses\n", aiController->getMessagePoolHits(), aiController->getMessagePoolMisses());
+
+    // Drop the messages still in flight to the agents released below.
+    aiController->cancelMessages();
+    for (size_t i = 0; i < agentNodes.size(); ++i)
+    {
+        agentNodes[i]->getAgent()->setListener(NULL);
+        SAFE_RELEASE(agentNodes[i]);
+    }
+    return 0;
+}
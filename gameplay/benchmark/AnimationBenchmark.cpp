@@ -0,0 +1,120 @@
+#include "../src/Base.h"
+#include "../src/Animation.h"
+#include "../src/AnimationController.h"
+#include "../src/Game.h"
+#include "../src/JobSystem.h"
+#include "../src/Node.h"
+#include "HeadlessGame.h"
+
+using namespace gameplay;
+
+// 500 characters of 60 joints, each animated by its own looping clip
+#define CHARACTER_COUNT     500
+#define JOINT_COUNT         60
+#define KEY_COUNT           31
+#define CLIP_DURATION       1000
+
+// Default number of frames
+#define DEFAULT_FRAMES      200
+
+/**
+ * Creates a character made of a chain of joints, each swinging around its parent with its own phase.
+ */
+static Node* createCharacter(unsigned int index)
+{
+    unsigned int keyTimes[KEY_COUNT];
+    float keyValues[KEY_COUNT * 7];
+    char id[32];
+    sprintf(id, "character%u", index);
+    Node* character = Node::create(id);
+
+    Node* parent = character;
+    for (unsigned int j = 0; j < JOINT_COUNT; ++j)
+    {
+        sprintf(id, "joint%u", j);
+        Node* joint = Node::create(id);
+        parent->addChild(joint);
+        joint->release();
+        parent = joint;
+
+        float phase = (float)(index * JOINT_COUNT + j) * 0.1f;
+        for (unsigned int k = 0; k < KEY_COUNT; ++k)
+        {
+            keyTimes[k] = k * CLIP_DURATION / (KEY_COUNT - 1);
+            float angle = 0.5f * sin(MATH_PIX2 * k / (KEY_COUNT - 1) + phase);
+            Quaternion rotation;
+            Quaternion::createFromAxisAngle(Vector3::unitZ(), angle, &rotation);
+            float* value = keyValues + k * 7;
+            value[0] = rotation.x;
+            value[1] = rotation.y;
+            value[2] = rotation.z;
+            value[3] = rotation.w;
+            value[4] = 0.0f;
+            value[5] = 1.0f;
+            value[6] = 0.0f;
+        }
+
+        // The joint owns the animation through its channel, so it is not released here.
+        Animation* animation = joint->createAnimation(id, Transform::ANIMATE_ROTATE_TRANSLATE, KEY_COUNT, keyTimes, keyValues, Curve::LINEAR);
+        AnimationClip* clip = animation->getClip();
+        clip->setRepeatCount(AnimationClip::REPEAT_INDEFINITE);
+        clip->play();
+    }
+    return character;
+}
+
+/**
+ * Runs frames of the game and reports the time spent in the update of the animation controller.
+ */
+static void updateAnimations(Game* game, const char* name, bool parallel, unsigned int frames)
+{
+    AnimationController* controller = game->getAnimationController();
+    controller->setParallelSampling(parallel);
+
+    // The first frame rebuilds the bindings of the clips, which is not measured.
+    game->frame();
+    double updateTime = 0;
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        game->frame();
+        updateTime += controller->getUpdateTime();
+    }
+    printf("%-20s %8.3f ms/frame\n", name, updateTime / frames);
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int frames = argc > 1 ? (unsigned int)atoi(argv[1]) : DEFAULT_FRAMES;
+    if (frames == 0)
+    {
+        printf("Usage: gameplay-animation-benchmark [frames]\n");
+        return 1;
+    }
+
+    Game game;
+    if (!startHeadlessGame(&game))
+    {
+        printf("Failed to start the game.\n");
+        return 1;
+    }
+    printf("%u frames of %u characters with %u animated joints, %u job system workers.\n",
+        frames, CHARACTER_COUNT, CHARACTER_COUNT * JOINT_COUNT, game.getJobSystem()->getWorkerCount());
+
+    std::vector<Node*> characters;
+    characters.reserve(CHARACTER_COUNT);
+    for (unsigned int i = 0; i < CHARACTER_COUNT; ++i)
+    {
+        characters.push_back(createCharacter(i));
+    }
+
+    // Sampling the clips on the calling thread, then across the job system.
+    updateAnimations(&game, "Serial sampling", false, frames);
+    updateAnimations(&game, "Parallel sampling", true, frames);
+
+    game.getAnimationController()->stopAllAnimations();
+    for (size_t i = 0; i < characters.size(); ++i)
+    {
+        SAFE_RELEASE(characters[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,17 @@
+#include "../src/Base.h"
+#include "HeadlessGame.h"
+#include "NullGraphics.h"
+
+using namespace gameplay;
+
+bool startHeadlessGame(Game* game)
+{
+    GP_ASSERT(game);
+
+    installNullGraphics();
+
+    // Select the null device of OpenAL Soft, unless another one is requested.
+    setenv("ALSOFT_DRIVERS", "null", 0);
+
+    return game->run() == 0;
+}
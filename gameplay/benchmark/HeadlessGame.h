@@ -0,0 +1,21 @@
+#ifndef HEADLESSGAME_H_
+#define HEADLESSGAME_H_
+
+#include "../src/Game.h"
+
+/**
+ * Starts the systems of a game without a window, graphics context or audio device.
+ *
+ * Benchmarks call this to use the engine systems started with the game (render state,
+ * job system, animation and AI controllers) on machines without a display: the null
+ * OpenGL entry points are installed and OpenAL is opened on its null device. The game
+ * is not updated or rendered by a platform, so the benchmarks drive the systems
+ * themselves, or run frames of the game with Game::frame().
+ *
+ * @param game The game to start.
+ *
+ * @return True if the game systems were started, false otherwise.
+ */
+bool startHeadlessGame(gameplay::Game* game);
+
+#endif
@@ -0,0 +1,244 @@
+#include "../src/Base.h"
+#include "../src/Game.h"
+#include "../src/InstancedModel.h"
+#include "../src/Material.h"
+#include "../src/MeshPart.h"
+#include "../src/Model.h"
+#include "../src/Node.h"
+#include "HeadlessGame.h"
+#include <chrono>
+
+using namespace gameplay;
+
+// 250 rows of 200 cubes
+#define GRID_COLUMNS        200
+#define GRID_ROWS           250
+#define GRID_SPACING        1.5f
+
+// Default number of frames
+#define DEFAULT_FRAMES      100
+
+static const char* __vertexShader =
+    "attribute vec4 a_position;\n"
+    "attribute vec2 a_texCoord;\n"
+    "#if defined(INSTANCING)\n"
+    "attribute mat4 a_instanceMatrix;\n"
+    "attribute vec4 a_instanceColor;\n"
+    "#endif\n"
+    "uniform mat4 u_worldViewProjectionMatrix;\n"
+    "varying vec2 v_texCoord;\n"
+    "varying vec4 v_color;\n"
+    "void main()\n"
+    "{\n"
+    "#if defined(INSTANCING)\n"
+    "    gl_Position = u_worldViewProjectionMatrix * a_instanceMatrix * a_position;\n"
+    "    v_color = a_instanceColor;\n"
+    "#else\n"
+    "    gl_Position = u_worldViewProjectionMatrix * a_position;\n"
+    "    v_color = vec4(1.0);\n"
+    "#endif\n"
+    "    v_texCoord = a_texCoord;\n"
+    "}\n";
+
+static const char* __fragmentShader =
+    "uniform sampler2D u_diffuseTexture;\n"
+    "uniform vec4 u_diffuseColor;\n"
+    "varying vec2 v_texCoord;\n"
+    "varying vec4 v_color;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FragColor = texture2D(u_diffuseTexture, v_texCoord) * u_diffuseColor * v_color;\n"
+    "}\n";
+
+static double getSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void report(const char* name, unsigned int frames, double seconds, unsigned int drawCalls)
+{
+    printf("%-28s %8.3f ms/frame  %6u draw calls\n", name, seconds * 1000.0 / frames, drawCalls);
+}
+
+static Mesh* createCubeMesh(float size = 1.0f)
+{
+    float a = size * 0.5f;
+    float vertices[] =
+    {
+        -a, -a,  a,    0.0,  0.0,  1.0,   0.0, 0.0,
+         a, -a,  a,    0.0,  0.0,  1.0,   1.0, 0.0,
+        -a,  a,  a,    0.0,  0.0,  1.0,   0.0, 1.0,
+         a,  a,  a,    0.0,  0.0,  1.0,   1.0, 1.0,
+        -a,  a,  a,    0.0,  1.0,  0.0,   0.0, 0.0,
+         a,  a,  a,    0.0,  1.0,  0.0,   1.0, 0.0,
+        -a,  a, -a,    0.0,  1.0,  0.0,   0.0, 1.0,
+         a,  a, -a,    0.0,  1.0,  0.0,   1.0, 1.0,
+        -a,  a, -a,    0.0,  0.0, -1.0,   0.0, 0.0,
+         a,  a, -a,    0.0,  0.0, -1.0,   1.0, 0.0,
+        -a, -a, -a,    0.0,  0.0, -1.0,   0.0, 1.0,
+         a, -a, -a,    0.0,  0.0, -1.0,   1.0, 1.0,
+        -a, -a, -a,    0.0, -1.0,  0.0,   0.0, 0.0,
+         a, -a, -a,    0.0, -1.0,  0.0,   1.0, 0.0,
+        -a, -a,  a,    0.0, -1.0,  0.0,   0.0, 1.0,
+         a, -a,  a,    0.0, -1.0,  0.0,   1.0, 1.0,
+         a, -a,  a,    1.0,  0.0,  0.0,   0.0, 0.0,
+         a, -a, -a,    1.0,  0.0,  0.0,   1.0, 0.0,
+         a,  a,  a,    1.0,  0.0,  0.0,   0.0, 1.0,
+         a,  a, -a,    1.0,  0.0,  0.0,   1.0, 1.0,
+        -a, -a, -a,   -1.0,  0.0,  0.0,   0.0, 0.0,
+        -a, -a,  a,   -1.0,  0.0,  0.0,   1.0, 0.0,
+        -a,  a, -a,   -1.0,  0.0,  0.0,   0.0, 1.0,
+        -a,  a,  a,   -1.0,  0.0,  0.0,   1.0, 1.0
+    };
+    short indices[] =
+    {
+        0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7, 8, 9, 10, 10, 9, 11, 12, 13, 14, 14, 13, 15, 16, 17, 18, 18, 17, 19, 20, 21, 22, 22, 21, 23
+    };
+    unsigned int vertexCount = 24;
+    unsigned int indexCount = 36;
+    VertexFormat::Element elements[] =
+    {
+        VertexFormat::Element(VertexFormat::POSITION, 3),
+        VertexFormat::Element(VertexFormat::NORMAL, 3),
+        VertexFormat::Element(VertexFormat::TEXCOORD0, 2)
+    };
+    Mesh* mesh = Mesh::createMesh(VertexFormat(elements, 3), vertexCount, false);
+    if (mesh == NULL)
+    {
+        GP_ERROR("Failed to create mesh.");
+        return NULL;
+    }
+    mesh->setVertexData(vertices, 0, vertexCount);
+    mesh->setBoundingBox(BoundingBox(-a, -a, -a, a, a, a));
+    mesh->setBoundingSphere(BoundingSphere(Vector3::zero(), a * sqrtf(3.0f)));
+    MeshPart* meshPart = mesh->addPart(Mesh::TRIANGLES, Mesh::INDEX16, indexCount, false);
+    meshPart->setIndexData(indices, 0, indexCount);
+    return mesh;
+}
+
+static Material* createMaterial(const char* defines, Texture* texture)
+{
+    Effect* effect = Effect::createFromSource(__vertexShader, __fragmentShader, defines);
+    GP_ASSERT(effect);
+    Material* material = Material::create(effect);
+    SAFE_RELEASE(effect);
+    material->setParameterAutoBinding("u_worldViewProjectionMatrix", "WORLD_VIEW_PROJECTION_MATRIX");
+    material->getParameter("u_diffuseColor")->setValue(Vector4::one());
+    Texture::Sampler* sampler = Texture::Sampler::create(texture);
+    sampler->setFilterMode(Texture::LINEAR_MIPMAP_LINEAR, Texture::LINEAR);
+    material->getParameter("u_diffuseTexture")->setValue(sampler);
+    SAFE_RELEASE(sampler);
+    material->getStateBlock()->setCullFace(true);
+    material->getStateBlock()->setDepthTest(true);
+    material->getStateBlock()->setDepthWrite(true);
+    return material;
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int frames = argc > 1 ? (unsigned int)atoi(argv[1]) : DEFAULT_FRAMES;
+    if (frames == 0)
+    {
+        printf("Usage: gameplay-instancing-benchmark [frames]\n");
+        return 1;
+    }
+    printf("%u frames of %u cubes.\n", frames, GRID_COLUMNS * GRID_ROWS);
+
+    Game game;
+    if (!startHeadlessGame(&game))
+    {
+        printf("Failed to start the game.\n");
+        return 1;
+    }
+
+    Mesh* cubeMesh = createCubeMesh();
+    unsigned char pixels[4 * 4 * 4] = { 0 };
+    Texture* texture = Texture::create(Texture::RGBA, 4, 4, pixels);
+
+    // Cloned nodes: every node draws its own model with its own material.
+    Model* cubeModel = Model::create(cubeMesh);
+    Material* material = createMaterial(NULL, texture);
+    cubeModel->setMaterial(material);
+    SAFE_RELEASE(material);
+    Node* prototypeNode = Node::create("cube");
+    prototypeNode->setDrawable(cubeModel);
+    SAFE_RELEASE(cubeModel);
+
+    // Instanced model: a single node draws every cube.
+    InstancedModel* instancedModel = InstancedModel::create(cubeMesh);
+    material = createMaterial("INSTANCING", texture);
+    instancedModel->setMaterial(material);
+    SAFE_RELEASE(material);
+
+    Node* cloneGroupNode = Node::create("clones");
+    std::vector<Vector3> positions;
+    float originX = -0.5f * GRID_COLUMNS * GRID_SPACING;
+    float originZ = -0.5f * GRID_ROWS * GRID_SPACING;
+    for (unsigned int row = 0; row < GRID_ROWS; ++row)
+    {
+        for (unsigned int column = 0; column < GRID_COLUMNS; ++column)
+        {
+            Vector3 position(originX + column * GRID_SPACING, 0, originZ + row * GRID_SPACING);
+            positions.push_back(position);
+
+            Node* node = prototypeNode->clone();
+            node->setTranslation(position);
+            cloneGroupNode->addChild(node);
+            SAFE_RELEASE(node);
+
+            Matrix transform;
+            Matrix::createTranslation(position, &transform);
+            instancedModel->addInstance(transform, Vector4((float)column / GRID_COLUMNS, (float)row / GRID_ROWS, 1.0f, 1.0f));
+        }
+    }
+    SAFE_RELEASE(prototypeNode);
+
+    Node* instancedNode = Node::create("instances");
+    instancedNode->setDrawable(instancedModel);
+    SAFE_RELEASE(instancedModel);
+
+    // Drawing every cloned node, binding its material and vertex attributes.
+    unsigned int drawCalls = 0;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        drawCalls = 0;
+        for (Node* node = cloneGroupNode->getFirstChild(); node; node = node->getNextSibling())
+        {
+            drawCalls += node->getDrawable()->draw();
+        }
+    }
+    report("Cloned nodes", frames, getSeconds(start), drawCalls);
+
+    // Drawing the instances of the instanced model, whose buffer is uploaded once.
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        drawCalls = instancedNode->getDrawable()->draw();
+    }
+    report("Instanced model", frames, getSeconds(start), drawCalls);
+
+    // Moving every instance before drawing, which uploads the buffer and recomputes the bounds.
+    float radius = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        InstancedModel* model = static_cast<InstancedModel*>(instancedNode->getDrawable());
+        for (unsigned int i = 0, count = model->getInstanceCount(); i < count; ++i)
+        {
+            Matrix transform;
+            Matrix::createTranslation(positions[i].x, sinf(f * 0.1f + i), positions[i].z, &transform);
+            model->setInstance(i, transform);
+        }
+        radius = instancedNode->getBoundingSphere().radius;
+        drawCalls = model->draw();
+    }
+    report("Instanced model (moving)", frames, getSeconds(start), drawCalls);
+    printf("Bounding radius of the instances: %.1f\n", radius);
+
+    SAFE_RELEASE(instancedNode);
+    SAFE_RELEASE(cloneGroupNode);
+    SAFE_RELEASE(texture);
+    SAFE_RELEASE(cubeMesh);
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "../src/Base.h"
+#include "../src/MathUtil.h"
+#include "../src/Matrix.h"
+#include "../src/Quaternion.h"
+#include "../src/Frustum.h"
+#include "../src/BoundingSphere.h"
+#include <chrono>
+
+using namespace gameplay;
+
+namespace gameplay
+{
+// The benchmark links only the math sources, so provide the logger they use.
+void Logger::log(Logger::Level level, const char* message, ...)
+{
+}
+}
+
+// Number of elements in each batch
+#define BATCH_SIZE          1024
+
+// Default number of times each batch is processed
+#define DEFAULT_ITERATIONS  2000
+
+static float random(float min, float max)
+{
+    return min + (max - min) * ((float)rand() / RAND_MAX);
+}
+
+static double getSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void report(const char* name, unsigned int iterations, double seconds, float checksum)
+{
+    double count = (double)iterations * BATCH_SIZE;
+    printf("%-36s %8.3f s  %9.2f M/s  %8.2f ns  (checksum %g)\n",
+        name, seconds, count / seconds / 1000000.0, seconds / count * 1000000000.0, checksum);
+}
+
+static const char* getBackendName()
+{
+#if defined(GP_USE_NEON)
+    return "NEON";
+#elif defined(GP_USE_SSE)
+#if defined(__AVX__) && defined(__FMA__)
+    return "SSE + AVX/FMA";
+#elif defined(__AVX__)
+    return "SSE + AVX";
+#else
+    return "SSE";
+#endif
+#else
+    return "scalar";
+#endif
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int iterations = argc > 1 ? (unsigned int)atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations == 0)
+    {
+        printf("Usage: gameplay-math-benchmark [iterations]\n");
+        return 1;
+    }
+    printf("Math backend: %s, %u iterations of %u elements.\n", getBackendName(), iterations, BATCH_SIZE);
+
+    std::vector<Matrix> m1(BATCH_SIZE), m2(BATCH_SIZE), matrices(BATCH_SIZE);
+    std::vector<Vector3> points(BATCH_SIZE), transformed(BATCH_SIZE);
+    std::vector<Quaternion> q1(BATCH_SIZE), q2(BATCH_SIZE), quaternions(BATCH_SIZE);
+    std::vector<BoundingSphere> spheres(BATCH_SIZE);
+    for (unsigned int i = 0; i < BATCH_SIZE; ++i)
+    {
+        Matrix::createRotation(Vector3(random(-1, 1), random(-1, 1), random(-1, 1)), random(0, MATH_PIX2), &m1[i]);
+        m1[i].translate(random(-10, 10), random(-10, 10), random(-10, 10));
+        Matrix::createRotation(Vector3(random(-1, 1), random(-1, 1), random(-1, 1)), random(0, MATH_PIX2), &m2[i]);
+        points[i].set(random(-100, 100), random(-100, 100), random(-100, 100));
+        Quaternion::createFromAxisAngle(Vector3(random(-1, 1), random(-1, 1), random(-1, 1)), random(0, MATH_PIX2), &q1[i]);
+        Quaternion::createFromAxisAngle(Vector3(random(-1, 1), random(-1, 1), random(-1, 1)), random(0, MATH_PIX2), &q2[i]);
+        spheres[i].set(Vector3(random(-100, 100), random(-100, 100), random(-100, 100)), random(0.5f, 5.0f));
+    }
+    Matrix projection, view;
+    Matrix::createPerspective(60.0f, 16.0f / 9.0f, 1.0f, 100.0f, &projection);
+    Matrix::createLookAt(Vector3(0, 0, 50), Vector3::zero(), Vector3::unitY(), &view);
+    Frustum frustum(projection * view);
+    bool* results = new bool[BATCH_SIZE];
+
+    std::chrono::high_resolution_clock::time_point start;
+    float checksum;
+
+    // Matrix products, one at a time and in a batch.
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int j = 0; j < iterations; ++j)
+    {
+        for (unsigned int i = 0; i < BATCH_SIZE; ++i)
+        {
+            Matrix::multiply(m1[i], m2[i], &matrices[i]);
+        }
+    }
+    checksum = matrices[BATCH_SIZE - 1].m[12];
+    report("Matrix::multiply", iterations, getSeconds(start), checksum);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int j = 0; j < iterations; ++j)
+    {
+        Matrix::multiply(&m1[0], &m2[0], BATCH_SIZE, &matrices[0]);
+    }
+    checksum = matrices[BATCH_SIZE - 1].m[12];
+    report("Matrix::multiply (batch)", iterations, getSeconds(start), checksum);
+
+    // Point transforms, one at a time and in a batch.
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int j = 0; j < iterations; ++j)
+    {
+        const Matrix& m = m1[j % BATCH_SIZE];
+        for (unsigned int i = 0; i < BATCH_SIZE; ++i)
+        {
+            m.transformPoint(points[i], &transformed[i]);
+        }
+    }
+    checksum = transformed[BATCH_SIZE - 1].x;
+    report("Matrix::transformPoint", iterations, getSeconds(start), checksum);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int j = 0; j < iterations; ++j)
+    {
+        m1[j % BATCH_SIZE].transformPoints(&points[0], BATCH_SIZE, &transformed[0]);
+    }
+    checksum = transformed[BATCH_SIZE - 1].x;
+    report("Matrix::transformPoints (batch)", iterations, getSeconds(start), checksum);
+
+    // Quaternion products.
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int j = 0; j < iterations; ++j)
+    {
+        for (unsigned int i = 0; i < BATCH_SIZE; ++i)
+        {
+            Quaternion::multiply(q1[i], q2[i], &quaternions[i]);
+        }
+    }
+    checksum = quaternions[BATCH_SIZE - 1].w;
+    report("Quaternion::multiply", iterations, getSeconds(start), checksum);
+
+    // Frustum culling, one sphere at a time and in a batch.
+    start = std::chrono::high_resolution_clock::now();
+    unsigned int visible = 0;
+    for (unsigned int j = 0; j < iterations; ++j)
+    {
+        for (unsigned int i = 0; i < BATCH_SIZE; ++i)
+        {
+            visible += frustum.intersects(spheres[i]) ? 1 : 0;
+        }
+    }
+    report("Frustum::intersects(BoundingSphere)", iterations, getSeconds(start), (float)visible);
+
+    start = std::chrono::high_resolution_clock::now();
+    visible = 0;
+    for (unsigned int j = 0; j < iterations; ++j)
+    {
+        visible += frustum.intersects(&spheres[0], BATCH_SIZE, results);
+    }
+    report("Frustum::intersects (batch)", iterations, getSeconds(start), (float)visible);
+
+    delete[] results;
+    return 0;
+}
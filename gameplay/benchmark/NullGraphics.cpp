@@ -0,0 +1,322 @@
+#include "../src/Base.h"
+#include "NullGraphics.h"
+
+// Largest vertex attribute index and number of color attachments reported
+#define MAX_VERTEX_ATTRIBS      16
+#define MAX_COLOR_ATTACHMENTS   1
+
+// Longest name of the attributes and uniforms reported by every program
+#define MAX_NAME_LENGTH         32
+
+/**
+ * A vertex attribute or uniform reported by every program.
+ */
+struct Variable
+{
+    const char* name;
+    GLenum type;
+};
+
+static const Variable __attributes[] =
+{
+    { "a_position", GL_FLOAT_VEC3 },
+    { "a_normal", GL_FLOAT_VEC3 },
+    { "a_texCoord", GL_FLOAT_VEC2 },
+    { "a_color", GL_FLOAT_VEC4 },
+    { "a_instanceColor", GL_FLOAT_VEC4 },
+    { "a_instanceMatrix", GL_FLOAT_MAT4 }   // Last, since it takes four locations
+};
+
+static const Variable __uniforms[] =
+{
+    { "u_worldViewProjectionMatrix", GL_FLOAT_MAT4 },
+    { "u_projectionMatrix", GL_FLOAT_MAT4 },
+    { "u_diffuseColor", GL_FLOAT_VEC4 },
+    { "u_diffuseTexture", GL_SAMPLER_2D },
+    { "u_texture", GL_SAMPLER_2D }
+};
+
+static const GLint __attributeCount = sizeof(__attributes) / sizeof(__attributes[0]);
+static const GLint __uniformCount = sizeof(__uniforms) / sizeof(__uniforms[0]);
+
+static GLuint __nextHandle = 1;
+
+static void generateHandles(GLsizei n, GLuint* handles)
+{
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        handles[i] = __nextHandle++;
+    }
+}
+
+static void getVariable(const Variable* variables, GLint count, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    GP_ASSERT(index < (GLuint)count);
+    const Variable& variable = variables[index];
+    strncpy(name, variable.name, bufSize);
+    name[bufSize - 1] = '\0';
+    if (length)
+        *length = (GLsizei)strlen(name);
+    *size = 1;
+    *type = variable.type;
+}
+
+static GLint getLocation(const Variable* variables, GLint count, const GLchar* name)
+{
+    for (GLint i = 0; i < count; ++i)
+    {
+        if (strcmp(variables[i].name, name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+// The core entry points returning values are defined here, so that they take precedence
+// over those of the OpenGL library, which return nothing without a graphics context.
+
+void GLAPIENTRY glGetIntegerv(GLenum pname, GLint* params)
+{
+    switch (pname)
+    {
+    case GL_MAX_VERTEX_ATTRIBS:
+        *params = MAX_VERTEX_ATTRIBS;
+        break;
+    case GL_MAX_COLOR_ATTACHMENTS:
+        *params = MAX_COLOR_ATTACHMENTS;
+        break;
+    default:
+        *params = 0;
+        break;
+    }
+}
+
+void GLAPIENTRY glGenTextures(GLsizei n, GLuint* textures)
+{
+    generateHandles(n, textures);
+}
+
+// The entry points loaded by GLEW.
+
+static void GLAPIENTRY nullGenerateHandles(GLsizei n, GLuint* handles)
+{
+    generateHandles(n, handles);
+}
+
+static void GLAPIENTRY nullDeleteHandles(GLsizei n, const GLuint* handles)
+{
+}
+
+static GLuint GLAPIENTRY nullCreateObject()
+{
+    return __nextHandle++;
+}
+
+static GLuint GLAPIENTRY nullCreateShader(GLenum type)
+{
+    return __nextHandle++;
+}
+
+static void GLAPIENTRY nullUseObject(GLuint object)
+{
+}
+
+static void GLAPIENTRY nullBindObject(GLenum target, GLuint object)
+{
+}
+
+static void GLAPIENTRY nullAttachShader(GLuint program, GLuint shader)
+{
+}
+
+static void GLAPIENTRY nullShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+}
+
+static void GLAPIENTRY nullGetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+    *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+static void GLAPIENTRY nullGetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+    switch (pname)
+    {
+    case GL_LINK_STATUS:
+        *params = GL_TRUE;
+        break;
+    case GL_ACTIVE_ATTRIBUTES:
+        *params = __attributeCount;
+        break;
+    case GL_ACTIVE_UNIFORMS:
+        *params = __uniformCount;
+        break;
+    case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH:
+    case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+        *params = MAX_NAME_LENGTH;
+        break;
+    default:
+        *params = 0;
+        break;
+    }
+}
+
+static void GLAPIENTRY nullGetInfoLog(GLuint object, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    if (length)
+        *length = 0;
+    if (bufSize > 0)
+        infoLog[0] = '\0';
+}
+
+static void GLAPIENTRY nullGetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    getVariable(__attributes, __attributeCount, index, bufSize, length, size, type, name);
+}
+
+static void GLAPIENTRY nullGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    getVariable(__uniforms, __uniformCount, index, bufSize, length, size, type, name);
+}
+
+static GLint GLAPIENTRY nullGetAttribLocation(GLuint program, const GLchar* name)
+{
+    return getLocation(__attributes, __attributeCount, name);
+}
+
+static GLint GLAPIENTRY nullGetUniformLocation(GLuint program, const GLchar* name)
+{
+    return getLocation(__uniforms, __uniformCount, name);
+}
+
+static void GLAPIENTRY nullBindAttribLocation(GLuint program, GLuint index, const GLchar* name)
+{
+}
+
+static void GLAPIENTRY nullBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+}
+
+static void GLAPIENTRY nullBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+}
+
+static void GLAPIENTRY nullCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height,
+                                                GLint border, GLsizei imageSize, const void* data)
+{
+}
+
+static void GLAPIENTRY nullGenerateMipmap(GLenum target)
+{
+}
+
+static void GLAPIENTRY nullActiveTexture(GLenum texture)
+{
+}
+
+static void GLAPIENTRY nullVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+}
+
+static void GLAPIENTRY nullVertexAttrib4fv(GLuint index, const GLfloat* v)
+{
+}
+
+static void GLAPIENTRY nullVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+}
+
+static void GLAPIENTRY nullDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount)
+{
+}
+
+static void GLAPIENTRY nullDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei primcount)
+{
+}
+
+static void GLAPIENTRY nullUniform1f(GLint location, GLfloat v0)
+{
+}
+
+static void GLAPIENTRY nullUniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+}
+
+static void GLAPIENTRY nullUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+}
+
+static void GLAPIENTRY nullUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+}
+
+static void GLAPIENTRY nullUniform1i(GLint location, GLint v0)
+{
+}
+
+static void GLAPIENTRY nullUniformfv(GLint location, GLsizei count, const GLfloat* value)
+{
+}
+
+static void GLAPIENTRY nullUniformiv(GLint location, GLsizei count, const GLint* value)
+{
+}
+
+static void GLAPIENTRY nullUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+}
+
+void installNullGraphics()
+{
+    // Vertex array objects are left unsupported, so the engine falls back to binding vertex
+    // attributes itself, without any further graphics objects.
+    glGenBuffers = (PFNGLGENBUFFERSPROC)nullGenerateHandles;
+    glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)nullDeleteHandles;
+    glBindBuffer = (PFNGLBINDBUFFERPROC)nullBindObject;
+    glBufferData = (PFNGLBUFFERDATAPROC)nullBufferData;
+    glBufferSubData = (PFNGLBUFFERSUBDATAPROC)nullBufferSubData;
+
+    glCreateShader = (PFNGLCREATESHADERPROC)nullCreateShader;
+    glDeleteShader = (PFNGLDELETESHADERPROC)nullUseObject;
+    glShaderSource = (PFNGLSHADERSOURCEPROC)nullShaderSource;
+    glCompileShader = (PFNGLCOMPILESHADERPROC)nullUseObject;
+    glGetShaderiv = (PFNGLGETSHADERIVPROC)nullGetShaderiv;
+    glGetShaderInfoLog = (PFNGLGETSHADERINFOLOGPROC)nullGetInfoLog;
+
+    glCreateProgram = (PFNGLCREATEPROGRAMPROC)nullCreateObject;
+    glDeleteProgram = (PFNGLDELETEPROGRAMPROC)nullUseObject;
+    glAttachShader = (PFNGLATTACHSHADERPROC)nullAttachShader;
+    glBindAttribLocation = (PFNGLBINDATTRIBLOCATIONPROC)nullBindAttribLocation;
+    glLinkProgram = (PFNGLLINKPROGRAMPROC)nullUseObject;
+    glGetProgramiv = (PFNGLGETPROGRAMIVPROC)nullGetProgramiv;
+    glGetProgramInfoLog = (PFNGLGETPROGRAMINFOLOGPROC)nullGetInfoLog;
+    glGetActiveAttrib = (PFNGLGETACTIVEATTRIBPROC)nullGetActiveAttrib;
+    glGetActiveUniform = (PFNGLGETACTIVEUNIFORMPROC)nullGetActiveUniform;
+    glGetAttribLocation = (PFNGLGETATTRIBLOCATIONPROC)nullGetAttribLocation;
+    glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC)nullGetUniformLocation;
+    glUseProgram = (PFNGLUSEPROGRAMPROC)nullUseObject;
+
+    glCompressedTexImage2D = (PFNGLCOMPRESSEDTEXIMAGE2DPROC)nullCompressedTexImage2D;
+    glGenerateMipmap = (PFNGLGENERATEMIPMAPPROC)nullGenerateMipmap;
+    glActiveTexture = (PFNGLACTIVETEXTUREPROC)nullActiveTexture;
+
+    glEnableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYPROC)nullUseObject;
+    glDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYPROC)nullUseObject;
+    glVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERPROC)nullVertexAttribPointer;
+    glVertexAttrib4fv = (PFNGLVERTEXATTRIB4FVPROC)nullVertexAttrib4fv;
+
+    glVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORPROC)nullVertexAttribDivisor;
+    glDrawArraysInstanced = (PFNGLDRAWARRAYSINSTANCEDPROC)nullDrawArraysInstanced;
+    glDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDPROC)nullDrawElementsInstanced;
+
+    glUniform1f = (PFNGLUNIFORM1FPROC)nullUniform1f;
+    glUniform2f = (PFNGLUNIFORM2FPROC)nullUniform2f;
+    glUniform3f = (PFNGLUNIFORM3FPROC)nullUniform3f;
+    glUniform4f = (PFNGLUNIFORM4FPROC)nullUniform4f;
+    glUniform1i = (PFNGLUNIFORM1IPROC)nullUniform1i;
+    glUniform1fv = (PFNGLUNIFORM1FVPROC)nullUniformfv;
+    glUniform2fv = (PFNGLUNIFORM2FVPROC)nullUniformfv;
+    glUniform3fv = (PFNGLUNIFORM3FVPROC)nullUniformfv;
+    glUniform4fv = (PFNGLUNIFORM4FVPROC)nullUniformfv;
+    glUniform1iv = (PFNGLUNIFORM1IVPROC)nullUniformiv;
+    glUniformMatrix4fv = (PFNGLUNIFORMMATRIX4FVPROC)nullUniformMatrix4fv;
+}
@@ -0,0 +1,18 @@
+#ifndef NULLGRAPHICS_H_
+#define NULLGRAPHICS_H_
+
+/**
+ * Installs OpenGL entry points that issue no graphics calls.
+ *
+ * Benchmarks call this before creating any graphics object, so that effects, meshes and
+ * textures can be created, bound and drawn with the engine code on machines without a GPU
+ * or graphics context. The CPU cost of the engine is measured, not that of a driver.
+ *
+ * Object handles are counted from one, shaders always compile and link, and every program
+ * reports the same vertex attributes and uniforms (those used by the built-in shaders for
+ * positions, normals, texture coordinates, colors, instances, transforms and diffuse
+ * textures). Instanced arrays are supported.
+ */
+void installNullGraphics();
+
+#endif
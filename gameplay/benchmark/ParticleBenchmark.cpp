@@ -0,0 +1,167 @@
+#include "../src/Base.h"
+#include "../src/FileSystem.h"
+#include "../src/Game.h"
+#include "../src/JobSystem.h"
+#include "../src/Node.h"
+#include "../src/ParticleEmitter.h"
+#include "HeadlessGame.h"
+#include <chrono>
+
+using namespace gameplay;
+
+// Number of large emitters and particles of each, whose updates are split across the job
+// system (the sprite batch of an emitter indexes fewer than 65536 particles)
+#define LARGE_EMITTER_COUNT     16
+#define LARGE_PARTICLE_COUNT    60000
+
+// Number of small emitters and particles of each, whose updates are not split
+#define SMALL_EMITTER_COUNT     256
+#define SMALL_PARTICLE_COUNT    4096
+
+// Default number of simulated frames
+#define DEFAULT_FRAMES          100
+
+// Simulation step in milliseconds
+#define FRAME_TIME              16.0f
+
+// Texture of the particles, relative to the resource path
+#define PARTICLE_TEXTURE        "res/logo_powered_white.png"
+
+static double getSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void report(const char* name, unsigned int frames, double seconds, unsigned int particleCount)
+{
+    double count = (double)frames * particleCount;
+    printf("%-36s %8.3f ms/frame  %9.2f particles/ms  %8.2f ns\n",
+        name, seconds * 1000.0 / frames, count / (seconds * 1000.0), seconds / count * 1000000000.0);
+}
+
+static const char* getBackendName()
+{
+#if defined(GP_USE_NEON)
+    return "NEON";
+#elif defined(GP_USE_SSE)
+#if defined(__AVX__) && defined(__FMA__)
+    return "SSE + AVX/FMA";
+#elif defined(__AVX__)
+    return "SSE + AVX";
+#else
+    return "SSE";
+#endif
+#else
+    return "scalar";
+#endif
+}
+
+/**
+ * Creates a smoke emitter attached to a new node, with all its particles emitted at once.
+ *
+ * The particles live much longer than the benchmark runs, so that every frame updates
+ * the same number of particles. They spin around random axes, as sparks do.
+ */
+static Node* createEmitter(unsigned int particleCount)
+{
+    ParticleEmitter* emitter = ParticleEmitter::create(PARTICLE_TEXTURE, ParticleEmitter::BLEND_ADDITIVE, particleCount);
+    if (emitter == NULL)
+        return NULL;
+
+    emitter->setEllipsoid(true);
+    emitter->setPosition(Vector3::zero(), Vector3::one());
+    emitter->setVelocity(Vector3(0, 2, 0), Vector3(4, 4, 4));
+    emitter->setAcceleration(Vector3(0, -1, 0), Vector3::zero());
+    emitter->setColor(Vector4(1, 0.75f, 0, 1), Vector4(0, 0.5f, 0, 0), Vector4(0.2f, 0.2f, 0.2f, 0), Vector4::zero());
+    emitter->setSize(0.5f, 1.0f, 2.0f, 4.0f);
+    emitter->setEnergy(1000000L, 4000000L);
+    emitter->setRotationPerParticle(-MATH_PI, MATH_PI);
+    emitter->setRotation(-MATH_PI, MATH_PI, Vector3::unitY(), Vector3::one());
+
+    Node* node = Node::create();
+    node->setDrawable(emitter);
+    emitter->emitOnce(particleCount);
+    SAFE_RELEASE(emitter);
+    return node;
+}
+
+/**
+ * Updates the emitters of the given nodes every frame and reports the time taken.
+ */
+static void updateEmitters(const char* name, const std::vector<Node*>& nodes, unsigned int frames)
+{
+    unsigned int particleCount = 0;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        particleCount = 0;
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            ParticleEmitter* emitter = static_cast<ParticleEmitter*>(nodes[i]->getDrawable());
+            emitter->update(FRAME_TIME);
+            particleCount += emitter->getParticlesCount();
+        }
+    }
+    report(name, frames, getSeconds(start), particleCount);
+}
+
+/**
+ * Creates the given number of emitters, updates them, and releases them.
+ */
+static bool benchmarkEmitters(const char* name, unsigned int emitterCount, unsigned int particleCount, unsigned int frames)
+{
+    std::vector<Node*> nodes;
+    for (unsigned int i = 0; i < emitterCount; ++i)
+    {
+        Node* node = createEmitter(particleCount);
+        if (node == NULL)
+            break;
+        nodes.push_back(node);
+    }
+    bool created = nodes.size() == emitterCount;
+    if (created)
+    {
+        updateEmitters(name, nodes, frames);
+    }
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        SAFE_RELEASE(nodes[i]);
+    }
+    return created;
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int frames = argc > 1 ? (unsigned int)atoi(argv[1]) : DEFAULT_FRAMES;
+    if (frames == 0)
+    {
+        printf("Usage: gameplay-particle-benchmark [frames]\n");
+        return 1;
+    }
+
+    FileSystem::setResourcePath(BENCHMARK_RESOURCE_PATH);
+    Game game;
+    if (!startHeadlessGame(&game))
+    {
+        printf("Failed to start the game.\n");
+        return 1;
+    }
+    JobSystem* jobSystem = game.getJobSystem();
+    GP_ASSERT(jobSystem);
+    printf("Math backend: %s, %u frames, %u job system workers.\n", getBackendName(), frames, jobSystem->getWorkerCount());
+
+    // The large emitters updated on the calling thread only, then across the job system.
+    jobSystem->setSingleThreaded(true);
+    bool created = benchmarkEmitters("Large emitters (single-threaded)", LARGE_EMITTER_COUNT, LARGE_PARTICLE_COUNT, frames);
+    jobSystem->setSingleThreaded(false);
+    created = created && benchmarkEmitters("Large emitters (job system)", LARGE_EMITTER_COUNT, LARGE_PARTICLE_COUNT, frames);
+
+    // Small emitters, which are always updated on the calling thread.
+    created = created && benchmarkEmitters("Small emitters", SMALL_EMITTER_COUNT, SMALL_PARTICLE_COUNT, frames);
+    if (!created)
+    {
+        printf("Failed to create the particle emitters.\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,303 @@
+#include "../src/Base.h"
+#include "../src/Camera.h"
+#include "../src/Game.h"
+#include "../src/Material.h"
+#include "../src/MeshPart.h"
+#include "../src/Model.h"
+#include "../src/Node.h"
+#include "../src/RenderQueue.h"
+#include "../src/Scene.h"
+#include "NullGraphics.h"
+#include <chrono>
+
+using namespace gameplay;
+
+// Number of models in the scene, cloned from a smaller number of prototypes
+#define MODEL_COUNT         10000
+#define PROTOTYPE_COUNT     64
+
+// Number of meshes shared by the prototypes, and number of parts of each mesh
+#define MESH_COUNT          16
+#define PART_COUNT          2
+
+// Number of distinct effects, textures and materials shared by the prototypes
+#define EFFECT_COUNT        8
+#define TEXTURE_COUNT       16
+#define MATERIAL_COUNT      64
+
+// One in this many materials is blended
+#define BLENDED_MATERIALS   7
+
+// Half the size of the cube the models are spread over, in front of the camera
+#define SCENE_EXTENT        100.0f
+
+// Default number of frames
+#define DEFAULT_FRAMES      200
+
+static const char* __vertexShader =
+    "attribute vec4 a_position;\n"
+    "attribute vec2 a_texCoord;\n"
+    "uniform mat4 u_worldViewProjectionMatrix;\n"
+    "varying vec2 v_texCoord;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = u_worldViewProjectionMatrix * a_position;\n"
+    "    v_texCoord = a_texCoord;\n"
+    "}\n";
+
+static const char* __fragmentShader =
+    "uniform sampler2D u_diffuseTexture;\n"
+    "uniform vec4 u_diffuseColor;\n"
+    "varying vec2 v_texCoord;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FragColor = texture2D(u_diffuseTexture, v_texCoord) * u_diffuseColor;\n"
+    "}\n";
+
+/**
+ * A backend issuing no graphics calls that counts the binds and draw calls, like the
+ * statistics of a render queue.
+ */
+class CountingBackend : public RenderQueue::Backend
+{
+public:
+
+    void bindEffect(Effect* effect)
+    {
+        statistics.effectBinds++;
+    }
+
+    void bindPass(Pass* pass, bool bindState, bool bindSamplers)
+    {
+        statistics.passBinds++;
+        if (bindState)
+            statistics.stateChanges++;
+        if (bindSamplers)
+            statistics.samplerBinds++;
+    }
+
+    void bindVertexAttributes(VertexAttributeBinding* binding)
+    {
+        statistics.vertexAttributeBinds++;
+    }
+
+    void unbindVertexAttributes(VertexAttributeBinding* binding)
+    {
+    }
+
+    void draw(const RenderQueue::Packet& packet)
+    {
+        statistics.packets++;
+        statistics.drawCalls++;
+    }
+
+    RenderQueue::Statistics statistics;
+};
+
+/**
+ * Draws the models of a scene one by one, in scene order.
+ */
+class SceneDrawer
+{
+public:
+
+    SceneDrawer(RenderQueue::Backend* backend) : _backend(backend)
+    {
+    }
+
+    bool drawNode(Node* node)
+    {
+        Model* model = dynamic_cast<Model*>(node->getDrawable());
+        if (model)
+            model->draw(_backend, false);
+        return true;
+    }
+
+private:
+
+    RenderQueue::Backend* _backend;
+};
+
+static float random(float min, float max)
+{
+    return min + (max - min) * ((float)rand() / RAND_MAX);
+}
+
+static double getSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void report(const char* name, unsigned int frames, double seconds, const RenderQueue::Statistics& statistics)
+{
+    printf("%-28s %8.3f ms/frame  %6u draws  %6u effects  %6u passes  %6u states  %6u samplers  %6u vertex bindings\n",
+        name, seconds * 1000.0 / frames, statistics.drawCalls, statistics.effectBinds, statistics.passBinds,
+        statistics.stateChanges, statistics.samplerBinds, statistics.vertexAttributeBinds);
+}
+
+static Mesh* createMesh()
+{
+    VertexFormat::Element elements[] =
+    {
+        VertexFormat::Element(VertexFormat::POSITION, 3),
+        VertexFormat::Element(VertexFormat::NORMAL, 3),
+        VertexFormat::Element(VertexFormat::TEXCOORD0, 2)
+    };
+    Mesh* mesh = Mesh::createMesh(VertexFormat(elements, 3), 24);
+    std::vector<unsigned short> indices(36);
+    for (unsigned int i = 0; i < 36; ++i)
+    {
+        indices[i] = (unsigned short)(i % 24);
+    }
+    for (unsigned int i = 0; i < PART_COUNT; ++i)
+    {
+        MeshPart* part = mesh->addPart(Mesh::TRIANGLES, Mesh::INDEX16, 36);
+        part->setIndexData(&indices[0], 0, 36);
+    }
+    return mesh;
+}
+
+static Material* createMaterial(Effect* effect, Texture* texture, bool blended)
+{
+    Material* material = Material::create(effect);
+    material->setParameterAutoBinding("u_worldViewProjectionMatrix", "WORLD_VIEW_PROJECTION_MATRIX");
+    material->getParameter("u_diffuseColor")->setValue(Vector4(random(0, 1), random(0, 1), random(0, 1), 1));
+    Texture::Sampler* sampler = Texture::Sampler::create(texture);
+    material->getParameter("u_diffuseTexture")->setValue(sampler);
+    SAFE_RELEASE(sampler);
+
+    RenderState::StateBlock* state = material->getStateBlock();
+    state->setDepthTest(true);
+    if (blended)
+    {
+        state->setBlend(true);
+        state->setBlendSrc(RenderState::BLEND_SRC_ALPHA);
+        state->setBlendDst(RenderState::BLEND_ONE_MINUS_SRC_ALPHA);
+        state->setDepthWrite(false);
+    }
+    return material;
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int frames = argc > 1 ? (unsigned int)atoi(argv[1]) : DEFAULT_FRAMES;
+    if (frames == 0)
+    {
+        printf("Usage: gameplay-renderqueue-benchmark [frames]\n");
+        return 1;
+    }
+    printf("%u frames of %u models cloned from %u prototypes with %u parts, %u materials and %u effects.\n",
+        frames, MODEL_COUNT, PROTOTYPE_COUNT, PART_COUNT, MATERIAL_COUNT, EFFECT_COUNT);
+
+    // The game is never run: it only provides the configuration read by the engine.
+    installNullGraphics();
+    Game game;
+
+    Effect* effects[EFFECT_COUNT];
+    for (unsigned int i = 0; i < EFFECT_COUNT; ++i)
+    {
+        char defines[32];
+        sprintf(defines, "EFFECT_%u", i);
+        effects[i] = Effect::createFromSource(__vertexShader, __fragmentShader, defines);
+    }
+    Texture* textures[TEXTURE_COUNT];
+    unsigned char pixels[4 * 4 * 4] = { 0 };
+    for (unsigned int i = 0; i < TEXTURE_COUNT; ++i)
+    {
+        textures[i] = Texture::create(Texture::RGBA, 4, 4, pixels);
+    }
+    Material* materials[MATERIAL_COUNT];
+    for (unsigned int i = 0; i < MATERIAL_COUNT; ++i)
+    {
+        materials[i] = createMaterial(effects[i % EFFECT_COUNT], textures[rand() % TEXTURE_COUNT], i % BLENDED_MATERIALS == BLENDED_MATERIALS - 1);
+    }
+    Mesh* meshes[MESH_COUNT];
+    for (unsigned int i = 0; i < MESH_COUNT; ++i)
+    {
+        meshes[i] = createMesh();
+    }
+
+    // Prototype models with random materials for their parts, which are cloned with their
+    // materials, so every model of the scene owns its passes.
+    Node* prototypes[PROTOTYPE_COUNT];
+    for (unsigned int i = 0; i < PROTOTYPE_COUNT; ++i)
+    {
+        Model* model = Model::create(meshes[i % MESH_COUNT]);
+        for (unsigned int j = 0; j < PART_COUNT; ++j)
+        {
+            model->setMaterial(materials[rand() % MATERIAL_COUNT], j);
+        }
+        prototypes[i] = Node::create();
+        prototypes[i]->setDrawable(model);
+        SAFE_RELEASE(model);
+    }
+
+    Scene* scene = Scene::create();
+    Camera* camera = Camera::createPerspective(45.0f, 16.0f / 9.0f, 1.0f, SCENE_EXTENT * 4.0f);
+    Node* cameraNode = scene->addNode("camera");
+    cameraNode->setCamera(camera);
+    scene->setActiveCamera(camera);
+    for (unsigned int i = 0; i < MODEL_COUNT; ++i)
+    {
+        Node* node = prototypes[rand() % PROTOTYPE_COUNT]->clone();
+        node->setTranslation(random(-SCENE_EXTENT, SCENE_EXTENT), random(-SCENE_EXTENT, SCENE_EXTENT), -SCENE_EXTENT + random(-SCENE_EXTENT, SCENE_EXTENT));
+        scene->addNode(node);
+        SAFE_RELEASE(node);
+    }
+
+    // Drawing the models one by one in scene order, binding every pass in full.
+    CountingBackend counter;
+    SceneDrawer counterDrawer(&counter);
+    scene->visit(&counterDrawer, &SceneDrawer::drawNode);
+    SceneDrawer drawer(RenderQueue::getNullBackend());
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        scene->visit(&drawer, &SceneDrawer::drawNode);
+    }
+    report("Scene order", frames, getSeconds(start), counter.statistics);
+
+    // Submitting, sorting and executing the packets of every frame.
+    RenderQueue queue;
+    queue.setBackend(RenderQueue::getNullBackend());
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        queue.begin(camera);
+        queue.submit(scene);
+        queue.execute();
+    }
+    report("Render queue", frames, getSeconds(start), queue.getStatistics());
+
+    // Executing the packets again, without submitting and sorting them.
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        queue.execute();
+    }
+    report("Render queue (execute only)", frames, getSeconds(start), queue.getStatistics());
+
+    SAFE_RELEASE(camera);
+    SAFE_RELEASE(scene);
+    for (unsigned int i = 0; i < PROTOTYPE_COUNT; ++i)
+    {
+        SAFE_RELEASE(prototypes[i]);
+    }
+    for (unsigned int i = 0; i < MESH_COUNT; ++i)
+    {
+        SAFE_RELEASE(meshes[i]);
+    }
+    for (unsigned int i = 0; i < MATERIAL_COUNT; ++i)
+    {
+        SAFE_RELEASE(materials[i]);
+    }
+    for (unsigned int i = 0; i < TEXTURE_COUNT; ++i)
+    {
+        SAFE_RELEASE(textures[i]);
+    }
+    for (unsigned int i = 0; i < EFFECT_COUNT; ++i)
+    {
+        SAFE_RELEASE(effects[i]);
+    }
+    return 0;
+}
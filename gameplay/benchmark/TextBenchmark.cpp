@@ -0,0 +1,132 @@
+#include "../src/Base.h"
+#include "../src/Font.h"
+#include <chrono>
+
+using namespace gameplay;
+
+// Number of labels laid out every frame
+#define LABEL_COUNT         10000
+
+// Number of columns the labels are laid out in, and the size of their text
+#define LABEL_COLUMNS       10
+#define LABEL_SIZE          14
+
+// Width and height of the area the labels are laid out in
+#define SCREEN_WIDTH        1280
+#define SCREEN_HEIGHT       720
+
+// Number of characters of the long text laid out in a single run
+#define LONG_TEXT_LENGTH    20000
+
+// Default number of simulated frames
+#define DEFAULT_FRAMES      100
+
+static double getSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void report(const char* name, unsigned int frames, double seconds, unsigned int glyphCount)
+{
+    printf("%-28s %8.3f ms/frame  %8u glyphs\n", name, seconds * 1000.0 / frames, glyphCount);
+}
+
+/**
+ * Creates a font for the printable ASCII characters that only lays out text.
+ *
+ * The glyphs have varying widths but no texture coordinates: the font has no texture map, so
+ * it needs no graphics context and cannot draw.
+ */
+static Font* createFont()
+{
+    Font::Glyph glyphs[95];
+    for (unsigned int i = 0; i < 95; ++i)
+    {
+        Font::Glyph& glyph = glyphs[i];
+        glyph.code = 32 + i;
+        glyph.width = LABEL_SIZE / 2 + i % 5;
+        glyph.bearingX = 0;
+        glyph.advance = glyph.width + 1;
+        glyph.uvs[0] = glyph.uvs[1] = glyph.uvs[2] = glyph.uvs[3] = 0.0f;
+    }
+    return Font::create("benchmark", Font::PLAIN, LABEL_SIZE, glyphs, 95, NULL, Font::BITMAP);
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int frames = argc > 1 ? (unsigned int)atoi(argv[1]) : DEFAULT_FRAMES;
+    if (frames == 0)
+    {
+        printf("Usage: gameplay-text-benchmark [frames]\n");
+        return 1;
+    }
+    printf("%u frames of %u labels.\n", frames, LABEL_COUNT);
+
+    Font* font = createFont();
+    if (font == NULL)
+    {
+        printf("Failed to create the font.\n");
+        return 1;
+    }
+
+    // Lay the labels out in columns, overlapping once the screen is full.
+    std::vector<std::string> labels(LABEL_COUNT);
+    std::vector<Rectangle> areas(LABEL_COUNT);
+    float columnWidth = SCREEN_WIDTH / (float)LABEL_COLUMNS;
+    unsigned int rowCount = SCREEN_HEIGHT / LABEL_SIZE;
+    for (unsigned int i = 0; i < LABEL_COUNT; ++i)
+    {
+        char buffer[32];
+        sprintf(buffer, "Label %u", i);
+        labels[i] = buffer;
+
+        unsigned int column = i % LABEL_COLUMNS;
+        unsigned int row = (i / LABEL_COLUMNS) % rowCount;
+        areas[i].set(column * columnWidth, row * LABEL_SIZE, columnWidth, LABEL_SIZE);
+    }
+
+    // Laying out a new text run for every label, as drawing text did before runs were kept.
+    unsigned int glyphCount = 0;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        glyphCount = 0;
+        for (unsigned int i = 0; i < LABEL_COUNT; ++i)
+        {
+            Font::TextRun run;
+            font->layoutText(&run, labels[i].c_str(), areas[i], LABEL_SIZE);
+            glyphCount += run.getGlyphCount();
+        }
+    }
+    report("Layout every frame", frames, getSeconds(start), glyphCount);
+
+    // Keeping a text run for every label, which is only checked against its text and area.
+    std::vector<Font::TextRun> runs(LABEL_COUNT);
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        glyphCount = 0;
+        for (unsigned int i = 0; i < LABEL_COUNT; ++i)
+        {
+            font->layoutText(&runs[i], labels[i].c_str(), areas[i], LABEL_SIZE);
+            glyphCount += runs[i].getGlyphCount();
+        }
+    }
+    report("Owned text runs", frames, getSeconds(start), glyphCount);
+
+    // A single run of more glyphs than one sprite batch can index, which is drawn in batches.
+    std::string text(LONG_TEXT_LENGTH, 'x');
+    for (unsigned int i = 0; i < LONG_TEXT_LENGTH; i += 16)
+        text[i] = ' ';
+    Font::TextRun run;
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        run = Font::TextRun();
+        font->layoutText(&run, text.c_str(), Rectangle(0, 0, SCREEN_WIDTH, FLT_MAX), LABEL_SIZE);
+    }
+    report("Long text run", frames, getSeconds(start), run.getGlyphCount());
+
+    SAFE_RELEASE(font);
+    return 0;
+}
@@ -23,6 +23,7 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/AnimationController.cpp \
     src/AnimationTarget.cpp \
     src/AnimationValue.cpp \
+    src/AsyncSceneLoader.cpp \
     src/AudioBuffer.cpp \
     src/AudioController.cpp \
     src/AudioListener.cpp \
@@ -55,6 +56,8 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/Image.cpp \
     src/Image.inl \
     src/ImageControl.cpp \
+    src/InstancedModel.cpp \
+    src/JobSystem.cpp \
     src/Joint.cpp \
     src/JoystickControl.cpp \
     src/Label.cpp \
@@ -66,6 +69,7 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/MathUtil.cpp \
     src/MathUtil.inl \
     src/MathUtilNeon.inl \
+    src/MathUtilSSE.inl \
     src/Matrix.cpp \
     src/Matrix.inl \
     src/Mesh.cpp \
@@ -107,8 +111,10 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/Ray.inl \
     src/Rectangle.cpp \
     src/Ref.cpp \
+    src/RenderQueue.cpp \
     src/RenderState.cpp \
     src/RenderTarget.cpp \
+    src/ResourceCache.cpp \
     src/Scene.cpp \
     src/SceneLoader.cpp \
     src/ScreenDisplayer.cpp \
@@ -117,6 +123,7 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/ScriptController.inl \
     src/ScriptTarget.cpp \
     src/Slider.cpp \
+    src/SpatialIndex.cpp \
     src/Sprite.cpp \
     src/SpriteBatch.cpp \
     src/Technique.cpp \
@@ -129,6 +136,7 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/ThemeStyle.cpp \
     src/TileSet.cpp \
     src/Transform.cpp \
+    src/TransformStore.cpp \
     src/Vector2.cpp \
     src/Vector2.inl \
     src/Vector3.cpp \
@@ -284,6 +292,7 @@ HEADERS += src/AbsoluteLayout.h \
     src/AnimationController.h \
     src/AnimationTarget.h \
     src/AnimationValue.h \
+    src/AsyncSceneLoader.h \
     src/AudioBuffer.h \
     src/AudioController.h \
     src/AudioListener.h \
@@ -315,6 +324,8 @@ HEADERS += src/AbsoluteLayout.h \
     src/HeightField.h \
     src/Image.h \
     src/ImageControl.h \
+    src/InstancedModel.h \
+    src/JobSystem.h \
     src/Joint.h \
     src/JoystickControl.h \
     src/Keyboard.h \
@@ -357,8 +368,10 @@ HEADERS += src/AbsoluteLayout.h \
     src/Ray.h \
     src/Rectangle.h \
     src/Ref.h \
+    src/RenderQueue.h \
     src/RenderState.h \
     src/RenderTarget.h \
+    src/ResourceCache.h \
     src/Scene.h \
     src/SceneLoader.h \
     src/ScreenDisplayer.h \
@@ -366,6 +379,7 @@ HEADERS += src/AbsoluteLayout.h \
     src/ScriptController.h \
     src/ScriptTarget.h \
     src/Slider.h \
+    src/SpatialIndex.h \
     src/Sprite.h \
     src/SpriteBatch.h \
     src/Stream.h \
@@ -381,6 +395,7 @@ HEADERS += src/AbsoluteLayout.h \
     src/TimeListener.h \
     src/Touch.h \
     src/Transform.h \
+    src/TransformStore.h \
     src/Vector2.h \
     src/Vector3.h \
     src/Vector4.h \
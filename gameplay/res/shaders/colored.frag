@@ -97,6 +97,10 @@ varying vec3 v_cameraDirection;
 
 #endif
 
+#if defined(INSTANCING)
+varying vec4 v_instanceColor;
+#endif
+
 #if defined(CLIP_PLANE)
 varying float v_clipDistance;
 #endif
@@ -134,6 +138,10 @@ void main()
 	gl_FragColor.rgb *= lightColor.rgb;
 	#endif
 
+    #if defined(INSTANCING)
+    gl_FragColor *= v_instanceColor;
+    #endif
+
 	#if defined(MODULATE_COLOR)
     gl_FragColor *= u_modulateColor;
     #endif
@@ -20,6 +20,11 @@ attribute vec4 a_blendWeights;
 attribute vec4 a_blendIndices;
 #endif
 
+#if defined(INSTANCING)
+attribute mat4 a_instanceMatrix;
+attribute vec4 a_instanceColor;
+#endif
+
 #if defined(LIGHTMAP)
 attribute vec2 a_texCoord1;
 #endif
@@ -111,6 +116,10 @@ varying vec3 v_cameraDirection;
 #include "skinning-none.vert" 
 #endif
 
+#if defined(INSTANCING)
+varying vec4 v_instanceColor;
+#endif
+
 #if defined(CLIP_PLANE)
 varying float v_clipDistance;
 #endif
@@ -120,6 +129,10 @@ void main()
     vec4 position = getPosition();
     gl_Position = u_worldViewProjectionMatrix * position;
 
+    #if defined(INSTANCING)
+    v_instanceColor = a_instanceColor;
+    #endif
+
     #if defined (LIGHTING)
 
     vec3 normal = getNormal();
@@ -1,3 +1,34 @@
+#if defined(INSTANCING)
+
+vec4 getPosition()
+{
+    return a_instanceMatrix * a_position;
+}
+
+#if defined(LIGHTING)
+
+// Instance matrices are assumed to have a uniform scale.
+vec3 getNormal()
+{
+    return mat3(a_instanceMatrix[0].xyz, a_instanceMatrix[1].xyz, a_instanceMatrix[2].xyz) * a_normal;
+}
+
+#if defined(BUMPED)
+vec3 getTangent()
+{
+    return mat3(a_instanceMatrix[0].xyz, a_instanceMatrix[1].xyz, a_instanceMatrix[2].xyz) * a_tangent;
+}
+
+vec3 getBinormal()
+{
+    return mat3(a_instanceMatrix[0].xyz, a_instanceMatrix[1].xyz, a_instanceMatrix[2].xyz) * a_binormal;
+}
+#endif
+
+#endif
+
+#else
+
 vec4 getPosition()
 {
     return a_position;    
@@ -22,4 +53,6 @@ vec3 getBinormal()
 }
 #endif
 
+#endif
+
 #endif
\ No newline at end of file
@@ -18,10 +18,17 @@ attribute vec4 a_position;
 attribute vec3 a_normal;
 #endif
 attribute vec2 a_texCoord0;
+#if defined(MORPH)
+attribute vec2 a_texCoord1;
+#endif
 
 ///////////////////////////////////////////////////////////
 // Uniforms
 uniform mat4 u_worldViewProjectionMatrix;
+#if defined(MORPH)
+uniform float u_morph;
+uniform vec4 u_edgeMorph;
+#endif
 #if !defined(NORMAL_MAP) && defined(LIGHTING)
 uniform mat4 u_normalMatrix;
 #endif
@@ -85,8 +92,18 @@ varying vec2 v_texCoordLayer2;
 
 void main()
 {
+    vec4 position = a_position;
+
+    #if defined(MORPH)
+    // Geomorph towards the next coarser level (a_texCoord1.x is the height delta to it). Vertices
+    // on an edge (a_texCoord1.y is the edge index + 1) use the morph factor shared with the neighbor.
+    vec4 edge = vec4(equal(vec4(a_texCoord1.y), vec4(1.0, 2.0, 3.0, 4.0)));
+    float morph = mix(u_morph, dot(edge, u_edgeMorph), dot(edge, vec4(1.0)));
+    position.y += a_texCoord1.x * morph;
+    #endif
+
     // Transform position to clip space.
-    gl_Position = u_worldViewProjectionMatrix * a_position;
+    gl_Position = u_worldViewProjectionMatrix * position;
 
     #if defined(LIGHTING)
 
@@ -94,7 +111,7 @@ void main()
     v_normalVector = normalize((u_normalMatrix * vec4(a_normal.x, a_normal.y, a_normal.z, 0)).xyz);
     #endif
 
-    applyLight(a_position);
+    applyLight(position);
 
     #endif
 
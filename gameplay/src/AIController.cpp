@@ -6,12 +6,16 @@ namespace gameplay
 {
 
 AIController::AIController()
-    : _paused(false), _firstMessage(NULL), _firstAgent(NULL)
+    : _paused(false), _messageSequence(0), _firstAgent(NULL), _messagePoolHits(0), _messagePoolMisses(0)
 {
 }
 
 AIController::~AIController()
 {
+    for (size_t i = 0, count = _messagePool.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_messagePool[i]);
+    }
 }
 
 void AIController::initialize()
@@ -29,16 +33,21 @@ void AIController::finalize()
         SAFE_RELEASE(temp);
     }
     _firstAgent = NULL;
+    _agentIndex.clear();
 
     // Remove all messages
-    AIMessage* message = _firstMessage;
-    while (message)
+    for (size_t i = 0, count = _pendingMessages.size(); i < count; ++i)
+    {
+        freeMessage(_pendingMessages[i].message);
+    }
+    _pendingMessages.clear();
+
+    // Release the pooled messages
+    for (size_t i = 0, count = _messagePool.size(); i < count; ++i)
     {
-        AIMessage* temp = message;
-        message = message->_next;
-        AIMessage::destroy(temp);
+        SAFE_DELETE(_messagePool[i]);
     }
-    _firstMessage = NULL;
+    _messagePool.clear();
 }
 
 void AIController::pause()
@@ -53,44 +62,85 @@ void AIController::resume()
 
 void AIController::sendMessage(AIMessage* message, float delay)
 {
+    GP_ASSERT(message);
+
     if (delay <= 0)
     {
         // Send instantly
-        if (message->getReceiver() == NULL || strlen(message->getReceiver()) == 0)
+        deliverMessage(message);
+    }
+    else
+    {
+        // Queue for later delivery
+        message->_deliveryTime = Game::getGameTime() + delay;
+
+        PendingMessage pending;
+        pending.deliveryTime = message->_deliveryTime;
+        pending.sequence = _messageSequence++;
+        pending.message = message;
+        _pendingMessages.push_back(pending);
+        std::push_heap(_pendingMessages.begin(), _pendingMessages.end(), &comparePendingMessages);
+    }
+}
+
+void AIController::cancelMessages(const char* receiver)
+{
+    size_t count = 0;
+    for (size_t i = 0, pendingCount = _pendingMessages.size(); i < pendingCount; ++i)
+    {
+        AIMessage* message = _pendingMessages[i].message;
+        if (receiver == NULL || strcmp(receiver, message->getReceiver()) == 0)
         {
-            // Broadcast message to all agents
-            AIAgent* agent = _firstAgent;
-            while (agent)
-            {
-                if (agent->processMessage(message))
-                    break; // message consumed by this agent - stop bubbling
-                agent = agent->_next;
-            }
+            freeMessage(message);
         }
         else
         {
-            // Single recipient
-            AIAgent* agent = findAgent(message->getReceiver());
-            if (agent)
-            {
-                agent->processMessage(message);
-            }
-            else
-            {
-                GP_WARN("Failed to locate AIAgent for message recipient: %s", message->getReceiver());
-            }
+            _pendingMessages[count++] = _pendingMessages[i];
         }
+    }
+    _pendingMessages.resize(count);
+    std::make_heap(_pendingMessages.begin(), _pendingMessages.end(), &comparePendingMessages);
+}
 
-        // Delete the message, since it is finished being processed
-        AIMessage::destroy(message);
+void AIController::deliverMessage(AIMessage* message)
+{
+    if (message->getReceiver() == NULL || strlen(message->getReceiver()) == 0)
+    {
+        // Broadcast message to all agents
+        AIAgent* agent = _firstAgent;
+        while (agent)
+        {
+            if (agent->processMessage(message))
+                break; // message consumed by this agent - stop bubbling
+            agent = agent->_next;
+        }
     }
     else
     {
-        // Queue for later delivery
-        if (_firstMessage)
-            message->_next = _firstMessage;
-        _firstMessage = message;
+        // Single recipient
+        AIAgent* agent = findAgent(message->getReceiver());
+        if (agent)
+        {
+            agent->processMessage(message);
+        }
+        else
+        {
+            GP_WARN("Failed to locate AIAgent for message recipient: %s", message->getReceiver());
+        }
     }
+
+    // Recycle the message, since it is finished being processed
+    freeMessage(message);
+}
+
+bool AIController::comparePendingMessages(const PendingMessage& m1, const PendingMessage& m2)
+{
+    // std::push_heap/pop_heap build a max-heap, so the later message compares as less.
+    if (m1.deliveryTime != m2.deliveryTime)
+        return m1.deliveryTime > m2.deliveryTime;
+
+    // The sequence number wraps around, so compare the signed difference.
+    return (int)(m1.sequence - m2.sequence) > 0;
 }
 
 void AIController::update(float elapsedTime)
@@ -98,30 +148,14 @@ void AIController::update(float elapsedTime)
     if (_paused)
         return;
 
-    static Game* game = Game::getInstance();
-
-    // Send all pending messages that have expired
-    AIMessage* prevMsg = NULL;
-    AIMessage* msg = _firstMessage;
-    while (msg)
+    // Send all pending messages that have expired, earliest first. Only due messages are touched.
+    double time = Game::getGameTime();
+    while (!_pendingMessages.empty() && _pendingMessages.front().deliveryTime <= time)
     {
-        // If the message delivery time has expired, send it (this also deletes it)
-        if (msg->getDeliveryTime() >= game->getGameTime())
-        {
-            // Link the message out of our list
-            if (prevMsg)
-                prevMsg->_next = msg->_next;
-
-            AIMessage* temp = msg;
-            msg = msg->_next;
-            temp->_next = NULL;
-            sendMessage(temp);
-        }
-        else
-        {
-            prevMsg = msg;
-            msg = msg->_next;
-        }
+        AIMessage* message = _pendingMessages.front().message;
+        std::pop_heap(_pendingMessages.begin(), _pendingMessages.end(), &comparePendingMessages);
+        _pendingMessages.pop_back();
+        deliverMessage(message);
     }
 
     // Update all enabled agents
@@ -143,6 +177,8 @@ void AIController::addAgent(AIAgent* agent)
         agent->_next = _firstAgent;
 
     _firstAgent = agent;
+
+    indexAgent(agent);
 }
 
 void AIController::removeAgent(AIAgent* agent)
@@ -160,6 +196,7 @@ void AIController::removeAgent(AIAgent* agent)
                 _firstAgent = agent->_next;
 
             agent->_next = NULL;
+            unindexAgent(agent, agent->getId());
             agent->release();
             break;
         }
@@ -169,20 +206,83 @@ void AIController::removeAgent(AIAgent* agent)
     }
 }
 
-AIAgent* AIController::findAgent(const char* id) const
+void AIController::indexAgent(AIAgent* agent)
 {
-    GP_ASSERT(id);
+    GP_ASSERT(agent);
 
-    AIAgent* agent = _firstAgent;
-    while (agent)
+    // Agents are added to the front of the list, so the most recently added
+    // agent is the first match for its ID.
+    const char* id = agent->getId();
+    if (id && *id)
     {
-        if (strcmp(id, agent->getId()) == 0)
-            return agent;
+        _agentIndex[id] = agent;
+    }
+}
 
-        agent = agent->_next;
+void AIController::unindexAgent(AIAgent* agent, const char* id)
+{
+    GP_ASSERT(agent);
+
+    if (id == NULL || *id == '\0')
+        return;
+
+    std::unordered_map<std::string, AIAgent*>::iterator itr = _agentIndex.find(id);
+    if (itr == _agentIndex.end() || itr->second != agent)
+        return;
+
+    // Fall back to the next registered agent sharing the same ID, if any.
+    AIAgent* next = _firstAgent;
+    while (next && (next == agent || strcmp(id, next->getId()) != 0))
+    {
+        next = next->_next;
+    }
+    if (next)
+        itr->second = next;
+    else
+        _agentIndex.erase(itr);
+}
+
+unsigned int AIController::getMessagePoolHits() const
+{
+    return _messagePoolHits;
+}
+
+unsigned int AIController::getMessagePoolMisses() const
+{
+    return _messagePoolMisses;
+}
+
+AIMessage* AIController::allocateMessage()
+{
+    if (_messagePool.empty())
+    {
+        ++_messagePoolMisses;
+        return new AIMessage();
     }
 
-    return NULL;
+    ++_messagePoolHits;
+    AIMessage* message = _messagePool.back();
+    _messagePool.pop_back();
+    return message;
+}
+
+void AIController::freeMessage(AIMessage* message)
+{
+    GP_ASSERT(message);
+
+    // Release string parameters now, but keep the parameter storage for reuse.
+    message->setParameterCount(0);
+    message->_deliveryTime = 0;
+    message->_messageType = AIMessage::MESSAGE_TYPE_CUSTOM;
+    _messagePool.push_back(message);
+}
+
+AIAgent* AIController::findAgent(const char* id) const
+{
+    GP_ASSERT(id);
+
+    std::unordered_map<std::string, AIAgent*>::const_iterator itr = _agentIndex.find(id);
+    return itr == _agentIndex.end() ? NULL : itr->second;
 }
 
 }
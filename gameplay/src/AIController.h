@@ -16,6 +16,7 @@ class AIController
 {
     friend class Game;
     friend class Node;
+    friend class AIMessage;
 
 public:
 
@@ -29,22 +30,61 @@ public:
      * For this reason, AIMessage pointers should NOT be held or explicitly destroyed by any code after
      * they are sent through the AIController.
      *
+     * Delayed messages are delivered in order of their delivery time. Messages with the same
+     * delivery time are delivered in the order they were sent.
+     *
      * @param message The message to send.
      * @param delay The delay (in milliseconds) to wait before sending the message.
      */
     void sendMessage(AIMessage* message, float delay = 0);
 
+    /**
+     * Cancels delayed messages that have not been delivered yet.
+     *
+     * Cancelled messages are destroyed without being delivered.
+     *
+     * @param receiver The ID of the receiver whose pending messages should be cancelled,
+     *        or NULL to cancel all pending messages.
+     */
+    void cancelMessages(const char* receiver = NULL);
+
     /**
      * Searches for an AIAgent that is registered with the AIController with the specified ID.
      *
+     * Agents are indexed by ID, so this lookup does not depend on the number of registered agents.
+     *
      * @param id ID of the agent to find.
      *
      * @return The first agent matching the specified ID, or NULL if no matching agent could be found.
      */
     AIAgent* findAgent(const char* id) const;
 
+    /**
+     * Gets the number of messages created from recycled pool memory.
+     *
+     * @return The number of message pool hits.
+     */
+    unsigned int getMessagePoolHits() const;
+
+    /**
+     * Gets the number of messages that had to be allocated because the message pool was empty.
+     *
+     * @return The number of message pool misses.
+     */
+    unsigned int getMessagePoolMisses() const;
+
 private:
 
+    /**
+     * A message waiting in the delivery queue.
+     */
+    struct PendingMessage
+    {
+        double deliveryTime;
+        unsigned int sequence;
+        AIMessage* message;
+    };
+
     /**
      * Constructor.
      */
@@ -96,9 +136,44 @@ private:
 
     void removeAgent(AIAgent* agent);
 
+    /**
+     * Adds the specified agent to the ID index.
+     */
+    void indexAgent(AIAgent* agent);
+
+    /**
+     * Removes the specified agent from the ID index.
+     */
+    void unindexAgent(AIAgent* agent, const char* id);
+
+    /**
+     * Delivers the specified message to its recipient(s) and destroys it.
+     */
+    void deliverMessage(AIMessage* message);
+
+    /**
+     * Takes a message from the pool, or allocates a new one if the pool is empty.
+     */
+    AIMessage* allocateMessage();
+
+    /**
+     * Returns a message to the pool.
+     */
+    void freeMessage(AIMessage* message);
+
+    /**
+     * Orders pending messages so that the earliest message is at the top of the heap.
+     */
+    static bool comparePendingMessages(const PendingMessage& m1, const PendingMessage& m2);
+
     bool _paused;
-    AIMessage* _firstMessage;
+    std::vector<PendingMessage> _pendingMessages;
+    unsigned int _messageSequence;
     AIAgent* _firstAgent;
+    std::unordered_map<std::string, AIAgent*> _agentIndex;
+    std::vector<AIMessage*> _messagePool;
+    unsigned int _messagePoolHits;
+    unsigned int _messagePoolMisses;
 
 };
 
@@ -1,34 +1,48 @@
 #include "Base.h"
 #include "AIMessage.h"
+#include "Game.h"
 
 namespace gameplay
 {
 
 AIMessage::AIMessage()
-    : _id(0), _deliveryTime(0), _parameters(NULL), _parameterCount(0), _messageType(MESSAGE_TYPE_CUSTOM), _next(NULL)
+    : _id(0), _deliveryTime(0), _parameters(NULL), _parameterCount(0), _heapParameters(NULL), _heapParameterCapacity(0),
+      _messageType(MESSAGE_TYPE_CUSTOM)
 {
 }
 
 AIMessage::~AIMessage()
 {
-    SAFE_DELETE_ARRAY(_parameters);
+    SAFE_DELETE_ARRAY(_heapParameters);
 }
 
 AIMessage* AIMessage::create(unsigned int id, const char* sender, const char* receiver, unsigned int parameterCount)
 {
-    AIMessage* message = new AIMessage();
+    Game* game = Game::getInstance();
+    AIController* aiController = game ? game->getAIController() : NULL;
+    AIMessage* message = aiController ? aiController->allocateMessage() : new AIMessage();
     message->_id = id;
-    message->_sender = sender;
-    message->_receiver = receiver;
-    message->_parameterCount = parameterCount;
-    if (parameterCount > 0)
-        message->_parameters = new AIMessage::Parameter[parameterCount];
+    message->_sender = sender ? sender : "";
+    message->_receiver = receiver ? receiver : "";
+    message->setParameterCount(parameterCount);
     return message;
 }
 
 void AIMessage::destroy(AIMessage* message)
 {
-    SAFE_DELETE(message);
+    if (!message)
+        return;
+
+    Game* game = Game::getInstance();
+    AIController* aiController = game ? game->getAIController() : NULL;
+    if (aiController)
+    {
+        aiController->freeMessage(message);
+    }
+    else
+    {
+        SAFE_DELETE(message);
+    }
 }
 
 unsigned int AIMessage::getId() const
@@ -176,6 +190,36 @@ AIMessage::ParameterType AIMessage::getParameterType(unsigned int index) const
     return _parameters[index].type;
 }
 
+void AIMessage::setParameterCount(unsigned int parameterCount)
+{
+    // Release any strings held by the previous parameters.
+    for (unsigned int i = 0; i < _parameterCount; ++i)
+    {
+        _parameters[i].clear();
+    }
+
+    if (parameterCount == 0)
+    {
+        _parameters = NULL;
+    }
+    else if (parameterCount <= AI_MESSAGE_INLINE_PARAMETERS)
+    {
+        _parameters = _inlineParameters;
+    }
+    else
+    {
+        // Keep the largest parameter array so recycled messages rarely reallocate it.
+        if (parameterCount > _heapParameterCapacity)
+        {
+            SAFE_DELETE_ARRAY(_heapParameters);
+            _heapParameters = new AIMessage::Parameter[parameterCount];
+            _heapParameterCapacity = parameterCount;
+        }
+        _parameters = _heapParameters;
+    }
+    _parameterCount = parameterCount;
+}
+
 void AIMessage::clearParameter(unsigned int index)
 {
     GP_ASSERT(index < _parameterCount);
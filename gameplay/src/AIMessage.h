@@ -1,6 +1,9 @@
 #ifndef AIMESSAGE_H_
 #define AIMESSAGE_H_
 
+// Number of parameters stored inside the message itself.
+#define AI_MESSAGE_INLINE_PARAMETERS 4
+
 namespace gameplay
 {
 
@@ -11,6 +14,10 @@ namespace gameplay
  * Messages can store an arbitrary number of parameters. For the sake of simplicity,
  * each parameter is stored as type double, which is flexible enough to store most
  * data that needs to be passed.
+ *
+ * Messages are recycled through a pool owned by the AIController, and messages with
+ * up to AI_MESSAGE_INLINE_PARAMETERS parameters store them inline, so creating and
+ * sending typical messages does not allocate memory once the pool is warm.
  */
 class AIMessage
 {
@@ -267,14 +274,21 @@ private:
 
     void clearParameter(unsigned int index);
 
+    /**
+     * Resizes the parameter storage, keeping the inline storage for small counts.
+     */
+    void setParameterCount(unsigned int parameterCount);
+
     unsigned int _id;
     std::string _sender;
     std::string _receiver;
     double _deliveryTime;
     Parameter* _parameters;
     unsigned int _parameterCount;
+    Parameter _inlineParameters[AI_MESSAGE_INLINE_PARAMETERS];
+    Parameter* _heapParameters;
+    unsigned int _heapParameterCapacity;
     MessageType _messageType;
-    AIMessage* _next;
 
 };
 
@@ -27,6 +27,7 @@ class Animation : public Ref
     friend class AnimationClip;
     friend class AnimationTarget;
     friend class Bundle;
+    friend class AnimationController;
 
 public:
 
@@ -125,6 +126,7 @@ private:
         friend class AnimationClip;
         friend class Animation;
         friend class AnimationTarget;
+        friend class AnimationController;
 
     private:
 
@@ -202,6 +204,11 @@ private:
      */
     Channel* createChannel(AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, float* keyInValue, float* keyOutValue, unsigned int type);
 
+    /**
+     * Creates a channel within this animation from an existing curve (such as a packed curve).
+     */
+    Channel* createChannel(AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration);
+
     /**
      * Adds a channel to the animation.
      */
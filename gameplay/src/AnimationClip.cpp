@@ -5,6 +5,7 @@
 #include "Game.h"
 #include "Quaternion.h"
 #include "ScriptController.h"
+#include "MathUtil.h"
 
 namespace gameplay
 {
@@ -15,7 +16,7 @@ AnimationClip::AnimationClip(const char* id, Animation* animation, unsigned long
     : _id(id), _animation(animation), _startTime(startTime), _endTime(endTime), _duration(_endTime - _startTime), 
       _stateBits(0x00), _repeatCount(1.0f), _loopBlendTime(0), _activeDuration(_duration * _repeatCount), _speed(1.0f), _timeStarted(0), 
       _elapsedTime(0), _crossFadeToClip(NULL), _crossFadeOutElapsed(0), _crossFadeOutDuration(0), _blendWeight(1.0f),
-      _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerItr(NULL)
+      _percentComplete(0.0f), _samplePending(false), _lerpCount(0), _slerpCount(0), _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerItr(NULL)
 {
     GP_REGISTER_SCRIPT_EVENTS();
 
@@ -399,6 +400,8 @@ void AnimationClip::removeEndListener(AnimationClip::Listener* listener)
 
 bool AnimationClip::update(float elapsedTime)
 {
+    _samplePending = false;
+
     if (isClipStateBitSet(CLIP_IS_PAUSED_BIT))
     {
         return false;
@@ -551,32 +554,135 @@ bool AnimationClip::update(float elapsedTime)
         }
     }
     
-    // Evaluate this clip.
-    Animation::Channel* channel = NULL;
-    AnimationValue* value = NULL;
-    AnimationTarget* target = NULL;
-    size_t channelCount = _animation->_channels.size();
+    // The channels are sampled (and the clip ended) by the controller once every clip is updated.
+    _percentComplete = percentComplete;
+    _samplePending = true;
+    return false;
+}
+
+void AnimationClip::prepareSample()
+{
+    GP_ASSERT(_animation);
+
+    const size_t channelCount = _animation->_channels.size();
+    if (_cursors.size() == channelCount)
+        return;
+
+    // Allocate the cursors, and count the largest number of components gathered.
+    _cursors.assign(channelCount, Curve::Cursor());
+    _lerpCount = 0;
+    _slerpCount = 0;
+    for (size_t i = 0; i < channelCount; i++)
+    {
+        const Curve* curve = _animation->_channels[i]->getCurve();
+        GP_ASSERT(curve);
+        _lerpCount += curve->_componentCount;
+        if (curve->_quaternionOffset)
+        {
+            _lerpCount -= 4;
+            _slerpCount++;
+        }
+    }
+}
+
+void AnimationClip::sample(SampleBatch* batch)
+{
+    GP_ASSERT(_animation);
+    GP_ASSERT(batch);
+
+    const size_t channelCount = _animation->_channels.size();
+    GP_ASSERT(_values.size() >= channelCount);
+    GP_ASSERT(_cursors.size() == channelCount);
+
+    // Evaluate the channels, gathering the linear segments into the batch.
+    const unsigned int scalarStride = (unsigned int)batch->_lerpValues.size();
+    const unsigned int rotationStride = (unsigned int)batch->_slerpValues.size();
+    float* lerpTracks = scalarStride > 0 ? &batch->_lerpTracks[0] : NULL;
+    float* slerpTracks = rotationStride > 0 ? &batch->_slerpTracks[0] : NULL;
+    unsigned int& scalarCount = batch->_scalarCount;
+    unsigned int& rotationCount = batch->_rotationCount;
     float percentageStart = (float)_startTime / (float)_animation->_duration;
     float percentageEnd = (float)_endTime / (float)_animation->_duration;
     float percentageBlend = (float)_loopBlendTime / (float)_animation->_duration;
     for (size_t i = 0; i < channelCount; i++)
     {
-        channel = _animation->_channels[i];
-        GP_ASSERT(channel);
-        target = channel->_target;
-        GP_ASSERT(target);
-        value = _values[i];
-        GP_ASSERT(value);
-
-        // Evaluate the point on Curve
-        GP_ASSERT(channel->getCurve());
-        channel->getCurve()->evaluate(percentComplete, percentageStart, percentageEnd, percentageBlend, value->_value);
+        const Curve* curve = _animation->_channels[i]->getCurve();
+        GP_ASSERT(curve);
+        GP_ASSERT(_values[i]);
+        float* value = _values[i]->_value;
+
+        unsigned int index;
+        float* fromValue;
+        float* toValue;
+        float t;
+        float decoded[32];  // Packed curves have at most 16 components.
+        if (curve->_samples)
+        {
+            // Packed curves locate their samples directly, and decode them to be gathered.
+            unsigned int next;
+            if (!curve->locateSample(_percentComplete, percentageStart, percentageEnd, percentageBlend, &index, &next, &t))
+            {
+                curve->decodeSample(index, value);
+                continue;
+            }
+            GP_ASSERT(curve->_componentCount <= 16);
+            fromValue = decoded;
+            toValue = decoded + 16;
+            curve->decodeSample(index, fromValue);
+            curve->decodeSample(next, toValue);
+            if (t < 0.0f)
+            {
+                curve->interpolateValues(t, fromValue, toValue, value);
+                continue;
+            }
+        }
+        else
+        {
+            Curve::Point* from;
+            Curve::Point* to;
+            if (!curve->locate(_percentComplete, percentageStart, percentageEnd, percentageBlend, &_cursors[i], &index, &from, &to, &t))
+            {
+                memcpy(value, from->value, curve->_componentSize);
+                continue;
+            }
+            if (from->type != Curve::LINEAR || t < 0.0f)
+            {
+                curve->interpolate(t, index, from, to, value);
+                continue;
+            }
+            fromValue = from->value;
+            toValue = to->value;
+        }
 
-        // Set the animation value on the target property.
-        target->setAnimationPropertyValue(channel->_propertyId, value, _blendWeight);
+        const unsigned int quaternionOffset = curve->_quaternionOffset ? *curve->_quaternionOffset : curve->_componentCount;
+        for (unsigned int j = 0; j < curve->_componentCount; j++)
+        {
+            if (j == quaternionOffset)
+            {
+                for (unsigned int k = 0; k < 4; k++)
+                {
+                    slerpTracks[k * rotationStride + rotationCount] = fromValue[j + k];
+                    slerpTracks[(k + 4) * rotationStride + rotationCount] = toValue[j + k];
+                }
+                slerpTracks[8 * rotationStride + rotationCount] = t;
+                batch->_slerpValues[rotationCount++] = value + j;
+                j += 3;
+            }
+            else
+            {
+                lerpTracks[scalarCount] = fromValue[j];
+                lerpTracks[scalarStride + scalarCount] = toValue[j];
+                lerpTracks[2 * scalarStride + scalarCount] = t;
+                batch->_lerpValues[scalarCount++] = value + j;
+            }
+        }
     }
+}
+
+bool AnimationClip::finishUpdate()
+{
+    _samplePending = false;
 
-    // When ended. Probably should move to it's own method so we can call it when the clip is ended early.
     if (isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT) || !isClipStateBitSet(CLIP_IS_STARTED_BIT))
     {
         onEnd();
@@ -665,6 +771,60 @@ void AnimationClip::resetClipStateBit(unsigned char bit)
     _stateBits &= ~bit;
 }
 
+AnimationClip::SampleBatch::SampleBatch()
+    : _scalarCount(0), _rotationCount(0)
+{
+}
+
+void AnimationClip::SampleBatch::begin(AnimationClip* const* clips, unsigned int count)
+{
+    unsigned int scalarCount = 0;
+    unsigned int rotationCount = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        clips[i]->prepareSample();
+        scalarCount += clips[i]->_lerpCount;
+        rotationCount += clips[i]->_slerpCount;
+    }
+
+    // The size of the value arrays is the stride between the arrays of the tracks.
+    _lerpTracks.resize(scalarCount * 3);
+    _lerpValues.resize(scalarCount);
+    _slerpTracks.resize(rotationCount * 9);
+    _slerpValues.resize(rotationCount);
+    _scalarCount = 0;
+    _rotationCount = 0;
+}
+
+void AnimationClip::SampleBatch::finish()
+{
+    // Interpolate the gathered components together, and scatter them to the values.
+    if (_scalarCount > 0)
+    {
+        const unsigned int stride = (unsigned int)_lerpValues.size();
+        float* tracks = &_lerpTracks[0];
+        MathUtil::lerpArray(tracks, tracks + stride, tracks + 2 * stride, tracks, _scalarCount);
+        for (unsigned int i = 0; i < _scalarCount; i++)
+        {
+            *_lerpValues[i] = tracks[i];
+        }
+    }
+    if (_rotationCount > 0)
+    {
+        const unsigned int stride = (unsigned int)_slerpValues.size();
+        float* tracks = &_slerpTracks[0];
+        Quaternion::slerpArray(tracks, tracks + 4 * stride, tracks + 8 * stride, tracks, _rotationCount, stride);
+        for (unsigned int i = 0; i < _rotationCount; i++)
+        {
+            float* value = _slerpValues[i];
+            value[0] = tracks[i];
+            value[1] = tracks[stride + i];
+            value[2] = tracks[2 * stride + i];
+            value[3] = tracks[3 * stride + i];
+        }
+    }
+}
+
 AnimationClip* AnimationClip::clone(Animation* animation) const
 {
     // Don't clone the elapsed time, listeners or crossfade information.
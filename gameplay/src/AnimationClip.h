@@ -322,6 +322,37 @@ private:
         unsigned long _eventTime;   // The time at which the listener will be called back at during the playback of the AnimationClip.
     };
 
+    /**
+     * SampleBatch.
+     *
+     * Internal structure gathering the linear segments of the channels of the clips sampled by one
+     * job, in structures of arrays, so that they are interpolated together with SIMD instructions.
+     */
+    struct SampleBatch
+    {
+        /**
+         * Constructor.
+         */
+        SampleBatch();
+
+        /**
+         * Empties the batch and allocates its arrays for the channels of the given clips.
+         */
+        void begin(AnimationClip* const* clips, unsigned int count);
+
+        /**
+         * Interpolates the gathered segments and scatters them to the values of the clips.
+         */
+        void finish();
+
+        std::vector<float> _lerpTracks;     // From, to and time arrays of the gathered linear scalar components.
+        std::vector<float*> _lerpValues;    // Values receiving the gathered linear scalar components.
+        std::vector<float> _slerpTracks;    // From, to (4 arrays each) and time arrays of the gathered linear rotations.
+        std::vector<float*> _slerpValues;   // Values receiving the gathered linear rotations.
+        unsigned int _scalarCount;          // The number of gathered scalar components.
+        unsigned int _rotationCount;        // The number of gathered rotations.
+    };
+
     /**
      * Constructor.
      */
@@ -348,10 +379,37 @@ private:
     AnimationClip& operator=(const AnimationClip&);
 
     /**
-     * Updates the animation with the elapsed time.
+     * Updates the time, events and blend weight of the clip with the elapsed time.
+     *
+     * The channels of the clip are sampled afterwards by sample(), when _samplePending is set.
+     *
+     * @return true if the clip has ended without being sampled, and must be removed from the controller.
      */
     bool update(float elapsedTime);
 
+    /**
+     * Allocates the keyframe search caches of the channels, and counts the components they can gather.
+     */
+    void prepareSample();
+
+    /**
+     * Samples the channels of the clip at its current time into its values.
+     *
+     * This only writes to the data of this clip and to the batch, so clips can be sampled in
+     * parallel into different batches. Linear segments of the curves are gathered into the
+     * batch, and only written to the values when the batch is finished.
+     *
+     * @param batch The batch gathering the linear segments, begun with this clip.
+     */
+    void sample(SampleBatch* batch);
+
+    /**
+     * Ends the clip if it reached its end (or was stopped) during the last update.
+     *
+     * @return true if the clip has ended, and must be removed from the controller.
+     */
+    bool finishUpdate();
+
     /**
      * Handles when the AnimationClip begins.
      */
@@ -403,6 +461,11 @@ private:
     unsigned long _crossFadeOutDuration;                // The duration of the cross fade.
     float _blendWeight;                                 // The clip's blendweight.
     std::vector<AnimationValue*> _values;               // AnimationValue holder.
+    float _percentComplete;                             // The position in the clip to sample, computed by update().
+    bool _samplePending;                                // Whether the clip must be sampled after update().
+    std::vector<Curve::Cursor> _cursors;                // Keyframe search cache of each channel.
+    unsigned int _lerpCount;                            // The number of linear scalar components the channels can gather.
+    unsigned int _slerpCount;                           // The number of linear rotations the channels can gather.
     std::vector<Listener*>* _beginListeners;            // Collection of begin listeners on the clip.
     std::vector<Listener*>* _endListeners;              // Collection of end listeners on the clip.
     std::list<ListenerEvent*>* _listeners;              // Ordered collection of listeners on the clip.
@@ -2,17 +2,47 @@
 #include "AnimationController.h"
 #include "Game.h"
 #include "Curve.h"
+#include "Quaternion.h"
+
+// The number of running channels from which clips are sampled in parallel.
+#define PARALLEL_CHANNEL_THRESHOLD 256
+
+// The number of clips sampled by each job.
+#define PARALLEL_CLIP_GRAIN 4
 
 namespace gameplay
 {
 
+// Blends a sampled value into the value of a property, the way targets blend the values they are set to.
+static void blendValue(float* dst, const float* value, unsigned int componentCount, const unsigned int* quaternionOffset, float blendWeight)
+{
+    for (unsigned int i = 0; i < componentCount; i++)
+    {
+        if (quaternionOffset && i == *quaternionOffset)
+        {
+            Quaternion q;
+            Quaternion::slerp(Quaternion(dst + i), Quaternion(value + i), blendWeight, &q);
+            dst[i] = q.x;
+            dst[i + 1] = q.y;
+            dst[i + 2] = q.z;
+            dst[i + 3] = q.w;
+            i += 3;
+        }
+        else
+        {
+            dst[i] = Curve::lerp(blendWeight, dst[i], value[i]);
+        }
+    }
+}
+
 AnimationController::AnimationController()
-    : _state(STOPPED)
+    : _state(STOPPED), _boundChannelCount(0), _parallelSampling(true), _updateTime(0)
 {
 }
 
 AnimationController::~AnimationController()
 {
+    clearBindings();
 }
 
 void AnimationController::stopAllAnimations() 
@@ -27,6 +57,21 @@ void AnimationController::stopAllAnimations()
     }
 }
 
+void AnimationController::setParallelSampling(bool parallel)
+{
+    _parallelSampling = parallel;
+}
+
+bool AnimationController::isParallelSampling() const
+{
+    return _parallelSampling;
+}
+
+double AnimationController::getUpdateTime() const
+{
+    return _updateTime;
+}
+
 AnimationController::State AnimationController::getState() const
 {
     return _state;
@@ -46,6 +91,7 @@ void AnimationController::finalize()
         SAFE_RELEASE(clip);
     }
     _runningClips.clear();
+    clearBindings();
     _state = STOPPED;
 }
 
@@ -97,10 +143,12 @@ void AnimationController::update(float elapsedTime)
 {
     if (_state != RUNNING)
         return;
-    
+
+    double updateStartTime = Game::getAbsoluteTime();
     Transform::suspendTransformChanged();
 
-    // Loop through running clips and call update() on them.
+    // Loop through running clips and call update() on them, collecting the clips to sample.
+    unsigned int channelCount = 0;
     std::list<AnimationClip*>::iterator clipIter = _runningClips.begin();
     while (clipIter != _runningClips.end())
     {
@@ -122,15 +170,192 @@ void AnimationController::update(float elapsedTime)
         }
         else
         {
+            if (clip->_samplePending)
+            {
+                clip->addRef();
+                _sampledClips.push_back(clip);
+                channelCount += (unsigned int)clip->_animation->_channels.size();
+            }
             clipIter++;
         }
         clip->release();
     }
 
+    // Sample all the clips, then blend their values and write them to the targets.
+    sampleClips(channelCount);
+    updateBindings(channelCount);
+    applyPoses();
+
+    // End the clips that reached their end.
+    for (size_t i = 0, count = _sampledClips.size(); i < count; i++)
+    {
+        AnimationClip* clip = _sampledClips[i];
+        if (clip->finishUpdate())
+        {
+            unschedule(clip);
+        }
+        SAFE_RELEASE(clip);
+    }
+    _sampledClips.clear();
+
     Transform::resumeTransformChanged();
 
     if (_runningClips.empty())
+    {
         _state = IDLE;
+        clearBindings();
+    }
+
+    _updateTime = Game::getAbsoluteTime() - updateStartTime;
+}
+
+void AnimationController::sampleClips(unsigned int channelCount)
+{
+    const unsigned int clipCount = (unsigned int)_sampledClips.size();
+    if (clipCount == 0)
+        return;
+
+    // Each range of clips is sampled into the batch at the index of its first clip, so the
+    // batches are allocated before the jobs start.
+    if (_sampleBatches.size() < clipCount)
+        _sampleBatches.resize(clipCount);
+
+    JobSystem* jobSystem = _parallelSampling ? Game::getInstance()->getJobSystem() : NULL;
+    if (jobSystem && channelCount >= PARALLEL_CHANNEL_THRESHOLD && clipCount > 1)
+    {
+        jobSystem->parallelFor(clipCount, PARALLEL_CLIP_GRAIN, [this](unsigned int start, unsigned int end)
+        {
+            sampleClipRange(start, end);
+        });
+    }
+    else
+    {
+        sampleClipRange(0, clipCount);
+    }
+}
+
+void AnimationController::sampleClipRange(unsigned int start, unsigned int end)
+{
+    // The linear segments of all the clips are gathered, then interpolated together.
+    AnimationClip::SampleBatch& batch = _sampleBatches[start];
+    batch.begin(&_sampledClips[start], end - start);
+    for (unsigned int i = start; i < end; i++)
+    {
+        _sampledClips[i]->sample(&batch);
+    }
+    batch.finish();
+}
+
+void AnimationController::applyPoses()
+{
+    for (size_t i = 0, count = _bindings.size(); i < count; i++)
+    {
+        _bindings[i].blendCount = 0;
+    }
+
+    // Properties animated by a single clip are set directly; the others are blended in the
+    // order of the clips, starting from the current value of the property.
+    size_t channelIndex = 0;
+    for (size_t i = 0, clipCount = _sampledClips.size(); i < clipCount; i++)
+    {
+        AnimationClip* clip = _sampledClips[i];
+        const std::vector<Animation::Channel*>& channels = clip->_animation->_channels;
+        for (size_t j = 0, count = channels.size(); j < count; j++)
+        {
+            Binding& binding = _bindings[_channelBindings[channelIndex++]];
+            AnimationValue* value = clip->_values[j];
+            GP_ASSERT(value);
+            if (binding.clipCount == 1)
+            {
+                binding.target->setAnimationPropertyValue(binding.propertyId, value, clip->_blendWeight);
+                continue;
+            }
+
+            if (binding.blendCount++ == 0)
+            {
+                binding.target->getAnimationPropertyValue(binding.propertyId, binding.value);
+            }
+            blendValue(binding.value->_value, value->_value, binding.value->_componentCount, binding.curve->_quaternionOffset, clip->_blendWeight);
+        }
+    }
+
+    for (size_t i = 0, count = _bindings.size(); i < count; i++)
+    {
+        const Binding& binding = _bindings[i];
+        if (binding.blendCount > 0)
+        {
+            binding.target->setAnimationPropertyValue(binding.propertyId, binding.value, 1.0f);
+        }
+    }
+}
+
+void AnimationController::updateBindings(unsigned int channelCount)
+{
+    if (channelCount == _boundChannelCount && _sampledClips == _boundClips)
+        return;
+
+    clearBindings();
+
+    // The bound clips are retained so that they cannot be reallocated at the same address.
+    _boundClips = _sampledClips;
+    for (size_t i = 0, count = _boundClips.size(); i < count; i++)
+    {
+        _boundClips[i]->addRef();
+    }
+    _boundChannelCount = channelCount;
+
+    std::map<std::pair<AnimationTarget*, int>, unsigned int> bindingIndices;
+    _channelBindings.reserve(channelCount);
+    for (size_t i = 0, clipCount = _boundClips.size(); i < clipCount; i++)
+    {
+        const std::vector<Animation::Channel*>& channels = _boundClips[i]->_animation->_channels;
+        for (size_t j = 0, count = channels.size(); j < count; j++)
+        {
+            Animation::Channel* channel = channels[j];
+            GP_ASSERT(channel && channel->_target);
+            std::pair<AnimationTarget*, int> key(channel->_target, channel->_propertyId);
+            std::map<std::pair<AnimationTarget*, int>, unsigned int>::iterator itr = bindingIndices.find(key);
+            if (itr == bindingIndices.end())
+            {
+                Binding binding;
+                binding.target = channel->_target;
+                binding.propertyId = channel->_propertyId;
+                binding.curve = channel->getCurve();
+                binding.value = NULL;
+                binding.clipCount = 0;
+                binding.blendCount = 0;
+                itr = bindingIndices.insert(std::make_pair(key, (unsigned int)_bindings.size())).first;
+                _bindings.push_back(binding);
+            }
+            _bindings[itr->second].clipCount++;
+            _channelBindings.push_back(itr->second);
+        }
+    }
+
+    for (size_t i = 0, count = _bindings.size(); i < count; i++)
+    {
+        if (_bindings[i].clipCount > 1)
+        {
+            _bindings[i].value = new AnimationValue(_bindings[i].curve->getComponentCount());
+        }
+    }
+}
+
+void AnimationController::clearBindings()
+{
+    for (size_t i = 0, count = _bindings.size(); i < count; i++)
+    {
+        SAFE_DELETE(_bindings[i].value);
+    }
+    _bindings.clear();
+    _channelBindings.clear();
+
+    for (size_t i = 0, count = _boundClips.size(); i < count; i++)
+    {
+        SAFE_RELEASE(_boundClips[i]);
+    }
+    _boundClips.clear();
+    _boundChannelCount = 0;
 }
 
 }
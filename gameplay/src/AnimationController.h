@@ -11,6 +11,12 @@ namespace gameplay
 
 /**
  * Defines a class for controlling game animation.
+ *
+ * Every frame, the controller updates the time, events and blend weights of the
+ * running clips, samples the channels of all the clips into their values (spread
+ * over the worker threads of the job system when many channels are running), then
+ * blends the values of the clips animating the same property and writes the final
+ * value of each animated property to its target once.
  */
 class AnimationController
 {
@@ -25,9 +31,48 @@ public:
      * Stops all AnimationClips currently playing on the AnimationController.
      */
     void stopAllAnimations();
+
+    /**
+     * Sets whether the running clips are sampled on the worker threads of the job system.
+     *
+     * Parallel sampling is enabled by default, and is only used when enough channels are running.
+     *
+     * @param parallel true to sample the clips in parallel, false to sample them on the calling thread.
+     * @script{ignore}
+     */
+    void setParallelSampling(bool parallel);
+
+    /**
+     * Determines whether the running clips are sampled on the worker threads of the job system.
+     *
+     * @return true if the clips are sampled in parallel, false otherwise.
+     * @script{ignore}
+     */
+    bool isParallelSampling() const;
+
+    /**
+     * Gets the time spent in the last update of the running clips.
+     *
+     * @return The time, in milliseconds.
+     * @script{ignore}
+     */
+    double getUpdateTime() const;
        
 private:
 
+    /**
+     * A property of a target animated by the sampled clips.
+     */
+    struct Binding
+    {
+        AnimationTarget* target;        // The animated target.
+        int propertyId;                 // The animated property of the target.
+        const Curve* curve;             // The curve of a channel animating the property.
+        AnimationValue* value;          // The blended value of the property, if several clips animate it.
+        unsigned int clipCount;         // The number of clips animating the property.
+        unsigned int blendCount;        // The number of clips blended into the value this frame.
+    };
+
     /**
      * The states that the AnimationController may be in.
      */
@@ -95,9 +140,42 @@ private:
      * Callback for when the controller receives a frame update event.
      */
     void update(float elapsedTime);
+
+    /**
+     * Samples the clips updated this frame, in parallel when they have enough channels.
+     */
+    void sampleClips(unsigned int channelCount);
+
+    /**
+     * Samples the clips updated this frame in [start, end) into one batch.
+     */
+    void sampleClipRange(unsigned int start, unsigned int end);
+
+    /**
+     * Blends the sampled values of the clips and writes them to their targets.
+     */
+    void applyPoses();
+
+    /**
+     * Maps the channels of the sampled clips to the properties they animate, if the sampled clips changed.
+     */
+    void updateBindings(unsigned int channelCount);
+
+    /**
+     * Clears the bindings and releases the clips they were built for.
+     */
+    void clearBindings();
     
     State _state;                                 // The current state of the AnimationController.
     std::list<AnimationClip*> _runningClips;      // A list of running AnimationClips.
+    std::vector<AnimationClip*> _sampledClips;    // The clips sampled this frame.
+    std::vector<AnimationClip*> _boundClips;      // The clips the bindings were built for.
+    std::vector<AnimationClip::SampleBatch> _sampleBatches; // The batch of the clips sampled from each index.
+    std::vector<Binding> _bindings;               // The properties animated by the bound clips.
+    std::vector<unsigned int> _channelBindings;   // The binding of each channel of the bound clips.
+    unsigned int _boundChannelCount;              // The number of channels of the bound clips.
+    bool _parallelSampling;                       // Whether clips are sampled on the job system.
+    double _updateTime;                           // The time spent in the last update.
 };
 
 }
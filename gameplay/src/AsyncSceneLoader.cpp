@@ -0,0 +1,207 @@
+#include "Base.h"
+#include "AsyncSceneLoader.h"
+#include "Bundle.h"
+#include "Game.h"
+#include "Scene.h"
+
+// Default time spent creating nodes on the main thread per frame (in milliseconds)
+#define SCENE_LOAD_FRAME_BUDGET     4.0f
+
+namespace gameplay
+{
+
+AsyncSceneLoader::AsyncSceneLoader(const char* path, const Callback& callback)
+    : _path(path), _callback(callback), _state(STATE_READING), _bundle(NULL), _scene(NULL),
+      _meshCount(0), _meshesRead(0), _childCount(0), _childrenCreated(0), _cancelled(false),
+      _frameBudget(SCENE_LOAD_FRAME_BUDGET)
+{
+}
+
+AsyncSceneLoader::~AsyncSceneLoader()
+{
+    clear();
+}
+
+float AsyncSceneLoader::getProgress() const
+{
+    if (_state == STATE_DONE)
+        return 1.0f;
+
+    // Reading the data and creating the nodes each account for half of the load.
+    unsigned int meshCount = _meshCount.load();
+    if (_state == STATE_READING)
+        return meshCount > 0 ? 0.5f * (float)_meshesRead.load() / (float)meshCount : 0.0f;
+
+    // The scene itself is completed after its root nodes.
+    return 0.5f + 0.5f * (float)_childrenCreated / (float)(_childCount + 1);
+}
+
+bool AsyncSceneLoader::isDone() const
+{
+    return _state == STATE_DONE;
+}
+
+void AsyncSceneLoader::cancel()
+{
+    if (_state == STATE_DONE)
+        return;
+
+    // The pending job frees the partially loaded scene.
+    _cancelled = true;
+    _state = STATE_DONE;
+}
+
+float AsyncSceneLoader::getFrameBudget() const
+{
+    return _frameBudget;
+}
+
+void AsyncSceneLoader::setFrameBudget(float budget)
+{
+    _frameBudget = budget;
+}
+
+void AsyncSceneLoader::start(bool readBundle)
+{
+    JobSystem* jobSystem = Game::getInstance()->getJobSystem();
+    GP_ASSERT(jobSystem);
+
+    // Keep the loader alive until the load has finished (released by finish() or update()).
+    addRef();
+
+    // A bundle that is already loaded is shared with the main thread, so it is not read in the background.
+    if (readBundle)
+    {
+        _bundle = Bundle::findCached(_path.c_str());
+        readBundle = _bundle == NULL;
+    }
+
+    if (readBundle)
+    {
+        jobSystem->run(std::bind(&AsyncSceneLoader::read, this));
+    }
+    else
+    {
+        _state = STATE_CREATING;
+        postUpdate();
+    }
+}
+
+void AsyncSceneLoader::read()
+{
+    // The bundle is opened outside of the bundle cache, so only this thread
+    // accesses it (and its reference count) until update() is posted.
+    Bundle* bundle = Bundle::open(_path.c_str());
+    if (bundle && !_cancelled.load())
+    {
+        _meshCount = bundle->getMeshCount();
+        bundle->preloadMeshData(&_cancelled, &_meshesRead);
+    }
+    _bundle = bundle;
+
+    postUpdate();
+}
+
+void AsyncSceneLoader::update()
+{
+    if (_cancelled.load())
+    {
+        clear();
+        release();
+        return;
+    }
+
+    if (_state == STATE_READING)
+    {
+        if (_bundle == NULL)
+        {
+            GP_WARN("Failed to load scene from bundle '%s'.", _path.c_str());
+            finish(NULL);
+            return;
+        }
+        _state = STATE_CREATING;
+    }
+
+    // Scenes that are not loaded from a bundle are loaded at once.
+    if (_bundle == NULL)
+    {
+        finish(Scene::load(_path.c_str()));
+        return;
+    }
+
+    // Create at least one root node (with all of its descendants) per frame.
+    double start = Game::getAbsoluteTime();
+    do
+    {
+        if (_scene == NULL)
+        {
+            _scene = _bundle->beginScene(NULL, &_childCount);
+            if (_scene == NULL)
+            {
+                finish(NULL);
+                return;
+            }
+        }
+        else if (_childrenCreated < _childCount)
+        {
+            _bundle->readSceneNode(_scene);
+            ++_childrenCreated;
+        }
+        else
+        {
+            if (!_bundle->finishScene(_scene))
+            {
+                SAFE_RELEASE(_scene);
+            }
+            Scene* scene = _scene;
+            _scene = NULL;
+            finish(scene);
+            return;
+        }
+    } while (Game::getAbsoluteTime() - start < _frameBudget);
+
+    postUpdate();
+}
+
+void AsyncSceneLoader::postUpdate()
+{
+    Game::getInstance()->getJobSystem()->post(std::bind(&AsyncSceneLoader::update, this), std::bind(&AsyncSceneLoader::abort, this));
+}
+
+void AsyncSceneLoader::abort()
+{
+    _cancelled = true;
+    _state = STATE_DONE;
+    clear();
+    release();
+}
+
+void AsyncSceneLoader::finish(Scene* scene)
+{
+    _state = STATE_DONE;
+    clear();
+
+    // The callback takes over the reference to the scene.
+    if (_callback)
+    {
+        _callback(scene);
+    }
+    else
+    {
+        SAFE_RELEASE(scene);
+    }
+
+    release();
+}
+
+void AsyncSceneLoader::clear()
+{
+    SAFE_RELEASE(_scene);
+    if (_bundle)
+    {
+        _bundle->clearPreloadedMeshData();
+        SAFE_RELEASE(_bundle);
+    }
+}
+
+}
@@ -0,0 +1,168 @@
+#ifndef ASYNCSCENELOADER_H_
+#define ASYNCSCENELOADER_H_
+
+#include "Ref.h"
+
+namespace gameplay
+{
+
+class Scene;
+class Bundle;
+
+/**
+ * Defines the state of a scene being loaded in the background.
+ *
+ * Asynchronous loads are started with Scene::loadAsync(). Loading a scene from a
+ * '.gpb' file runs in two stages:
+ *
+ * - The bundle is opened and the data of all of its meshes is read and decoded on
+ *   a thread of the game's job system.
+ * - The nodes of the scene (with their models, materials and GPU buffers) are then
+ *   created on the main thread, a few at a time at the start of every frame, until
+ *   the time budget for the frame is used up.
+ *
+ * Once the scene is complete, the completion callback is invoked on the main thread.
+ * Scenes loaded from '.scene' files are loaded in a single frame.
+ *
+ * @see Scene::loadAsync
+ * @script{ignore}
+ */
+class AsyncSceneLoader : public Ref
+{
+    friend class Scene;
+
+public:
+
+    /**
+     * Defines the callback invoked when an asynchronous scene load has finished.
+     *
+     * The scene is NULL if it could not be loaded. Otherwise the callback owns a
+     * reference to the scene and must release it when it is no longer needed.
+     */
+    typedef std::function<void(Scene* scene)> Callback;
+
+    /**
+     * Gets the progress of the load.
+     *
+     * @return The progress, from 0 when the load starts to 1 once it has finished.
+     */
+    float getProgress() const;
+
+    /**
+     * Determines if the load has finished (or has been cancelled).
+     *
+     * @return true if the load has finished, false otherwise.
+     */
+    bool isDone() const;
+
+    /**
+     * Cancels the load.
+     *
+     * The nodes created so far are released and the completion callback is not invoked.
+     * This method must be called on the main thread.
+     */
+    void cancel();
+
+    /**
+     * Gets the maximum time spent creating nodes on the main thread per frame.
+     *
+     * @return The time budget, in milliseconds.
+     */
+    float getFrameBudget() const;
+
+    /**
+     * Sets the maximum time spent creating nodes on the main thread per frame.
+     *
+     * At least one node is created per frame, regardless of the budget.
+     *
+     * @param budget The time budget, in milliseconds (4 by default).
+     */
+    void setFrameBudget(float budget);
+
+private:
+
+    /**
+     * The stage of the load.
+     */
+    enum State
+    {
+        STATE_READING,
+        STATE_CREATING,
+        STATE_DONE
+    };
+
+    /**
+     * Constructor.
+     */
+    AsyncSceneLoader(const char* path, const Callback& callback);
+
+    /**
+     * Hidden copy constructor.
+     */
+    AsyncSceneLoader(const AsyncSceneLoader& copy);
+
+    /**
+     * Destructor.
+     */
+    ~AsyncSceneLoader();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    AsyncSceneLoader& operator=(const AsyncSceneLoader&);
+
+    /**
+     * Starts the load.
+     *
+     * @param readBundle true if the scene is loaded from a bundle, false otherwise.
+     */
+    void start(bool readBundle);
+
+    /**
+     * Opens the bundle and reads its mesh data. Runs on a job system thread.
+     */
+    void read();
+
+    /**
+     * Creates the nodes of the scene until the frame budget is used up. Runs on the main thread.
+     */
+    void update();
+
+    /**
+     * Posts update() to the main thread, or abort() if the game shuts down first.
+     */
+    void postUpdate();
+
+    /**
+     * Cancels the load because the game is shutting down, and releases the loader.
+     *
+     * The completion callback is not invoked.
+     */
+    void abort();
+
+    /**
+     * Finishes the load and invokes the completion callback with the specified scene.
+     */
+    void finish(Scene* scene);
+
+    /**
+     * Frees the bundle and the partially loaded scene.
+     */
+    void clear();
+
+    std::string _path;
+    Callback _callback;
+    State _state;
+    Bundle* _bundle;
+    Scene* _scene;
+    std::atomic<unsigned int> _meshCount;
+    std::atomic<unsigned int> _meshesRead;
+    unsigned int _childCount;
+    unsigned int _childrenCreated;
+    std::atomic<bool> _cancelled;
+    float _frameBudget;
+};
+
+}
+
+#endif
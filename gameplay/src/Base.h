@@ -31,6 +31,11 @@
 #include <thread>
 #include <mutex>
 #include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
 #include "Logger.h"
 
 // Bring common functions from C into global namespace
@@ -223,10 +228,12 @@ using std::va_list;
         #define GLEW_STATIC
         #include <GL/glew.h>
         #define GP_USE_VAO
+        #define GP_USE_INSTANCING
 #elif __linux__
         #define GLEW_STATIC
         #include <GL/glew.h>
         #define GP_USE_VAO
+        #define GP_USE_INSTANCING
 #elif __APPLE__
     #include "TargetConditionals.h"
     #if TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
@@ -247,7 +254,11 @@ using std::va_list;
         #define glDeleteVertexArrays glDeleteVertexArraysAPPLE
         #define glGenVertexArrays glGenVertexArraysAPPLE
         #define glIsVertexArray glIsVertexArrayAPPLE
+        #define glVertexAttribDivisor glVertexAttribDivisorARB
+        #define glDrawArraysInstanced glDrawArraysInstancedARB
+        #define glDrawElementsInstanced glDrawElementsInstancedARB
         #define GP_USE_VAO
+        #define GP_USE_INSTANCING
     #else
         #error "Unsupported Apple Device"
     #endif
@@ -262,6 +273,8 @@ using std::va_list;
 #define VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME          "a_blendWeights"
 #define VERTEX_ATTRIBUTE_BLENDINDICES_NAME          "a_blendIndices"
 #define VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME       "a_texCoord"
+#define VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME       "a_instanceMatrix"
+#define VERTEX_ATTRIBUTE_INSTANCE_COLOR_NAME        "a_instanceColor"
 
 // Hardware buffer
 namespace gameplay
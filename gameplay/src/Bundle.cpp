@@ -27,9 +27,18 @@
 // For sanity checking string reads
 #define BUNDLE_MAX_STRING_LENGTH        5000
 
+// Stride at which memory-mapped mesh data is touched to page it in
+#define BUNDLE_PAGE_SIZE                4096
+
+// Signature at the end of the optional index section
+#define BUNDLE_INDEX_SIGNATURE          "GPBI"
+
 #define BUNDLE_VERSION_MAJOR_FONT_FORMAT  1
 #define BUNDLE_VERSION_MINOR_FONT_FORMAT  5
 
+#define BUNDLE_VERSION_MAJOR_PACKED_CURVES  1
+#define BUNDLE_VERSION_MINOR_PACKED_CURVES  6
+
 namespace gameplay
 {
 
@@ -43,6 +52,7 @@ Bundle::Bundle(const char* path) :
 Bundle::~Bundle()
 {
     clearLoadSession();
+    clearPreloadedMeshData();
 
     // Remove this Bundle from the cache.
     std::vector<Bundle*>::iterator itr = std::find(__bundleCache.begin(), __bundleCache.end(), this);
@@ -141,6 +151,85 @@ bool Bundle::readArray(unsigned int* length, std::vector<T>* values, unsigned in
     return true;
 }
 
+template <class T>
+bool Bundle::readArray(unsigned int* length, const T** ptr, std::vector<T>* buffer)
+{
+    GP_ASSERT(length);
+    GP_ASSERT(ptr);
+    GP_ASSERT(buffer);
+    GP_ASSERT(_stream);
+
+    *ptr = NULL;
+    if (_stream->getData())
+    {
+        if (!read(length))
+        {
+            GP_ERROR("Failed to read the length of an array of data (to be read in place).");
+            return false;
+        }
+        if (*length == 0)
+            return true;
+
+        // Use the values in place unless they are misaligned for T.
+        long position = _stream->position();
+        const unsigned char* data = readMapped(*length * sizeof(T));
+        if (data == NULL)
+        {
+            GP_ERROR("Failed to read an array of data from bundle (in place).");
+            return false;
+        }
+        if (((size_t)data % std::alignment_of<T>::value) == 0)
+        {
+            *ptr = (const T*)data;
+            return true;
+        }
+
+        _stream->seek(position, SEEK_SET);
+        buffer->resize(*length);
+        if (_stream->read(&(*buffer)[0], sizeof(T), *length) != *length)
+        {
+            GP_ERROR("Failed to read an array of data from bundle (into a std::vector).");
+            return false;
+        }
+    }
+    else if (!readArray(length, buffer))
+    {
+        return false;
+    }
+
+    if (*length > 0)
+        *ptr = &(*buffer)[0];
+    return true;
+}
+
+const unsigned char* Bundle::readMapped(unsigned int byteCount)
+{
+    GP_ASSERT(_stream);
+
+    const unsigned char* data = _stream->getData();
+    if (data == NULL)
+        return NULL;
+
+    long position = _stream->position();
+    if (position < 0 || (size_t)position + byteCount > _stream->length())
+        return NULL;
+
+    _stream->seek(byteCount, SEEK_CUR);
+    return data + position;
+}
+
+// FNV-1a hash of a reference id, which must match the hash used by the encoder for the index section.
+static unsigned int hashId(const char* id, size_t length)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)id[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
 static std::string readString(Stream* stream)
 {
     GP_ASSERT(stream);
@@ -172,6 +261,17 @@ Bundle* Bundle::create(const char* path)
 {
     GP_ASSERT(path);
 
+    Bundle* bundle = findCached(path);
+    if (bundle)
+        return bundle;
+
+    return open(path);
+}
+
+Bundle* Bundle::findCached(const char* path)
+{
+    GP_ASSERT(path);
+
     // Search the cache for this bundle.
     for (size_t i = 0, count = __bundleCache.size(); i < count; ++i)
     {
@@ -184,9 +284,15 @@ Bundle* Bundle::create(const char* path)
             return p;
         }
     }
+    return NULL;
+}
 
-    // Open the bundle.
-    Stream* stream = FileSystem::open(path);
+Bundle* Bundle::open(const char* path)
+{
+    GP_ASSERT(path);
+
+    // Open the bundle, memory-mapped where supported so that bulk data can be used in place.
+    Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAP);
     if (!stream)
     {
         GP_WARN("Failed to open file '%s'.", path);
@@ -249,22 +355,139 @@ Bundle* Bundle::create(const char* path)
     bundle->_referenceCount = refCount;
     bundle->_references = refs;
     bundle->_stream = stream;
+    bundle->buildIndex();
 
     return bundle;
 }
 
+void Bundle::buildIndex()
+{
+    GP_ASSERT(_stream);
+
+    _animationsIndex.clear();
+    for (unsigned int i = 0; i < _referenceCount; ++i)
+    {
+        if (_references[i].type == BUNDLE_TYPE_ANIMATIONS)
+            _animationsIndex.push_back(i);
+    }
+
+    long position = _stream->position();
+    bool indexed = readIndex();
+    _stream->seek(position, SEEK_SET);
+    if (indexed)
+        return;
+
+    // Hash the ids into a table that is at most half full. The first reference
+    // with a given id takes precedence over later duplicates.
+    unsigned int bucketCount = 1;
+    while (bucketCount < _referenceCount * 2)
+        bucketCount <<= 1;
+    _idIndex.assign(bucketCount, 0);
+    for (unsigned int i = 0; i < _referenceCount; ++i)
+    {
+        const std::string& id = _references[i].id;
+        unsigned int slot = hashId(id.c_str(), id.length()) & (bucketCount - 1);
+        while (_idIndex[slot] != 0 && _references[_idIndex[slot] - 1].id != id)
+        {
+            slot = (slot + 1) & (bucketCount - 1);
+        }
+        if (_idIndex[slot] == 0)
+            _idIndex[slot] = i + 1;
+    }
+
+    // Sort the references by offset.
+    _offsetIndex.resize(_referenceCount);
+    for (unsigned int i = 0; i < _referenceCount; ++i)
+    {
+        _offsetIndex[i] = i;
+    }
+    const Reference* references = _references;
+    std::stable_sort(_offsetIndex.begin(), _offsetIndex.end(), [references](unsigned int a, unsigned int b)
+    {
+        return references[a].offset < references[b].offset;
+    });
+}
+
+bool Bundle::readIndex()
+{
+    GP_ASSERT(_stream);
+
+    // The index section is written at the end of the file by the encoder:
+    //   unsigned int bucketCount
+    //   unsigned int buckets[bucketCount]
+    //   unsigned int offsetIndex[referenceCount]
+    //   unsigned int sectionSize (in bytes, excluding the size and signature)
+    //   char signature[4]
+    // The buckets form an open-addressed hash table of the reference ids (using hashId and
+    // linear probing) and hold the index + 1 of a reference, or 0 for empty buckets. The
+    // offset index lists the references sorted by offset.
+    size_t length = _stream->length();
+    unsigned int size;
+    char signature[4];
+    if (length < 8 || !_stream->seek(-8, SEEK_END) || !read(&size) ||
+        _stream->read(signature, 1, 4) != 4 || memcmp(signature, BUNDLE_INDEX_SIGNATURE, 4) != 0)
+    {
+        return false;
+    }
+
+    unsigned int bucketCount;
+    if (size < 4 || (size_t)size + 8 > length || !_stream->seek(-(long)size - 8, SEEK_END) || !read(&bucketCount) ||
+        bucketCount <= _referenceCount || (bucketCount & (bucketCount - 1)) != 0 ||
+        (size_t)size != 4 * ((size_t)bucketCount + _referenceCount + 1))
+    {
+        GP_WARN("Invalid index section in bundle '%s'.", _path.c_str());
+        return false;
+    }
+
+    _idIndex.resize(bucketCount);
+    _offsetIndex.resize(_referenceCount);
+    bool valid = _stream->read(&_idIndex[0], 4, bucketCount) == bucketCount &&
+        (_referenceCount == 0 || _stream->read(&_offsetIndex[0], 4, _referenceCount) == _referenceCount);
+
+    // Validate the tables so that a corrupt index cannot cause out of bounds accesses or endless probing.
+    unsigned int used = 0;
+    for (unsigned int i = 0; valid && i < bucketCount; ++i)
+    {
+        if (_idIndex[i] > _referenceCount)
+            valid = false;
+        else if (_idIndex[i] != 0)
+            ++used;
+    }
+    valid = valid && used == _referenceCount;
+    for (unsigned int i = 0; valid && i < _referenceCount; ++i)
+    {
+        if (_offsetIndex[i] >= _referenceCount ||
+            (i > 0 && _references[_offsetIndex[i - 1]].offset > _references[_offsetIndex[i]].offset))
+        {
+            valid = false;
+        }
+    }
+
+    if (!valid)
+    {
+        GP_WARN("Invalid index section in bundle '%s'.", _path.c_str());
+        _idIndex.clear();
+        _offsetIndex.clear();
+    }
+    return valid;
+}
+
 Bundle::Reference* Bundle::find(const char* id) const
 {
     GP_ASSERT(id);
     GP_ASSERT(_references);
+    GP_ASSERT(!_idIndex.empty());
 
-    // Search the ref table for the given id (case-sensitive).
-    for (unsigned int i = 0; i < _referenceCount; ++i)
+    // Probe the hash table of ids (case-sensitive).
+    size_t length = strlen(id);
+    unsigned int mask = (unsigned int)_idIndex.size() - 1;
+    for (unsigned int slot = hashId(id, length) & mask; _idIndex[slot] != 0; slot = (slot + 1) & mask)
     {
-        if (_references[i].id == id)
+        Reference* ref = &_references[_idIndex[slot] - 1];
+        if (ref->id.length() == length && memcmp(ref->id.c_str(), id, length) == 0)
         {
             // Found a match
-            return &_references[i];
+            return ref;
         }
     }
 
@@ -288,15 +511,18 @@ const char* Bundle::getIdFromOffset() const
 
 const char* Bundle::getIdFromOffset(unsigned int offset) const
 {
-    // Search the ref table for the given offset.
+    // Search the offset-sorted references for the given offset.
     if (offset > 0)
     {
         GP_ASSERT(_references);
-        for (unsigned int i = 0; i < _referenceCount; ++i)
+        const Reference* references = _references;
+        std::vector<unsigned int>::const_iterator itr = std::lower_bound(_offsetIndex.begin(), _offsetIndex.end(), offset,
+            [references](unsigned int index, unsigned int offset) { return references[index].offset < offset; });
+        for (; itr != _offsetIndex.end() && _references[*itr].offset == offset; ++itr)
         {
-            if (_references[i].offset == offset && _references[i].id.length() > 0)
+            if (_references[*itr].id.length() > 0)
             {
-                return _references[i].id.c_str();
+                return _references[*itr].id.c_str();
             }
         }
     }
@@ -391,6 +617,30 @@ bool Bundle::readMatrix(float* m)
 
 Scene* Bundle::loadScene(const char* id)
 {
+    unsigned int childrenCount;
+    Scene* scene = beginScene(id, &childrenCount);
+    if (scene == NULL)
+        return NULL;
+
+    // Read each child directly into the scene.
+    for (unsigned int i = 0; i < childrenCount; i++)
+    {
+        readSceneNode(scene);
+    }
+
+    if (!finishScene(scene))
+    {
+        SAFE_RELEASE(scene);
+        return NULL;
+    }
+
+    return scene;
+}
+
+Scene* Bundle::beginScene(const char* id, unsigned int* childCount)
+{
+    GP_ASSERT(childCount);
+
     clearLoadSession();
 
     Reference* ref = NULL;
@@ -416,26 +666,32 @@ Scene* Bundle::loadScene(const char* id)
     Scene* scene = Scene::create(getIdFromOffset());
 
     // Read the number of children.
-    unsigned int childrenCount;
-    if (!read(&childrenCount))
+    if (!read(childCount))
     {
         GP_ERROR("Failed to read the scene's number of children.");
         SAFE_RELEASE(scene);
         return NULL;
     }
-    if (childrenCount > 0)
+
+    return scene;
+}
+
+void Bundle::readSceneNode(Scene* scene)
+{
+    GP_ASSERT(scene);
+
+    Node* node = readNode(scene, NULL);
+    if (node)
     {
-        // Read each child directly into the scene.
-        for (unsigned int i = 0; i < childrenCount; i++)
-        {
-            Node* node = readNode(scene, NULL);
-            if (node)
-            {
-                scene->addNode(node);
-                node->release(); // scene now owns node
-            }
-        }
+        scene->addNode(node);
+        node->release(); // scene now owns node
     }
+}
+
+bool Bundle::finishScene(Scene* scene)
+{
+    GP_ASSERT(scene);
+
     // Read active camera.
     std::string xref = readString(_stream);
     if (xref.length() > 1 && xref[0] == '#') // TODO: Handle full xrefs
@@ -452,44 +708,109 @@ Scene* Bundle::loadScene(const char* id)
     if (!read(&red))
     {
         GP_ERROR("Failed to read red component of the scene's ambient color in bundle '%s'.", _path.c_str());
-        SAFE_RELEASE(scene);
-        return NULL;
+        return false;
     }
     if (!read(&green))
     {
         GP_ERROR("Failed to read green component of the scene's ambient color in bundle '%s'.", _path.c_str());
-        SAFE_RELEASE(scene);
-        return NULL;
+        return false;
     }
     if (!read(&blue))
     {
         GP_ERROR("Failed to read blue component of the scene's ambient color in bundle '%s'.", _path.c_str());
-        SAFE_RELEASE(scene);
-        return NULL;
+        return false;
     }
     scene->setAmbientColor(red, green, blue);
 
     // Parse animations.
     GP_ASSERT(_references);
     GP_ASSERT(_stream);
+    for (size_t i = 0, count = _animationsIndex.size(); i < count; ++i)
+    {
+        Reference* ref = &_references[_animationsIndex[i]];
+        if (_stream->seek(ref->offset, SEEK_SET) == false)
+        {
+            GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
+            return false;
+        }
+        readAnimations(scene);
+    }
+
+    resolveJointReferences(scene, NULL);
+
+    return true;
+}
+
+unsigned int Bundle::getMeshCount() const
+{
+    unsigned int count = 0;
     for (unsigned int i = 0; i < _referenceCount; ++i)
     {
+        if (_references[i].type == BUNDLE_TYPE_MESH)
+            ++count;
+    }
+    return count;
+}
+
+// Reads a byte from every page of the specified memory, so that the pages of a memory-mapped file are loaded.
+static void touchPages(const unsigned char* data, size_t size)
+{
+    volatile unsigned char value = 0;
+    for (size_t i = 0; i < size; i += BUNDLE_PAGE_SIZE)
+        value += data[i];
+    if (size > 0)
+        value += data[size - 1];
+}
+
+void Bundle::preloadMeshData(const std::atomic<bool>* cancelled, std::atomic<unsigned int>* loadedCount)
+{
+    GP_ASSERT(_stream);
+
+    clearPreloadedMeshData();
+    _preloadedMeshData.resize(_referenceCount, NULL);
+    for (unsigned int i = 0; i < _referenceCount; ++i)
+    {
+        if (cancelled && cancelled->load())
+            break;
+
         Reference* ref = &_references[i];
-        if (ref->type == BUNDLE_TYPE_ANIMATIONS)
+        if (ref->type != BUNDLE_TYPE_MESH)
+            continue;
+
+        if (_stream->seek(ref->offset, SEEK_SET) == false)
         {
-            // Found a match.
-            if (_stream->seek(ref->offset, SEEK_SET) == false)
+            GP_WARN("Failed to seek to mesh '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
+            continue;
+        }
+
+        // Meshes that fail to load here are read again (and reported) by loadMesh().
+        MeshData* meshData = readMeshData();
+        if (meshData && meshData->mapping)
+        {
+            // Mapped data is used in place, so fault its pages in here rather than on the main thread.
+            touchPages(meshData->vertexData, meshData->vertexCount * meshData->vertexFormat.getVertexSize());
+            for (size_t j = 0, partCount = meshData->parts.size(); j < partCount; ++j)
             {
-                GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
-                return NULL;
+                MeshPartData* partData = meshData->parts[j];
+                unsigned int indexSize = partData->indexFormat == Mesh::INDEX32 ? 4 : (partData->indexFormat == Mesh::INDEX16 ? 2 : 1);
+                touchPages(partData->indexData, partData->indexCount * indexSize);
             }
-            readAnimations(scene);
         }
+        _preloadedMeshData[i] = meshData;
+        if (loadedCount)
+            ++(*loadedCount);
     }
+}
 
-    resolveJointReferences(scene, NULL);
-
-    return scene;
+void Bundle::clearPreloadedMeshData()
+{
+    // Mesh data of a memory-mapped bundle holds a reference to the bundle, so this
+    // must be called explicitly for the bundle to be destroyed.
+    for (size_t i = 0, count = _preloadedMeshData.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_preloadedMeshData[i]);
+    }
+    _preloadedMeshData.clear();
 }
 
 Node* Bundle::loadNode(const char* id)
@@ -512,90 +833,87 @@ Node* Bundle::loadNode(const char* id, Scene* sceneContext)
         resolveJointReferences(sceneContext, node);
 
     // Load all animations targeting any nodes or mesh skins under this node's hierarchy.
-    for (unsigned int i = 0; i < _referenceCount; i++)
+    for (size_t i = 0, count = _animationsIndex.size(); i < count; ++i)
     {
-        Reference* ref = &_references[i];
-        if (ref->type == BUNDLE_TYPE_ANIMATIONS)
+        Reference* ref = &_references[_animationsIndex[i]];
+        if (_stream->seek(ref->offset, SEEK_SET) == false)
         {
-            if (_stream->seek(ref->offset, SEEK_SET) == false)
-            {
-                GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
-                SAFE_DELETE(_trackedNodes);
-                return NULL;
-            }
+            GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
+            SAFE_DELETE(_trackedNodes);
+            return NULL;
+        }
 
-            // Read the number of animations in this object.
-            unsigned int animationCount;
-            if (!read(&animationCount))
+        // Read the number of animations in this object.
+        unsigned int animationCount;
+        if (!read(&animationCount))
+        {
+            GP_ERROR("Failed to read the number of animations for object '%s'.", ref->id.c_str());
+            SAFE_DELETE(_trackedNodes);
+            return NULL;
+        }
+
+        for (unsigned int j = 0; j < animationCount; j++)
+        {
+            const std::string id = readString(_stream);
+
+            // Read the number of animation channels in this animation.
+            unsigned int animationChannelCount;
+            if (!read(&animationChannelCount))
             {
-                GP_ERROR("Failed to read the number of animations for object '%s'.", ref->id.c_str());
+                GP_ERROR("Failed to read the number of animation channels for animation '%s'.", "animationChannelCount", id.c_str());
                 SAFE_DELETE(_trackedNodes);
                 return NULL;
             }
 
-            for (unsigned int j = 0; j < animationCount; j++)
+            Animation* animation = NULL;
+            for (unsigned int k = 0; k < animationChannelCount; k++)
             {
-                const std::string id = readString(_stream);
-
-                // Read the number of animation channels in this animation.
-                unsigned int animationChannelCount;
-                if (!read(&animationChannelCount))
+                // Read target id.
+                std::string targetId = readString(_stream);
+                if (targetId.empty())
                 {
-                    GP_ERROR("Failed to read the number of animation channels for animation '%s'.", "animationChannelCount", id.c_str());
+                    GP_ERROR("Failed to read target id for animation '%s'.", id.c_str());
                     SAFE_DELETE(_trackedNodes);
                     return NULL;
                 }
 
-                Animation* animation = NULL;
-                for (unsigned int k = 0; k < animationChannelCount; k++)
+                // If the target is one of the loaded nodes/joints, then load the animation.
+                std::map<std::string, Node*>::iterator iter = _trackedNodes->find(targetId);
+                if (iter != _trackedNodes->end())
                 {
-                    // Read target id.
-                    std::string targetId = readString(_stream);
-                    if (targetId.empty())
+                    // Read target attribute.
+                    unsigned int targetAttribute;
+                    if (!read(&targetAttribute))
                     {
-                        GP_ERROR("Failed to read target id for animation '%s'.", id.c_str());
+                        GP_ERROR("Failed to read target attribute for animation '%s'.", id.c_str());
                         SAFE_DELETE(_trackedNodes);
                         return NULL;
                     }
 
-                    // If the target is one of the loaded nodes/joints, then load the animation.
-                    std::map<std::string, Node*>::iterator iter = _trackedNodes->find(targetId);
-                    if (iter != _trackedNodes->end())
+                    AnimationTarget* target = iter->second;
+                    if (!target)
                     {
-                        // Read target attribute.
-                        unsigned int targetAttribute;
-                        if (!read(&targetAttribute))
-                        {
-                            GP_ERROR("Failed to read target attribute for animation '%s'.", id.c_str());
-                            SAFE_DELETE(_trackedNodes);
-                            return NULL;
-                        }
-
-                        AnimationTarget* target = iter->second;
-                        if (!target)
-                        {
-                            GP_ERROR("Failed to read %s for %s: %s", "animation target", targetId.c_str(), id.c_str());
-                            SAFE_DELETE(_trackedNodes);
-                            return NULL;
-                        }
-
-                        animation = readAnimationChannelData(animation, id.c_str(), target, targetAttribute);
+                        GP_ERROR("Failed to read %s for %s: %s", "animation target", targetId.c_str(), id.c_str());
+                        SAFE_DELETE(_trackedNodes);
+                        return NULL;
                     }
-                    else
-                    {
-                        // Skip over the target attribute.
-                        unsigned int data;
-                        if (!read(&data))
-                        {
-                            GP_ERROR("Failed to skip over target attribute for animation '%s'.", id.c_str());
-                            SAFE_DELETE(_trackedNodes);
-                            return NULL;
-                        }
 
-                        // Skip the animation channel (passing a target attribute of
-                        // 0 causes the animation to not be created).
-                        readAnimationChannelData(NULL, id.c_str(), NULL, 0);
+                    animation = readAnimationChannelData(animation, id.c_str(), target, targetAttribute);
+                }
+                else
+                {
+                    // Skip over the target attribute.
+                    unsigned int data;
+                    if (!read(&data))
+                    {
+                        GP_ERROR("Failed to skip over target attribute for animation '%s'.", id.c_str());
+                        SAFE_DELETE(_trackedNodes);
+                        return NULL;
                     }
+
+                    // Skip the animation channel (passing a target attribute of
+                    // 0 causes the animation to not be created).
+                    readAnimationChannelData(NULL, id.c_str(), NULL, 0);
                 }
             }
         }
@@ -1291,11 +1609,17 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
 {
     GP_ASSERT(id);
 
-    std::vector<unsigned int> keyTimes;
-    std::vector<float> values;
-    std::vector<float> tangentsIn;
-    std::vector<float> tangentsOut;
-    std::vector<unsigned int> interpolation;
+    // The arrays point into the memory mapping of the bundle when possible, otherwise into these buffers.
+    std::vector<unsigned int> keyTimesBuffer;
+    std::vector<float> valuesBuffer;
+    std::vector<float> tangentsInBuffer;
+    std::vector<float> tangentsOutBuffer;
+    std::vector<unsigned int> interpolationBuffer;
+    const unsigned int* keyTimes;
+    const float* values;
+    const float* tangentsIn;
+    const float* tangentsOut;
+    const unsigned int* interpolation;
 
     // Length of the arrays.
     unsigned int keyTimesCount;
@@ -1305,52 +1629,121 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
     unsigned int interpolationCount;
 
     // Read key times.
-    if (!readArray(&keyTimesCount, &keyTimes, sizeof(unsigned int)))
+    if (!readArray(&keyTimesCount, &keyTimes, &keyTimesBuffer))
     {
         GP_ERROR("Failed to read key times for animation '%s'.", id);
         return NULL;
     }
 
     // Read key values.
-    if (!readArray(&valuesCount, &values))
+    if (!readArray(&valuesCount, &values, &valuesBuffer))
     {
         GP_ERROR("Failed to read key values for animation '%s'.", id);
         return NULL;
     }
 
     // Read in-tangents.
-    if (!readArray(&tangentsInCount, &tangentsIn))
+    if (!readArray(&tangentsInCount, &tangentsIn, &tangentsInBuffer))
     {
         GP_ERROR("Failed to read in tangents for animation '%s'.", id);
         return NULL;
     }
 
     // Read out-tangents.
-    if (!readArray(&tangentsOutCount, &tangentsOut))
+    if (!readArray(&tangentsOutCount, &tangentsOut, &tangentsOutBuffer))
     {
         GP_ERROR("Failed to read out tangents for animation '%s'.", id);
         return NULL;
     }
 
     // Read interpolations.
-    if (!readArray(&interpolationCount, &interpolation, sizeof(unsigned int)))
+    if (!readArray(&interpolationCount, &interpolation, &interpolationBuffer))
     {
         GP_ERROR("Failed to read the interpolation values for animation '%s'.", id);
         return NULL;
     }
 
-    if (targetAttribute > 0)
+    // Read the packed samples, which replace the key values when present.
+    unsigned int sampleCount = 0;
+    unsigned int sampleComponentCount = 0;
+    std::vector<float> minimumsBuffer;
+    std::vector<float> extentsBuffer;
+    std::vector<unsigned short> samplesBuffer;
+    const float* minimums = NULL;
+    const float* extents = NULL;
+    const unsigned short* samples = NULL;
+    if (getVersionMajor() >= BUNDLE_VERSION_MAJOR_PACKED_CURVES && getVersionMinor() >= BUNDLE_VERSION_MINOR_PACKED_CURVES)
+    {
+        if (!read(&sampleCount))
+        {
+            GP_ERROR("Failed to read the sample count for animation '%s'.", id);
+            return NULL;
+        }
+        if (sampleCount > 0)
+        {
+            unsigned int minimumsCount;
+            unsigned int extentsCount;
+            unsigned int samplesCount;
+            if (!readArray(&minimumsCount, &minimums, &minimumsBuffer) ||
+                !readArray(&extentsCount, &extents, &extentsBuffer) ||
+                !readArray(&samplesCount, &samples, &samplesBuffer))
+            {
+                GP_ERROR("Failed to read the packed samples for animation '%s'.", id);
+                return NULL;
+            }
+            if (minimumsCount == 0 || minimumsCount > 16 || extentsCount != minimumsCount || samplesCount != sampleCount * minimumsCount)
+            {
+                GP_ERROR("Invalid packed samples for animation '%s'.", id);
+                return NULL;
+            }
+            sampleComponentCount = minimumsCount;
+        }
+    }
+
+    if (targetAttribute > 0 && sampleCount > 0)
+    {
+        GP_ASSERT(target);
+        GP_ASSERT(keyTimesCount > 0);
+
+        if (target->getAnimationPropertyComponentCount(targetAttribute) != sampleComponentCount)
+        {
+            GP_ERROR("Packed samples of animation '%s' do not match the component count of their target.", id);
+            return NULL;
+        }
+
+        // The key times of a packed curve only hold its start and end times.
+        unsigned long duration = keyTimes[keyTimesCount - 1] - keyTimes[0];
+        Curve* curve = Curve::createPacked(sampleCount, sampleComponentCount, minimums, extents, samples);
+        if (animation == NULL)
+        {
+            animation = new Animation(id);
+            animation->createChannel(target, targetAttribute, curve, duration);
+
+            // Release the animation because a newly created animation has a ref count of 1 and the channels hold the ref to animation.
+            animation->release();
+        }
+        else
+        {
+            animation->createChannel(target, targetAttribute, curve, duration);
+        }
+        curve->release();
+    }
+    else if (targetAttribute > 0)
     {
         GP_ASSERT(target);
-        GP_ASSERT(keyTimes.size() > 0 && values.size() > 0);
+        GP_ASSERT(keyTimesCount > 0 && valuesCount > 0);
+
+        // The key times and values are only read while they are copied into the animation curve.
+        unsigned int* keyTimesData = const_cast<unsigned int*>(keyTimes);
+        float* valuesData = const_cast<float*>(values);
         if (animation == NULL)
         {
             // TODO: This code currently assumes LINEAR only.
-            animation = target->createAnimation(id, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
+            animation = target->createAnimation(id, targetAttribute, keyTimesCount, keyTimesData, valuesData, Curve::LINEAR);
         }
         else
         {
-            animation->createChannel(target, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
+            animation->createChannel(target, targetAttribute, keyTimesCount, keyTimesData, valuesData, Curve::LINEAR);
         }
     }
 
@@ -1383,8 +1776,15 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
         return NULL;
     }
 
-    // Read mesh data.
-    MeshData* meshData = readMeshData();
+    // Read mesh data, unless it was read ahead of time by preloadMeshData().
+    MeshData* meshData = NULL;
+    if (!_preloadedMeshData.empty())
+    {
+        unsigned int index = (unsigned int)(ref - _references);
+        std::swap(meshData, _preloadedMeshData[index]);
+    }
+    if (meshData == NULL)
+        meshData = readMeshData();
     if (meshData == NULL)
     {
         GP_ERROR("Failed to load mesh data for mesh '%s'.", id);
@@ -1396,7 +1796,7 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
     if (mesh == NULL)
     {
         GP_ERROR("Failed to create mesh '%s'.", id);
-        SAFE_DELETE_ARRAY(meshData);
+        SAFE_DELETE(meshData);
         return NULL;
     }
 
@@ -1476,6 +1876,14 @@ Bundle::MeshData* Bundle::readMeshData()
     MeshData* meshData = new MeshData(VertexFormat(vertexElements, vertexElementCount));
     SAFE_DELETE_ARRAY(vertexElements);
 
+    // Vertex and index data of a memory-mapped bundle are used in place, which requires
+    // the bundle to stay open for as long as the mesh data exists.
+    if (_stream->getData())
+    {
+        meshData->mapping = this;
+        addRef();
+    }
+
     // Read vertex data.
     unsigned int vertexByteCount;
     if (_stream->read(&vertexByteCount, 4, 1) != 1)
@@ -1493,8 +1901,17 @@ Bundle::MeshData* Bundle::readMeshData()
 
     GP_ASSERT(meshData->vertexFormat.getVertexSize());
     meshData->vertexCount = vertexByteCount / meshData->vertexFormat.getVertexSize();
-    meshData->vertexData = new unsigned char[vertexByteCount];
-    if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+    if (meshData->mapping)
+    {
+        meshData->vertexData = const_cast<unsigned char*>(readMapped(vertexByteCount));
+    }
+    else
+    {
+        meshData->vertexData = new unsigned char[vertexByteCount];
+        if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+            SAFE_DELETE_ARRAY(meshData->vertexData);
+    }
+    if (meshData->vertexData == NULL)
     {
         GP_ERROR("Failed to load vertex data.");
         SAFE_DELETE(meshData);
@@ -1566,14 +1983,24 @@ Bundle::MeshData* Bundle::readMeshData()
             break;
         default:
             GP_ERROR("Unsupported index format for mesh part with index %d.", i);
+            SAFE_DELETE(meshData);
             return NULL;
         }
 
         GP_ASSERT(indexSize);
         partData->indexCount = iByteCount / indexSize;
 
-        partData->indexData = new unsigned char[iByteCount];
-        if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+        if (meshData->mapping)
+        {
+            partData->indexData = const_cast<unsigned char*>(readMapped(iByteCount));
+        }
+        else
+        {
+            partData->indexData = new unsigned char[iByteCount];
+            if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+                SAFE_DELETE_ARRAY(partData->indexData);
+        }
+        if (partData->indexData == NULL)
         {
             GP_ERROR("Failed to read index data for mesh part with index %d.", i);
             SAFE_DELETE(meshData);
@@ -1770,9 +2197,16 @@ Font* Bundle::loadFont(const char* id)
             return NULL;
         }
 
-        // Read texture data.
-        unsigned char* textureData = new unsigned char[textureByteCount];
-        if (_stream->read(textureData, 1, textureByteCount) != textureByteCount)
+        // Read texture data (in place if the bundle is memory-mapped).
+        unsigned char* textureData = NULL;
+        const unsigned char* texturePixels = readMapped(textureByteCount);
+        if (texturePixels == NULL)
+        {
+            textureData = new unsigned char[textureByteCount];
+            if (_stream->read(textureData, 1, textureByteCount) == textureByteCount)
+                texturePixels = textureData;
+        }
+        if (texturePixels == NULL)
         {
             GP_ERROR("Failed to read texture data for font '%s'.", id);
             SAFE_DELETE_ARRAY(glyphs);
@@ -1795,7 +2229,7 @@ Font* Bundle::loadFont(const char* id)
         }
 
         // Create the texture for the font.
-        Texture* texture = Texture::create(Texture::ALPHA, width, height, textureData, true);
+        Texture* texture = Texture::create(Texture::ALPHA, width, height, texturePixels, true);
 
         // Free the texture data (no longer needed).
         SAFE_DELETE_ARRAY(textureData);
@@ -1881,18 +2315,30 @@ Bundle::MeshPartData::~MeshPartData()
 }
 
 Bundle::MeshData::MeshData(const VertexFormat& vertexFormat)
-    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL), primitiveType(Mesh::TRIANGLES)
+    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL), primitiveType(Mesh::TRIANGLES), mapping(NULL)
 {
 }
 
 Bundle::MeshData::~MeshData()
 {
+    // Data that points into the memory mapping of a bundle is not owned.
+    if (mapping)
+    {
+        vertexData = NULL;
+        for (unsigned int i = 0; i < parts.size(); ++i)
+        {
+            parts[i]->indexData = NULL;
+        }
+    }
+
     SAFE_DELETE_ARRAY(vertexData);
 
     for (unsigned int i = 0; i < parts.size(); ++i)
     {
         SAFE_DELETE(parts[i]);
     }
+
+    SAFE_RELEASE(mapping);
 }
 
 }
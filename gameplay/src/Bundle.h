@@ -18,6 +18,7 @@ class Bundle : public Ref
 {
     friend class PhysicsController;
     friend class SceneLoader;
+    friend class AsyncSceneLoader;
 
 public:
 
@@ -152,6 +153,14 @@ private:
         unsigned char* indexData;
     };
 
+    /**
+     * Vertex and index data read from a bundle.
+     *
+     * When the bundle is memory-mapped, the vertex and index data point directly into
+     * the read-only mapping (and are not necessarily aligned). The mesh data then keeps
+     * a reference to the bundle, which is held in the mapping field, and does not own
+     * the data.
+     */
     struct MeshData
     {
         MeshData(const VertexFormat& vertexFormat);
@@ -164,6 +173,7 @@ private:
         BoundingSphere boundingSphere;
         Mesh::PrimitiveType primitiveType;
         std::vector<MeshPartData*> parts;
+        Bundle* mapping;
     };
 
     Bundle(const char* path);
@@ -178,6 +188,44 @@ private:
      */
     Bundle& operator=(const Bundle&);
 
+    /**
+     * Finds a bundle in the bundle cache and increments its reference count.
+     *
+     * The bundle cache is not synchronized, so this must be called on the main thread.
+     *
+     * @param path The path of the bundle.
+     *
+     * @return The cached bundle, or NULL if the bundle is not loaded.
+     */
+    static Bundle* findCached(const char* path);
+
+    /**
+     * Opens a bundle and reads its reference table, without using the bundle cache.
+     *
+     * This can run on any thread. The returned bundle is not shared, so it can be used
+     * by the calling thread until it is handed over to the main thread.
+     *
+     * @param path The path of the bundle.
+     *
+     * @return The new Bundle or NULL if there was an error.
+     */
+    static Bundle* open(const char* path);
+
+    /**
+     * Builds the indices used to look up references by ID and by offset.
+     *
+     * The indices are read from the index section at the end of the bundle when it
+     * is present and valid, otherwise they are computed from the reference table.
+     */
+    void buildIndex();
+
+    /**
+     * Reads the index section at the end of the bundle, if any.
+     *
+     * @return True if the indices were read, false if the bundle has no valid index section.
+     */
+    bool readIndex();
+
     /**
      * Finds a reference by ID.
      */
@@ -315,6 +363,31 @@ private:
      */
     template <class T>
     bool readArray(unsigned int* length, std::vector<T>* values, unsigned int readSize);
+
+    /**
+     * Reads an array of values and the array length from the current file position
+     * without copying the values when the bundle is memory-mapped.
+     *
+     * @param length A pointer to where the length of the array will be copied to.
+     * @param ptr A pointer to where the address of the values will be copied to. This points
+     *        into the memory mapping of the bundle if it is suitably aligned, otherwise to the buffer.
+     * @param buffer The vector that the values are copied to when they cannot be used in place.
+     *
+     * @return True if successful, false if an error occurred.
+     */
+    template <class T>
+    bool readArray(unsigned int* length, const T** ptr, std::vector<T>* buffer);
+
+    /**
+     * Returns a pointer to the data at the current file position of a memory-mapped bundle
+     * and moves the file position past the specified number of bytes.
+     *
+     * @param byteCount The number of bytes to skip.
+     *
+     * @return A pointer into the memory mapping, or NULL if the bundle is not
+     *         memory-mapped or there are fewer than byteCount bytes left.
+     */
+    const unsigned char* readMapped(unsigned int byteCount);
     
     /**
      * Reads 16 floats from the current file position.
@@ -342,6 +415,58 @@ private:
      */
     Node* readNode(Scene* sceneContext, Node* nodeContext);
 
+    /**
+     * Starts loading the scene with the specified ID (or the first scene if id is NULL)
+     * and reads the number of nodes at the root of the scene.
+     *
+     * The root nodes are then read with readSceneNode() and the scene is completed with finishScene().
+     *
+     * @param id The ID of the scene to load.
+     * @param childCount Where to store the number of root nodes in the scene.
+     *
+     * @return The new scene, or NULL if there was an error.
+     */
+    Scene* beginScene(const char* id, unsigned int* childCount);
+
+    /**
+     * Reads the next root node of the scene started with beginScene() (with all of its descendants)
+     * and adds it to the scene.
+     *
+     * @param scene The scene being loaded.
+     */
+    void readSceneNode(Scene* scene);
+
+    /**
+     * Reads the rest of the scene started with beginScene() after all of its root nodes have been read,
+     * and loads the animations of the bundle.
+     *
+     * @param scene The scene being loaded.
+     *
+     * @return True if successful, false if an error occurred.
+     */
+    bool finishScene(Scene* scene);
+
+    /**
+     * Gets the number of meshes in the bundle.
+     */
+    unsigned int getMeshCount() const;
+
+    /**
+     * Reads the data of all meshes in the bundle into memory so that loadMesh() does not
+     * read them from the file. The pages of memory-mapped mesh data are touched, so that
+     * they are paged in by the calling thread. This does not use the graphics device and
+     * can run on any thread, as long as no other thread uses the bundle.
+     *
+     * @param cancelled Stops reading when set to true.
+     * @param loadedCount Incremented for every mesh that is read.
+     */
+    void preloadMeshData(const std::atomic<bool>* cancelled, std::atomic<unsigned int>* loadedCount);
+
+    /**
+     * Frees the mesh data read by preloadMeshData() that has not been used by loadMesh().
+     */
+    void clearPreloadedMeshData();
+
     /**
      * Reads a camera from the current file position.
      *
@@ -455,6 +580,10 @@ private:
     std::string _materialPath;
     unsigned int _referenceCount;
     Reference* _references;
+    std::vector<unsigned int> _idIndex;
+    std::vector<unsigned int> _offsetIndex;
+    std::vector<unsigned int> _animationsIndex;
+    std::vector<MeshData*> _preloadedMeshData;
     Stream* _stream;
 
     std::vector<MeshSkinData*> _meshSkins;
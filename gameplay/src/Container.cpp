@@ -664,7 +664,7 @@ unsigned int Container::draw(Form* form, const Rectangle& clip)
         Control* control = _controls[i];
         if (control && control->_absoluteClipBounds.intersects(_absoluteClipBounds))
         {
-            drawCalls += control->draw(form, _viewportClipBounds);
+            drawCalls += control->drawRetained(form, _viewportClipBounds);
         }
     }
 
@@ -1561,6 +1561,7 @@ void Container::setAnimationPropertyValue(int propertyId, AnimationValue* value,
     {
     case ANIMATE_SCROLLBAR_OPACITY:
         _scrollBarOpacity = Curve::lerp(blendWeight, _opacity, value->getFloat(0));
+        setDirty(DIRTY_DRAW);
         break;
     default:
         Control::setAnimationPropertyValue(propertyId, value, blendWeight);
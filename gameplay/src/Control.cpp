@@ -8,7 +8,7 @@ namespace gameplay
 {
 
 Control::Control()
-    : _id(""), _boundsBits(0), _dirtyBits(DIRTY_BOUNDS | DIRTY_STATE), _consumeInputEvents(true), _alignment(ALIGN_TOP_LEFT),
+    : _id(""), _boundsBits(0), _dirtyBits(DIRTY_BOUNDS | DIRTY_STATE | DIRTY_DRAW), _consumeInputEvents(true), _alignment(ALIGN_TOP_LEFT),
     _autoSize(AUTO_SIZE_BOTH), _listeners(NULL), _style(NULL), _visible(true), _opacity(0.0f), _zIndex(-1),
     _contactIndex(INVALID_CONTACT_INDEX), _focusIndex(-1), _canFocus(false), _state(NORMAL), _parent(NULL), _styleOverridden(false), _skin(NULL)
 {
@@ -1062,6 +1062,10 @@ void Control::notifyListeners(Control::Listener::EventType eventType)
     // need to keep it alive until the method returns.
     this->addRef();
 
+    // Events are raised when the control's value, text or interaction state changes, any of which
+    // may change how it is drawn.
+    setDirty(DIRTY_DRAW);
+
     controlEvent(eventType);
 
     if (_listeners)
@@ -1089,7 +1093,12 @@ void Control::controlEvent(Control::Listener::EventType evt)
 
 void Control::setDirty(int bits)
 {
-    _dirtyBits |= bits;
+    _dirtyBits |= bits | DIRTY_DRAW;
+
+    // Parents cache the geometry of their whole subtree, so it is out of date for them too.
+    // Always walk to the root: a parent may have redrawn without drawing a dirty (clipped) child.
+    for (Control* parent = _parent; parent; parent = parent->_parent)
+        parent->_dirtyBits |= DIRTY_DRAW;
 }
 
 bool Control::isDirty(int bit) const
@@ -1107,9 +1116,14 @@ void Control::update(float elapsedTime)
 
     // Since opacity is pre-multiplied, we compute it every frame so that we don't need to
     // dirty the entire hierarchy any time a state changes (which could affect opacity).
-    _opacity = getOpacity(state);
+    float opacity = getOpacity(state);
     if (_parent)
-        _opacity *= _parent->_opacity;
+        opacity *= _parent->_opacity;
+    if (opacity != _opacity)
+    {
+        _opacity = opacity;
+        setDirty(DIRTY_DRAW);
+    }
 }
 
 void Control::updateState(State state)
@@ -1291,6 +1305,74 @@ void Control::finishBatch(Form* form, SpriteBatch* batch)
     form->finishBatch(batch);
 }
 
+unsigned int Control::drawRetained(Form* form, const Rectangle& clip)
+{
+    GP_ASSERT(form);
+
+    // Geometry can only be cached while batches stay open until the whole form has been drawn.
+    if (!form->_batched)
+    {
+        ++form->_redrawnControlCount;
+        return draw(form, clip);
+    }
+
+    if ((_dirtyBits & DIRTY_DRAW) == 0)
+    {
+        // Nothing in this subtree changed since it was last drawn, so replay its cached geometry.
+        // Batches are started in the order they were first drawn into, which keeps the layering
+        // of batches across the form the same as when the geometry was built.
+        for (size_t i = 0, count = _drawCache.size(); i < count; ++i)
+        {
+            DrawCache& cache = _drawCache[i];
+            form->startBatch(cache.batch);
+            if (!cache.indices.empty())
+                cache.batch->draw(&cache.vertices[0], (unsigned int)cache.vertices.size(), &cache.indices[0], (unsigned int)cache.indices.size());
+        }
+        ++form->_cachedControlCount;
+        return (unsigned int)_drawCache.size();
+    }
+
+    // Record how much geometry each open batch holds, so that whatever this control and its children
+    // add to the batches can be copied out once they are drawn.
+    size_t markStart = form->_batchMarks.size();
+    size_t markCount = form->_batches.size();
+    for (size_t i = 0; i < markCount; ++i)
+    {
+        SpriteBatch* batch = form->_batches[i];
+        form->_batchMarks.push_back(std::make_pair(batch->getVertexCount(), batch->getIndexCount()));
+    }
+
+    unsigned int drawCalls = draw(form, clip);
+    ++form->_redrawnControlCount;
+
+    size_t cacheCount = 0;
+    for (size_t i = 0, count = form->_batches.size(); i < count; ++i)
+    {
+        SpriteBatch* batch = form->_batches[i];
+        unsigned int vertexStart = 0;
+        unsigned int indexStart = 0;
+        if (i < markCount)
+        {
+            vertexStart = form->_batchMarks[markStart + i].first;
+            indexStart = form->_batchMarks[markStart + i].second;
+        }
+        if (batch->getVertexCount() == vertexStart)
+            continue;
+
+        if (cacheCount == _drawCache.size())
+            _drawCache.push_back(DrawCache());
+        DrawCache& cache = _drawCache[cacheCount++];
+        cache.batch = batch;
+        batch->copyVertices(vertexStart, indexStart, &cache.vertices, &cache.indices);
+    }
+    _drawCache.resize(cacheCount);
+    form->_batchMarks.resize(markStart);
+
+    _dirtyBits &= ~DIRTY_DRAW;
+
+    return drawCalls;
+}
+
 unsigned int Control::draw(Form* form, const Rectangle& clip)
 {
     if (!_visible)
@@ -1657,6 +1739,9 @@ Theme::Style::Overlay* Control::getOverlay(State state) const
 
 void Control::overrideStyle()
 {
+    // Overridden style properties are set right after this, and may change how the control is drawn.
+    setDirty(DIRTY_DRAW);
+
     if (_styleOverridden)
     {
         return;
@@ -997,6 +997,13 @@ protected:
      */
     static const int DIRTY_STATE = 2;
 
+    /**
+     * Indicates that the geometry cached for drawing the control (and its children) is out of date.
+     *
+     * Setting any dirty bit on a control also sets this bit on the control and all of its parents.
+     */
+    static const int DIRTY_DRAW = 4;
+
     /**
      * Indicates that the x position of the control is a percentage.
      */
@@ -1482,8 +1489,20 @@ private:
      */    
     Control(const Control& copy);
 
+    /**
+     * Geometry drawn by a control and its children into a single batch.
+     */
+    struct DrawCache
+    {
+        SpriteBatch* batch;
+        std::vector<SpriteBatch::SpriteVertex> vertices;
+        std::vector<unsigned short> indices;
+    };
+
     bool updateBoundsInternal(const Vector2& offset);
 
+    unsigned int drawRetained(Form* form, const Rectangle& clip);
+
     AutoSize parseAutoSize(const char* str);
 
     Theme::Style::Overlay** getOverlays(unsigned char overlayTypes, Theme::Style::Overlay** overlays);
@@ -1506,6 +1525,7 @@ private:
 
     bool _styleOverridden;
     Theme::Skin* _skin;
+    std::vector<DrawCache> _drawCache;
 
 };
 
@@ -5,8 +5,10 @@
 #include <cstring>
 #include <cmath>
 #include <memory>
+#include <algorithm>
 
 using std::memcpy;
+using std::memset;
 using std::fabs;
 using std::sqrt;
 using std::cos;
@@ -18,6 +20,12 @@ using std::strcmp;
 #define NULL 0
 #endif
 
+// The largest number of components of a packed curve.
+#define PACKED_MAX_COMPONENTS 16
+
+// The largest quantized value of a component of a packed curve.
+#define PACKED_MAX_SAMPLE 65535.0f
+
 #ifndef MATH_PI
 #define MATH_PI 3.14159265358979323846f
 #endif
@@ -88,8 +96,14 @@ Curve* Curve::create(unsigned int pointCount, unsigned int componentCount)
     return new Curve(pointCount, componentCount);
 }
 
+Curve* Curve::createPacked(unsigned int sampleCount, unsigned int componentCount, const float* minimums, const float* extents, const unsigned short* samples)
+{
+    return new Curve(sampleCount, componentCount, minimums, extents, samples);
+}
+
 Curve::Curve(unsigned int pointCount, unsigned int componentCount)
-    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL)
+    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL),
+      _samples(NULL), _sampleMinimums(NULL), _sampleScales(NULL)
 {
     _points = new Point[_pointCount];
     for (unsigned int i = 0; i < _pointCount; i++)
@@ -103,10 +117,30 @@ Curve::Curve(unsigned int pointCount, unsigned int componentCount)
     _points[_pointCount - 1].time = 1.0f;
 }
 
+Curve::Curve(unsigned int sampleCount, unsigned int componentCount, const float* minimums, const float* extents, const unsigned short* samples)
+    : _pointCount(sampleCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL),
+      _samples(NULL), _sampleMinimums(NULL), _sampleScales(NULL)
+{
+    assert(sampleCount > 0 && componentCount <= PACKED_MAX_COMPONENTS && minimums && extents && samples);
+
+    _samples = new unsigned short[sampleCount * componentCount];
+    memcpy(_samples, samples, sizeof(unsigned short) * sampleCount * componentCount);
+    _sampleMinimums = new float[componentCount];
+    _sampleScales = new float[componentCount];
+    for (unsigned int i = 0; i < componentCount; i++)
+    {
+        _sampleMinimums[i] = minimums[i];
+        _sampleScales[i] = extents[i] / PACKED_MAX_SAMPLE;
+    }
+}
+
 Curve::~Curve()
 {
     SAFE_DELETE_ARRAY(_points);
     SAFE_DELETE_ARRAY(_quaternionOffset);
+    SAFE_DELETE_ARRAY(_samples);
+    SAFE_DELETE_ARRAY(_sampleMinimums);
+    SAFE_DELETE_ARRAY(_sampleScales);
 }
 
 Curve::Point::Point()
@@ -133,17 +167,27 @@ unsigned int Curve::getComponentCount() const
 
 float Curve::getStartTime() const
 {
+    if (_samples)
+        return 0.0f;
+
     return _points[0].time;
 }
 
 float Curve::getEndTime() const
 {
+    if (_samples)
+        return _pointCount > 1 ? 1.0f : 0.0f;
+
     return _points[_pointCount-1].time;
 }
 
 float Curve::getPointTime(unsigned int index) const
 {
     assert(index < _pointCount);
+
+    if (_samples)
+        return _pointCount > 1 ? (float)index / (float)(_pointCount - 1) : 0.0f;
+
     return _points[index].time;
 }
 
@@ -151,12 +195,28 @@ float Curve::getPointTime(unsigned int index) const
 Curve::InterpolationType Curve::getPointInterpolation(unsigned int index) const
 {
     assert(index < _pointCount);
+
+    if (_samples)
+        return LINEAR;
+
     return _points[index].type;;
 }
 
 void Curve::getPointValues(unsigned int index, float* value, float* inValue, float* outValue) const
 {
     assert(index < _pointCount);
+
+    if (_samples)
+    {
+        // Packed curves have no tangents.
+        if (value)
+            decodeSample(index, value);
+        if (inValue)
+            memset(inValue, 0, _componentSize);
+        if (outValue)
+            memset(outValue, 0, _componentSize);
+        return;
+    }
     
     if (value)
         memcpy(value, _points[index].value, _componentSize);
@@ -175,7 +235,7 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 
 void Curve::setPoint(unsigned int index, float time, float* value, InterpolationType type, float* inValue, float* outValue)
 {
-    assert(index < _pointCount && time >= 0.0f && time <= 1.0f && !(_pointCount > 1 && index == 0 && time != 0.0f) && !(_pointCount != 1 && index == _pointCount - 1 && time != 1.0f));
+    assert(_points && index < _pointCount && time >= 0.0f && time <= 1.0f && !(_pointCount > 1 && index == 0 && time != 0.0f) && !(_pointCount != 1 && index == _pointCount - 1 && time != 1.0f));
 
     _points[index].time = time;
     _points[index].type = type;
@@ -192,7 +252,7 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 
 void Curve::setTangent(unsigned int index, InterpolationType type, float* inValue, float* outValue)
 {
-    assert(index < _pointCount);
+    assert(_points && index < _pointCount);
 
     _points[index].type = type;
 
@@ -211,14 +271,54 @@ void Curve::evaluate(float time, float* dst) const
 }
 
 void Curve::evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst) const
+{
+    evaluate(time, startTime, endTime, loopBlendTime, dst, NULL);
+}
+
+void Curve::evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst, Cursor* cursor) const
 {
     assert(dst && startTime >= 0.0f && startTime <= endTime && endTime <= 1.0f && loopBlendTime >= 0.0f);
 
+    if (_samples)
+    {
+        unsigned int index;
+        unsigned int next;
+        float t;
+        if (!locateSample(time, startTime, endTime, loopBlendTime, &index, &next, &t))
+        {
+            decodeSample(index, dst);
+            return;
+        }
+        float from[PACKED_MAX_COMPONENTS];
+        float to[PACKED_MAX_COMPONENTS];
+        decodeSample(index, from);
+        decodeSample(next, to);
+        interpolateValues(t, from, to, dst);
+        return;
+    }
+
+    Point* from;
+    Point* to;
+    float t;
+    unsigned int index;
+    if (!locate(time, startTime, endTime, loopBlendTime, cursor, &index, &from, &to, &t))
+    {
+        // The time is exactly on a point, so return its value directly.
+        memcpy(dst, from->value, _componentSize);
+        return;
+    }
+    interpolate(t, index, from, to, dst);
+}
+
+bool Curve::locate(float time, float startTime, float endTime, float loopBlendTime, Cursor* cursor, unsigned int* index, Point** from, Point** to, float* t) const
+{
+    assert(_points && index && from && to && t);
+
     // If there's only one point on the curve, return its value.
     if (_pointCount == 1)
     {
-        memcpy(dst, _points[0].value, _componentSize);
-        return;
+        *from = &_points[0];
+        return false;
     }
 
     unsigned int min = 0;
@@ -227,8 +327,23 @@ void Curve::evaluate(float time, float startTime, float endTime, float loopBlend
     if (startTime > 0.0f || endTime < 1.0f)
     {
         // Evaluating a sub section of the curve
-        min = determineIndex(startTime, 0, max);
-        max = determineIndex(endTime, min, max);
+        if (cursor && cursor->startTime == startTime && cursor->endTime == endTime)
+        {
+            min = cursor->min;
+            max = cursor->max;
+        }
+        else
+        {
+            min = determineIndex(startTime, 0, max);
+            max = determineIndex(endTime, min, max);
+            if (cursor)
+            {
+                cursor->startTime = startTime;
+                cursor->endTime = endTime;
+                cursor->min = min;
+                cursor->max = max;
+            }
+        }
 
         // Convert time to fall within the subregion
         localTime = _points[min].time + (_points[max].time - _points[min].time) * time;
@@ -246,53 +361,145 @@ void Curve::evaluate(float time, float startTime, float endTime, float loopBlend
     // If an exact endpoint was specified, skip interpolation and return the value directly
     if (localTime == _points[min].time)
     {
-        memcpy(dst, _points[min].value, _componentSize);
-        return;
+        *from = &_points[min];
+        return false;
     }
     if (localTime == _points[max].time)
     {
-        memcpy(dst, _points[max].value, _componentSize);
-        return;
+        *from = &_points[max];
+        return false;
     }
 
-    Point* from;
-    Point* to;
-    float scale;
-    float t;
-    unsigned int index;
-
     if (localTime > _points[max].time)
     {
         // Looping forward
-        index = max;
-        from = &_points[max];
-        to = &_points[min];
+        *index = max;
+        *from = &_points[max];
+        *to = &_points[min];
 
         // Calculate the fractional time between the two points.
-        t = (localTime - from->time) / loopBlendTime;
+        *t = (localTime - (*from)->time) / loopBlendTime;
     }
     else if (localTime < _points[min].time)
     {
         // Looping in reverse
-        index = min;
-        from = &_points[min];
-        to = &_points[max];
+        *index = min;
+        *from = &_points[min];
+        *to = &_points[max];
 
         // Calculate the fractional time between the two points.
-        t = (from->time - localTime) / loopBlendTime;
+        *t = ((*from)->time - localTime) / loopBlendTime;
     }
     else
     {
-        // Locate the points we are interpolating between using a binary search.
-        index = determineIndex(localTime, min, max);
-        from = &_points[index];
-        to = &_points[index == max ? index : index+1];
+        // Locate the points we are interpolating between, starting from the last located points.
+        *index = determineIndex(localTime, min, max, cursor);
+        *from = &_points[*index];
+        *to = &_points[*index == max ? *index : *index + 1];
 
         // Calculate the fractional time between the two points.
-        scale = (to->time - from->time);
-        t = (localTime - from->time) / scale;
+        *t = (localTime - (*from)->time) / ((*to)->time - (*from)->time);
+    }
+    return true;
+}
+
+bool Curve::locateSample(float time, float startTime, float endTime, float loopBlendTime, unsigned int* index, unsigned int* next, float* t) const
+{
+    assert(_samples && index && next && t);
+
+    // If there's only one sample on the curve, return its value.
+    if (_pointCount == 1)
+    {
+        *index = 0;
+        return false;
+    }
+
+    // Work in units of samples, which lie at integer positions.
+    const float last = (float)(_pointCount - 1);
+    unsigned int min = 0;
+    unsigned int max = _pointCount - 1;
+    float position = time * last;
+    if (startTime > 0.0f || endTime < 1.0f)
+    {
+        // Evaluating a sub section of the curve, starting and ending on the samples before its times.
+        min = std::min((unsigned int)(startTime * last), max);
+        max = std::max(std::min((unsigned int)(endTime * last), max), min);
+        position = (float)min + (float)(max - min) * time;
+    }
+
+    if (loopBlendTime == 0.0f)
+    {
+        // If no loop blend time is specified, clamp time to end points
+        if (position < (float)min)
+            position = (float)min;
+        else if (position > (float)max)
+            position = (float)max;
     }
 
+    // If an exact endpoint was specified, skip interpolation and return the value directly
+    if (position == (float)min)
+    {
+        *index = min;
+        return false;
+    }
+    if (position == (float)max)
+    {
+        *index = max;
+        return false;
+    }
+
+    if (position > (float)max)
+    {
+        // Looping forward
+        *index = max;
+        *next = min;
+        *t = (position - (float)max) / (loopBlendTime * last);
+    }
+    else if (position < (float)min)
+    {
+        // Looping in reverse
+        *index = min;
+        *next = max;
+        *t = ((float)min - position) / (loopBlendTime * last);
+    }
+    else
+    {
+        // The samples are uniform, so the one to interpolate from is found directly.
+        *index = std::min((unsigned int)position, max - 1);
+        *next = *index + 1;
+        *t = position - (float)*index;
+    }
+    return true;
+}
+
+void Curve::decodeSample(unsigned int index, float* dst) const
+{
+    assert(_samples && index < _pointCount);
+
+    const unsigned short* sample = _samples + index * _componentCount;
+    for (unsigned int i = 0; i < _componentCount; i++)
+    {
+        dst[i] = _sampleMinimums[i] + (float)sample[i] * _sampleScales[i];
+    }
+
+    // Quantization denormalizes rotations.
+    if (_quaternionOffset)
+    {
+        float* q = dst + *_quaternionOffset;
+        float n = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+        if (n > 0.0f)
+        {
+            n = 1.0f / sqrt(n);
+            q[0] *= n;
+            q[1] *= n;
+            q[2] *= n;
+            q[3] *= n;
+        }
+    }
+}
+
+void Curve::interpolate(float t, unsigned int index, Point* from, Point* to, float* dst) const
+{
     // Calculate the value of the curve discretely if appropriate.
     switch (from->type)
     {
@@ -1198,9 +1405,11 @@ void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, P
 
 void Curve::interpolateLinear(float s, Point* from, Point* to, float* dst) const
 {
-    float* fromValue = from->value;
-    float* toValue = to->value;
+    interpolateValues(s, from->value, to->value, dst);
+}
 
+void Curve::interpolateValues(float s, float* fromValue, float* toValue, float* dst) const
+{
     if (!_quaternionOffset)
     {
         for (unsigned int i = 0; i < _componentCount; i++)
@@ -1267,6 +1476,34 @@ int Curve::determineIndex(float time, unsigned int min, unsigned int max) const
     return max;
 }
 
+int Curve::determineIndex(float time, unsigned int min, unsigned int max, Cursor* cursor) const
+{
+    if (!cursor)
+        return determineIndex(time, min, max);
+
+    // Playback usually stays within the last located segment or moves on to the next one.
+    unsigned int index = cursor->index;
+    if (index >= min && index < max && time >= _points[index].time)
+    {
+        if (time < _points[index + 1].time)
+            return index;
+
+        if (index + 1 < max && time < _points[index + 2].time)
+        {
+            cursor->index = index + 1;
+            return index + 1;
+        }
+    }
+
+    cursor->index = determineIndex(time, min, max);
+    return cursor->index;
+}
+
+Curve::Cursor::Cursor()
+    : startTime(-1.0f), endTime(-1.0f), min(0), max(0), index(0)
+{
+}
+
 int Curve::getInterpolationType(const char* curveId)
 {
     if (strcmp(curveId, "BEZIER") == 0)
@@ -16,6 +16,7 @@ class Curve : public Ref
     friend class AnimationClip;
     friend class AnimationController;
     friend class MeshSkin;
+    friend class Bundle;
 
 public:
 
@@ -455,6 +456,24 @@ private:
         Point& operator=(const Point&);
     };
 
+    /**
+     * Caches the keyframe search of one evaluator of a curve (such as an animation clip)
+     * between evaluations, since consecutive evaluations are usually close in time.
+     */
+    struct Cursor
+    {
+        /**
+         * Constructor.
+         */
+        Cursor();
+
+        float startTime;        // The start time of the subregion of the cached min and max points.
+        float endTime;          // The end time of the subregion of the cached min and max points.
+        unsigned int min;       // The first point of the subregion.
+        unsigned int max;       // The last point of the subregion.
+        unsigned int index;     // The point last interpolated from.
+    };
+
     /**
      * Constructor.
      */
@@ -468,6 +487,11 @@ private:
      */
     Curve(unsigned int pointCount, unsigned int componentCount);
 
+    /**
+     * Constructs a new packed curve (see createPacked).
+     */
+    Curve(unsigned int sampleCount, unsigned int componentCount, const float* minimums, const float* extents, const unsigned short* samples);
+
     /**
      * Constructor.
      */
@@ -483,6 +507,62 @@ private:
      */
     Curve& operator=(const Curve&);
 
+    /**
+     * Creates a packed curve, made of samples taken at uniform intervals and quantized to 16 bits.
+     *
+     * Sample i lies at time i / (sampleCount - 1), and the value of its component c is
+     * minimums[c] + samples[i * componentCount + c] * extents[c] / 65535. The samples are
+     * interpolated linearly, so the samples to interpolate between are found in constant
+     * time and no tangents are stored. Packed curves are read-only.
+     *
+     * @param sampleCount The number of samples in the curve.
+     * @param componentCount The number of float component values per sample.
+     * @param minimums The minimum value of each component.
+     * @param extents The range of values of each component.
+     * @param samples The quantized component values of the samples.
+     *
+     * @return The new curve.
+     */
+    static Curve* createPacked(unsigned int sampleCount, unsigned int componentCount, const float* minimums, const float* extents, const unsigned short* samples);
+
+    /**
+     * Locates the samples of a packed curve to interpolate between at the specified time.
+     *
+     * @return false if the time is exactly on the sample returned in index, true if the
+     *      value must be interpolated between the samples index and next at the fractional time t.
+     */
+    bool locateSample(float time, float startTime, float endTime, float loopBlendTime, unsigned int* index, unsigned int* next, float* t) const;
+
+    /**
+     * Decodes the values of a sample of a packed curve.
+     */
+    void decodeSample(unsigned int index, float* dst) const;
+
+    /**
+     * Interpolates linearly between two arrays of values of the curve.
+     */
+    void interpolateValues(float s, float* from, float* to, float* dst) const;
+
+    /**
+     * Evaluates the curve like evaluate(float, float, float, float, float*), starting the
+     * keyframe search from the points located by the last evaluation with the given cursor.
+     */
+    void evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst, Cursor* cursor) const;
+
+    /**
+     * Locates the points to interpolate between at the specified time.
+     *
+     * @return false if the time is exactly on the point returned in from, true if the
+     *      value must be interpolated between from and to at the fractional time t.
+     */
+    bool locate(float time, float startTime, float endTime, float loopBlendTime, Cursor* cursor,
+                unsigned int* index, Point** from, Point** to, float* t) const;
+
+    /**
+     * Interpolates between two located points with the interpolation type of the first one.
+     */
+    void interpolate(float t, unsigned int index, Point* from, Point* to, float* dst) const;
+
     /**
      * Bezier interpolation function.
      */
@@ -523,6 +603,12 @@ private:
      */
     int determineIndex(float time, unsigned int min, unsigned int max) const;
 
+    /**
+     * Determines the current keyframe to interpolate from, checking the keyframes
+     * following the one cached in the cursor before searching.
+     */
+    int determineIndex(float time, unsigned int min, unsigned int max, Cursor* cursor) const;
+
     /**
      * Sets the offset for the beginning of a Quaternion piece of data within the curve's value span at the specified
      * index. The next four components of data starting at the given index will be interpolated as a Quaternion.
@@ -545,7 +631,10 @@ private:
     unsigned int _componentCount;       // Number of components on the curve.
     unsigned int _componentSize;        // The component size (in bytes).
     unsigned int* _quaternionOffset;    // Offset for the rotation component.
-    Point* _points;                     // The points on the curve.
+    Point* _points;                     // The points on the curve (NULL for packed curves).
+    unsigned short* _samples;           // The quantized samples of a packed curve.
+    float* _sampleMinimums;             // The minimum value of each component of a packed curve.
+    float* _sampleScales;               // The size of a quantization step of each component of a packed curve.
 };
 
 }
@@ -1,6 +1,7 @@
 #include "Base.h"
 #include "Drawable.h"
 #include "Node.h"
+#include "RenderQueue.h"
 
 
 namespace gameplay
@@ -15,6 +16,12 @@ Drawable::~Drawable()
 {
 }
 
+void Drawable::submit(RenderQueue* queue, bool wireframe)
+{
+    GP_ASSERT(queue);
+    queue->submit(this, wireframe);
+}
+
 Node* Drawable::getNode() const
 {
     return _node;
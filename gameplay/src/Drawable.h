@@ -6,6 +6,7 @@ namespace gameplay
 
 class Node;
 class NodeCloneContext;
+class RenderQueue;
 
 /**
  * Defines a drawable object that can be attached to a Node.
@@ -35,6 +36,17 @@ public:
 
     virtual unsigned int draw(bool wireframe = false) = 0;
 
+    /**
+     * Submits the object to a render queue, to be drawn when the queue is executed.
+     *
+     * By default the object is submitted to be drawn as a whole by calling draw.
+     *
+     * @param queue The render queue.
+     * @param wireframe true if you want to request to draw the wireframe only.
+     * @script{ignore}
+     */
+    virtual void submit(RenderQueue* queue, bool wireframe = false);
+
     /**
      * Gets the node this drawable is attached to.
      *
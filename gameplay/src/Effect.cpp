@@ -9,17 +9,26 @@ namespace gameplay
 {
 
 // Cache of unique effects.
-static std::map<std::string, Effect*> __effectCache;
+static ResourceCache __effectCache;
 static Effect* __currentEffect = NULL;
 
-Effect::Effect() : _program(0)
+// Serial numbers identifying effects (never reused, unlike addresses).
+static unsigned int __effectSerial = 0;
+
+// Uniform uploads issued and skipped during the current and the last frame.
+static unsigned int __uniformUploads = 0;
+static unsigned int __uniformUploadsSkipped = 0;
+static unsigned int __lastUniformUploads = 0;
+static unsigned int __lastUniformUploadsSkipped = 0;
+
+Effect::Effect() : _program(0), _serial(++__effectSerial), _cacheKey(NULL)
 {
 }
 
 Effect::~Effect()
 {
     // Remove this effect from the cache.
-    __effectCache.erase(_id);
+    __effectCache.remove(_cacheKey, this);
 
     // Free uniforms.
     for (std::map<std::string, Uniform*>::iterator itr = _uniforms.begin(); itr != _uniforms.end(); ++itr)
@@ -55,13 +64,12 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
     {
         uniqueId += defines;
     }
-    std::map<std::string, Effect*>::const_iterator itr = __effectCache.find(uniqueId);
-    if (itr != __effectCache.end())
+    Effect* cached = static_cast<Effect*>(__effectCache.find(uniqueId.c_str()));
+    if (cached)
     {
         // Found an exiting effect with this id, so increase its ref count and return it.
-        GP_ASSERT(itr->second);
-        itr->second->addRef();
-        return itr->second;
+        cached->addRef();
+        return cached;
     }
 
     // Read source from file.
@@ -92,7 +100,7 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
     {
         // Store this effect in the cache.
         effect->_id = uniqueId;
-        __effectCache[uniqueId] = effect;
+        effect->_cacheKey = __effectCache.add(uniqueId.c_str(), effect);
     }
 
     return effect;
@@ -496,6 +504,11 @@ Uniform* Effect::getUniform(const char* name) const
 				uniform->_location = uniformLocation;
 				uniform->_index = 0;
 				uniform->_type = puniform->getType();
+
+				// Array elements share storage with their array, so their values are not shadowed.
+				uniform->_shadowed = false;
+				puniform->_shadowed = false;
+				puniform->_shadow.clear();
 				_uniforms[name] = uniform;
 
 				SAFE_DELETE_ARRAY(parentname);
@@ -530,79 +543,115 @@ unsigned int Effect::getUniformCount() const
 void Effect::setValue(Uniform* uniform, float value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1f(uniform->_location, value) );
+    if (uniform->updateShadow(&value, sizeof(float)))
+    {
+        GL_ASSERT( glUniform1f(uniform->_location, value) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const float* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    if (uniform->updateShadow(values, sizeof(float) * count))
+    {
+        GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, int value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1i(uniform->_location, value) );
+    if (uniform->updateShadow(&value, sizeof(int)))
+    {
+        GL_ASSERT( glUniform1i(uniform->_location, value) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const int* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    if (uniform->updateShadow(values, sizeof(int) * count))
+    {
+        GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    if (uniform->updateShadow(value.m, sizeof(float) * 16))
+    {
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    if (uniform->updateShadow(values, sizeof(Matrix) * count))
+    {
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    if (uniform->updateShadow(&value.x, sizeof(float) * 2))
+    {
+        GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateShadow(values, sizeof(Vector2) * count))
+    {
+        GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    if (uniform->updateShadow(&value.x, sizeof(float) * 3))
+    {
+        GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateShadow(values, sizeof(Vector3) * count))
+    {
+        GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    if (uniform->updateShadow(&value.x, sizeof(float) * 4))
+    {
+        GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateShadow(values, sizeof(Vector4) * count))
+    {
+        GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
@@ -618,7 +667,12 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
     // Bind the sampler - this binds the texture and applies sampler state
     const_cast<Texture::Sampler*>(sampler)->bind();
 
-    GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+    // The texture unit of a sampler uniform never changes.
+    GLint unit = (GLint)uniform->_index;
+    if (uniform->updateShadow(&unit, sizeof(GLint)))
+    {
+        GL_ASSERT( glUniform1i(uniform->_location, unit) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigned int count)
@@ -642,14 +696,20 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigne
     }
 
     // Pass texture unit array to GL
-    GL_ASSERT( glUniform1iv(uniform->_location, count, units) );
+    if (uniform->updateShadow(units, sizeof(GLint) * count))
+    {
+        GL_ASSERT( glUniform1iv(uniform->_location, count, units) );
+    }
 }
 
 void Effect::bind()
 {
-   GL_ASSERT( glUseProgram(_program) );
-
-    __currentEffect = this;
+    // Skip the program switch when the effect is already in use.
+    if (__currentEffect != this)
+    {
+        GL_ASSERT( glUseProgram(_program) );
+        __currentEffect = this;
+    }
 }
 
 Effect* Effect::getCurrentEffect()
@@ -657,8 +717,26 @@ Effect* Effect::getCurrentEffect()
     return __currentEffect;
 }
 
+unsigned int Effect::getUniformUploadCount()
+{
+    return __lastUniformUploads;
+}
+
+unsigned int Effect::getUniformUploadSkipCount()
+{
+    return __lastUniformUploadsSkipped;
+}
+
+void Effect::resetStatistics()
+{
+    __lastUniformUploads = __uniformUploads;
+    __lastUniformUploadsSkipped = __uniformUploadsSkipped;
+    __uniformUploads = 0;
+    __uniformUploadsSkipped = 0;
+}
+
 Uniform::Uniform() :
-    _location(-1), _type(0), _index(0), _effect(NULL)
+    _location(-1), _type(0), _index(0), _effect(NULL), _version(0), _shadowed(true)
 {
 }
 
@@ -682,4 +760,36 @@ const GLenum Uniform::getType() const
     return _type;
 }
 
+bool Uniform::updateShadow(const void* data, size_t size)
+{
+    // The version of the value is only known to the caller (see MaterialParameter::bind).
+    _version = 0;
+
+    if (!_shadowed)
+    {
+        ++__uniformUploads;
+        return true;
+    }
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    if (_shadow.size() == size && memcmp(&_shadow[0], bytes, size) == 0)
+    {
+        ++__uniformUploadsSkipped;
+        return false;
+    }
+
+    _shadow.assign(bytes, bytes + size);
+    ++__uniformUploads;
+    return true;
+}
+
+bool Uniform::isCurrent(unsigned long long version)
+{
+    if (version == 0 || !_shadowed || _version != version)
+        return false;
+
+    ++__uniformUploadsSkipped;
+    return true;
+}
+
 }
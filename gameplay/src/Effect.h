@@ -7,6 +7,7 @@
 #include "Vector4.h"
 #include "Matrix.h"
 #include "Texture.h"
+#include "ResourceCache.h"
 
 namespace gameplay
 {
@@ -25,6 +26,9 @@ class Uniform;
  */
 class Effect: public Ref
 {
+    friend class Game;
+    friend class MaterialParameter;
+
 public:
 
     /**
@@ -222,6 +226,23 @@ public:
      */
     static Effect* getCurrentEffect();
 
+    /**
+     * Gets the number of uniform values uploaded to programs during the last frame.
+     *
+     * @return The number of uniform uploads issued.
+     * @script{ignore}
+     */
+    static unsigned int getUniformUploadCount();
+
+    /**
+     * Gets the number of uniform uploads skipped during the last frame because
+     * the program already held the value.
+     *
+     * @return The number of uniform uploads avoided.
+     * @script{ignore}
+     */
+    static unsigned int getUniformUploadSkipCount();
+
 private:
 
     /**
@@ -241,8 +262,15 @@ private:
 
     static Effect* createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines = NULL);
 
+    /**
+     * Publishes the uniform upload counters of the frame that ended and resets them.
+     */
+    static void resetStatistics();
+
     GLuint _program;
+    unsigned int _serial;
     std::string _id;
+    ResourceCache::Key _cacheKey;
     std::map<std::string, VertexAttribute> _vertexAttributes;
     mutable std::map<std::string, Uniform*> _uniforms;
     static Uniform _emptyUniform;
@@ -254,6 +282,7 @@ private:
 class Uniform
 {
     friend class Effect;
+    friend class MaterialParameter;
 
 public:
 
@@ -300,11 +329,30 @@ private:
      */
     Uniform& operator=(const Uniform&);
 
+    /**
+     * Updates the copy of the value last uploaded to the uniform.
+     *
+     * @param data The new value.
+     * @param size The size of the value, in bytes.
+     *
+     * @return true if the value must be uploaded, false if the uniform already holds it.
+     */
+    bool updateShadow(const void* data, size_t size);
+
+    /**
+     * Determines whether the uniform holds the value of the given version, counting
+     * the upload as skipped if it does.
+     */
+    bool isCurrent(unsigned long long version);
+
     std::string _name;
     GLint _location;
     GLenum _type;
     unsigned int _index;
     Effect* _effect;
+    std::vector<unsigned char> _shadow;
+    unsigned long long _version;
+    bool _shadowed;
 };
 
 }
@@ -18,6 +18,9 @@
     #define __EXT_POSIX2
     #include <libgen.h>
     #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
     #define gp_stat stat
     #define gp_stat_struct struct stat
 #endif
@@ -145,6 +148,46 @@ private:
     bool _canWrite;
 };
 
+#ifndef WIN32
+
+/**
+ * A read-only stream over a memory-mapped file.
+ *
+ * @script{ignore}
+ */
+class MappedFileStream : public Stream
+{
+public:
+    friend class FileSystem;
+
+    ~MappedFileStream();
+    virtual bool canRead();
+    virtual bool canWrite();
+    virtual bool canSeek();
+    virtual void close();
+    virtual size_t read(void* ptr, size_t size, size_t count);
+    virtual char* readLine(char* str, int num);
+    virtual size_t write(const void* ptr, size_t size, size_t count);
+    virtual bool eof();
+    virtual size_t length();
+    virtual long int position();
+    virtual bool seek(long int offset, int origin);
+    virtual bool rewind();
+    virtual const unsigned char* getData();
+
+    static MappedFileStream* create(const char* filePath);
+
+private:
+    MappedFileStream(unsigned char* data, size_t length);
+
+private:
+    unsigned char* _data;
+    size_t _length;
+    size_t _position;
+};
+
+#endif
+
 #ifdef __ANDROID__
 
 /**
@@ -372,6 +415,13 @@ Stream* FileSystem::open(const char* path, size_t streamMode)
     std::string fullPath(__resourcePath);
     fullPath += resolvePath(path);
 
+    if ((streamMode & WRITE) == 0 && (streamMode & MAP) != 0)
+    {
+        MappedFileStream* stream = MappedFileStream::create(fullPath.c_str());
+        if (stream)
+            return stream;
+    }
+
     if ((streamMode & WRITE) != 0)
     {
         // Open a file on the SD card
@@ -404,6 +454,14 @@ Stream* FileSystem::open(const char* path, size_t streamMode)
 #else
     std::string fullPath;
     getFullPath(path, fullPath);
+#ifndef WIN32
+    if ((streamMode & WRITE) == 0 && (streamMode & MAP) != 0)
+    {
+        MappedFileStream* stream = MappedFileStream::create(fullPath.c_str());
+        if (stream)
+            return stream;
+    }
+#endif
     FileStream* stream = FileStream::create(fullPath.c_str(), modeStr);
     return stream;
 #endif
@@ -717,6 +775,169 @@ bool FileStream::rewind()
 
 ////////////////////////////////
 
+#ifndef WIN32
+
+MappedFileStream::MappedFileStream(unsigned char* data, size_t length)
+    : _data(data), _length(length), _position(0)
+{
+}
+
+MappedFileStream::~MappedFileStream()
+{
+    if (_data)
+    {
+        close();
+    }
+}
+
+MappedFileStream* MappedFileStream::create(const char* filePath)
+{
+    int fd = ::open(filePath, O_RDONLY);
+    if (fd == -1)
+        return NULL;
+
+    // Empty files cannot be mapped.
+    gp_stat_struct s;
+    if (fstat(fd, &s) != 0 || s.st_size <= 0)
+    {
+        ::close(fd);
+        return NULL;
+    }
+
+    // The mapping stays valid after the file descriptor is closed.
+    size_t length = (size_t)s.st_size;
+    void* data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+
+#ifdef MADV_WILLNEED
+    // Start reading the file ahead of the first page faults.
+    madvise(data, length, MADV_WILLNEED);
+#endif
+
+    return new MappedFileStream((unsigned char*)data, length);
+}
+
+bool MappedFileStream::canRead()
+{
+    return _data != NULL;
+}
+
+bool MappedFileStream::canWrite()
+{
+    return false;
+}
+
+bool MappedFileStream::canSeek()
+{
+    return _data != NULL;
+}
+
+void MappedFileStream::close()
+{
+    if (_data)
+        munmap(_data, _length);
+    _data = NULL;
+    _length = 0;
+    _position = 0;
+}
+
+size_t MappedFileStream::read(void* ptr, size_t size, size_t count)
+{
+    if (!_data || size == 0)
+        return 0;
+
+    // Like fread(), only whole elements are read.
+    count = std::min(count, (_length - _position) / size);
+    memcpy(ptr, _data + _position, size * count);
+    _position += size * count;
+    return count;
+}
+
+char* MappedFileStream::readLine(char* str, int num)
+{
+    if (!_data || num <= 0 || _position >= _length)
+        return NULL;
+
+    // Like fgets(), read up to num - 1 characters and stop after a newline.
+    int i = 0;
+    while (i < num - 1 && _position < _length)
+    {
+        char c = (char)_data[_position++];
+        str[i++] = c;
+        if (c == '\n')
+            break;
+    }
+    str[i] = '\0';
+    return str;
+}
+
+size_t MappedFileStream::write(const void* ptr, size_t size, size_t count)
+{
+    return 0;
+}
+
+bool MappedFileStream::eof()
+{
+    return _position >= _length;
+}
+
+size_t MappedFileStream::length()
+{
+    return _length;
+}
+
+long int MappedFileStream::position()
+{
+    if (!_data)
+        return -1;
+    return (long int)_position;
+}
+
+bool MappedFileStream::seek(long int offset, int origin)
+{
+    if (!_data)
+        return false;
+
+    long int base;
+    switch (origin)
+    {
+    case SEEK_SET:
+        base = 0;
+        break;
+    case SEEK_CUR:
+        base = (long int)_position;
+        break;
+    case SEEK_END:
+        base = (long int)_length;
+        break;
+    default:
+        return false;
+    }
+    if (base + offset < 0 || (size_t)(base + offset) > _length)
+        return false;
+    _position = (size_t)(base + offset);
+    return true;
+}
+
+bool MappedFileStream::rewind()
+{
+    if (!_data)
+        return false;
+    _position = 0;
+    return true;
+}
+
+const unsigned char* MappedFileStream::getData()
+{
+    return _data;
+}
+
+#endif
+
+////////////////////////////////
+
 #ifdef __ANDROID__
 
 FileStreamAndroid::FileStreamAndroid(AAsset* asset)
@@ -24,7 +24,14 @@ public:
     enum StreamMode
     {
         READ = 1,
-        WRITE = 2
+        WRITE = 2,
+
+        /**
+         * Memory-maps the file when it is opened for reading, on platforms that support it.
+         * The contents of a mapped stream are available through Stream::getData().
+         * Other streams are returned when the file cannot be mapped.
+         */
+        MAP = 4
     };
 
     /**
@@ -10,26 +10,91 @@
 #define FONT_VSH "res/shaders/font.vert"
 #define FONT_FSH "res/shaders/font.frag"
 
+// Number of text runs cached by each font size for drawText before the runs that were not drawn
+// recently are dropped (up to twice as many are kept). Large enough for all the text of a busy UI.
+#define FONT_TEXT_RUN_CACHE_SIZE 16384
+
+// Number of glyphs in each batch of a text run. The glyphs of a batch are indexed with unsigned
+// shorts from the first vertex of the batch (4 vertices and up to 6 indices per glyph).
+#define TEXT_RUN_BATCH_GLYPHS 8192
+
+// Number of indices in the sprite batch of a font past which it is drawn before more glyphs are
+// appended, leaving room below the unsigned short limit for the sprite batch to grow in steps.
+#define FONT_BATCH_MAX_INDICES 60000
+
 namespace gameplay
 {
 
-static std::vector<Font*> __fontCache;
+static ResourceCache __fontCache;
+
+// Returns the font cache key for the font with the specified ID in the specified bundle.
+// The font loaded without an ID (the first font in the bundle) is cached under the path alone.
+static std::string getFontCacheKey(const char* path, const char* id)
+{
+    std::string key = path;
+    if (id)
+    {
+        key += '#';
+        key += id;
+    }
+    return key;
+}
 
 static Effect* __fontEffect = NULL;
 
+// FNV-1a hash of the text and layout parameters of a text run.
+static unsigned int hashTextRun(const char* text, const Rectangle& area, unsigned int size, Font::Justify justify, bool wrap, bool rightToLeft)
+{
+    unsigned int hash = 2166136261u;
+    for (const char* c = text; *c; ++c)
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+
+    unsigned int bits[4];
+    memcpy(bits, &area.x, sizeof(float));
+    memcpy(bits + 1, &area.y, sizeof(float));
+    memcpy(bits + 2, &area.width, sizeof(float));
+    memcpy(bits + 3, &area.height, sizeof(float));
+    for (unsigned int i = 0; i < 4; ++i)
+        hash = (hash ^ bits[i]) * 16777619u;
+
+    hash = (hash ^ size) * 16777619u;
+    hash = (hash ^ (unsigned int)justify) * 16777619u;
+    hash = (hash ^ ((wrap ? 1u : 0u) | (rightToLeft ? 2u : 0u))) * 16777619u;
+    return hash;
+}
+
+// Draws the glyphs appended to a sprite batch so far if the given number of indices (and those
+// joining them to the previous glyphs) would take it past FONT_BATCH_MAX_INDICES.
+static void reserveFontBatch(SpriteBatch* batch, unsigned int indexCount)
+{
+    if (batch->getIndexCount() + indexCount + 2 > FONT_BATCH_MAX_INDICES)
+    {
+        batch->finish();
+        batch->start();
+    }
+}
+
+// Appends a glyph vertex to a text run (colors are filled in when the run is drawn).
+static void addTextRunVertex(std::vector<SpriteBatch::SpriteVertex>* vertices, float x, float y, float u, float v)
+{
+    SpriteBatch::SpriteVertex vertex = { x, y, 0, u, v, 0, 0, 0, 0 };
+    vertices->push_back(vertex);
+}
+
 Font::Font() :
-    _format(BITMAP), _style(PLAIN), _size(0), _spacing(0.0f), _glyphs(NULL), _glyphCount(0), _texture(NULL), _batch(NULL), _cutoffParam(NULL)
+    _format(BITMAP), _style(PLAIN), _size(0), _spacing(0.0f), _glyphs(NULL), _glyphCount(0), _texture(NULL), _batch(NULL), _cutoffParam(NULL), _cacheKey(NULL)
 {
 }
 
 Font::~Font()
 {
     // Remove this Font from the font cache.
-    std::vector<Font*>::iterator itr = std::find(__fontCache.begin(), __fontCache.end(), this);
-    if (itr != __fontCache.end())
-    {
-        __fontCache.erase(itr);
-    }
+    __fontCache.remove(_cacheKey, this);
+
+    for (std::unordered_map<unsigned int, TextRun*>::iterator itr = _textRuns.begin(); itr != _textRuns.end(); ++itr)
+        SAFE_DELETE(itr->second);
+    for (std::unordered_map<unsigned int, TextRun*>::iterator itr = _oldTextRuns.begin(); itr != _oldTextRuns.end(); ++itr)
+        SAFE_DELETE(itr->second);
 
     SAFE_DELETE(_batch);
     SAFE_DELETE_ARRAY(_glyphs);
@@ -47,16 +112,19 @@ Font* Font::create(const char* path, const char* id)
     GP_ASSERT(path);
 
     // Search the font cache for a font with the given path and ID.
-    for (size_t i = 0, count = __fontCache.size(); i < count; ++i)
+    // The first font in the bundle may have been cached without its ID.
+    Font* f = static_cast<Font*>(__fontCache.find(getFontCacheKey(path, id).c_str()));
+    if (f == NULL && id)
     {
-        Font* f = __fontCache[i];
-        GP_ASSERT(f);
-        if (f->_path == path && (id == NULL || f->_id == id))
-        {
-            // Found a match.
-            f->addRef();
-            return f;
-        }
+        f = static_cast<Font*>(__fontCache.find(path));
+        if (f && f->_id != id)
+            f = NULL;
+    }
+    if (f)
+    {
+        // Found a match.
+        f->addRef();
+        return f;
     }
 
     // Load the bundle.
@@ -78,6 +146,15 @@ Font* Font::create(const char* path, const char* id)
             return NULL;
         }
 
+        // The first font may have been cached under its ID.
+        f = static_cast<Font*>(__fontCache.find(getFontCacheKey(path, id).c_str()));
+        if (f)
+        {
+            f->addRef();
+            SAFE_RELEASE(bundle);
+            return f;
+        }
+
         // Load the font using the ID of the first object in the bundle.
         font = bundle->loadFont(bundle->getObjectId(0));
     }
@@ -90,7 +167,7 @@ Font* Font::create(const char* path, const char* id)
     if (font)
     {
         // Add this font to the cache.
-        __fontCache.push_back(font);
+        font->_cacheKey = __fontCache.add(getFontCacheKey(path, id).c_str(), font);
     }
 
     SAFE_RELEASE(bundle);
@@ -102,46 +179,50 @@ Font* Font::create(const char* family, Style style, unsigned int size, Glyph* gl
 {
     GP_ASSERT(family);
     GP_ASSERT(glyphs);
-    GP_ASSERT(texture);
 
-    // Create the effect for the font's sprite batch.
-    if (__fontEffect == NULL)
+    // Fonts without a texture only lay out text, and have no batch to draw it with.
+    SpriteBatch* batch = NULL;
+    if (texture)
     {
-        const char* defines = NULL;
-        if (format == DISTANCE_FIELD)
-            defines = "DISTANCE_FIELD";
-        __fontEffect = Effect::createFromFile(FONT_VSH, FONT_FSH, defines);
+        // Create the effect for the font's sprite batch.
         if (__fontEffect == NULL)
         {
-            GP_WARN("Failed to create effect for font.");
-            SAFE_RELEASE(texture);
-            return NULL;
+            const char* defines = NULL;
+            if (format == DISTANCE_FIELD)
+                defines = "DISTANCE_FIELD";
+            __fontEffect = Effect::createFromFile(FONT_VSH, FONT_FSH, defines);
+            if (__fontEffect == NULL)
+            {
+                GP_WARN("Failed to create effect for font.");
+                SAFE_RELEASE(texture);
+                return NULL;
+            }
+        }
+        else
+        {
+            __fontEffect->addRef();
         }
-    }
-    else
-    {
-        __fontEffect->addRef();
-    }
 
-    // Create batch for the font.
-    SpriteBatch* batch = SpriteBatch::create(texture, __fontEffect, 128);
+        // Create batch for the font.
+        batch = SpriteBatch::create(texture, __fontEffect, 128);
 
-    // Release __fontEffect since the SpriteBatch keeps a reference to it
-    SAFE_RELEASE(__fontEffect);
+        // Release __fontEffect since the SpriteBatch keeps a reference to it
+        SAFE_RELEASE(__fontEffect);
 
-    if (batch == NULL)
-    {
-        GP_WARN("Failed to create batch for font.");
-        return NULL;
-    }
+        if (batch == NULL)
+        {
+            GP_WARN("Failed to create batch for font.");
+            return NULL;
+        }
 
-    // Add linear filtering for better font quality.
-    Texture::Sampler* sampler = batch->getSampler();
-    sampler->setFilterMode(Texture::LINEAR_MIPMAP_LINEAR, Texture::LINEAR);
-    sampler->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+        // Add linear filtering for better font quality.
+        Texture::Sampler* sampler = batch->getSampler();
+        sampler->setFilterMode(Texture::LINEAR_MIPMAP_LINEAR, Texture::LINEAR);
+        sampler->setWrapMode(Texture::CLAMP, Texture::CLAMP);
 
-    // Increase the ref count of the texture to retain it.
-    texture->addRef();
+        // Increase the ref count of the texture to retain it.
+        texture->addRef();
+    }
 
     Font* font = new Font();
     font->_format = format;
@@ -210,13 +291,13 @@ void Font::lazyStart()
 void Font::finish()
 {
     // Finish any font batches that have been started
-    if (_batch->isStarted())
+    if (_batch && _batch->isStarted())
         _batch->finish();
 
     for (size_t i = 0, count = _sizes.size(); i < count; ++i)
     {
         SpriteBatch* batch = _sizes[i]->_batch;
-        if (batch->isStarted())
+        if (batch && batch->isStarted())
             batch->finish();
     }
 }
@@ -412,7 +493,147 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
         }
     }
 
-    lazyStart();
+    // The same text is usually drawn in the same place every frame, so reuse its layout.
+    drawText(findTextRun(text, area, size, justify, wrap, rightToLeft), color, clip);
+}
+
+bool Font::layoutText(TextRun* run, const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft)
+{
+    GP_ASSERT(run);
+    GP_ASSERT(text);
+    GP_ASSERT(_size);
+
+    Font* f = this;
+    if (size == 0)
+        size = _size;
+    else
+        f = findClosestSize(size);
+
+    if (run->_font == f && run->_size == size && run->_area == area && run->_justify == justify &&
+        run->_wrap == wrap && run->_rightToLeft == rightToLeft && run->_spacing == f->_spacing && run->_text == text)
+    {
+        return false;
+    }
+
+    f->buildTextRun(run, text, area, size, justify, wrap, rightToLeft);
+    return true;
+}
+
+void Font::drawText(TextRun* run, const Vector4& color, const Rectangle& clip)
+{
+    GP_ASSERT(run);
+
+    if (run->_vertices.empty())
+        return;
+
+    Font* f = run->_font;
+    GP_ASSERT(f);
+    GP_ASSERT(f->_batch);
+    f->lazyStart();
+
+    if (f->getFormat() == DISTANCE_FIELD)
+    {
+        if (f->_cutoffParam == NULL)
+            f->_cutoffParam = f->_batch->getMaterial()->getParameter("u_cutoff");
+        // TODO: Fix me so that smaller font are much smoother
+        f->_cutoffParam->setVector2(Vector2(1.0, 1.0));
+    }
+
+    // Vertex colors only need to be rewritten when the color changes.
+    if (color != run->_color)
+    {
+        for (size_t i = 0, count = run->_vertices.size(); i < count; ++i)
+        {
+            SpriteBatch::SpriteVertex& v = run->_vertices[i];
+            v.r = color.x;
+            v.g = color.y;
+            v.b = color.z;
+            v.a = color.w;
+        }
+        run->_color = color;
+    }
+
+    if (clip == Rectangle(0, 0, 0, 0) || clip.contains(run->_bounds))
+    {
+        // Nothing to clip, so append the glyphs a batch at a time.
+        const unsigned int glyphCount = run->getGlyphCount();
+        unsigned int indexStart = 0;
+        for (unsigned int glyphStart = 0; glyphStart < glyphCount; glyphStart += TEXT_RUN_BATCH_GLYPHS)
+        {
+            const unsigned int vertexCount = std::min(glyphCount - glyphStart, (unsigned int)TEXT_RUN_BATCH_GLYPHS) * 4;
+            const unsigned int indexCount = vertexCount / 4 * 6 - 2;
+            reserveFontBatch(f->_batch, indexCount);
+            f->_batch->draw(&run->_vertices[glyphStart * 4], vertexCount, &run->_indices[indexStart], indexCount);
+            indexStart += indexCount;
+        }
+    }
+    else
+    {
+        // Clip each glyph as SpriteBatch::draw does.
+        for (size_t i = 0, count = run->_vertices.size(); i < count; i += 4)
+        {
+            const SpriteBatch::SpriteVertex& v1 = run->_vertices[i];
+            const SpriteBatch::SpriteVertex& v2 = run->_vertices[i + 3];
+            reserveFontBatch(f->_batch, 4);
+            f->_batch->draw(v1.x, v1.y, v2.x - v1.x, v2.y - v1.y, v1.u, v1.v, v2.u, v2.v, color, clip);
+        }
+    }
+}
+
+Font::TextRun* Font::findTextRun(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft)
+{
+    unsigned int hash = hashTextRun(text, area, size, justify, wrap, rightToLeft);
+
+    std::unordered_map<unsigned int, TextRun*>::iterator itr = _textRuns.find(hash);
+    if (itr == _textRuns.end())
+    {
+        // Runs still in use are moved over from the previous generation of the cache.
+        TextRun* run = NULL;
+        std::unordered_map<unsigned int, TextRun*>::iterator oldItr = _oldTextRuns.find(hash);
+        if (oldItr != _oldTextRuns.end())
+        {
+            run = oldItr->second;
+            _oldTextRuns.erase(oldItr);
+        }
+        else
+        {
+            run = new TextRun();
+        }
+
+        // When the cache fills up, drop the runs that were not drawn since it last filled up.
+        if (_textRuns.size() >= FONT_TEXT_RUN_CACHE_SIZE)
+        {
+            for (itr = _oldTextRuns.begin(); itr != _oldTextRuns.end(); ++itr)
+                SAFE_DELETE(itr->second);
+            _oldTextRuns.clear();
+            _oldTextRuns.swap(_textRuns);
+        }
+
+        itr = _textRuns.insert(std::make_pair(hash, run)).first;
+    }
+
+    // Verifies the run matches (hashes may collide), and lays it out again if not.
+    layoutText(itr->second, text, area, size, justify, wrap, rightToLeft);
+    return itr->second;
+}
+
+void Font::buildTextRun(TextRun* run, const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft)
+{
+    GP_ASSERT(run);
+    GP_ASSERT(text);
+
+    run->_font = this;
+    run->_text = text;
+    run->_area = area;
+    run->_size = size;
+    run->_justify = justify;
+    run->_wrap = wrap;
+    run->_rightToLeft = rightToLeft;
+    run->_spacing = _spacing;
+    run->_vertices.clear();
+    run->_indices.clear();
+    run->_color = Vector4::zero();
+    run->_bounds = Rectangle();
 
     float scale = (float)size / _size;
     int spacing = (int)(size * _spacing);
@@ -423,6 +644,8 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
 
     getMeasurementInfo(text, area, size, justify, wrap, rightToLeft, &xPositions, &yPos, &lineLengths);
 
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+
     // Now we have the info we need in order to render.
     int xPos = area.x;
     std::vector<int>::const_iterator xPositionsIt = xPositions.begin();
@@ -504,7 +727,6 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
         }
 
         GP_ASSERT(_glyphs);
-        GP_ASSERT(_batch);
         for (int i = startIndex; i < (int)tokenLength && i >= 0; i += iteration)
         {
             char c = token[i];
@@ -522,24 +744,34 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
                 }
                 else if (xPos >= (int)area.x)
                 {
-                    // Draw this character.
+                    // Add a quad for this character.
                     if (draw)
                     {
-                        if (getFormat() == DISTANCE_FIELD)
+                        const float x1 = xPos + (int)(g.bearingX * scale);
+                        const float y1 = yPos;
+                        const float x2 = x1 + g.width * scale;
+                        const float y2 = y1 + size;
+
+                        // Glyphs are indexed from the first vertex of their batch.
+                        unsigned short index = (unsigned short)(run->_vertices.size() % (TEXT_RUN_BATCH_GLYPHS * 4));
+                        if (index > 0)
                         {
-                            if (_cutoffParam == NULL)
-                                _cutoffParam = _batch->getMaterial()->getParameter("u_cutoff");
-                            // TODO: Fix me so that smaller font are much smoother
-                            _cutoffParam->setVector2(Vector2(1.0, 1.0));
-                        }
-                        if (clip != Rectangle(0, 0, 0, 0))
-                        {
-                            _batch->draw(xPos + (int)(g.bearingX * scale), yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color, clip);
-                        }
-                        else
-                        {
-                            _batch->draw(xPos + (int)(g.bearingX * scale), yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color);
+                            // Join to the previous glyph of the batch with a degenerate triangle, as MeshBatch does for strips.
+                            run->_indices.push_back(index - 1);
+                            run->_indices.push_back(index);
                         }
+                        for (unsigned short j = 0; j < 4; ++j)
+                            run->_indices.push_back(index + j);
+
+                        addTextRunVertex(&run->_vertices, x1, y1, g.uvs[0], g.uvs[1]);
+                        addTextRunVertex(&run->_vertices, x1, y2, g.uvs[0], g.uvs[3]);
+                        addTextRunVertex(&run->_vertices, x2, y1, g.uvs[2], g.uvs[1]);
+                        addTextRunVertex(&run->_vertices, x2, y2, g.uvs[2], g.uvs[3]);
+
+                        minX = std::min(minX, x1);
+                        minY = std::min(minY, y1);
+                        maxX = std::max(maxX, x2);
+                        maxY = std::max(maxY, y2);
                     }
                 }
                 xPos += (int)(g.advance)*scale + spacing;
@@ -608,6 +840,9 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
             }
         }
     }
+
+    if (!run->_vertices.empty())
+        run->_bounds.set(minX, minY, maxX - minX, maxY - minY);
 }
 
 void Font::measureText(const char* text, unsigned int size, unsigned int* width, unsigned int* height)
@@ -1634,6 +1869,21 @@ void Font::addLineInfo(const Rectangle& area, int lineWidth, int lineLength, Jus
     }
 }
 
+Font::TextRun::TextRun()
+    : _font(NULL), _size(0), _justify(ALIGN_TOP_LEFT), _wrap(true), _rightToLeft(false), _spacing(0.0f)
+{
+}
+
+unsigned int Font::TextRun::getGlyphCount() const
+{
+    return (unsigned int)_vertices.size() / 4;
+}
+
+const Rectangle& Font::TextRun::getBounds() const
+{
+    return _bounds;
+}
+
 SpriteBatch* Font::getSpriteBatch(unsigned int size) const
 {
     if (size == 0)
@@ -2,6 +2,7 @@
 #define FONT_H_
 
 #include "SpriteBatch.h"
+#include "ResourceCache.h"
 
 namespace gameplay
 {
@@ -59,6 +60,93 @@ public:
         DISTANCE_FIELD = 1
     };
 
+    /**
+     * Defines a font glyph within the texture map for a font.
+     *
+     * @script{ignore}
+     */
+    class Glyph
+    {
+    public:
+        /**
+         * Glyph character code (decimal value).
+         */
+        unsigned int code;
+
+        /**
+         * Glyph width (in pixels).
+         */
+        unsigned int width;
+
+        /**
+         * Glyph left side bearing (in pixels).
+         */
+        int bearingX;
+
+        /**
+         * Glyph horizontal advance (in pixels).
+         */
+        unsigned int advance;
+
+        /**
+         * Glyph texture coordinates.
+         */
+        float uvs[4];
+    };
+
+    /**
+     * Defines a run of text laid out by a font, ready to be drawn.
+     *
+     * A text run stores the glyph quads of a string laid out within an area, in the form
+     * they are appended to the sprite batch of the font. Runs are laid out with Font::layoutText
+     * and drawn with Font::drawText(TextRun*, const Vector4&, const Rectangle&).
+     *
+     * Font::drawText also keeps a cache of the runs it lays out, so drawing the same text in
+     * the same area every frame does not lay it out again.
+     *
+     * @script{ignore}
+     */
+    class TextRun
+    {
+        friend class Font;
+
+    public:
+
+        /**
+         * Constructor.
+         */
+        TextRun();
+
+        /**
+         * Gets the number of glyphs in the run.
+         *
+         * @return The number of glyph quads drawn for the run.
+         */
+        unsigned int getGlyphCount() const;
+
+        /**
+         * Gets the bounds of the glyph quads in the run.
+         *
+         * @return The bounds of the laid out text.
+         */
+        const Rectangle& getBounds() const;
+
+    private:
+
+        Font* _font;
+        std::string _text;
+        Rectangle _area;
+        unsigned int _size;
+        Justify _justify;
+        bool _wrap;
+        bool _rightToLeft;
+        float _spacing;
+        std::vector<SpriteBatch::SpriteVertex> _vertices;
+        std::vector<unsigned short> _indices;
+        Vector4 _color;
+        Rectangle _bounds;
+    };
+
     /**
      * Creates a font from the given bundle.
      *
@@ -77,6 +165,28 @@ public:
      */
     static Font* create(const char* path, const char* id = NULL);
 
+    /**
+     * Creates a font with the given characteristics from the specified glyph array and texture map.
+     *
+     * This method will create a new Font object regardless of whether another Font is already
+     * created with the same attributes.
+     *
+     * If no texture map is given, the font can measure and lay out text but not draw it, which
+     * needs no graphics context.
+     *
+     * @param family The font family name.
+     * @param style The font style.
+     * @param size The font size.
+     * @param glyphs An array of font glyphs, defining each character in the font within the texture map.
+     * @param glyphCount The number of items in the glyph array.
+     * @param texture A texture map containing rendered glyphs, or NULL to only lay out text.
+     * @param format The format of the font (bitmap or distance fields)
+     *
+     * @return The new Font or NULL if there was an error.
+     * @script{ignore}
+     */
+    static Font* create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Font::Format format);
+
     /**
      * Gets the font size (max height of glyphs) in pixels, at the specified index.
      *
@@ -157,6 +267,41 @@ public:
                   Justify justify = ALIGN_TOP_LEFT, bool wrap = true, bool rightToLeft = false,
                   const Rectangle& clip = Rectangle(0, 0, 0, 0));
 
+    /**
+     * Lays out text within an area as a text run, which can be drawn any number of times with
+     * drawText(TextRun*, const Vector4&, const Rectangle&).
+     *
+     * The glyph quads of the run are only rebuilt if the text, size, area, justification,
+     * wrapping or direction differ from when the run was last laid out. Text that stays the
+     * same from frame to frame is therefore laid out only once.
+     *
+     * @param run The text run to lay out.
+     * @param text The text to lay out.
+     * @param area The viewport area to lay out the text within.
+     * @param size The size to lay out text at (0 for default size).
+     * @param justify Justification of text within the viewport.
+     * @param wrap Wraps text to fit within the width of the viewport if true.
+     * @param rightToLeft Whether to lay out text from right to left.
+     *
+     * @return True if the glyph quads of the run were rebuilt, false if the run was up to date.
+     * @script{ignore}
+     */
+    bool layoutText(TextRun* run, const char* text, const Rectangle& area, unsigned int size = 0,
+                    Justify justify = ALIGN_TOP_LEFT, bool wrap = true, bool rightToLeft = false);
+
+    /**
+     * Draws a text run that was laid out with layoutText.
+     *
+     * The glyph quads of the run are appended to the sprite batch of the font size the run
+     * was laid out with, which must not have been released since.
+     *
+     * @param run The text run to draw.
+     * @param color The color of text.
+     * @param clip A region to clip text within.
+     * @script{ignore}
+     */
+    void drawText(TextRun* run, const Vector4& color, const Rectangle& clip = Rectangle(0, 0, 0, 0));
+
     /**
      * Finishes text batching for this font and renders all drawn text.
      */
@@ -242,38 +387,6 @@ public:
 
 private:
 
-    /**
-     * Defines a font glyph within the texture map for a font.
-     */
-    class Glyph
-    {
-    public:
-        /**
-         * Glyph character code (decimal value).
-         */
-        unsigned int code;
-
-        /**
-         * Glyph width (in pixels).
-         */
-        unsigned int width;
-
-        /**
-         * Glyph left side bearing (in pixels).
-         */
-        int bearingX;
-
-        /**
-         * Glyph horizontal advance (in pixels).
-         */
-        unsigned int advance;
-
-        /**
-         * Glyph texture coordinates.
-         */
-        float uvs[4];
-    };
-
     /**
      * Constructor.
      */
@@ -294,24 +407,6 @@ private:
      */
     Font& operator=(const Font&);
 
-    /**
-     * Creates a font with the given characteristics from the specified glyph array and texture map.
-     *
-     * This method will create a new Font object regardless of whether another Font is already
-     * created with the same attributes.
-     *
-     * @param family The font family name.
-     * @param style The font style.
-     * @param size The font size.
-     * @param glyphs An array of font glyphs, defining each character in the font within the texture map.
-     * @param glyphCount The number of items in the glyph array.
-     * @param texture A texture map containing rendered glyphs.
-     * @param format The format of the font (bitmap or distance fields)
-     *
-     * @return The new Font or NULL if there was an error.
-     */
-    static Font* create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Font::Format format);
-
     void getMeasurementInfo(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
                             std::vector<int>* xPositions, int* yPosition, std::vector<unsigned int>* lineLengths);
 
@@ -333,6 +428,10 @@ private:
 
     void lazyStart();
 
+    void buildTextRun(TextRun* run, const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft);
+
+    TextRun* findTextRun(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft);
+
     Format _format;
     std::string _path;
     std::string _id;
@@ -347,6 +446,9 @@ private:
     SpriteBatch* _batch;
     Rectangle _viewport;
     MaterialParameter* _cutoffParam;
+    ResourceCache::Key _cacheKey;
+    std::unordered_map<unsigned int, TextRun*> _textRuns;    // Runs drawn by drawText, keyed by a hash of their layout parameters
+    std::unordered_map<unsigned int, TextRun*> _oldTextRuns; // Runs drawn before the cache last filled up, dropped when it fills up again
 };
 
 }
@@ -42,7 +42,7 @@ struct FormInit
 };
 static FormInit __init;
 
-Form::Form() : Drawable(), _batched(true)
+Form::Form() : Drawable(), _batched(true), _redrawnControlCount(0), _cachedControlCount(0)
 {
 }
 
@@ -261,8 +261,10 @@ unsigned int Form::draw(bool wireframe)
         Matrix::createOrthographicOffCenter(0, viewport.width, viewport.height, 0, 0, 1, &_projectionMatrix);
     }
 
-    // Draw the form
-    unsigned int drawCalls = Container::draw(this, _absoluteClipBounds);
+    // Draw the form, rebuilding only the controls that changed since the last frame
+    _redrawnControlCount = 0;
+    _cachedControlCount = 0;
+    unsigned int drawCalls = drawRetained(this, _absoluteClipBounds);
 
     // Flush all batches that were queued during drawing and then empty the batch list
     if (_batched)
@@ -292,6 +294,16 @@ void Form::setBatchingEnabled(bool enabled)
     _batched = enabled;
 }
 
+unsigned int Form::getRedrawnControlCount() const
+{
+    return _redrawnControlCount;
+}
+
+unsigned int Form::getCachedControlCount() const
+{
+    return _cachedControlCount;
+}
+
 void Form::updateInternal(float elapsedTime)
 {
     pollGamepads();
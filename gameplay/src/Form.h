@@ -136,10 +136,34 @@ public:
      * batching may cause some visual artifacts due alpha blending issues. In these cases,
      * turning batching off usually fixes the issue at a slight performance cost.
      *
+     * While batching is enabled, the geometry drawn by each control and its children is also
+     * cached and drawn again on later frames without being rebuilt, until the control (or one
+     * of its children) is marked dirty. With batching disabled, every control is redrawn each frame.
+     *
      * @param enabled True to enable batching (default), false otherwise.
      */
     void setBatchingEnabled(bool enabled);
 
+    /**
+     * Gets the number of controls whose geometry was rebuilt during the last call to draw.
+     *
+     * Controls that did not change since the previous frame (along with all of their children)
+     * draw their cached geometry instead, which is counted by getCachedControlCount.
+     *
+     * @return The number of controls redrawn in the last frame.
+     */
+    unsigned int getRedrawnControlCount() const;
+
+    /**
+     * Gets the number of controls that drew their cached geometry during the last call to draw.
+     *
+     * A cached container also draws the cached geometry of all of its children, which are not
+     * counted separately.
+     *
+     * @return The number of cached controls drawn in the last frame.
+     */
+    unsigned int getCachedControlCount() const;
+
 private:
     
     /**
@@ -279,6 +303,9 @@ private:
     Matrix _projectionMatrix;           // Projection matrix to be set on SpriteBatch objects when rendering the form
     std::vector<SpriteBatch*> _batches;
     bool _batched;
+    std::vector<std::pair<unsigned int, unsigned int> > _batchMarks; // Vertex and index counts of open batches when each control being drawn started
+    unsigned int _redrawnControlCount;
+    unsigned int _cachedControlCount;
 };
 
 }
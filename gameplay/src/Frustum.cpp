@@ -2,6 +2,7 @@
 #include "Frustum.h"
 #include "BoundingSphere.h"
 #include "BoundingBox.h"
+#include "MathUtil.h"
 
 namespace gameplay
 {
@@ -115,6 +116,25 @@ bool Frustum::intersects(const BoundingSphere& sphere) const
     return sphere.intersects(*this);
 }
 
+unsigned int Frustum::intersects(const BoundingSphere* spheres, unsigned int count, bool* results) const
+{
+    GP_ASSERT(spheres && results);
+
+    const Plane* planes[6] = { &_near, &_far, &_bottom, &_top, &_left, &_right };
+    float p[24];
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        const Vector3& normal = planes[i]->getNormal();
+        p[i * 4] = normal.x;
+        p[i * 4 + 1] = normal.y;
+        p[i * 4 + 2] = normal.z;
+        p[i * 4 + 3] = planes[i]->getDistance();
+    }
+
+    // BoundingSphere is laid out as its center followed by its radius.
+    return MathUtil::intersectSphereArray(p, &spheres->center.x, results, count);
+}
+
 bool Frustum::intersects(const BoundingBox& box) const
 {
     return box.intersects(*this);
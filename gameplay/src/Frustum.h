@@ -162,6 +162,21 @@ public:
      */
     bool intersects(const BoundingSphere& sphere) const;
 
+    /**
+     * Tests whether this frustum intersects each of the specified bounding spheres.
+     *
+     * This is faster than testing the spheres one at a time.
+     *
+     * @param spheres The array of bounding spheres to test intersection with.
+     * @param count The number of bounding spheres in the array.
+     * @param results An array of count values set to whether the bounding sphere at
+     *  the same index intersects this frustum.
+     *
+     * @return The number of bounding spheres that intersect this frustum.
+     * @script{ignore}
+     */
+    unsigned int intersects(const BoundingSphere* spheres, unsigned int count, bool* results) const;
+
     /**
      * Tests whether this frustum intersects the specified bounding box.
      *
@@ -65,7 +65,7 @@ Game::Game()
       _clearDepth(1.0f), _clearStencil(0), _properties(NULL),
       _animationController(NULL), _audioController(NULL),
       _physicsController(NULL), _aiController(NULL), _audioListener(NULL),
-      _timeEvents(NULL), _scriptController(NULL), _scriptTarget(NULL)
+      _timeEvents(NULL), _scriptController(NULL), _scriptTarget(NULL), _jobSystem(NULL)
 {
     GP_ASSERT(__gameInstance == NULL);
 
@@ -164,6 +164,21 @@ bool Game::startup()
     RenderState::initialize();
     FrameBuffer::initialize();
 
+    // Start the job system first so that other subsystems can submit work to it.
+    // By default there is one worker thread per additional hardware thread.
+    unsigned int workerCount = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+    bool singleThreaded = false;
+    Properties* jobsConfig = _properties ? _properties->getNamespace("jobs", true) : NULL;
+    if (jobsConfig)
+    {
+        if (jobsConfig->exists("workers"))
+            workerCount = (unsigned int)std::max(jobsConfig->getInt("workers"), 0);
+        singleThreaded = jobsConfig->getBool("singleThreaded");
+    }
+    _jobSystem = new JobSystem();
+    _jobSystem->initialize(workerCount);
+    _jobSystem->setSingleThreaded(singleThreaded);
+
     _animationController = new AnimationController();
     _animationController->initialize();
 
@@ -236,9 +251,14 @@ void Game::shutdown()
         GP_ASSERT(_audioController);
         GP_ASSERT(_physicsController);
         GP_ASSERT(_aiController);
+        GP_ASSERT(_jobSystem);
 
         Platform::signalShutdown();
 
+        // Finish the background jobs and cancel the jobs posted to the main thread while the game
+        // is still intact, since they would otherwise run after it is finalized.
+        _jobSystem->finalize();
+
 		// Call user finalize
         finalize();
 
@@ -269,6 +289,8 @@ void Game::shutdown()
         SAFE_DELETE(_physicsController);
         _aiController->finalize();
         SAFE_DELETE(_aiController);
+
+        SAFE_DELETE(_jobSystem);
         
         ControlFactory::finalize();
 
@@ -371,6 +393,13 @@ void Game::frame()
 	static double lastFrameTime = Game::getGameTime();
 	double frameTime = getGameTime();
 
+    // Start counting the uniform uploads of the new frame
+    Effect::resetStatistics();
+
+    // Run the work posted to the main thread by jobs
+    GP_ASSERT(_jobSystem);
+    _jobSystem->executePosted();
+
     // Fire time events to scheduled TimeListeners
     fireTimeEvents(frameTime);
 
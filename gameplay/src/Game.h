@@ -14,6 +14,7 @@
 #include "Rectangle.h"
 #include "Vector4.h"
 #include "TimeListener.h"
+#include "JobSystem.h"
 
 namespace gameplay
 {
@@ -261,6 +262,14 @@ public:
      */
     inline AIController* getAIController() const;
 
+    /**
+     * Gets the job system for running work across multiple threads.
+     *
+     * @return The job system for this game.
+     * @script{ignore}
+     */
+    inline JobSystem* getJobSystem() const;
+
     /**
      * Gets the script controller for managing control of Lua scripts
      * associated with the game.
@@ -766,6 +775,7 @@ private:
     std::priority_queue<TimeEvent, std::vector<TimeEvent>, std::less<TimeEvent> >* _timeEvents;     // Contains the scheduled time events.
     ScriptController* _scriptController;            // Controls the scripting engine.
     ScriptTarget* _scriptTarget;                // Script target for the game
+    JobSystem* _jobSystem;                      // Runs jobs across worker threads.
 
     // Note: Do not add STL object member variables on the stack; this will cause false memory leaks to be reported.
 
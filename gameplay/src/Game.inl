@@ -58,6 +58,12 @@ inline ScriptController* Game::getScriptController() const
 {
     return _scriptController;
 }
+
+inline JobSystem* Game::getJobSystem() const
+{
+    return _jobSystem;
+}
+
 inline AIController* Game::getAIController() const
 {
     return _aiController;
@@ -103,9 +103,21 @@ HeightField* HeightField::create(const char* path, unsigned int width, unsigned
             return NULL;
         }
 
-        // Load raw bytes
+        // Map the raw bytes, or read them if the file cannot be mapped
+        Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAP);
+        const unsigned char* bytes = stream ? stream->getData() : NULL;
+        unsigned char* buffer = NULL;
         int fileSize = 0;
-        unsigned char* bytes = (unsigned char*)FileSystem::readAll(path, &fileSize);
+        if (bytes)
+        {
+            fileSize = (int)stream->length();
+        }
+        else
+        {
+            SAFE_DELETE(stream);
+            buffer = (unsigned char*)FileSystem::readAll(path, &fileSize);
+            bytes = buffer;
+        }
         if (bytes == NULL)
         {
             GP_WARN("Falied to read bytes from RAW heightfield image: %s.", path);
@@ -117,7 +129,8 @@ HeightField* HeightField::create(const char* path, unsigned int width, unsigned
         if (bits != 8 && bits != 16)
         {
             GP_WARN("Invalid RAW file - must be 8-bit or 16-bit, but found neither: %s.", path);
-            SAFE_DELETE_ARRAY(bytes);
+            SAFE_DELETE_ARRAY(buffer);
+            SAFE_DELETE(stream);
             return NULL;
         }
 
@@ -149,7 +162,8 @@ HeightField* HeightField::create(const char* path, unsigned int width, unsigned
             }
         }
 
-        SAFE_DELETE_ARRAY(bytes);
+        SAFE_DELETE_ARRAY(buffer);
+        SAFE_DELETE(stream);
     }
     else
     {
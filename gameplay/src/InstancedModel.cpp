@@ -0,0 +1,354 @@
+#include "Base.h"
+#include "InstancedModel.h"
+#include "MeshPart.h"
+#include "Technique.h"
+#include "Pass.h"
+#include "Node.h"
+
+// Number of floats of an instance in the instance buffer (matrix and color)
+#define INSTANCE_SIZE       20
+
+namespace gameplay
+{
+
+static const VertexFormat::Element __instanceElements[] =
+{
+    VertexFormat::Element(VertexFormat::INSTANCE_MATRIX, 16),
+    VertexFormat::Element(VertexFormat::INSTANCE_COLOR, 4)
+};
+
+InstancedModel::InstancedModel(Mesh* mesh) : Drawable(),
+    _mesh(mesh), _material(NULL), _instanceFormat(__instanceElements, 2), _instanceBuffer(0), _instanceCapacity(0), _dirty(false), _boundsDirty(false)
+{
+    GP_ASSERT(mesh);
+}
+
+InstancedModel::~InstancedModel()
+{
+    setMaterial((Material*)NULL);
+    SAFE_RELEASE(_mesh);
+
+    if (_instanceBuffer)
+    {
+        GL_ASSERT( glDeleteBuffers(1, &_instanceBuffer) );
+        _instanceBuffer = 0;
+    }
+}
+
+InstancedModel* InstancedModel::create(Mesh* mesh)
+{
+    GP_ASSERT(mesh);
+
+    GLuint vbo;
+    GL_ASSERT( glGenBuffers(1, &vbo) );
+
+    mesh->addRef();
+    InstancedModel* model = new InstancedModel(mesh);
+    model->_instanceBuffer = vbo;
+    return model;
+}
+
+Mesh* InstancedModel::getMesh() const
+{
+    return _mesh;
+}
+
+Material* InstancedModel::getMaterial() const
+{
+    return _material;
+}
+
+void InstancedModel::setMaterial(Material* material)
+{
+    if (material == _material)
+        return;
+
+    // Release the old material and its bindings.
+    if (_material)
+    {
+        for (unsigned int i = 0, tCount = _material->getTechniqueCount(); i < tCount; ++i)
+        {
+            Technique* t = _material->getTechniqueByIndex(i);
+            GP_ASSERT(t);
+            for (unsigned int j = 0, pCount = t->getPassCount(); j < pCount; ++j)
+            {
+                GP_ASSERT(t->getPassByIndex(j));
+                t->getPassByIndex(j)->setVertexAttributeBinding(NULL);
+            }
+        }
+        SAFE_RELEASE(_material);
+    }
+
+    if (material)
+    {
+        _material = material;
+        _material->addRef();
+
+        // Bind the mesh and instance buffers to every pass of the new material.
+        for (unsigned int i = 0, tCount = material->getTechniqueCount(); i < tCount; ++i)
+        {
+            Technique* t = material->getTechniqueByIndex(i);
+            GP_ASSERT(t);
+            for (unsigned int j = 0, pCount = t->getPassCount(); j < pCount; ++j)
+            {
+                Pass* p = t->getPassByIndex(j);
+                GP_ASSERT(p);
+                VertexAttributeBinding* b = VertexAttributeBinding::create(_mesh, p->getEffect(), _instanceFormat, _instanceBuffer);
+                p->setVertexAttributeBinding(b);
+                SAFE_RELEASE(b);
+            }
+        }
+        if (_node)
+        {
+            material->setNodeBinding(_node);
+        }
+    }
+}
+
+Material* InstancedModel::setMaterial(const char* materialPath)
+{
+    Material* material = Material::create(materialPath);
+    if (material == NULL)
+    {
+        GP_ERROR("Failed to create material for instanced model.");
+        return NULL;
+    }
+
+    setMaterial(material);
+    material->release();
+
+    return material;
+}
+
+unsigned int InstancedModel::addInstance(const Matrix& transform, const Vector4& color)
+{
+    unsigned int index = getInstanceCount();
+    _instanceData.resize(_instanceData.size() + INSTANCE_SIZE);
+    setInstance(index, transform, color);
+    return index;
+}
+
+void InstancedModel::setInstance(unsigned int index, const Matrix& transform, const Vector4& color)
+{
+    GP_ASSERT(index < getInstanceCount());
+
+    float* data = &_instanceData[index * INSTANCE_SIZE];
+    memcpy(data, transform.m, sizeof(float) * 16);
+    data[16] = color.x;
+    data[17] = color.y;
+    data[18] = color.z;
+    data[19] = color.w;
+    instancesChanged();
+}
+
+void InstancedModel::removeInstance(unsigned int index)
+{
+    unsigned int count = getInstanceCount();
+    GP_ASSERT(index < count);
+
+    if (index != count - 1)
+    {
+        memcpy(&_instanceData[index * INSTANCE_SIZE], &_instanceData[(count - 1) * INSTANCE_SIZE], sizeof(float) * INSTANCE_SIZE);
+    }
+    _instanceData.resize((count - 1) * INSTANCE_SIZE);
+    instancesChanged();
+}
+
+void InstancedModel::clearInstances()
+{
+    _instanceData.clear();
+    instancesChanged();
+}
+
+unsigned int InstancedModel::getInstanceCount() const
+{
+    return (unsigned int)(_instanceData.size() / INSTANCE_SIZE);
+}
+
+const BoundingBox& InstancedModel::getBoundingBox() const
+{
+    if (_boundsDirty)
+    {
+        _boundsDirty = false;
+        _boundingBox.set(Vector3::zero(), Vector3::zero());
+
+        GP_ASSERT(_mesh);
+        const BoundingBox& meshBox = _mesh->getBoundingBox();
+        for (unsigned int i = 0, count = getInstanceCount(); i < count; ++i)
+        {
+            BoundingBox box(meshBox);
+            box.transform(Matrix(&_instanceData[i * INSTANCE_SIZE]));
+            if (i == 0)
+                _boundingBox.set(box);
+            else
+                _boundingBox.merge(box);
+        }
+    }
+    return _boundingBox;
+}
+
+void InstancedModel::instancesChanged()
+{
+    _dirty = true;
+
+    // The node only needs to be told once until its bounds are computed again.
+    if (!_boundsDirty)
+    {
+        _boundsDirty = true;
+        if (_node)
+        {
+            _node->setBoundsDirty();
+        }
+    }
+}
+
+void InstancedModel::updateInstanceBuffer()
+{
+    if (!_dirty)
+        return;
+    _dirty = false;
+
+    // The fallback path reads the instances from memory.
+    if (!VertexAttributeBinding::isInstancingSupported())
+        return;
+
+    unsigned int count = getInstanceCount();
+    if (count == 0)
+        return;
+
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer) );
+    if (count > _instanceCapacity)
+    {
+        // Grow the buffer storage (the handle, and so the vertex bindings, stay the same).
+        _instanceCapacity = std::max(count, _instanceCapacity * 2);
+        GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, _instanceCapacity * _instanceFormat.getVertexSize(), NULL, GL_DYNAMIC_DRAW) );
+    }
+    GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, 0, count * _instanceFormat.getVertexSize(), &_instanceData[0]) );
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+}
+
+unsigned int InstancedModel::draw(bool wireframe)
+{
+    GP_ASSERT(_mesh);
+
+    if (_material == NULL || _instanceData.empty())
+        return 0;
+
+    updateInstanceBuffer();
+
+    Technique* technique = _material->getTechnique();
+    GP_ASSERT(technique);
+
+    unsigned int drawCalls = 0;
+    unsigned int partCount = _mesh->getPartCount();
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        pass->bind();
+        if (partCount == 0)
+        {
+            drawCalls += drawInstances(NULL, pass);
+        }
+        else
+        {
+            for (unsigned int j = 0; j < partCount; ++j)
+            {
+                drawCalls += drawInstances(_mesh->getPart(j), pass);
+            }
+        }
+        pass->unbind();
+    }
+    return drawCalls;
+}
+
+unsigned int InstancedModel::drawInstances(MeshPart* part, Pass* pass)
+{
+    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part ? part->getIndexBuffer() : 0) );
+
+    unsigned int count = getInstanceCount();
+
+#ifdef GP_USE_INSTANCING
+    if (VertexAttributeBinding::isInstancingSupported())
+    {
+        if (part)
+        {
+            GL_ASSERT( glDrawElementsInstanced(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0, count) );
+        }
+        else
+        {
+            GL_ASSERT( glDrawArraysInstanced(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount(), count) );
+        }
+        return 1;
+    }
+#endif
+
+    // Set the matrix columns and color of each instance as constant vertex attributes.
+    Effect* effect = pass->getEffect();
+    GP_ASSERT(effect);
+    VertexAttribute matrixAttrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME);
+    VertexAttribute colorAttrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_COLOR_NAME);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const float* data = &_instanceData[i * INSTANCE_SIZE];
+        if (matrixAttrib != -1)
+        {
+            for (unsigned int column = 0; column < 4; ++column)
+            {
+                GL_ASSERT( glVertexAttrib4fv(matrixAttrib + column, data + column * 4) );
+            }
+        }
+        if (colorAttrib != -1)
+        {
+            GL_ASSERT( glVertexAttrib4fv(colorAttrib, data + 16) );
+        }
+
+        if (part)
+        {
+            GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
+        }
+        else
+        {
+            GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
+        }
+    }
+    return count;
+}
+
+void InstancedModel::setNode(Node* node)
+{
+    Drawable::setNode(node);
+
+    // Re-bind node related material parameters.
+    if (node && _material)
+    {
+        _material->setNodeBinding(node);
+    }
+}
+
+Drawable* InstancedModel::clone(NodeCloneContext& context)
+{
+    InstancedModel* model = InstancedModel::create(getMesh());
+    if (!model)
+    {
+        GP_ERROR("Failed to clone instanced model.");
+        return NULL;
+    }
+
+    if (_material)
+    {
+        Material* materialClone = _material->clone(context);
+        if (!materialClone)
+        {
+            GP_ERROR("Failed to clone material for instanced model.");
+            return model;
+        }
+        model->setMaterial(materialClone);
+        materialClone->release();
+    }
+    model->_instanceData = _instanceData;
+    model->instancesChanged();
+    return model;
+}
+
+}
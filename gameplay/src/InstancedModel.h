@@ -0,0 +1,206 @@
+#ifndef INSTANCEDMODEL_H_
+#define INSTANCEDMODEL_H_
+
+#include "Mesh.h"
+#include "Material.h"
+#include "Drawable.h"
+#include "VertexFormat.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a drawable that draws many instances of the same Mesh with the same Material.
+ *
+ * Drawing thousands of copies of a model through cloned nodes issues one set of
+ * uniform uploads and draw calls per node. An instanced model instead stores a
+ * transformation matrix and a color per instance in a vertex buffer, and draws all
+ * of its instances with a single instanced draw call per mesh part and pass.
+ *
+ * The instance matrices are relative to the node the instanced model is attached
+ * to, so the whole group can be moved by transforming the node. In the shaders, the
+ * matrix and color of each instance are read from the 'a_instanceMatrix' and
+ * 'a_instanceColor' vertex attributes. The built-in shaders read them when they are
+ * compiled with the INSTANCING define (skinned meshes cannot be instanced):
+ *
+ * @code
+ * InstancedModel* trees = InstancedModel::create(treeMesh);
+ * trees->setMaterial("res/common/tree.material#instanced");   // defines = INSTANCING
+ * for (unsigned int i = 0; i < count; ++i)
+ *     trees->addInstance(treeTransforms[i]);
+ * node->setDrawable(trees);
+ * @endcode
+ *
+ * On devices that do not support instanced arrays (such as OpenGL ES 2.0 devices),
+ * the instances are drawn one at a time, with their matrix and color set as constant
+ * vertex attributes, which still saves the node traversal and uniform uploads.
+ *
+ * @see VertexAttributeBinding::isInstancingSupported
+ * @script{ignore}
+ */
+class InstancedModel : public Ref, public Drawable
+{
+    friend class Node;
+
+public:
+
+    /**
+     * Creates a new instanced model, with no instances.
+     *
+     * @param mesh The mesh of every instance.
+     *
+     * @return The new instanced model.
+     */
+    static InstancedModel* create(Mesh* mesh);
+
+    /**
+     * Returns the Mesh of the instances.
+     *
+     * @return The Mesh of the instances.
+     */
+    Mesh* getMesh() const;
+
+    /**
+     * Returns the Material of the instances.
+     *
+     * @return The Material, or NULL if no Material is set.
+     */
+    Material* getMaterial() const;
+
+    /**
+     * Sets the Material of the instances (shared by all the mesh parts).
+     *
+     * @param material The new material.
+     */
+    void setMaterial(Material* material);
+
+    /**
+     * Sets the Material of the instances from a material file.
+     *
+     * @param materialPath The path to the material file.
+     *
+     * @return The newly created and bound Material, or NULL if the Material could not be created.
+     */
+    Material* setMaterial(const char* materialPath);
+
+    /**
+     * Adds an instance.
+     *
+     * @param transform The transformation of the instance, relative to the node.
+     * @param color The color of the instance.
+     *
+     * @return The index of the new instance.
+     */
+    unsigned int addInstance(const Matrix& transform, const Vector4& color = Vector4::one());
+
+    /**
+     * Sets the transformation and color of an instance.
+     *
+     * @param index The index of the instance.
+     * @param transform The transformation of the instance, relative to the node.
+     * @param color The color of the instance.
+     */
+    void setInstance(unsigned int index, const Matrix& transform, const Vector4& color = Vector4::one());
+
+    /**
+     * Removes an instance.
+     *
+     * The last instance is moved to the index of the removed one.
+     *
+     * @param index The index of the instance to remove.
+     */
+    void removeInstance(unsigned int index);
+
+    /**
+     * Removes all the instances.
+     */
+    void clearInstances();
+
+    /**
+     * Gets the number of instances.
+     *
+     * @return The number of instances.
+     */
+    unsigned int getInstanceCount() const;
+
+    /**
+     * Gets the local bounding box of the instances.
+     *
+     * This is the bounding box of the mesh merged over the transformations of all the
+     * instances, relative to the node. It is recomputed when requested after the
+     * instances have changed.
+     *
+     * @return The local bounding box of the instances (empty if there are no instances).
+     */
+    const BoundingBox& getBoundingBox() const;
+
+    /**
+     * Draws all the instances.
+     *
+     * @param wireframe Ignored (instances are always drawn solid).
+     *
+     * @return The number of draw calls issued.
+     */
+    unsigned int draw(bool wireframe = false);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    InstancedModel(Mesh* mesh);
+
+    /**
+     * Destructor.
+     */
+    ~InstancedModel();
+
+    /**
+     * Hidden copy constructor.
+     */
+    InstancedModel(const InstancedModel& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    InstancedModel& operator=(const InstancedModel&);
+
+    /**
+     * @see Drawable::setNode
+     */
+    void setNode(Node* node);
+
+    /**
+     * @see Drawable::clone
+     */
+    Drawable* clone(NodeCloneContext& context);
+
+    /**
+     * Marks the instance buffer and the bounds of the instances (and of the node) as dirty.
+     */
+    void instancesChanged();
+
+    /**
+     * Uploads the instance data to the instance buffer if it has changed.
+     */
+    void updateInstanceBuffer();
+
+    /**
+     * Draws the given mesh part (or the mesh vertices if NULL) once per instance.
+     */
+    unsigned int drawInstances(MeshPart* part, Pass* pass);
+
+    Mesh* _mesh;
+    Material* _material;
+    VertexFormat _instanceFormat;
+    VertexBufferHandle _instanceBuffer;
+    unsigned int _instanceCapacity;
+    std::vector<float> _instanceData;
+    bool _dirty;
+    mutable BoundingBox _boundingBox;
+    mutable bool _boundsDirty;
+};
+
+}
+
+#endif
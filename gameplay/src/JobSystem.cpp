@@ -0,0 +1,335 @@
+#include "Base.h"
+#include "JobSystem.h"
+
+// Thread-local storage specifier
+#ifdef _MSC_VER
+#define JOB_THREAD_LOCAL __declspec(thread)
+#else
+#define JOB_THREAD_LOCAL __thread
+#endif
+
+namespace gameplay
+{
+
+// Index of the job queue owned by the calling thread (0 is the shared queue used by non-worker threads).
+static JOB_THREAD_LOCAL unsigned int __queueIndex = 0;
+
+JobSystem::Counter::Counter()
+    : _count(0)
+{
+}
+
+JobSystem::Counter::~Counter()
+{
+    GP_ASSERT(_count == 0);
+}
+
+bool JobSystem::Counter::isDone() const
+{
+    return _count.load() == 0;
+}
+
+JobSystem::JobSystem()
+    : _pending(0), _running(false), _singleThreaded(false)
+{
+}
+
+JobSystem::~JobSystem()
+{
+    finalize();
+}
+
+void JobSystem::initialize(unsigned int workerCount)
+{
+    GP_ASSERT(_threads.empty());
+
+    // Queue 0 is shared by all threads that are not workers.
+    _queues.push_back(new Queue());
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        _queues.push_back(new Queue());
+    }
+
+    _running = true;
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        _threads.push_back(new std::thread(&workerThreadProc, this, i + 1));
+    }
+}
+
+void JobSystem::finalize()
+{
+    if (_running)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _running = false;
+        }
+        _wake.notify_all();
+        for (size_t i = 0, count = _threads.size(); i < count; ++i)
+        {
+            _threads[i]->join();
+            SAFE_DELETE(_threads[i]);
+        }
+        _threads.clear();
+    }
+
+    // Run anything that is still queued so that counters are not left waiting.
+    Task task;
+    while (pop(&task))
+    {
+        execute(task);
+    }
+
+    // The posted jobs would run against a game that is shutting down, so only their cancel jobs
+    // run (until they post no more jobs).
+    std::vector<std::pair<Job, Job> > posted;
+    do
+    {
+        {
+            std::lock_guard<std::mutex> lock(_postedMutex);
+            posted.clear();
+            posted.swap(_posted);
+        }
+        for (size_t i = 0, count = posted.size(); i < count; ++i)
+        {
+            if (posted[i].second)
+                posted[i].second();
+        }
+    } while (!posted.empty());
+
+    for (size_t i = 0, count = _queues.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_queues[i]);
+    }
+    _queues.clear();
+}
+
+unsigned int JobSystem::getWorkerCount() const
+{
+    return (unsigned int)_threads.size();
+}
+
+bool JobSystem::isSingleThreaded() const
+{
+    return _singleThreaded;
+}
+
+void JobSystem::setSingleThreaded(bool singleThreaded)
+{
+    _singleThreaded = singleThreaded;
+}
+
+void JobSystem::run(const Job& job, Counter* counter, Counter* dependency)
+{
+    GP_ASSERT(job);
+
+    if (counter)
+    {
+        ++counter->_count;
+    }
+
+    Task task;
+    task.job = job;
+    task.counter = counter;
+
+    if (_singleThreaded || _threads.empty())
+    {
+        // Jobs run in submission order, so any dependency has already completed.
+        execute(task);
+        return;
+    }
+
+    if (dependency)
+    {
+        std::lock_guard<std::mutex> lock(dependency->_mutex);
+        if (dependency->_count.load() > 0)
+        {
+            // Defer the job until the dependency is signaled for the last time.
+            dependency->_dependents.push_back(std::make_pair(job, counter));
+            return;
+        }
+    }
+    push(task);
+}
+
+void JobSystem::wait(Counter* counter)
+{
+    GP_ASSERT(counter);
+
+    Task task;
+    while (counter->_count.load() > 0)
+    {
+        // Help out instead of blocking.
+        if (pop(&task))
+        {
+            execute(task);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Wait for the thread that signaled the counter last to release it.
+    std::lock_guard<std::mutex> lock(counter->_mutex);
+}
+
+void JobSystem::parallelFor(unsigned int count, unsigned int grainSize, const RangeJob& job)
+{
+    GP_ASSERT(job);
+
+    if (count == 0)
+        return;
+
+    if (grainSize == 0)
+        grainSize = 1;
+
+    unsigned int threadCount = getWorkerCount() + 1;
+    if (_singleThreaded || threadCount == 1 || count <= grainSize)
+    {
+        job(0, count);
+        return;
+    }
+
+    // Split the range into a few chunks per thread (but never smaller than the grain size)
+    // so that threads finishing early can steal the remaining work.
+    unsigned int chunkSize = std::max(grainSize, (count + threadCount * 4 - 1) / (threadCount * 4));
+
+    Counter counter;
+    for (unsigned int start = chunkSize; start < count; start += chunkSize)
+    {
+        unsigned int end = std::min(start + chunkSize, count);
+        run(std::bind(job, start, end), &counter);
+    }
+    job(0, std::min(chunkSize, count));
+    wait(&counter);
+}
+
+void JobSystem::post(const Job& job, const Job& cancel)
+{
+    GP_ASSERT(job);
+
+    std::lock_guard<std::mutex> lock(_postedMutex);
+    _posted.push_back(std::make_pair(job, cancel));
+}
+
+void JobSystem::executePosted()
+{
+    // Posted jobs may post more jobs, which then run on the next frame.
+    std::vector<std::pair<Job, Job> > posted;
+    {
+        std::lock_guard<std::mutex> lock(_postedMutex);
+        posted.swap(_posted);
+    }
+    for (size_t i = 0, count = posted.size(); i < count; ++i)
+    {
+        posted[i].first();
+    }
+}
+
+void JobSystem::push(const Task& task)
+{
+    GP_ASSERT(__queueIndex < _queues.size());
+
+    Queue* queue = _queues[__queueIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tasks.push_back(task);
+    }
+    ++_pending;
+    _wake.notify_one();
+}
+
+bool JobSystem::pop(Task* task)
+{
+    GP_ASSERT(task);
+
+    size_t queueCount = _queues.size();
+    if (queueCount == 0 || _pending.load() <= 0)
+        return false;
+
+    // Take the most recently pushed job from our own queue first (it is most likely to be hot in cache).
+    unsigned int index = __queueIndex < queueCount ? __queueIndex : 0;
+    Queue* queue = _queues[index];
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->tasks.empty())
+        {
+            *task = queue->tasks.back();
+            queue->tasks.pop_back();
+            --_pending;
+            return true;
+        }
+    }
+
+    // Steal the oldest job from another queue.
+    for (size_t i = 1; i < queueCount; ++i)
+    {
+        queue = _queues[(index + i) % queueCount];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->tasks.empty())
+        {
+            *task = queue->tasks.front();
+            queue->tasks.pop_front();
+            --_pending;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(Task& task)
+{
+    task.job();
+    if (task.counter)
+    {
+        signal(task.counter);
+    }
+}
+
+void JobSystem::signal(Counter* counter)
+{
+    GP_ASSERT(counter);
+
+    // The counter may be destroyed by a waiting thread as soon as it reaches zero,
+    // so it is only accessed while its mutex is held.
+    std::vector<std::pair<Job, Counter*> > dependents;
+    {
+        std::lock_guard<std::mutex> lock(counter->_mutex);
+        if (--counter->_count == 0)
+        {
+            dependents.swap(counter->_dependents);
+        }
+    }
+    for (size_t i = 0, count = dependents.size(); i < count; ++i)
+    {
+        Task task;
+        task.job = dependents[i].first;
+        task.counter = dependents[i].second;
+        push(task);
+    }
+}
+
+void JobSystem::workerThreadProc(JobSystem* jobSystem, unsigned int index)
+{
+    GP_ASSERT(jobSystem);
+
+    __queueIndex = index;
+
+    Task task;
+    while (jobSystem->_running.load())
+    {
+        if (jobSystem->pop(&task))
+        {
+            jobSystem->execute(task);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(jobSystem->_sleepMutex);
+            jobSystem->_wake.wait_for(lock, std::chrono::milliseconds(1), [jobSystem]() { return !jobSystem->_running.load() || jobSystem->_pending.load() > 0; });
+        }
+    }
+}
+
+}
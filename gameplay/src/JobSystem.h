@@ -0,0 +1,263 @@
+#ifndef JOBSYSTEM_H_
+#define JOBSYSTEM_H_
+
+namespace gameplay
+{
+
+/**
+ * Defines a job system for running engine and game work across all cores.
+ *
+ * Each worker thread owns a job queue. Workers execute jobs from the back of their
+ * own queue and steal jobs from the front of the other queues when they run out of
+ * work. Jobs submitted from threads that are not workers (such as the main thread)
+ * are placed on a shared queue that all workers steal from.
+ *
+ * Completion of jobs is tracked with counters. A counter is incremented for every
+ * job submitted against it and decremented when the job finishes, so a counter can
+ * be waited on, or used as a dependency that must reach zero before other jobs start.
+ * Threads waiting on a counter help execute pending jobs instead of blocking.
+ *
+ * The number of worker threads can be specified in the game config:
+ *
+ * @code
+ * jobs
+ * {
+ *     workers = 7
+ *     singleThreaded = false
+ * }
+ * @endcode
+ *
+ * When single-threaded mode is enabled, all jobs execute immediately on the
+ * submitting thread, in submission order. This deterministic mode is useful
+ * for debugging.
+ *
+ * @script{ignore}
+ */
+class JobSystem
+{
+    friend class Game;
+
+public:
+
+    /**
+     * A job function.
+     */
+    typedef std::function<void()> Job;
+
+    /**
+     * A function that processes the range of elements [start, end) in a parallel for loop.
+     */
+    typedef std::function<void(unsigned int start, unsigned int end)> RangeJob;
+
+    /**
+     * Tracks the completion of a group of jobs.
+     */
+    class Counter
+    {
+        friend class JobSystem;
+
+    public:
+
+        /**
+         * Constructor.
+         */
+        Counter();
+
+        /**
+         * Destructor.
+         */
+        ~Counter();
+
+        /**
+         * Determines if all jobs submitted against this counter have finished.
+         *
+         * @return true if all jobs have finished, false otherwise.
+         */
+        bool isDone() const;
+
+    private:
+
+        /**
+         * Hidden copy constructor.
+         */
+        Counter(const Counter& copy);
+
+        /**
+         * Hidden copy assignment operator.
+         */
+        Counter& operator=(const Counter&);
+
+        std::atomic<int> _count;
+        std::mutex _mutex;
+        std::vector<std::pair<Job, Counter*> > _dependents;
+    };
+
+    /**
+     * Gets the number of worker threads.
+     *
+     * The calling thread of wait() and parallelFor() also executes jobs, so the
+     * number of threads doing work is one more than the worker count.
+     *
+     * @return The number of worker threads.
+     */
+    unsigned int getWorkerCount() const;
+
+    /**
+     * Determines if the job system runs all jobs on the submitting thread.
+     *
+     * @return true if the job system is in single-threaded mode, false otherwise.
+     */
+    bool isSingleThreaded() const;
+
+    /**
+     * Sets whether the job system runs all jobs on the submitting thread.
+     *
+     * @param singleThreaded true to run all jobs immediately on the submitting thread
+     *        in submission order, false to run jobs on the worker threads.
+     */
+    void setSingleThreaded(bool singleThreaded);
+
+    /**
+     * Submits a job.
+     *
+     * @param job The job to run.
+     * @param counter An optional counter that is incremented now and decremented
+     *        when the job has finished.
+     * @param dependency An optional counter that must reach zero before the job starts.
+     */
+    void run(const Job& job, Counter* counter = NULL, Counter* dependency = NULL);
+
+    /**
+     * Waits for all jobs submitted against the specified counter to finish.
+     *
+     * The calling thread executes pending jobs while it waits.
+     *
+     * @param counter The counter to wait on.
+     */
+    void wait(Counter* counter);
+
+    /**
+     * Runs the specified function over the range [0, count) split into
+     * chunks of grainSize elements that are processed in parallel.
+     *
+     * This method returns once all chunks have been processed.
+     *
+     * @param count The number of elements to process.
+     * @param grainSize The minimum number of elements per job.
+     * @param job The function processing a range of elements.
+     */
+    void parallelFor(unsigned int count, unsigned int grainSize, const RangeJob& job);
+
+    /**
+     * Posts a job to be run on the main thread.
+     *
+     * Posted jobs run in posting order at the start of the next frame, before
+     * time events are fired. This is used by jobs that need to hand their
+     * results to code that is not thread-safe, such as the graphics device.
+     * This method can be called from any thread.
+     *
+     * Posted jobs that have not run when the game shuts down are never run. Their
+     * cancel jobs run instead, on the main thread before Game::finalize is called,
+     * to release what the jobs hold.
+     *
+     * @param job The job to run on the main thread.
+     * @param cancel An optional job run instead of the job if the game shuts down first.
+     */
+    void post(const Job& job, const Job& cancel = Job());
+
+private:
+
+    /**
+     * A job queued for execution.
+     */
+    struct Task
+    {
+        Job job;
+        Counter* counter;
+    };
+
+    /**
+     * A job queue guarded by a mutex.
+     */
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /**
+     * Constructor.
+     */
+    JobSystem();
+
+    /**
+     * Hidden copy constructor.
+     */
+    JobSystem(const JobSystem& copy);
+
+    /**
+     * Destructor.
+     */
+    ~JobSystem();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    JobSystem& operator=(const JobSystem&);
+
+    /**
+     * Starts the worker threads.
+     *
+     * @param workerCount The number of worker threads to start.
+     */
+    void initialize(unsigned int workerCount);
+
+    /**
+     * Stops the worker threads, runs the jobs still queued, and cancels the posted jobs.
+     */
+    void finalize();
+
+    /**
+     * Pushes a task onto the queue of the calling thread.
+     */
+    void push(const Task& task);
+
+    /**
+     * Pops a task from the queue of the calling thread or steals one from another queue.
+     */
+    bool pop(Task* task);
+
+    /**
+     * Executes a task and signals its counter.
+     */
+    void execute(Task& task);
+
+    /**
+     * Signals that a job submitted against the specified counter has finished.
+     */
+    void signal(Counter* counter);
+
+    /**
+     * Runs the jobs posted to the main thread.
+     */
+    void executePosted();
+
+    /**
+     * The worker thread entry point.
+     */
+    static void workerThreadProc(JobSystem* jobSystem, unsigned int index);
+
+    std::vector<Queue*> _queues;
+    std::vector<std::thread*> _threads;
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    std::atomic<int> _pending;
+    std::atomic<bool> _running;
+    bool _singleThreaded;
+    std::mutex _postedMutex;
+    std::vector<std::pair<Job, Job> > _posted;
+};
+
+}
+
+#endif
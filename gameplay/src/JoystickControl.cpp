@@ -328,6 +328,7 @@ bool JoystickControl::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned i
                 }
 
                 _displacement.set(dx, dy);
+                setDirty(DIRTY_DRAW);
 
                 // If the displacement is greater than the radius, then cap the displacement to the
                 // radius.
@@ -366,6 +367,7 @@ bool JoystickControl::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned i
                 float dy = -(y - ((_relative) ? _screenRegionPixels.y - _bounds.y : 0.0f) - _screenRegionPixels.height * 0.5f);
 
                 _displacement.set(dx, dy);
+                setDirty(DIRTY_DRAW);
 
                 Vector2 value;
                 if ((fabs(_displacement.x) > _radiusPixels) || (fabs(_displacement.y) > _radiusPixels))
@@ -400,6 +402,7 @@ bool JoystickControl::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned i
 
                 // Reset displacement and direction vectors.
                 _displacement.set(0.0f, 0.0f);
+                setDirty(DIRTY_DRAW);
                 Vector2 value(_displacement);
                 if (_value != value)
                 {
@@ -4,7 +4,7 @@
 namespace gameplay
 {
 
-Label::Label() : _text(""), _font(NULL)
+Label::Label() : _text(""), _font(NULL), _measuredFont(NULL), _measuredFontSize(0), _measuredWidth(0), _measuredHeight(0)
 {
 }
 
@@ -66,8 +66,7 @@ void Label::setText(const char* text)
     if ((text == NULL && _text.length() > 0) || strcmp(text, _text.c_str()) != 0)
     {
         _text = text ? text : "";
-        if (_autoSize != AUTO_SIZE_NONE)
-            setDirty(DIRTY_BOUNDS);
+        setDirty(_autoSize != AUTO_SIZE_NONE ? DIRTY_BOUNDS : DIRTY_DRAW);
     }
 }
 
@@ -81,8 +80,13 @@ void Label::update(float elapsedTime)
     Control::update(elapsedTime);
 
     // Update text opacity each frame since opacity is updated in Control::update.
-    _textColor = getTextColor(getState());
-    _textColor.w *= _opacity;
+    Vector4 textColor = getTextColor(getState());
+    textColor.w *= _opacity;
+    if (textColor != _textColor)
+    {
+        _textColor = textColor;
+        setDirty(DIRTY_DRAW);
+    }
 }
 
 void Label::updateState(State state)
@@ -101,15 +105,23 @@ void Label::updateBounds()
         // Measure bounds based only on normal state so that bounds updates are not always required on state changes.
         // This is a trade-off for functionality vs performance, but changing the size of UI controls on hover/focus/etc
         // is a pretty bad practice so we'll prioritize performance here.
-        unsigned int w, h;
-        _font->measureText(_text.c_str(), getFontSize(NORMAL), &w, &h);
+        // Bounds are updated whenever a parent's layout changes, so only re-measure the text when it
+        // (or the font used to measure it) has changed since it was last measured.
+        unsigned int fontSize = getFontSize(NORMAL);
+        if (_font != _measuredFont || fontSize != _measuredFontSize || _text != _measuredText)
+        {
+            _font->measureText(_text.c_str(), fontSize, &_measuredWidth, &_measuredHeight);
+            _measuredText = _text;
+            _measuredFont = _font;
+            _measuredFontSize = fontSize;
+        }
         if (_autoSize & AUTO_SIZE_WIDTH)
         {
-            setWidthInternal(w + getBorder(NORMAL).left + getBorder(NORMAL).right + getPadding().left + getPadding().right);
+            setWidthInternal(_measuredWidth + getBorder(NORMAL).left + getBorder(NORMAL).right + getPadding().left + getPadding().right);
         }
         if (_autoSize & AUTO_SIZE_HEIGHT)
         {
-            setHeightInternal(h + getBorder(NORMAL).top + getBorder(NORMAL).bottom + getPadding().top + getPadding().bottom);
+            setHeightInternal(_measuredHeight + getBorder(NORMAL).top + getBorder(NORMAL).bottom + getPadding().top + getPadding().bottom);
         }
     }
 }
@@ -147,6 +147,12 @@ private:
      * Constructor.
      */
     Label(const Label& copy);
+
+    std::string _measuredText;
+    Font* _measuredFont;
+    unsigned int _measuredFontSize;
+    unsigned int _measuredWidth;
+    unsigned int _measuredHeight;
 };
 
 }
@@ -27,6 +27,7 @@ class Material : public RenderState
     friend class RenderState;
     friend class Node;
     friend class Model;
+    friend class InstancedModel;
 
 public:
 
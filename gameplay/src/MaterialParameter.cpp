@@ -2,11 +2,18 @@
 #include "MaterialParameter.h"
 #include "Node.h"
 
+// Number of effects for which a parameter caches its uniform
+#define UNIFORM_CACHE_SIZE 4
+
 namespace gameplay
 {
 
+// Last version given to a parameter value (versions are unique across all parameters).
+static unsigned long long __valueVersion = 0;
+
 MaterialParameter::MaterialParameter(const char* name) :
-_type(MaterialParameter::NONE), _count(1), _dynamic(false), _name(name ? name : ""), _uniform(NULL), _loggerDirtyBits(0)
+_type(MaterialParameter::NONE), _count(1), _dynamic(false), _name(name ? name : ""), _uniform(NULL), _loggerDirtyBits(0),
+_version(0), _nextUniformBinding(0)
 {
     clearValue();
 }
@@ -73,6 +80,12 @@ void MaterialParameter::clearValue()
 
     memset(&_value, 0, sizeof(_value));
     _type = MaterialParameter::NONE;
+    updateVersion();
+}
+
+void MaterialParameter::updateVersion()
+{
+    _version = ++__valueVersion;
 }
 
 const char* MaterialParameter::getName() const
@@ -211,6 +224,7 @@ void MaterialParameter::setValue(const Matrix& value)
     _dynamic = true;
     _count = 1;
     _type = MaterialParameter::MATRIX;
+    updateVersion();
 }
 
 void MaterialParameter::setValue(const Matrix* values, unsigned int count)
@@ -450,24 +464,26 @@ void MaterialParameter::bind(Effect* effect)
 {
     GP_ASSERT(effect);
 
-    // If we had a Uniform cached that is not from the passed in effect,
-    // we need to update our uniform to point to the new effect's uniform.
-    if (!_uniform || _uniform->getEffect() != effect)
+    _uniform = getUniform(effect);
+    if (!_uniform)
     {
-        _uniform = effect->getUniform(_name.c_str());
-
-        if (!_uniform)
+        if ((_loggerDirtyBits & UNIFORM_NOT_FOUND) == 0)
         {
-            if ((_loggerDirtyBits & UNIFORM_NOT_FOUND) == 0)
-            {
-                // This parameter was not found in the specified effect, so do nothing.
-                GP_WARN("Material parameter for uniform '%s' not found in effect: '%s'.", _name.c_str(), effect->getId());
-                _loggerDirtyBits |= UNIFORM_NOT_FOUND;
-            }
-            return;
+            // This parameter was not found in the specified effect, so do nothing.
+            GP_WARN("Material parameter for uniform '%s' not found in effect: '%s'.", _name.c_str(), effect->getId());
+            _loggerDirtyBits |= UNIFORM_NOT_FOUND;
         }
+        return;
     }
 
+    // Values stored by the parameter itself only change through its setters, which give them a
+    // new version, so they need no upload if the uniform still holds the version last uploaded.
+    // Samplers are always bound since texture units are shared by all effects.
+    bool versioned = _type == MaterialParameter::FLOAT || _type == MaterialParameter::INT ||
+        (_dynamic && _type != MaterialParameter::METHOD && _type != MaterialParameter::SAMPLER_ARRAY);
+    if (versioned && _uniform->isCurrent(_version))
+        return;
+
     switch (_type)
     {
     case MaterialParameter::FLOAT:
@@ -514,6 +530,36 @@ void MaterialParameter::bind(Effect* effect)
             break;
         }
     }
+
+    if (versioned)
+    {
+        _uniform->_version = _version;
+    }
+}
+
+Uniform* MaterialParameter::getUniform(Effect* effect)
+{
+    // Effects are identified by serial number, which unlike their address is never reused.
+    for (size_t i = 0, count = _uniformCache.size(); i < count; ++i)
+    {
+        if (_uniformCache[i].effect == effect->_serial)
+            return _uniformCache[i].uniform;
+    }
+
+    // Uniforms missing from the effect are cached as well.
+    UniformBinding binding;
+    binding.effect = effect->_serial;
+    binding.uniform = effect->getUniform(_name.c_str());
+    if (_uniformCache.size() < UNIFORM_CACHE_SIZE)
+    {
+        _uniformCache.push_back(binding);
+    }
+    else
+    {
+        _uniformCache[_nextUniformBinding] = binding;
+        _nextUniformBinding = (_nextUniformBinding + 1) % UNIFORM_CACHE_SIZE;
+    }
+    return binding.uniform;
 }
 
 void MaterialParameter::bindValue(Node* node, const char* binding)
@@ -739,6 +785,7 @@ void MaterialParameter::setAnimationPropertyValue(int propertyId, AnimationValue
                 default:
                     break;
             }
+            updateVersion();
         }
         break;
     }
@@ -432,10 +432,31 @@ private:
 
     void bind(Effect* effect);
 
+    /**
+     * Gets the uniform of the given effect that this parameter binds to.
+     *
+     * The uniforms are cached for the last few effects the parameter was bound to.
+     */
+    Uniform* getUniform(Effect* effect);
+
+    /**
+     * Gives the value of the parameter a new version.
+     */
+    void updateVersion();
+
     void applyAnimationValue(AnimationValue* value, float blendWeight, int components);
 
     void cloneInto(MaterialParameter* materialParameter) const;
 
+    /**
+     * The uniform of an effect the parameter was bound to.
+     */
+    struct UniformBinding
+    {
+        unsigned int effect;
+        Uniform* uniform;
+    };
+
     enum LOGGER_DIRTYBITS
     {
         UNIFORM_NOT_FOUND = 0x01,
@@ -481,6 +502,9 @@ private:
     std::string _name;
     Uniform* _uniform;
     char _loggerDirtyBits;
+    unsigned long long _version;
+    std::vector<UniformBinding> _uniformCache;
+    unsigned int _nextUniformBinding;
 };
 
 template <class ClassType, class ParameterType>
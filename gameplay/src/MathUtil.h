@@ -12,6 +12,11 @@ class MathUtil
 {
     friend class Matrix;
     friend class Vector3;
+    friend class Quaternion;
+    friend class Frustum;
+    friend class ParticleEmitter;
+    friend class MeshSkin;
+    friend class AnimationClip;
 
 public:
 
@@ -44,6 +49,29 @@ public:
      */
     static void smooth(float* x, float target, float elapsedTime, float riseTime, float fallTime);
 
+    /**
+     * Adds the elements of an array scaled by a scalar to another array (dst[i] += src[i] * scalar).
+     *
+     * @param dst The array to add to.
+     * @param src The array to scale and add.
+     * @param scalar The scalar to scale by.
+     * @param count The number of elements in the arrays.
+     * @script{ignore}
+     */
+    inline static void addScaledArray(float* dst, const float* src, float scalar, unsigned int count);
+
+    /**
+     * Linearly interpolates between the elements of two arrays (dst[i] = from[i] + (to[i] - from[i]) * t[i]).
+     *
+     * @param from The array to interpolate from.
+     * @param to The array to interpolate to.
+     * @param t The array of interpolation coefficients.
+     * @param dst The array to store the results in.
+     * @param count The number of elements in the arrays.
+     * @script{ignore}
+     */
+    inline static void lerpArray(const float* from, const float* to, const float* t, float* dst, unsigned int count);
+
 private:
 
     inline static void addMatrix(const float* m, float scalar, float* dst);
@@ -66,6 +94,22 @@ private:
 
     inline static void crossVector3(const float* v1, const float* v2, float* dst);
 
+    // dst[i * 12] = the first three rows of (m1[i] * m2[i * 16]), stored row-wise (4x3 palette matrices)
+    inline static void multiplyMatrixPalette(const float* const* m1, const float* m2, float* dst, unsigned int count);
+
+    // dst = q1 * q2, with quaternions stored as x, y, z, w
+    inline static void multiplyQuaternion(const float* q1, const float* q2, float* dst);
+
+    // dst[i * 16] = m1[i * 16] * m2[i * 16]
+    inline static void multiplyMatrixArray(const float* m1, const float* m2, float* dst, unsigned int count);
+
+    // dst[i * 3] = m * (points[i * 3], 1), where points and dst may be the same array
+    inline static void transformPointArray(const float* m, const float* points, float* dst, unsigned int count);
+
+    // results[i] = whether the sphere spheres[i * 4] (center, radius) is in front of or intersects
+    // each of the six planes[j * 4] (normal, distance); returns the number of intersecting spheres
+    inline static unsigned int intersectSphereArray(const float* planes, const float* spheres, bool* results, unsigned int count);
+
     MathUtil();
 };
 
@@ -73,8 +117,15 @@ private:
 
 #define MATRIX_SIZE ( sizeof(float) * 16)
 
-#ifdef GP_USE_NEON
+// Define GP_NO_SSE to force the scalar implementation on x86 (e.g. to compare against it).
+#if !defined(GP_USE_NEON) && !defined(GP_NO_SSE) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define GP_USE_SSE
+#endif
+
+#if defined(GP_USE_NEON)
 #include "MathUtilNeon.inl"
+#elif defined(GP_USE_SSE)
+#include "MathUtilSSE.inl"
 #else
 #include "MathUtil.inl"
 #endif
@@ -172,6 +172,86 @@ inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
     dst[2] = z;
 }
 
+inline void MathUtil::addScaledArray(float* dst, const float* src, float scalar, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i] += src[i] * scalar;
+    }
+}
+
+inline void MathUtil::lerpArray(const float* from, const float* to, const float* t, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i] = from[i] + (to[i] - from[i]) * t[i];
+    }
+}
+
+inline void MathUtil::multiplyMatrixPalette(const float* const* m1, const float* m2, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i, m2 += 16, dst += 12)
+    {
+        const float* a = m1[i];
+        for (unsigned int row = 0; row < 3; ++row)
+        {
+            for (unsigned int column = 0; column < 4; ++column)
+            {
+                const float* b = m2 + column * 4;
+                dst[row * 4 + column] = a[row] * b[0] + a[row + 4] * b[1] + a[row + 8] * b[2] + a[row + 12] * b[3];
+            }
+        }
+    }
+}
+
+inline void MathUtil::multiplyQuaternion(const float* q1, const float* q2, float* dst)
+{
+    // Support the case where q1 or q2 is the same array as dst.
+    float x = q1[3] * q2[0] + q1[0] * q2[3] + q1[1] * q2[2] - q1[2] * q2[1];
+    float y = q1[3] * q2[1] - q1[0] * q2[2] + q1[1] * q2[3] + q1[2] * q2[0];
+    float z = q1[3] * q2[2] + q1[0] * q2[1] - q1[1] * q2[0] + q1[2] * q2[3];
+    float w = q1[3] * q2[3] - q1[0] * q2[0] - q1[1] * q2[1] - q1[2] * q2[2];
+
+    dst[0] = x;
+    dst[1] = y;
+    dst[2] = z;
+    dst[3] = w;
+}
+
+inline void MathUtil::multiplyMatrixArray(const float* m1, const float* m2, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        multiplyMatrix(m1 + i * 16, m2 + i * 16, dst + i * 16);
+    }
 }
 
+inline void MathUtil::transformPointArray(const float* m, const float* points, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i, points += 3, dst += 3)
+    {
+        transformVector4(m, points[0], points[1], points[2], 1.0f, dst);
+    }
+}
+
+inline unsigned int MathUtil::intersectSphereArray(const float* planes, const float* spheres, bool* results, unsigned int count)
+{
+    unsigned int intersecting = 0;
+    for (unsigned int i = 0; i < count; ++i, spheres += 4)
+    {
+        results[i] = true;
+        for (unsigned int j = 0; j < 6; ++j)
+        {
+            const float* plane = planes + j * 4;
+            if (plane[0] * spheres[0] + plane[1] * spheres[1] + plane[2] * spheres[2] + plane[3] + spheres[3] < 0.0f)
+            {
+                results[i] = false;
+                break;
+            }
+        }
+        intersecting += results[i] ? 1 : 0;
+    }
+    return intersecting;
+}
 
+}
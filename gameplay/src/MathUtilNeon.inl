@@ -1,3 +1,5 @@
+#include <arm_neon.h>
+
 namespace gameplay
 {
 
@@ -226,4 +228,147 @@ inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
     );
 }
 
+inline void MathUtil::addScaledArray(float* dst, const float* src, float scalar, unsigned int count)
+{
+    unsigned int i = 0;
+    float32x4_t s = vdupq_n_f32(scalar);
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), s));
+    }
+    for (; i < count; ++i)
+    {
+        dst[i] += src[i] * scalar;
+    }
+}
+
+inline void MathUtil::lerpArray(const float* from, const float* to, const float* t, float* dst, unsigned int count)
+{
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t a = vld1q_f32(from + i);
+        float32x4_t b = vld1q_f32(to + i);
+        vst1q_f32(dst + i, vmlaq_f32(a, vsubq_f32(b, a), vld1q_f32(t + i)));
+    }
+    for (; i < count; ++i)
+    {
+        dst[i] = from[i] + (to[i] - from[i]) * t[i];
+    }
+}
+
+inline void MathUtil::multiplyMatrixPalette(const float* const* m1, const float* m2, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i, m2 += 16, dst += 12)
+    {
+        const float* a = m1[i];
+        float32x4_t a0 = vld1q_f32(a);
+        float32x4_t a1 = vld1q_f32(a + 4);
+        float32x4_t a2 = vld1q_f32(a + 8);
+        float32x4_t a3 = vld1q_f32(a + 12);
+
+        // Compute the columns of the product, then store its first three rows.
+        float c[16];
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            const float* b = m2 + j * 4;
+            float32x4_t column = vmulq_n_f32(a0, b[0]);
+            column = vmlaq_n_f32(column, a1, b[1]);
+            column = vmlaq_n_f32(column, a2, b[2]);
+            column = vmlaq_n_f32(column, a3, b[3]);
+            vst1q_f32(c + j * 4, column);
+        }
+        float32x4x4_t rows = vld4q_f32(c);
+        vst1q_f32(dst, rows.val[0]);
+        vst1q_f32(dst + 4, rows.val[1]);
+        vst1q_f32(dst + 8, rows.val[2]);
+    }
+}
+
+inline void MathUtil::multiplyQuaternion(const float* q1, const float* q2, float* dst)
+{
+    // A single product has too little work to pay for shuffling the components into registers.
+    float x = q1[3] * q2[0] + q1[0] * q2[3] + q1[1] * q2[2] - q1[2] * q2[1];
+    float y = q1[3] * q2[1] - q1[0] * q2[2] + q1[1] * q2[3] + q1[2] * q2[0];
+    float z = q1[3] * q2[2] + q1[0] * q2[1] - q1[1] * q2[0] + q1[2] * q2[3];
+    float w = q1[3] * q2[3] - q1[0] * q2[0] - q1[1] * q2[1] - q1[2] * q2[2];
+
+    dst[0] = x;
+    dst[1] = y;
+    dst[2] = z;
+    dst[3] = w;
+}
+
+inline void MathUtil::multiplyMatrixArray(const float* m1, const float* m2, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        multiplyMatrix(m1 + i * 16, m2 + i * 16, dst + i * 16);
+    }
+}
+
+inline void MathUtil::transformPointArray(const float* m, const float* points, float* dst, unsigned int count)
+{
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4, points += 12, dst += 12)
+    {
+        // De-interleave four points into their x, y and z components.
+        float32x4x3_t p = vld3q_f32(points);
+        float32x4x3_t r;
+        r.val[0] = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[12]), p.val[0], m[0]), p.val[1], m[4]), p.val[2], m[8]);
+        r.val[1] = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[13]), p.val[0], m[1]), p.val[1], m[5]), p.val[2], m[9]);
+        r.val[2] = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[14]), p.val[0], m[2]), p.val[1], m[6]), p.val[2], m[10]);
+        vst3q_f32(dst, r);
+    }
+    for (; i < count; ++i, points += 3, dst += 3)
+    {
+        float x = points[0] * m[0] + points[1] * m[4] + points[2] * m[8] + m[12];
+        float y = points[0] * m[1] + points[1] * m[5] + points[2] * m[9] + m[13];
+        float z = points[0] * m[2] + points[1] * m[6] + points[2] * m[10] + m[14];
+        dst[0] = x;
+        dst[1] = y;
+        dst[2] = z;
+    }
+}
+
+inline unsigned int MathUtil::intersectSphereArray(const float* planes, const float* spheres, bool* results, unsigned int count)
+{
+    unsigned int intersecting = 0;
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4, spheres += 16)
+    {
+        // De-interleave four spheres into their centers and radii.
+        float32x4x4_t s = vld4q_f32(spheres);
+        uint32x4_t outside = vdupq_n_u32(0);
+        for (unsigned int j = 0; j < 6; ++j)
+        {
+            const float* plane = planes + j * 4;
+            float32x4_t distance = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(plane[3]), s.val[0], plane[0]), s.val[1], plane[1]), s.val[2], plane[2]);
+            outside = vorrq_u32(outside, vcltq_f32(vaddq_f32(distance, s.val[3]), vdupq_n_f32(0.0f)));
+        }
+        unsigned int mask[4];
+        vst1q_u32(mask, outside);
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            results[i + j] = mask[j] == 0;
+            intersecting += results[i + j] ? 1 : 0;
+        }
+    }
+    for (; i < count; ++i, spheres += 4)
+    {
+        results[i] = true;
+        for (unsigned int j = 0; j < 6; ++j)
+        {
+            const float* plane = planes + j * 4;
+            if (plane[0] * spheres[0] + plane[1] * spheres[1] + plane[2] * spheres[2] + plane[3] + spheres[3] < 0.0f)
+            {
+                results[i] = false;
+                break;
+            }
+        }
+        intersecting += results[i] ? 1 : 0;
+    }
+    return intersecting;
+}
+
 }
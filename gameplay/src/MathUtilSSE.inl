@@ -0,0 +1,330 @@
+#ifdef __AVX__
+#include <immintrin.h>
+#else
+#include <xmmintrin.h>
+#endif
+
+// Multiply-add of packed floats: a * b + c, fused when FMA instructions are enabled
+#ifdef __FMA__
+#define MATHUTIL_MADD_PS(a, b, c) _mm_fmadd_ps(a, b, c)
+#define MATHUTIL_MADD256_PS(a, b, c) _mm256_fmadd_ps(a, b, c)
+#else
+#define MATHUTIL_MADD_PS(a, b, c) _mm_add_ps(_mm_mul_ps(a, b), c)
+#define MATHUTIL_MADD256_PS(a, b, c) _mm256_add_ps(_mm256_mul_ps(a, b), c)
+#endif
+
+namespace gameplay
+{
+
+inline void MathUtil::addMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(m), s));
+    _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(m + 4), s));
+    _mm_storeu_ps(dst + 8, _mm_add_ps(_mm_loadu_ps(m + 8), s));
+    _mm_storeu_ps(dst + 12, _mm_add_ps(_mm_loadu_ps(m + 12), s));
+}
+
+inline void MathUtil::addMatrix(const float* m1, const float* m2, float* dst)
+{
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(m1), _mm_loadu_ps(m2)));
+    _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(m1 + 4), _mm_loadu_ps(m2 + 4)));
+    _mm_storeu_ps(dst + 8, _mm_add_ps(_mm_loadu_ps(m1 + 8), _mm_loadu_ps(m2 + 8)));
+    _mm_storeu_ps(dst + 12, _mm_add_ps(_mm_loadu_ps(m1 + 12), _mm_loadu_ps(m2 + 12)));
+}
+
+inline void MathUtil::subtractMatrix(const float* m1, const float* m2, float* dst)
+{
+    _mm_storeu_ps(dst, _mm_sub_ps(_mm_loadu_ps(m1), _mm_loadu_ps(m2)));
+    _mm_storeu_ps(dst + 4, _mm_sub_ps(_mm_loadu_ps(m1 + 4), _mm_loadu_ps(m2 + 4)));
+    _mm_storeu_ps(dst + 8, _mm_sub_ps(_mm_loadu_ps(m1 + 8), _mm_loadu_ps(m2 + 8)));
+    _mm_storeu_ps(dst + 12, _mm_sub_ps(_mm_loadu_ps(m1 + 12), _mm_loadu_ps(m2 + 12)));
+}
+
+inline void MathUtil::multiplyMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    _mm_storeu_ps(dst, _mm_mul_ps(_mm_loadu_ps(m), s));
+    _mm_storeu_ps(dst + 4, _mm_mul_ps(_mm_loadu_ps(m + 4), s));
+    _mm_storeu_ps(dst + 8, _mm_mul_ps(_mm_loadu_ps(m + 8), s));
+    _mm_storeu_ps(dst + 12, _mm_mul_ps(_mm_loadu_ps(m + 12), s));
+}
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+    // Each column of the product is a combination of the columns of m1. All the columns
+    // are computed before any is stored, to support the case where m1 or m2 is dst.
+#ifdef __AVX__
+    // Two columns of the product at a time: the lanes of each half of b are broadcast within that half.
+    __m256 a0 = _mm256_broadcast_ps((const __m128*)m1);
+    __m256 a1 = _mm256_broadcast_ps((const __m128*)(m1 + 4));
+    __m256 a2 = _mm256_broadcast_ps((const __m128*)(m1 + 8));
+    __m256 a3 = _mm256_broadcast_ps((const __m128*)(m1 + 12));
+    __m256 c[2];
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        __m256 b = _mm256_loadu_ps(m2 + i * 8);
+        c[i] = _mm256_mul_ps(a0, _mm256_shuffle_ps(b, b, 0x00));
+        c[i] = MATHUTIL_MADD256_PS(a1, _mm256_shuffle_ps(b, b, 0x55), c[i]);
+        c[i] = MATHUTIL_MADD256_PS(a2, _mm256_shuffle_ps(b, b, 0xAA), c[i]);
+        c[i] = MATHUTIL_MADD256_PS(a3, _mm256_shuffle_ps(b, b, 0xFF), c[i]);
+    }
+    _mm256_storeu_ps(dst, c[0]);
+    _mm256_storeu_ps(dst + 8, c[1]);
+#else
+    // Without AVX the four-lane kernel is slower than the scalar products, which the
+    // compiler schedules better, so use those.
+    float product[16];
+
+    product[0]  = m1[0] * m2[0]  + m1[4] * m2[1] + m1[8]   * m2[2]  + m1[12] * m2[3];
+    product[1]  = m1[1] * m2[0]  + m1[5] * m2[1] + m1[9]   * m2[2]  + m1[13] * m2[3];
+    product[2]  = m1[2] * m2[0]  + m1[6] * m2[1] + m1[10]  * m2[2]  + m1[14] * m2[3];
+    product[3]  = m1[3] * m2[0]  + m1[7] * m2[1] + m1[11]  * m2[2]  + m1[15] * m2[3];
+
+    product[4]  = m1[0] * m2[4]  + m1[4] * m2[5] + m1[8]   * m2[6]  + m1[12] * m2[7];
+    product[5]  = m1[1] * m2[4]  + m1[5] * m2[5] + m1[9]   * m2[6]  + m1[13] * m2[7];
+    product[6]  = m1[2] * m2[4]  + m1[6] * m2[5] + m1[10]  * m2[6]  + m1[14] * m2[7];
+    product[7]  = m1[3] * m2[4]  + m1[7] * m2[5] + m1[11]  * m2[6]  + m1[15] * m2[7];
+
+    product[8]  = m1[0] * m2[8]  + m1[4] * m2[9] + m1[8]   * m2[10] + m1[12] * m2[11];
+    product[9]  = m1[1] * m2[8]  + m1[5] * m2[9] + m1[9]   * m2[10] + m1[13] * m2[11];
+    product[10] = m1[2] * m2[8]  + m1[6] * m2[9] + m1[10]  * m2[10] + m1[14] * m2[11];
+    product[11] = m1[3] * m2[8]  + m1[7] * m2[9] + m1[11]  * m2[10] + m1[15] * m2[11];
+
+    product[12] = m1[0] * m2[12] + m1[4] * m2[13] + m1[8]  * m2[14] + m1[12] * m2[15];
+    product[13] = m1[1] * m2[12] + m1[5] * m2[13] + m1[9]  * m2[14] + m1[13] * m2[15];
+    product[14] = m1[2] * m2[12] + m1[6] * m2[13] + m1[10] * m2[14] + m1[14] * m2[15];
+    product[15] = m1[3] * m2[12] + m1[7] * m2[13] + m1[11] * m2[14] + m1[15] * m2[15];
+
+    memcpy(dst, product, MATRIX_SIZE);
+#endif
+}
+
+inline void MathUtil::negateMatrix(const float* m, float* dst)
+{
+    __m128 signMask = _mm_set1_ps(-0.0f);
+    _mm_storeu_ps(dst, _mm_xor_ps(_mm_loadu_ps(m), signMask));
+    _mm_storeu_ps(dst + 4, _mm_xor_ps(_mm_loadu_ps(m + 4), signMask));
+    _mm_storeu_ps(dst + 8, _mm_xor_ps(_mm_loadu_ps(m + 8), signMask));
+    _mm_storeu_ps(dst + 12, _mm_xor_ps(_mm_loadu_ps(m + 12), signMask));
+}
+
+inline void MathUtil::transposeMatrix(const float* m, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(m);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 c3 = _mm_loadu_ps(m + 12);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(dst, c0);
+    _mm_storeu_ps(dst + 4, c1);
+    _mm_storeu_ps(dst + 8, c2);
+    _mm_storeu_ps(dst + 12, c3);
+}
+
+inline void MathUtil::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+    __m128 v = _mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(x));
+    v = MATHUTIL_MADD_PS(_mm_loadu_ps(m + 4), _mm_set1_ps(y), v);
+    v = MATHUTIL_MADD_PS(_mm_loadu_ps(m + 8), _mm_set1_ps(z), v);
+    v = MATHUTIL_MADD_PS(_mm_loadu_ps(m + 12), _mm_set1_ps(w), v);
+
+    // Only store the first three components: dst may be a Vector3.
+    _mm_storel_pi((__m64*)dst, v);
+    _mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+}
+
+inline void MathUtil::transformVector4(const float* m, const float* v, float* dst)
+{
+    // Handle case where v == dst.
+    __m128 r = _mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(v[0]));
+    r = MATHUTIL_MADD_PS(_mm_loadu_ps(m + 4), _mm_set1_ps(v[1]), r);
+    r = MATHUTIL_MADD_PS(_mm_loadu_ps(m + 8), _mm_set1_ps(v[2]), r);
+    r = MATHUTIL_MADD_PS(_mm_loadu_ps(m + 12), _mm_set1_ps(v[3]), r);
+    _mm_storeu_ps(dst, r);
+}
+
+inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
+{
+    // Vectors of three components can't be loaded into registers faster than this is computed.
+    float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
+    float y = (v1[2] * v2[0]) - (v1[0] * v2[2]);
+    float z = (v1[0] * v2[1]) - (v1[1] * v2[0]);
+
+    dst[0] = x;
+    dst[1] = y;
+    dst[2] = z;
+}
+
+inline void MathUtil::multiplyQuaternion(const float* q1, const float* q2, float* dst)
+{
+    // Each component of q1 scales q2 with its components reordered and some negated.
+    __m128 b = _mm_loadu_ps(q2);
+    __m128 r = _mm_mul_ps(_mm_set1_ps(q1[3]), b);
+    r = MATHUTIL_MADD_PS(_mm_set1_ps(q1[0]), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)), _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f)), r);
+    r = MATHUTIL_MADD_PS(_mm_set1_ps(q1[1]), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)), _mm_set_ps(-0.0f, -0.0f, 0.0f, 0.0f)), r);
+    r = MATHUTIL_MADD_PS(_mm_set1_ps(q1[2]), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)), _mm_set_ps(-0.0f, 0.0f, 0.0f, -0.0f)), r);
+    _mm_storeu_ps(dst, r);
+}
+
+inline void MathUtil::addScaledArray(float* dst, const float* src, float scalar, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef __AVX__
+    __m256 s8 = _mm256_set1_ps(scalar);
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, MATHUTIL_MADD256_PS(_mm256_loadu_ps(src + i), s8, _mm256_loadu_ps(dst + i)));
+    }
+#endif
+    __m128 s4 = _mm_set1_ps(scalar);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(dst + i, MATHUTIL_MADD_PS(_mm_loadu_ps(src + i), s4, _mm_loadu_ps(dst + i)));
+    }
+    for (; i < count; ++i)
+    {
+        dst[i] += src[i] * scalar;
+    }
+}
+
+inline void MathUtil::lerpArray(const float* from, const float* to, const float* t, float* dst, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef __AVX__
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 a = _mm256_loadu_ps(from + i);
+        __m256 b = _mm256_loadu_ps(to + i);
+        _mm256_storeu_ps(dst + i, MATHUTIL_MADD256_PS(_mm256_sub_ps(b, a), _mm256_loadu_ps(t + i), a));
+    }
+#endif
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(from + i);
+        __m128 b = _mm_loadu_ps(to + i);
+        _mm_storeu_ps(dst + i, MATHUTIL_MADD_PS(_mm_sub_ps(b, a), _mm_loadu_ps(t + i), a));
+    }
+    for (; i < count; ++i)
+    {
+        dst[i] = from[i] + (to[i] - from[i]) * t[i];
+    }
+}
+
+inline void MathUtil::multiplyMatrixPalette(const float* const* m1, const float* m2, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i, m2 += 16, dst += 12)
+    {
+        const float* a = m1[i];
+        __m128 a0 = _mm_loadu_ps(a);
+        __m128 a1 = _mm_loadu_ps(a + 4);
+        __m128 a2 = _mm_loadu_ps(a + 8);
+        __m128 a3 = _mm_loadu_ps(a + 12);
+
+        // Compute the columns of the product, then store its first three rows.
+        __m128 c[4];
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            __m128 b = _mm_loadu_ps(m2 + j * 4);
+            c[j] = _mm_mul_ps(a0, _mm_shuffle_ps(b, b, 0x00));
+            c[j] = MATHUTIL_MADD_PS(a1, _mm_shuffle_ps(b, b, 0x55), c[j]);
+            c[j] = MATHUTIL_MADD_PS(a2, _mm_shuffle_ps(b, b, 0xAA), c[j]);
+            c[j] = MATHUTIL_MADD_PS(a3, _mm_shuffle_ps(b, b, 0xFF), c[j]);
+        }
+        _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+        _mm_storeu_ps(dst, c[0]);
+        _mm_storeu_ps(dst + 4, c[1]);
+        _mm_storeu_ps(dst + 8, c[2]);
+    }
+}
+
+inline void MathUtil::multiplyMatrixArray(const float* m1, const float* m2, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        multiplyMatrix(m1 + i * 16, m2 + i * 16, dst + i * 16);
+    }
+}
+
+inline void MathUtil::transformPointArray(const float* m, const float* points, float* dst, unsigned int count)
+{
+    __m128 m0 = _mm_loadu_ps(m);
+    __m128 m1 = _mm_loadu_ps(m + 4);
+    __m128 m2 = _mm_loadu_ps(m + 8);
+    __m128 m3 = _mm_loadu_ps(m + 12);
+
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4, points += 12, dst += 12)
+    {
+        // Load four points (x0 y0 z0 x1, y1 z1 x2 y2, z2 x3 y3 z3) and gather their x, y and z components.
+        __m128 p0 = _mm_loadu_ps(points);
+        __m128 p1 = _mm_loadu_ps(points + 4);
+        __m128 p2 = _mm_loadu_ps(points + 8);
+        __m128 x = _mm_shuffle_ps(_mm_shuffle_ps(p0, p0, _MM_SHUFFLE(3, 0, 3, 0)), _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+        __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(p2, p2, _MM_SHUFFLE(3, 0, 3, 0)), _MM_SHUFFLE(1, 0, 2, 0));
+
+        __m128 rx = MATHUTIL_MADD_PS(x, _mm_shuffle_ps(m0, m0, 0x00), MATHUTIL_MADD_PS(y, _mm_shuffle_ps(m1, m1, 0x00), MATHUTIL_MADD_PS(z, _mm_shuffle_ps(m2, m2, 0x00), _mm_shuffle_ps(m3, m3, 0x00))));
+        __m128 ry = MATHUTIL_MADD_PS(x, _mm_shuffle_ps(m0, m0, 0x55), MATHUTIL_MADD_PS(y, _mm_shuffle_ps(m1, m1, 0x55), MATHUTIL_MADD_PS(z, _mm_shuffle_ps(m2, m2, 0x55), _mm_shuffle_ps(m3, m3, 0x55))));
+        __m128 rz = MATHUTIL_MADD_PS(x, _mm_shuffle_ps(m0, m0, 0xAA), MATHUTIL_MADD_PS(y, _mm_shuffle_ps(m1, m1, 0xAA), MATHUTIL_MADD_PS(z, _mm_shuffle_ps(m2, m2, 0xAA), _mm_shuffle_ps(m3, m3, 0xAA))));
+
+        // Interleave the transformed components back into points.
+        __m128 xy01 = _mm_unpacklo_ps(rx, ry);
+        __m128 xy23 = _mm_unpackhi_ps(rx, ry);
+        _mm_storeu_ps(dst, _mm_shuffle_ps(xy01, _mm_shuffle_ps(rz, xy01, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(dst + 4, _mm_shuffle_ps(_mm_shuffle_ps(xy01, rz, _MM_SHUFFLE(1, 1, 3, 3)), xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+        _mm_storeu_ps(dst + 8, _mm_shuffle_ps(_mm_shuffle_ps(rz, xy23, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(xy23, rz, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+    for (; i < count; ++i, points += 3, dst += 3)
+    {
+        transformVector4(m, points[0], points[1], points[2], 1.0f, dst);
+    }
+}
+
+inline unsigned int MathUtil::intersectSphereArray(const float* planes, const float* spheres, bool* results, unsigned int count)
+{
+    unsigned int intersecting = 0;
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4, spheres += 16)
+    {
+        // Gather the centers and radii of four spheres.
+        __m128 x = _mm_loadu_ps(spheres);
+        __m128 y = _mm_loadu_ps(spheres + 4);
+        __m128 z = _mm_loadu_ps(spheres + 8);
+        __m128 r = _mm_loadu_ps(spheres + 12);
+        _MM_TRANSPOSE4_PS(x, y, z, r);
+
+        // A sphere is outside when it is entirely behind any of the planes.
+        __m128 outside = _mm_setzero_ps();
+        for (unsigned int j = 0; j < 6; ++j)
+        {
+            const float* plane = planes + j * 4;
+            __m128 distance = MATHUTIL_MADD_PS(x, _mm_set1_ps(plane[0]), MATHUTIL_MADD_PS(y, _mm_set1_ps(plane[1]),
+                              MATHUTIL_MADD_PS(z, _mm_set1_ps(plane[2]), _mm_set1_ps(plane[3]))));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, r), _mm_setzero_ps()));
+        }
+        int mask = _mm_movemask_ps(outside);
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            results[i + j] = (mask & (1 << j)) == 0;
+            intersecting += results[i + j] ? 1 : 0;
+        }
+    }
+    for (; i < count; ++i, spheres += 4)
+    {
+        results[i] = true;
+        for (unsigned int j = 0; j < 6; ++j)
+        {
+            const float* plane = planes + j * 4;
+            if (plane[0] * spheres[0] + plane[1] * spheres[1] + plane[2] * spheres[2] + plane[3] + spheres[3] < 0.0f)
+            {
+                results[i] = false;
+                break;
+            }
+        }
+        intersecting += results[i] ? 1 : 0;
+    }
+    return intersecting;
+}
+
+}
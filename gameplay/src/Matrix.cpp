@@ -734,6 +734,13 @@ void Matrix::multiply(const Matrix& m1, const Matrix& m2, Matrix* dst)
     MathUtil::multiplyMatrix(m1.m, m2.m, dst->m);
 }
 
+void Matrix::multiply(const Matrix* m1, const Matrix* m2, unsigned int count, Matrix* dst)
+{
+    GP_ASSERT(m1 && m2 && dst);
+
+    MathUtil::multiplyMatrixArray(m1->m, m2->m, dst->m, count);
+}
+
 void Matrix::negate()
 {
     negate(this);
@@ -903,6 +910,14 @@ void Matrix::transformPoint(const Vector3& point, Vector3* dst) const
     transformVector(point.x, point.y, point.z, 1.0f, dst);
 }
 
+void Matrix::transformPoints(const Vector3* points, unsigned int count, Vector3* dst) const
+{
+    GP_ASSERT(points && dst);
+
+    // Vector3 is laid out as three consecutive floats.
+    MathUtil::transformPointArray(m, &points->x, &dst->x, count);
+}
+
 void Matrix::transformVector(Vector3* vector) const
 {
     GP_ASSERT(vector);
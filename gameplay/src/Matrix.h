@@ -527,6 +527,20 @@ public:
      */
     static void multiply(const Matrix& m1, const Matrix& m2, Matrix* dst);
 
+    /**
+     * Multiplies each matrix in m1 by the matrix at the same index in m2 and stores
+     * the results in dst.
+     *
+     * This is faster than multiplying the matrices one at a time, and dst may be m1 or m2.
+     *
+     * @param m1 The array of first matrices to multiply.
+     * @param m2 The array of second matrices to multiply.
+     * @param count The number of matrices in each array.
+     * @param dst An array of count matrices to store the results in.
+     * @script{ignore}
+     */
+    static void multiply(const Matrix* m1, const Matrix* m2, unsigned int count, Matrix* dst);
+
     /**
      * Negates this matrix.
      */
@@ -762,6 +776,18 @@ public:
      */
     void transformPoint(const Vector3& point, Vector3* dst) const;
 
+    /**
+     * Transforms an array of points by this matrix, and stores the results in dst.
+     *
+     * This is faster than transforming the points one at a time, and dst may be points.
+     *
+     * @param points The array of points to transform.
+     * @param count The number of points in the array.
+     * @param dst An array of count vectors to store the transformed points in.
+     * @script{ignore}
+     */
+    void transformPoints(const Vector3* points, unsigned int count, Vector3* dst) const;
+
     /**
      * Transforms the specified vector by this matrix by
      * treating the fourth (w) coordinate as zero.
@@ -13,6 +13,8 @@ class Material;
  */
 class MeshBatch
 {
+    friend class SpriteBatch;
+
 public:
 
     /**
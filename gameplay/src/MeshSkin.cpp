@@ -2,15 +2,20 @@
 #include "MeshSkin.h"
 #include "Joint.h"
 #include "Model.h"
+#include "Game.h"
+#include "MathUtil.h"
 
 // The number of rows in each palette matrix.
 #define PALETTE_ROWS 3
 
+// The number of skins per job when computing palettes in parallel.
+#define PALETTE_PARALLEL_GRAIN 4
+
 namespace gameplay
 {
 
 MeshSkin::MeshSkin()
-    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL)
+    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL), _bindMatricesDirty(true), _paletteDirty(true)
 {
 }
 
@@ -29,6 +34,7 @@ const Matrix& MeshSkin::getBindShape() const
 void MeshSkin::setBindShape(const float* matrix)
 {
     _bindShape.set(matrix);
+    setPaletteDirty(true);
 }
 
 unsigned int MeshSkin::getJointCount() const
@@ -134,6 +140,9 @@ void MeshSkin::setJointCount(unsigned int jointCount)
             _matrixPalette[i+2].set(0.0f, 0.0f, 1.0f, 0.0f);
         }
     }
+    _bindMatrices.resize(jointCount);
+    _jointMatrices.resize(jointCount);
+    setPaletteDirty(true);
 }
 
 void MeshSkin::setJoint(Joint* joint, unsigned int index)
@@ -153,16 +162,16 @@ void MeshSkin::setJoint(Joint* joint, unsigned int index)
         joint->addRef();
         joint->addSkin(this);
     }
+    setPaletteDirty(true);
 }
 
 Vector4* MeshSkin::getMatrixPalette() const
 {
     GP_ASSERT(_matrixPalette);
 
-    for (size_t i = 0, count = _joints.size(); i < count; i++)
+    if (preparePalette())
     {
-        GP_ASSERT(_joints[i]);
-        _joints[i]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
+        computePalette();
     }
     return _matrixPalette;
 }
@@ -172,6 +181,168 @@ unsigned int MeshSkin::getMatrixPaletteSize() const
     return (unsigned int)_joints.size() * PALETTE_ROWS;
 }
 
+void MeshSkin::updateMatrixPalettes(MeshSkin** skins, unsigned int count)
+{
+    GP_ASSERT(skins || count == 0);
+
+    // Resolving world matrices walks (and caches into) nodes shared between skins,
+    // so it is done serially before computing the palettes in parallel.
+    std::vector<const MeshSkin*> pending;
+    pending.reserve(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        GP_ASSERT(skins[i]);
+        if (skins[i]->_matrixPalette && skins[i]->preparePalette())
+        {
+            pending.push_back(skins[i]);
+        }
+    }
+
+    JobSystem* jobSystem = Game::getInstance() ? Game::getInstance()->getJobSystem() : NULL;
+    if (jobSystem && pending.size() > PALETTE_PARALLEL_GRAIN)
+    {
+        jobSystem->parallelFor((unsigned int)pending.size(), PALETTE_PARALLEL_GRAIN, [&pending](unsigned int start, unsigned int end)
+        {
+            for (unsigned int i = start; i < end; ++i)
+            {
+                pending[i]->computePalette();
+            }
+        });
+    }
+    else
+    {
+        for (size_t i = 0, pendingCount = pending.size(); i < pendingCount; ++i)
+        {
+            pending[i]->computePalette();
+        }
+    }
+}
+
+bool MeshSkin::skinVertices(const float* vertices, unsigned int vertexCount, float* skinnedVertices) const
+{
+    GP_ASSERT(vertices);
+    GP_ASSERT(skinnedVertices);
+
+    if (_model == NULL || _model->getMesh() == NULL || _matrixPalette == NULL)
+    {
+        GP_WARN("Failed to skin vertices; the skin has no model or no joints.");
+        return false;
+    }
+
+    // Find the elements to skin.
+    const VertexFormat& format = _model->getMesh()->getVertexFormat();
+    int positionOffset = -1;
+    int weightsOffset = -1;
+    int indicesOffset = -1;
+    unsigned int influenceCount = 0;
+    int directionOffsets[3];
+    unsigned int directionCount = 0;
+    unsigned int vertexSize = 0;
+    for (unsigned int i = 0, elementCount = format.getElementCount(); i < elementCount; ++i)
+    {
+        const VertexFormat::Element& e = format.getElement(i);
+        switch (e.usage)
+        {
+        case VertexFormat::POSITION:
+            if (e.size >= 3)
+                positionOffset = (int)vertexSize;
+            break;
+        case VertexFormat::NORMAL:
+        case VertexFormat::TANGENT:
+        case VertexFormat::BINORMAL:
+            if (e.size >= 3)
+                directionOffsets[directionCount++] = (int)vertexSize;
+            break;
+        case VertexFormat::BLENDWEIGHTS:
+            weightsOffset = (int)vertexSize;
+            influenceCount = e.size;
+            break;
+        case VertexFormat::BLENDINDICES:
+            indicesOffset = (int)vertexSize;
+            influenceCount = std::min(influenceCount ? influenceCount : e.size, e.size);
+            break;
+        default:
+            break;
+        }
+        vertexSize += e.size;
+    }
+    if (weightsOffset < 0 || indicesOffset < 0)
+    {
+        GP_WARN("Failed to skin vertices; the vertex format has no blend weights or blend indices.");
+        return false;
+    }
+
+    const float* palette = &getMatrixPalette()->x;
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        const float* src = vertices + v * vertexSize;
+        float* dst = skinnedVertices + v * vertexSize;
+        if (dst != src)
+        {
+            memcpy(dst, src, vertexSize * sizeof(float));
+        }
+
+        // Blend the palette matrices of the joints influencing the vertex.
+        float m[12] = { 0 };
+        for (unsigned int i = 0; i < influenceCount; ++i)
+        {
+            float weight = src[weightsOffset + i];
+            if (weight != 0.0f)
+            {
+                unsigned int joint = (unsigned int)src[indicesOffset + i];
+                GP_ASSERT(joint < getJointCount());
+                MathUtil::addScaledArray(m, palette + joint * PALETTE_ROWS * 4, weight, 12);
+            }
+        }
+
+        if (positionOffset >= 0)
+        {
+            const float* p = src + positionOffset;
+            float x = p[0], y = p[1], z = p[2];
+            dst[positionOffset]     = m[0] * x + m[1] * y + m[2]  * z + m[3];
+            dst[positionOffset + 1] = m[4] * x + m[5] * y + m[6]  * z + m[7];
+            dst[positionOffset + 2] = m[8] * x + m[9] * y + m[10] * z + m[11];
+        }
+        for (unsigned int i = 0; i < directionCount; ++i)
+        {
+            const float* d = src + directionOffsets[i];
+            Vector3 direction(m[0] * d[0] + m[1] * d[1] + m[2]  * d[2],
+                              m[4] * d[0] + m[5] * d[1] + m[6]  * d[2],
+                              m[8] * d[0] + m[9] * d[1] + m[10] * d[2]);
+            direction.normalize();
+            dst[directionOffsets[i]]     = direction.x;
+            dst[directionOffsets[i] + 1] = direction.y;
+            dst[directionOffsets[i] + 2] = direction.z;
+        }
+    }
+    return true;
+}
+
+bool MeshSkin::skinVertices(const float* vertices, unsigned int vertexCount, Mesh* mesh) const
+{
+    GP_ASSERT(mesh);
+
+    if (!mesh->isDynamic() || vertexCount > mesh->getVertexCount())
+    {
+        GP_WARN("Failed to skin vertices; the mesh is not dynamic or has too few vertices.");
+        return false;
+    }
+    if (_model && _model->getMesh() && _model->getMesh()->getVertexFormat() != mesh->getVertexFormat())
+    {
+        GP_WARN("Failed to skin vertices; the vertex format of the mesh differs from the skinned mesh.");
+        return false;
+    }
+    if (vertexCount == 0)
+        return true;
+
+    std::vector<float> skinnedVertices(vertexCount * mesh->getVertexFormat().getVertexSize() / sizeof(float));
+    if (!skinVertices(vertices, vertexCount, &skinnedVertices[0]))
+        return false;
+
+    mesh->setVertexData(&skinnedVertices[0], 0, vertexCount);
+    return true;
+}
+
 Model* MeshSkin::getModel() const
 {
     return _model;
@@ -261,6 +432,47 @@ void MeshSkin::setRootNode(Node* node)
     }
 }
 
+void MeshSkin::setPaletteDirty(bool bindMatrices)
+{
+    _paletteDirty = true;
+    if (bindMatrices)
+    {
+        _bindMatricesDirty = true;
+    }
+}
+
+bool MeshSkin::preparePalette() const
+{
+    if (!_paletteDirty)
+        return false;
+
+    const size_t count = _joints.size();
+    GP_ASSERT(_bindMatrices.size() == count && _jointMatrices.size() == count);
+    if (_bindMatricesDirty)
+    {
+        _bindMatricesDirty = false;
+        for (size_t i = 0; i < count; ++i)
+        {
+            GP_ASSERT(_joints[i]);
+            Matrix::multiply(_joints[i]->getInverseBindPose(), _bindShape, &_bindMatrices[i]);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        GP_ASSERT(_joints[i]);
+        _jointMatrices[i] = _joints[i]->getWorldMatrix().m;
+    }
+    return count > 0;
+}
+
+void MeshSkin::computePalette() const
+{
+    // Each palette matrix is (world * inverse bind pose * bind shape), stored as 3 rows.
+    MathUtil::multiplyMatrixPalette(&_jointMatrices[0], _bindMatrices[0].m, &_matrixPalette[0].x, (unsigned int)_joints.size());
+    _paletteDirty = false;
+}
+
 void MeshSkin::clearJoints()
 {
     setRootJoint(NULL);
@@ -11,6 +11,7 @@ class Bundle;
 class Model;
 class Node;
 class Joint;
+class Mesh;
 
 /**
  * Defines the skin for a mesh.
@@ -27,6 +28,7 @@ class MeshSkin : public Transform::Listener
     friend class Joint;
     friend class Node;
     friend class Scene;
+    friend class SpatialIndex;
 
 public:
 
@@ -92,6 +94,9 @@ public:
 
     /**
      * Returns the pointer to the Vector4 array for the purpose of binding to a shader.
+     *
+     * The palette is cached, and is only computed again when joints of the skin
+     * have moved since it was last computed.
      * 
      * @return The pointer to the matrix palette.
      */
@@ -106,6 +111,51 @@ public:
      */
     unsigned int getMatrixPaletteSize() const;
 
+    /**
+     * Computes the matrix palettes of the specified skins.
+     *
+     * The world matrices of the joints are resolved first, then the palettes of the
+     * skins whose joints have moved are computed in parallel on the job system.
+     * Calling this once per frame, after updating the animations and before drawing
+     * the scene, takes the palette computation out of the draw calls.
+     *
+     * @param skins The skins to update.
+     * @param count The number of skins.
+     * @script{ignore}
+     */
+    static void updateMatrixPalettes(MeshSkin** skins, unsigned int count);
+
+    /**
+     * Skins the specified vertices on the CPU with the matrix palette of this skin.
+     *
+     * The vertices must be in the vertex format of the mesh of the model of this skin,
+     * which must have blend weights and blend indices. Positions are transformed,
+     * normals, tangents and binormals are rotated, and the other elements are copied.
+     * This gives the same results as the skinning vertex shader, and is intended for
+     * tools and for verifying the skinning without a GPU.
+     *
+     * @param vertices The vertices in bind pose.
+     * @param vertexCount The number of vertices.
+     * @param skinnedVertices The array receiving the skinned vertices, in the same vertex format.
+     *
+     * @return true if the vertices were skinned, false otherwise.
+     * @script{ignore}
+     */
+    bool skinVertices(const float* vertices, unsigned int vertexCount, float* skinnedVertices) const;
+
+    /**
+     * Skins the specified vertices on the CPU and writes them to the vertex buffer of a dynamic mesh.
+     *
+     * @param vertices The vertices in bind pose.
+     * @param vertexCount The number of vertices.
+     * @param mesh The dynamic mesh receiving the skinned vertices, in the same vertex format.
+     *
+     * @return true if the vertices were skinned, false otherwise.
+     * @see skinVertices(const float*, unsigned int, float*) const
+     * @script{ignore}
+     */
+    bool skinVertices(const float* vertices, unsigned int vertexCount, Mesh* mesh) const;
+
     /**
      * Returns our parent Model.
      */
@@ -175,6 +225,23 @@ private:
      */
     void clearJoints();
 
+    /**
+     * Marks the matrix palette (and optionally the bind matrices) as needing to be computed again.
+     */
+    void setPaletteDirty(bool bindMatrices = false);
+
+    /**
+     * Resolves the world matrices of the joints, and the bind matrices if they changed.
+     *
+     * @return true if the palette needs to be computed, false otherwise.
+     */
+    bool preparePalette() const;
+
+    /**
+     * Computes the palette from the joint world matrices resolved by preparePalette().
+     */
+    void computePalette() const;
+
     Matrix _bindShape;
     std::vector<Joint*> _joints;
     Joint* _rootJoint;
@@ -190,6 +257,13 @@ private:
     // The number of Vector4's is (_joints.size() * 3).
     Vector4* _matrixPalette;
     Model* _model;
+
+    // The inverse bind pose of each joint multiplied by the bind shape.
+    mutable std::vector<Matrix> _bindMatrices;
+    // The world matrices of the joints, resolved before computing the palette.
+    mutable std::vector<const float*> _jointMatrices;
+    mutable bool _bindMatricesDirty;
+    mutable bool _paletteDirty;
 };
 
 }
@@ -1,5 +1,6 @@
 #include "Base.h"
 #include "Model.h"
+#include "RenderQueue.h"
 #include "MeshPart.h"
 #include "Scene.h"
 #include "Technique.h"
@@ -328,6 +329,79 @@ static bool drawWireframe(MeshPart* part)
 
 unsigned int Model::draw(bool wireframe)
 {
+    return draw(RenderQueue::getGraphicsBackend(), wireframe);
+}
+
+unsigned int Model::draw(RenderQueue::Backend* backend, bool wireframe)
+{
+    GP_ASSERT(backend);
+    GP_ASSERT(_mesh);
+
+    unsigned int partCount = _mesh->getPartCount();
+    if (partCount == 0)
+    {
+        // No mesh parts (index buffers).
+        if (_material)
+        {
+            drawPasses(backend, _material, NULL, wireframe);
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            MeshPart* part = _mesh->getPart(i);
+            GP_ASSERT(part);
+
+            // Get the material for this mesh part.
+            Material* material = getMaterial(i);
+            if (material)
+            {
+                drawPasses(backend, material, part, wireframe);
+            }
+        }
+    }
+    return partCount;
+}
+
+void Model::drawPasses(RenderQueue::Backend* backend, Material* material, MeshPart* part, bool wireframe)
+{
+    GP_ASSERT(material);
+
+    RenderQueue::Packet packet;
+    packet.key = 0;
+    packet.model = this;
+    packet.part = part;
+    packet.drawable = NULL;
+    packet.stateKey = 0;
+    packet.stateId = 0;
+    packet.wireframe = wireframe;
+
+    Technique* technique = material->getTechnique();
+    GP_ASSERT(technique);
+    unsigned int passCount = technique->getPassCount();
+    for (unsigned int i = 0; i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        packet.pass = pass;
+        packet.effect = pass->getEffect();
+
+        // Bind the pass as Pass::bind does, draw, and unbind it.
+        VertexAttributeBinding* binding = pass->getVertexAttributeBinding();
+        backend->bindEffect(packet.effect);
+        backend->bindPass(pass, true, true);
+        if (binding)
+            backend->bindVertexAttributes(binding);
+        backend->draw(packet);
+        if (binding)
+            backend->unbindVertexAttributes(binding);
+    }
+}
+
+void Model::submit(RenderQueue* queue, bool wireframe)
+{
+    GP_ASSERT(queue);
     GP_ASSERT(_mesh);
 
     unsigned int partCount = _mesh->getPartCount();
@@ -338,18 +412,9 @@ unsigned int Model::draw(bool wireframe)
         {
             Technique* technique = _material->getTechnique();
             GP_ASSERT(technique);
-            unsigned int passCount = technique->getPassCount();
-            for (unsigned int i = 0; i < passCount; ++i)
+            for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
             {
-                Pass* pass = technique->getPassByIndex(i);
-                GP_ASSERT(pass);
-                pass->bind();
-                GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
-                if (!wireframe || !drawWireframe(_mesh))
-                {
-                    GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
-                }
-                pass->unbind();
+                queue->submit(this, NULL, technique->getPassByIndex(i), i, wireframe);
             }
         }
     }
@@ -360,29 +425,38 @@ unsigned int Model::draw(bool wireframe)
             MeshPart* part = _mesh->getPart(i);
             GP_ASSERT(part);
 
-            // Get the material for this mesh part.
             Material* material = getMaterial(i);
             if (material)
             {
                 Technique* technique = material->getTechnique();
                 GP_ASSERT(technique);
-                unsigned int passCount = technique->getPassCount();
-                for (unsigned int j = 0; j < passCount; ++j)
+                for (unsigned int j = 0, passCount = technique->getPassCount(); j < passCount; ++j)
                 {
-                    Pass* pass = technique->getPassByIndex(j);
-                    GP_ASSERT(pass);
-                    pass->bind();
-                    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->_indexBuffer) );
-                    if (!wireframe || !drawWireframe(part))
-                    {
-                        GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
-                    }
-                    pass->unbind();
+                    queue->submit(this, part, technique->getPassByIndex(j), j, wireframe);
                 }
             }
         }
     }
-    return partCount;
+}
+
+void Model::drawPart(MeshPart* part, bool wireframe)
+{
+    if (part)
+    {
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->_indexBuffer) );
+        if (!wireframe || !drawWireframe(part))
+        {
+            GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
+        }
+    }
+    else
+    {
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+        if (!wireframe || !drawWireframe(_mesh))
+        {
+            GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
+        }
+    }
 }
 
 void Model::setMaterialNodeBinding(Material *material)
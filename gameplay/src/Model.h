@@ -5,6 +5,7 @@
 #include "MeshSkin.h"
 #include "Material.h"
 #include "Drawable.h"
+#include "RenderQueue.h"
 
 namespace gameplay
 {
@@ -25,6 +26,7 @@ class Model : public Ref, public Drawable
     friend class Scene;
     friend class Mesh;
     friend class Bundle;
+    friend class RenderQueue;
 
 public:
 
@@ -141,6 +143,30 @@ public:
      */
     unsigned int draw(bool wireframe = false);
 
+    /**
+     * Draws the model as draw does, issuing the binds and draw calls through the given
+     * render queue backend.
+     *
+     * Every pass is bound in full, so that drawing models one by one can be measured
+     * with the null backend against drawing them through a RenderQueue.
+     *
+     * @param backend The backend issuing the binds and draw calls.
+     * @param wireframe true to draw the wireframe only.
+     *
+     * @return The number of mesh parts of the model.
+     * @script{ignore}
+     */
+    unsigned int draw(RenderQueue::Backend* backend, bool wireframe);
+
+    /**
+     * @see Drawable::submit
+     *
+     * Submits a packet for every pass of the material of every MeshPart,
+     * so that the model can be drawn sorted by render state.
+     * @script{ignore}
+     */
+    void submit(RenderQueue* queue, bool wireframe = false);
+
 private:
 
     /**
@@ -187,6 +213,17 @@ private:
 
     void validatePartCount();
 
+    /**
+     * Binds the index buffer of the given MeshPart (or none if NULL) and draws it
+     * with the currently bound pass.
+     */
+    void drawPart(MeshPart* part, bool wireframe);
+
+    /**
+     * Binds every pass of the given material in turn and draws the given MeshPart with it.
+     */
+    void drawPasses(RenderQueue::Backend* backend, Material* material, MeshPart* part, bool wireframe);
+
     Mesh* _mesh;
     Material* _material;
     unsigned int _partCount;
@@ -13,6 +13,9 @@
 #include "Drawable.h"
 #include "Form.h"
 #include "Ref.h"
+#include "TransformStore.h"
+#include "SpatialIndex.h"
+#include "InstancedModel.h"
 
 // Node dirty flags
 #define NODE_DIRTY_WORLD 1
@@ -26,7 +29,7 @@ namespace gameplay
 Node::Node(const char* id)
     : _scene(NULL), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(0), _enabled(true), _tags(NULL),
     _drawable(NULL), _camera(NULL), _light(NULL), _audioSource(NULL), _collisionObject(NULL), _agent(NULL), _userObject(NULL),
-      _dirtyBits(NODE_DIRTY_ALL)
+      _dirtyBits(NODE_DIRTY_ALL), _transformStore(NULL), _transformIndex(-1), _spatialIndex(NULL), _spatialProxy(-1)
 {
     GP_REGISTER_SCRIPT_EVENTS();
     if (id)
@@ -72,7 +75,18 @@ void Node::setId(const char* id)
 {
     if (id)
     {
-        _id = id;
+        if (_agent)
+        {
+            // Keep the AI controller's agent index in sync with the new ID.
+            AIController* aiController = Game::getInstance()->getAIController();
+            aiController->unindexAgent(_agent, _id.c_str());
+            _id = id;
+            aiController->indexAgent(_agent);
+        }
+        else
+        {
+            _id = id;
+        }
     }
 }
 
@@ -122,6 +136,15 @@ void Node::addChild(Node* child)
     ++_childCount;
     setBoundsDirty();
 
+    if (_transformStore)
+    {
+        _transformStore->invalidate();
+    }
+    if (_spatialIndex)
+    {
+        _spatialIndex->invalidate();
+    }
+
     if (_dirtyBits & NODE_DIRTY_HIERARCHY)
     {
         hierarchyChanged();
@@ -153,6 +176,17 @@ void Node::removeAllChildren()
 
 void Node::remove()
 {
+    if (_transformStore)
+    {
+        _transformStore->invalidate();
+        detachTransformStore();
+    }
+    if (_spatialIndex)
+    {
+        _spatialIndex->invalidate();
+        detachSpatialIndex();
+    }
+
     // Re-link our neighbours.
     if (_prevSibling)
     {
@@ -416,6 +450,12 @@ bool Node::isStatic() const
 
 const Matrix& Node::getWorldMatrix() const
 {
+    if (_transformStore)
+    {
+        // Resolve the pending transforms of our ancestors only.
+        return _transformStore->resolve(const_cast<Node*>(this));
+    }
+
     if (_dirtyBits & NODE_DIRTY_WORLD)
     {
         // Clear our dirty flag immediately to prevent this block from being entered if our
@@ -639,6 +679,18 @@ void Node::transformChanged()
 {
     // Our local transform was changed, so mark our world matrices dirty.
     _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS;
+    if (_spatialIndex)
+    {
+        _spatialIndex->setMoved(_spatialProxy);
+    }
+
+    // The transform store resolves our subtree and notifies our children when it updates.
+    if (_transformStore)
+    {
+        _transformStore->setDirty(_transformIndex);
+        Transform::transformChanged();
+        return;
+    }
 
     // Notify our children that their transform has also changed (since transforms are inherited).
     for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
@@ -660,10 +712,51 @@ void Node::transformChanged()
     Transform::transformChanged();
 }
 
+void Node::detachTransformStore()
+{
+    if (_transformStore)
+    {
+        // Keep the last resolved world matrix for nodes that are not resolved again (i.e. static nodes).
+        if (_transformIndex >= 0 && _transformIndex < (int)_transformStore->getNodeCount())
+        {
+            _world = _transformStore->getWorldMatrix(_transformIndex);
+        }
+        _transformStore = NULL;
+        _transformIndex = -1;
+        _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS;
+    }
+
+    for (Node* child = getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        child->detachTransformStore();
+    }
+}
+
+void Node::detachSpatialIndex()
+{
+    _spatialIndex = NULL;
+    _spatialProxy = -1;
+
+    Model* model = dynamic_cast<Model*>(_drawable);
+    if (model && model->getSkin() && model->getSkin()->_rootNode)
+    {
+        model->getSkin()->_rootNode->detachSpatialIndex();
+    }
+
+    for (Node* child = getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        child->detachSpatialIndex();
+    }
+}
+
 void Node::setBoundsDirty()
 {
     // Mark ourself and our parent nodes as dirty
     _dirtyBits |= NODE_DIRTY_BOUNDS;
+    if (_spatialIndex)
+    {
+        _spatialIndex->setMoved(_spatialProxy);
+    }
 
     // Mark our parent bounds as dirty as well
     if (_parent)
@@ -808,6 +901,11 @@ void Node::setDrawable(Drawable* drawable)
                 ref->addRef();
             _drawable->setNode(this);
         }
+
+        if (_spatialIndex)
+        {
+            _spatialIndex->invalidate();
+        }
     }
     setBoundsDirty();
 }
@@ -818,109 +916,131 @@ const BoundingSphere& Node::getBoundingSphere() const
     {
         _dirtyBits &= ~NODE_DIRTY_BOUNDS;
 
-        const Matrix& worldMatrix = getWorldMatrix();
+        bool empty = !computeBounds(&_bounds);
 
-        // Start with our local bounding sphere
-        // TODO: Incorporate bounds from entities other than mesh (i.e. particleemitters, audiosource, etc)
-        bool empty = true;
-        Terrain* terrain = dynamic_cast<Terrain*>(_drawable);
-        if (terrain)
-        {
-            _bounds.set(terrain->getBoundingBox());
-            empty = false;
-        }
-        Model* model = dynamic_cast<Model*>(_drawable);
-        if (model && model->getMesh())
-        {
-            if (empty)
-            {
-                _bounds.set(model->getMesh()->getBoundingSphere());
-                empty = false;
-            }
-            else
-            {
-                _bounds.merge(model->getMesh()->getBoundingSphere());
-            }
-        }
-        if (_light)
+        // Merge this world-space bounding sphere with our childrens' bounding volumes.
+        for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
         {
-            switch (_light->getLightType())
+            const BoundingSphere& childSphere = n->getBoundingSphere();
+            if (!childSphere.isEmpty())
             {
-            case Light::POINT:
                 if (empty)
                 {
-                    _bounds.set(Vector3::zero(), _light->getRange());
+                    _bounds.set(childSphere);
                     empty = false;
                 }
                 else
                 {
-                    _bounds.merge(BoundingSphere(Vector3::zero(), _light->getRange()));
+                    _bounds.merge(childSphere);
                 }
-                break;
-            case Light::SPOT:
-                // TODO: Implement spot light bounds
-                break;
             }
         }
+    }
+
+    return _bounds;
+}
+
+bool Node::computeBounds(BoundingSphere* bounds) const
+{
+    GP_ASSERT(bounds);
+
+    const Matrix& worldMatrix = getWorldMatrix();
+
+    // Start with our local bounding sphere
+    // TODO: Incorporate bounds from entities other than mesh (i.e. particleemitters, audiosource, etc)
+    bool empty = true;
+    Terrain* terrain = dynamic_cast<Terrain*>(_drawable);
+    if (terrain)
+    {
+        bounds->set(terrain->getBoundingBox());
+        empty = false;
+    }
+    Model* model = dynamic_cast<Model*>(_drawable);
+    if (model && model->getMesh())
+    {
         if (empty)
         {
-            // Empty bounding sphere, set the world translation with zero radius
-            worldMatrix.getTranslation(&_bounds.center);
-            _bounds.radius = 0;
+            bounds->set(model->getMesh()->getBoundingSphere());
+            empty = false;
         }
-
-        // Transform the sphere (if not empty) into world space.
-        if (!empty)
+        else
+        {
+            bounds->merge(model->getMesh()->getBoundingSphere());
+        }
+    }
+    InstancedModel* instancedModel = dynamic_cast<InstancedModel*>(_drawable);
+    if (instancedModel && instancedModel->getInstanceCount() > 0)
+    {
+        if (empty)
+        {
+            bounds->set(instancedModel->getBoundingBox());
+            empty = false;
+        }
+        else
+        {
+            bounds->merge(instancedModel->getBoundingBox());
+        }
+    }
+    if (_light)
+    {
+        switch (_light->getLightType())
         {
-            bool applyWorldTransform = true;
-            if (model && model->getSkin())
+        case Light::POINT:
+            if (empty)
             {
-                // Special case: If the root joint of our mesh skin is parented by any nodes, 
-                // multiply the world matrix of the root joint's parent by this node's
-                // world matrix. This computes a final world matrix used for transforming this
-                // node's bounding volume. This allows us to store a much smaller bounding
-                // volume approximation than would otherwise be possible for skinned meshes,
-                // since joint parent nodes that are not in the matrix palette do not need to
-                // be considered as directly transforming vertices on the GPU (they can instead
-                // be applied directly to the bounding volume transformation below).
-                GP_ASSERT(model->getSkin()->getRootJoint());
-                Node* jointParent = model->getSkin()->getRootJoint()->getParent();
-                if (jointParent)
-                {
-                    // TODO: Should we protect against the case where joints are nested directly
-                    // in the node hierachy of the model (this is normally not the case)?
-                    Matrix boundsMatrix;
-                    Matrix::multiply(getWorldMatrix(), jointParent->getWorldMatrix(), &boundsMatrix);
-                    _bounds.transform(boundsMatrix);
-                    applyWorldTransform = false;
-                }
+                bounds->set(Vector3::zero(), _light->getRange());
+                empty = false;
             }
-            if (applyWorldTransform)
+            else
             {
-                _bounds.transform(getWorldMatrix());
+                bounds->merge(BoundingSphere(Vector3::zero(), _light->getRange()));
             }
+            break;
+        case Light::SPOT:
+            // TODO: Implement spot light bounds
+            break;
         }
+    }
+    if (empty)
+    {
+        // Empty bounding sphere, set the world translation with zero radius
+        worldMatrix.getTranslation(&bounds->center);
+        bounds->radius = 0;
+    }
 
-        // Merge this world-space bounding sphere with our childrens' bounding volumes.
-        for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
+    // Transform the sphere (if not empty) into world space.
+    if (!empty)
+    {
+        bool applyWorldTransform = true;
+        if (model && model->getSkin())
         {
-            const BoundingSphere& childSphere = n->getBoundingSphere();
-            if (!childSphere.isEmpty())
+            // Special case: If the root joint of our mesh skin is parented by any nodes, 
+            // multiply the world matrix of the root joint's parent by this node's
+            // world matrix. This computes a final world matrix used for transforming this
+            // node's bounding volume. This allows us to store a much smaller bounding
+            // volume approximation than would otherwise be possible for skinned meshes,
+            // since joint parent nodes that are not in the matrix palette do not need to
+            // be considered as directly transforming vertices on the GPU (they can instead
+            // be applied directly to the bounding volume transformation below).
+            GP_ASSERT(model->getSkin()->getRootJoint());
+            Node* jointParent = model->getSkin()->getRootJoint()->getParent();
+            if (jointParent)
             {
-                if (empty)
-                {
-                    _bounds.set(childSphere);
-                    empty = false;
-                }
-                else
-                {
-                    _bounds.merge(childSphere);
-                }
+                // TODO: Should we protect against the case where joints are nested directly
+                // in the node hierachy of the model (this is normally not the case)?
+                Matrix boundsMatrix;
+                Matrix::multiply(getWorldMatrix(), jointParent->getWorldMatrix(), &boundsMatrix);
+                bounds->transform(boundsMatrix);
+                applyWorldTransform = false;
             }
         }
+        if (applyWorldTransform)
+        {
+            bounds->transform(getWorldMatrix());
+        }
     }
 
-    return _bounds;
+    return !empty;
 }
 
 Node* Node::clone() const
@@ -25,6 +25,8 @@ class Light;
 class AudioSource;
 class AIAgent;
 class Drawable;
+class TransformStore;
+class SpatialIndex;
 
 /**
  * Defines a hierarchical structure of objects in 3D transformation spaces.
@@ -41,6 +43,9 @@ class Node : public Transform, public Ref
     friend class Bundle;
     friend class MeshSkin;
     friend class Light;
+    friend class TransformStore;
+    friend class SpatialIndex;
+    friend class InstancedModel;
 
     GP_SCRIPT_EVENTS_START();
     GP_SCRIPT_EVENT(update, "<Node>f");
@@ -679,6 +684,26 @@ private:
 
     PhysicsCollisionObject* setCollisionObject(Properties* properties);
 
+    /**
+     * Detaches this node and its descendants from the transform store of its scene.
+     */
+    void detachTransformStore();
+
+    /**
+     * Detaches this node and its descendants from the spatial index of its scene.
+     */
+    void detachSpatialIndex();
+
+    /**
+     * Computes the world-space bounding sphere of the drawable and light of this node,
+     * excluding its children.
+     *
+     * @param bounds The bounding sphere to populate.
+     *
+     * @return false if the node has no bounds (the sphere is then a point at the node's translation).
+     */
+    bool computeBounds(BoundingSphere* bounds) const;
+
 protected:
 
     /** The scene this node is attached to. */
@@ -719,6 +744,14 @@ protected:
     mutable BoundingSphere _bounds;
     /** The dirty bits used for optimization. */
     mutable int _dirtyBits;
+    /** The transform store resolving the world matrix of this node, if any. */
+    TransformStore* _transformStore;
+    /** The index of this node in the transform store. */
+    int _transformIndex;
+    /** The spatial index holding the bounds of this node, if any. */
+    SpatialIndex* _spatialIndex;
+    /** The index of this node in the spatial index. */
+    int _spatialProxy;
 };
 
 /**
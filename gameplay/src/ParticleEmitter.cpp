@@ -5,17 +5,20 @@
 #include "Scene.h"
 #include "Quaternion.h"
 #include "Properties.h"
+#include "MathUtil.h"
 
 #define PARTICLE_COUNT_MAX                       100
 #define PARTICLE_EMISSION_RATE                   10
 #define PARTICLE_EMISSION_RATE_TIME_INTERVAL     1000.0f / (float)PARTICLE_EMISSION_RATE
 #define PARTICLE_UPDATE_RATE_MAX                 8
+#define PARTICLE_PARALLEL_THRESHOLD              16384
+#define PARTICLE_PARALLEL_GRAIN                  4096
 
 namespace gameplay
 {
 
 ParticleEmitter::ParticleEmitter(unsigned int particleCountMax) : Drawable(),
-    _particleCountMax(particleCountMax), _particleCount(0), _particles(NULL),
+    _particleCountMax(particleCountMax), _particleCount(0), _particleData(NULL), _particleFrames(NULL),
     _emissionRate(PARTICLE_EMISSION_RATE), _started(false), _ellipsoid(false),
     _sizeStartMin(1.0f), _sizeStartMax(1.0f), _sizeEndMin(1.0f), _sizeEndMax(1.0f),
     _energyMin(1000L), _energyMax(1000L),
@@ -25,20 +28,21 @@ ParticleEmitter::ParticleEmitter(unsigned int particleCountMax) : Drawable(),
     _acceleration(Vector3::zero()), _accelerationVar(Vector3::zero()),
     _rotationPerParticleSpeedMin(0.0f), _rotationPerParticleSpeedMax(0.0f),
     _rotationSpeedMin(0.0f), _rotationSpeedMax(0.0f),
-    _rotationAxis(Vector3::zero()), _rotation(Matrix::identity()),
+    _rotationAxis(Vector3::zero()),
     _spriteBatch(NULL), _spriteBlendMode(BLEND_ALPHA),  _spriteTextureWidth(0), _spriteTextureHeight(0), _spriteTextureWidthRatio(0), _spriteTextureHeightRatio(0), _spriteTextureCoords(NULL),
     _spriteAnimated(false),  _spriteLooped(false), _spriteFrameCount(1), _spriteFrameRandomOffset(0),_spriteFrameDuration(0L), _spriteFrameDurationSecs(0.0f), _spritePercentPerFrame(0.0f),
     _orbitPosition(false), _orbitVelocity(false), _orbitAcceleration(false),
-    _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _emitTime(0), _lastUpdated(0)
+    _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _emitTime(0), _updateTime(0)
 {
     GP_ASSERT(particleCountMax);
-    _particles = new Particle[particleCountMax];
+    allocateParticles(particleCountMax);
 }
 
 ParticleEmitter::~ParticleEmitter()
 {
     SAFE_DELETE(_spriteBatch);
-    SAFE_DELETE_ARRAY(_particles);
+    SAFE_DELETE_ARRAY(_particleData);
+    SAFE_DELETE_ARRAY(_particleFrames);
     SAFE_DELETE_ARRAY(_spriteTextureCoords);
 }
 
@@ -250,7 +254,11 @@ Texture* ParticleEmitter::getTexture() const
 
 void ParticleEmitter::setParticleCountMax(unsigned int max)
 {
-    _particleCountMax = max;
+    GP_ASSERT(max);
+    if (max != _particleCountMax)
+    {
+        allocateParticles(max);
+    }
 }
 
 unsigned int ParticleEmitter::getParticleCountMax() const
@@ -273,7 +281,7 @@ void ParticleEmitter::setEmissionRate(unsigned int rate)
 void ParticleEmitter::start()
 {
     _started = true;
-    _lastUpdated = 0;
+    _updateTime = 0;
 }
 
 void ParticleEmitter::stop()
@@ -300,7 +308,7 @@ bool ParticleEmitter::isActive() const
 void ParticleEmitter::emitOnce(unsigned int particleCount)
 {
     GP_ASSERT(_node);
-    GP_ASSERT(_particles);
+    GP_ASSERT(_particleData);
 
     // Limit particleCount so as not to go over _particleCountMax.
     if (particleCount + _particleCount > _particleCountMax)
@@ -318,63 +326,100 @@ void ParticleEmitter::emitOnce(unsigned int particleCount)
     world.m[14] = 0.0f;
 
     // Emit the new particles.
+    float** streams = _particleStreams;
+    Vector4 colorStart, colorEnd;
+    Vector3 position, velocity, acceleration, rotationAxis;
     for (unsigned int i = 0; i < particleCount; i++)
     {
-        Particle* p = &_particles[_particleCount];
+        unsigned int index = _particleCount;
 
-        generateColor(_colorStart, _colorStartVar, &p->_colorStart);
-        generateColor(_colorEnd, _colorEndVar, &p->_colorEnd);
-        p->_color.set(p->_colorStart);
+        generateColor(_colorStart, _colorStartVar, &colorStart);
+        generateColor(_colorEnd, _colorEndVar, &colorEnd);
 
-        p->_energy = p->_energyStart = generateScalar(_energyMin, _energyMax);
-        p->_size = p->_sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
-        p->_sizeEnd = generateScalar(_sizeEndMin, _sizeEndMax);
-        p->_rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
-        p->_angle = generateScalar(0.0f, p->_rotationPerParticleSpeed);
-        p->_rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
+        float energy = generateScalar(_energyMin, _energyMax);
+        float sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
+        float rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
+        float rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
 
         // Only initial position can be generated within an ellipsoidal domain.
-        generateVector(_position, _positionVar, &p->_position, _ellipsoid);
-        generateVector(_velocity, _velocityVar, &p->_velocity, false);
-        generateVector(_acceleration, _accelerationVar, &p->_acceleration, false);
-        generateVector(_rotationAxis, _rotationAxisVar, &p->_rotationAxis, false);
+        generateVector(_position, _positionVar, &position, _ellipsoid);
+        generateVector(_velocity, _velocityVar, &velocity, false);
+        generateVector(_acceleration, _accelerationVar, &acceleration, false);
+        generateVector(_rotationAxis, _rotationAxisVar, &rotationAxis, false);
 
         // Initial position, velocity and acceleration can all be relative to the emitter's transform.
         // Rotate specified properties by the node's rotation.
         if (_orbitPosition)
         {
-            world.transformPoint(p->_position, &p->_position);
+            world.transformPoint(position, &position);
         }
 
         if (_orbitVelocity)
         {
-            world.transformPoint(p->_velocity, &p->_velocity);
+            world.transformPoint(velocity, &velocity);
         }
 
         if (_orbitAcceleration)
         {
-            world.transformPoint(p->_acceleration, &p->_acceleration);
+            world.transformPoint(acceleration, &acceleration);
         }
 
-        // The rotation axis always orbits the node.
-        if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
+        // The rotation axis always orbits the node. It is stored normalized so
+        // the update does not have to normalize it again.
+        if (rotationSpeed != 0.0f && !rotationAxis.isZero())
+        {
+            world.transformPoint(rotationAxis, &rotationAxis);
+            rotationAxis.normalize();
+        }
+        else
         {
-            world.transformPoint(p->_rotationAxis, &p->_rotationAxis);
+            rotationSpeed = 0.0f;
         }
 
         // Translate position relative to the node's world space.
-        p->_position.add(translation);
+        position.add(translation);
+
+        streams[STREAM_POSITION_X][index] = position.x;
+        streams[STREAM_POSITION_Y][index] = position.y;
+        streams[STREAM_POSITION_Z][index] = position.z;
+        streams[STREAM_VELOCITY_X][index] = velocity.x;
+        streams[STREAM_VELOCITY_Y][index] = velocity.y;
+        streams[STREAM_VELOCITY_Z][index] = velocity.z;
+        streams[STREAM_ACCELERATION_X][index] = acceleration.x;
+        streams[STREAM_ACCELERATION_Y][index] = acceleration.y;
+        streams[STREAM_ACCELERATION_Z][index] = acceleration.z;
+        streams[STREAM_COLOR_START_R][index] = streams[STREAM_COLOR_R][index] = colorStart.x;
+        streams[STREAM_COLOR_START_G][index] = streams[STREAM_COLOR_G][index] = colorStart.y;
+        streams[STREAM_COLOR_START_B][index] = streams[STREAM_COLOR_B][index] = colorStart.z;
+        streams[STREAM_COLOR_START_A][index] = streams[STREAM_COLOR_A][index] = colorStart.w;
+        streams[STREAM_COLOR_END_R][index] = colorEnd.x;
+        streams[STREAM_COLOR_END_G][index] = colorEnd.y;
+        streams[STREAM_COLOR_END_B][index] = colorEnd.z;
+        streams[STREAM_COLOR_END_A][index] = colorEnd.w;
+        streams[STREAM_ROTATION_AXIS_X][index] = rotationAxis.x;
+        streams[STREAM_ROTATION_AXIS_Y][index] = rotationAxis.y;
+        streams[STREAM_ROTATION_AXIS_Z][index] = rotationAxis.z;
+        streams[STREAM_ROTATION_SPEED][index] = rotationSpeed;
+        streams[STREAM_ROTATION_PER_PARTICLE_SPEED][index] = rotationPerParticleSpeed;
+        streams[STREAM_ANGLE][index] = generateScalar(0.0f, rotationPerParticleSpeed);
+
+        // The lifetime of a particle is tracked as the percentage of its energy spent.
+        streams[STREAM_PERCENT][index] = 0.0f;
+        streams[STREAM_PERCENT_PER_MS][index] = energy > 0.0f ? 1.0f / energy : FLT_MAX;
+
+        streams[STREAM_SIZE_START][index] = streams[STREAM_SIZE][index] = sizeStart;
+        streams[STREAM_SIZE_END][index] = generateScalar(_sizeEndMin, _sizeEndMax);
 
         // Initial sprite frame.
         if (_spriteFrameRandomOffset > 0)
         {
-            p->_frame = rand() % _spriteFrameRandomOffset;
+            _particleFrames[index] = rand() % _spriteFrameRandomOffset;
         }
         else
         {
-            p->_frame = 0;
+            _particleFrames[index] = 0;
         }
-        p->_timeOnCurrentFrame = 0.0f;
+        streams[STREAM_TIME_ON_CURRENT_FRAME][index] = 0.0f;
 
         ++_particleCount;
     }
@@ -864,15 +909,12 @@ void ParticleEmitter::update(float elapsedTime)
     // Cap particle updates at a maximum rate. This saves processing
     // and also improves precision since updating with very small
     // time increments is more lossy.
-    static double runningTime = 0;
-    runningTime += elapsedTime;
-    if (runningTime < PARTICLE_UPDATE_RATE_MAX)
-        return;    
-
-    float elapsedMs = runningTime;
-    runningTime = 0;
+    _updateTime += elapsedTime;
+    if (_updateTime < PARTICLE_UPDATE_RATE_MAX)
+        return;
 
-    float elapsedSecs = elapsedMs * 0.001f;
+    float elapsedMs = (float)_updateTime;
+    _updateTime = 0;
 
     if (_started && _emissionRate)
     {
@@ -893,88 +935,166 @@ void ParticleEmitter::update(float elapsedTime)
         }
     }
 
-    // Now update all currently living particles.
-    GP_ASSERT(_particles);
-    for (unsigned int particlesIndex = 0; particlesIndex < _particleCount; ++particlesIndex)
+    // Now update all currently living particles, splitting large emitters across threads.
+    GP_ASSERT(_particleData);
+    JobSystem* jobSystem = Game::getInstance()->getJobSystem();
+    if (jobSystem && _particleCount >= PARTICLE_PARALLEL_THRESHOLD)
     {
-        Particle* p = &_particles[particlesIndex];
-        p->_energy -= elapsedMs;
-
-        if (p->_energy > 0L)
+        jobSystem->parallelFor(_particleCount, PARTICLE_PARALLEL_GRAIN, [this, elapsedMs](unsigned int start, unsigned int end)
         {
-            if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
-            {
-                Matrix::createRotation(p->_rotationAxis, p->_rotationSpeed * elapsedSecs, &_rotation);
+            updateParticles(start, end, elapsedMs);
+        });
+    }
+    else
+    {
+        updateParticles(0, _particleCount, elapsedMs);
+    }
+    removeDeadParticles();
+}
 
-                _rotation.transformPoint(p->_velocity, &p->_velocity);
-                _rotation.transformPoint(p->_acceleration, &p->_acceleration);
-            }
+void ParticleEmitter::allocateParticles(unsigned int particleCountMax)
+{
+    GP_ASSERT(particleCountMax);
 
-            // Particle is still alive.
-            p->_velocity.x += p->_acceleration.x * elapsedSecs;
-            p->_velocity.y += p->_acceleration.y * elapsedSecs;
-            p->_velocity.z += p->_acceleration.z * elapsedSecs;
+    float* data = new float[particleCountMax * STREAM_COUNT];
+    unsigned int* frames = new unsigned int[particleCountMax];
 
-            p->_position.x += p->_velocity.x * elapsedSecs;
-            p->_position.y += p->_velocity.y * elapsedSecs;
-            p->_position.z += p->_velocity.z * elapsedSecs;
+    // Keep the living particles that still fit.
+    unsigned int count = std::min(_particleCount, particleCountMax);
+    if (_particleData)
+    {
+        for (unsigned int i = 0; i < STREAM_COUNT; ++i)
+        {
+            memcpy(data + i * particleCountMax, _particleStreams[i], count * sizeof(float));
+        }
+        memcpy(frames, _particleFrames, count * sizeof(unsigned int));
+    }
+    SAFE_DELETE_ARRAY(_particleData);
+    SAFE_DELETE_ARRAY(_particleFrames);
 
-            p->_angle += p->_rotationPerParticleSpeed * elapsedSecs;
+    _particleData = data;
+    _particleFrames = frames;
+    for (unsigned int i = 0; i < STREAM_COUNT; ++i)
+    {
+        _particleStreams[i] = _particleData + i * particleCountMax;
+    }
+    _particleCountMax = particleCountMax;
+    _particleCount = count;
+}
 
-            // Simple linear interpolation of color and size.
-            float percent = 1.0f - ((float)p->_energy / (float)p->_energyStart);
+void ParticleEmitter::updateParticles(unsigned int start, unsigned int end, float elapsedMs)
+{
+    if (start >= end)
+        return;
 
-            p->_color.x = p->_colorStart.x + (p->_colorEnd.x - p->_colorStart.x) * percent;
-            p->_color.y = p->_colorStart.y + (p->_colorEnd.y - p->_colorStart.y) * percent;
-            p->_color.z = p->_colorStart.z + (p->_colorEnd.z - p->_colorStart.z) * percent;
-            p->_color.w = p->_colorStart.w + (p->_colorEnd.w - p->_colorStart.w) * percent;
+    float** streams = _particleStreams;
+    unsigned int count = end - start;
+    float elapsedSecs = elapsedMs * 0.001f;
 
-            p->_size = p->_sizeStart + (p->_sizeEnd - p->_sizeStart) * percent;
+    // Rotate the velocity and acceleration of particles spinning around their world-space axis.
+    // The axis is normalized, so this is a direct application of Rodrigues' rotation formula.
+    const float* rotationSpeed = streams[STREAM_ROTATION_SPEED];
+    for (unsigned int i = start; i < end; ++i)
+    {
+        if (rotationSpeed[i] == 0.0f)
+            continue;
+
+        float angle = rotationSpeed[i] * elapsedSecs;
+        float c = cos(angle);
+        float s = sin(angle);
+        float t = 1.0f - c;
+        float ax = streams[STREAM_ROTATION_AXIS_X][i];
+        float ay = streams[STREAM_ROTATION_AXIS_Y][i];
+        float az = streams[STREAM_ROTATION_AXIS_Z][i];
+        for (unsigned int v = STREAM_VELOCITY_X; v <= STREAM_ACCELERATION_X; v += 3)
+        {
+            float x = streams[v][i];
+            float y = streams[v + 1][i];
+            float z = streams[v + 2][i];
+            float d = (ax * x + ay * y + az * z) * t;
+            streams[v][i] = x * c + (ay * z - az * y) * s + ax * d;
+            streams[v + 1][i] = y * c + (az * x - ax * z) * s + ay * d;
+            streams[v + 2][i] = z * c + (ax * y - ay * x) * s + az * d;
+        }
+    }
+
+    // Integrate velocity, position and angle.
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        MathUtil::addScaledArray(streams[STREAM_VELOCITY_X + i] + start, streams[STREAM_ACCELERATION_X + i] + start, elapsedSecs, count);
+        MathUtil::addScaledArray(streams[STREAM_POSITION_X + i] + start, streams[STREAM_VELOCITY_X + i] + start, elapsedSecs, count);
+    }
+    MathUtil::addScaledArray(streams[STREAM_ANGLE] + start, streams[STREAM_ROTATION_PER_PARTICLE_SPEED] + start, elapsedSecs, count);
+
+    // Simple linear interpolation of color and size over the particle's lifetime.
+    float* percent = streams[STREAM_PERCENT] + start;
+    MathUtil::addScaledArray(percent, streams[STREAM_PERCENT_PER_MS] + start, elapsedMs, count);
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        MathUtil::lerpArray(streams[STREAM_COLOR_START_R + i] + start, streams[STREAM_COLOR_END_R + i] + start, percent, streams[STREAM_COLOR_R + i] + start, count);
+    }
+    MathUtil::lerpArray(streams[STREAM_SIZE_START] + start, streams[STREAM_SIZE_END] + start, percent, streams[STREAM_SIZE] + start, count);
 
-            // Handle sprite animations.
-            if (_spriteAnimated)
+    // Handle sprite animations.
+    if (_spriteAnimated)
+    {
+        float* timeOnCurrentFrame = streams[STREAM_TIME_ON_CURRENT_FRAME];
+        if (!_spriteLooped)
+        {
+            // The last frame should finish exactly when the particle dies.
+            percent = streams[STREAM_PERCENT];
+            for (unsigned int i = start; i < end; ++i)
             {
-                if (!_spriteLooped)
+                unsigned int frame = _particleFrames[i];
+                timeOnCurrentFrame[i] = percent[i] - frame * _spritePercentPerFrame;
+                if (frame < _spriteFrameCount - 1 && timeOnCurrentFrame[i] >= _spritePercentPerFrame)
                 {
-                    // The last frame should finish exactly when the particle dies.
-                    float percentSpent = 0.0f;
-                    for (unsigned int i = 0; i < p->_frame; i++)
-                    {
-                        percentSpent += _spritePercentPerFrame;
-                    }
-                    p->_timeOnCurrentFrame = percent - percentSpent;
-                    if (p->_frame < _spriteFrameCount - 1 &&
-                        p->_timeOnCurrentFrame >= _spritePercentPerFrame)
-                    {
-                        ++p->_frame;
-                    }
+                    _particleFrames[i] = frame + 1;
                 }
-                else
+            }
+        }
+        else
+        {
+            // _spriteFrameDurationSecs is an absolute time measured in seconds,
+            // and the animation repeats indefinitely.
+            for (unsigned int i = start; i < end; ++i)
+            {
+                timeOnCurrentFrame[i] += elapsedSecs;
+                if (timeOnCurrentFrame[i] >= _spriteFrameDurationSecs)
                 {
-                    // _spriteFrameDurationSecs is an absolute time measured in seconds,
-                    // and the animation repeats indefinitely.
-                    p->_timeOnCurrentFrame += elapsedSecs;
-                    if (p->_timeOnCurrentFrame >= _spriteFrameDurationSecs)
+                    timeOnCurrentFrame[i] -= _spriteFrameDurationSecs;
+                    if (++_particleFrames[i] == _spriteFrameCount)
                     {
-                        p->_timeOnCurrentFrame -= _spriteFrameDurationSecs;
-                        ++p->_frame;
-                        if (p->_frame == _spriteFrameCount)
-                        {
-                            p->_frame = 0;
-                        }
+                        _particleFrames[i] = 0;
                     }
                 }
             }
         }
-        else
+    }
+}
+
+void ParticleEmitter::removeDeadParticles()
+{
+    const float* percent = _particleStreams[STREAM_PERCENT];
+    unsigned int i = 0;
+    while (i < _particleCount)
+    {
+        if (percent[i] < 1.0f)
         {
-            // Particle is dead.  Move the particle furthest from the start of the array
-            // down to take its place, and re-use the slot at the end of the list of living particles.
-            if (particlesIndex != _particleCount - 1)
+            ++i;
+            continue;
+        }
+
+        // Particle is dead.  Move the particle furthest from the start of the arrays
+        // down to take its place, and re-use the slot at the end of the list of living particles.
+        unsigned int last = --_particleCount;
+        if (i != last)
+        {
+            for (unsigned int j = 0; j < STREAM_COUNT; ++j)
             {
-                _particles[particlesIndex] = _particles[_particleCount - 1];
+                _particleStreams[j][i] = _particleStreams[j][last];
             }
-            --_particleCount;
+            _particleFrames[i] = _particleFrames[last];
         }
     }
 }
@@ -987,7 +1107,7 @@ unsigned int ParticleEmitter::draw(bool wireframe)
     if (_particleCount > 0)
     {
         GP_ASSERT(_spriteBatch);
-        GP_ASSERT(_particles);
+        GP_ASSERT(_particleData);
         GP_ASSERT(_spriteTextureCoords);
 
         // Set our node's view projection matrix to this emitter's effect.
@@ -1011,13 +1131,17 @@ unsigned int ParticleEmitter::draw(bool wireframe)
         Vector3 up;
         cameraWorldMatrix.getUpVector(&up);
 
+        float** streams = _particleStreams;
         for (unsigned int i = 0; i < _particleCount; i++)
         {
-            Particle* p = &_particles[i];
-
-            _spriteBatch->draw(p->_position, right, up, p->_size, p->_size,
-                                _spriteTextureCoords[p->_frame * 4], _spriteTextureCoords[p->_frame * 4 + 1], _spriteTextureCoords[p->_frame * 4 + 2], _spriteTextureCoords[p->_frame * 4 + 3],
-                                p->_color, pivot, p->_angle);
+            Vector3 position(streams[STREAM_POSITION_X][i], streams[STREAM_POSITION_Y][i], streams[STREAM_POSITION_Z][i]);
+            Vector4 color(streams[STREAM_COLOR_R][i], streams[STREAM_COLOR_G][i], streams[STREAM_COLOR_B][i], streams[STREAM_COLOR_A][i]);
+            float size = streams[STREAM_SIZE][i];
+            const float* texCoords = &_spriteTextureCoords[_particleFrames[i] * 4];
+
+            _spriteBatch->draw(position, right, up, size, size,
+                                texCoords[0], texCoords[1], texCoords[2], texCoords[3],
+                                color, pivot, streams[STREAM_ANGLE][i]);
         }
 
         // Render.
@@ -703,6 +703,10 @@ public:
     /**
      * Updates the particles currently being emitted.
      *
+     * Each emitter accumulates its own elapsed time and updates at most once every
+     * few milliseconds. Emitters with many living particles split the update across
+     * the threads of the game's job system.
+     *
      * @param elapsedTime The amount of time that has passed since the last call to update(), in milliseconds.
      */
     void update(float elapsedTime);
@@ -766,34 +770,70 @@ private:
     static ParticleEmitter::BlendMode getBlendModeFromString(const char* src);
 
     /**
-     * Defines the data for a single particle in the system.
+     * Defines the attribute streams of the particles in the system.
+     *
+     * Particles are stored as a structure of arrays: each attribute of every
+     * particle is kept in its own contiguous stream of floats so that the
+     * update can be processed in wide SIMD batches and split across threads.
      */
-    class Particle
+    enum ParticleStream
     {
-
-    public:
-        Vector3 _position;
-        Vector3 _velocity;
-        Vector3 _acceleration;
-        Vector4 _colorStart;
-        Vector4 _colorEnd;
-        Vector4 _color;
-        float _rotationPerParticleSpeed;
-        Vector3 _rotationAxis;
-        float _rotationSpeed;
-        float _angle;
-        long _energyStart;
-        long _energy;
-        float _sizeStart;
-        float _sizeEnd;
-        float _size;
-        unsigned int _frame;
-        float _timeOnCurrentFrame;
+        STREAM_POSITION_X,
+        STREAM_POSITION_Y,
+        STREAM_POSITION_Z,
+        STREAM_VELOCITY_X,
+        STREAM_VELOCITY_Y,
+        STREAM_VELOCITY_Z,
+        STREAM_ACCELERATION_X,
+        STREAM_ACCELERATION_Y,
+        STREAM_ACCELERATION_Z,
+        STREAM_COLOR_START_R,
+        STREAM_COLOR_START_G,
+        STREAM_COLOR_START_B,
+        STREAM_COLOR_START_A,
+        STREAM_COLOR_END_R,
+        STREAM_COLOR_END_G,
+        STREAM_COLOR_END_B,
+        STREAM_COLOR_END_A,
+        STREAM_COLOR_R,
+        STREAM_COLOR_G,
+        STREAM_COLOR_B,
+        STREAM_COLOR_A,
+        STREAM_ROTATION_AXIS_X,
+        STREAM_ROTATION_AXIS_Y,
+        STREAM_ROTATION_AXIS_Z,
+        STREAM_ROTATION_SPEED,
+        STREAM_ROTATION_PER_PARTICLE_SPEED,
+        STREAM_ANGLE,
+        STREAM_PERCENT,
+        STREAM_PERCENT_PER_MS,
+        STREAM_SIZE_START,
+        STREAM_SIZE_END,
+        STREAM_SIZE,
+        STREAM_TIME_ON_CURRENT_FRAME,
+        STREAM_COUNT
     };
 
+    /**
+     * Allocates the particle streams for the specified maximum number of particles.
+     */
+    void allocateParticles(unsigned int particleCountMax);
+
+    /**
+     * Updates the particles in the range [start, end).
+     */
+    void updateParticles(unsigned int start, unsigned int end, float elapsedMs);
+
+    /**
+     * Removes the dead particles by moving the last living particles into their slots.
+     */
+    void removeDeadParticles();
+
     unsigned int _particleCountMax;
     unsigned int _particleCount;
-    Particle* _particles;
+    float* _particleData;
+    float* _particleStreams[STREAM_COUNT];
+    unsigned int* _particleFrames;
     unsigned int _emissionRate;
     bool _started;
     bool _ellipsoid;
@@ -819,7 +859,6 @@ private:
     float _rotationSpeedMax;
     Vector3 _rotationAxis;
     Vector3 _rotationAxisVar;
-    Matrix _rotation;
     SpriteBatch* _spriteBatch;
     BlendMode _spriteBlendMode;
     float _spriteTextureWidth;
@@ -839,7 +878,7 @@ private:
     bool _orbitAcceleration;
     float _timePerEmission;
     float _emitTime;
-    double _lastUpdated;
+    double _updateTime;
 };
 
 }
@@ -81,6 +81,11 @@ void Pass::bind()
     }
 }
 
+void Pass::bindParameters(bool bindState, bool bindSamplers)
+{
+    RenderState::bind(this, bindState, bindSamplers);
+}
+
 void Pass::unbind()
 {
     // If we have a vertex attribute binding, unbind it
@@ -60,6 +60,18 @@ public:
      */
     void bind();
 
+    /**
+     * Binds the material parameters of this pass, without binding its effect or vertex
+     * attribute binding.
+     *
+     * This lets a RenderQueue leave bound what consecutive passes share.
+     *
+     * @param bindState false to leave the currently bound render state as it is.
+     * @param bindSamplers false to leave the currently bound textures as they are.
+     * @script{ignore}
+     */
+    void bindParameters(bool bindState = true, bool bindSamplers = true);
+
     /**
      * Unbinds the render state for this pass.
      * 
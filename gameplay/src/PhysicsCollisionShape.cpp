@@ -41,6 +41,9 @@ PhysicsCollisionShape::~PhysicsCollisionShape()
         case SHAPE_HEIGHTFIELD:
             if (_shapeData.heightfieldData)
             {
+                // Tiled terrains own the heightfields of their tiles in the compound shape.
+                if (_shapeData.heightfieldData->terrain)
+                    _shapeData.heightfieldData->terrain->setCollisionShape(NULL);
                 SAFE_RELEASE(_shapeData.heightfieldData->heightfield);
                 SAFE_DELETE(_shapeData.heightfieldData);
             }
@@ -9,6 +9,7 @@ namespace gameplay
 {
     class Node;
     class Properties;
+    class Terrain;
 
 /**
  * Defines the physics collision shape class that all supported shapes derive from.
@@ -17,6 +18,7 @@ class PhysicsCollisionShape : public Ref
 {
     friend class PhysicsController;
     friend class PhysicsRigidBody;
+    friend class Terrain;
 
 public:
 
@@ -250,6 +252,7 @@ private:
         Matrix inverse;
         float minHeight;
         float maxHeight;
+        Terrain* terrain;
     };
 
     /**
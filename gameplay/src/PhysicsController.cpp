@@ -22,26 +22,21 @@
 namespace gameplay
 {
 
-const int PhysicsController::DIRTY         = 0x01;
-const int PhysicsController::COLLISION     = 0x02;
-const int PhysicsController::REGISTERED    = 0x04;
-const int PhysicsController::REMOVE        = 0x08;
+const int PhysicsController::COLLISION     = 0x01;
+const int PhysicsController::REGISTERED    = 0x02;
+const int PhysicsController::REMOVE        = 0x04;
 
 PhysicsController::PhysicsController()
   : _isUpdating(false), _collisionConfiguration(NULL), _dispatcher(NULL),
     _overlappingPairCache(NULL), _solver(NULL), _world(NULL), _ghostPairCallback(NULL),
     _debugDrawer(NULL), _status(PhysicsController::Listener::DEACTIVATED), _listeners(NULL),
-    _gravity(btScalar(0.0), btScalar(-9.8), btScalar(0.0)), _collisionCallback(NULL)
+    _gravity(btScalar(0.0), btScalar(-9.8), btScalar(0.0)), _collisionFrame(0), _activeObject(NULL)
 {
     GP_REGISTER_SCRIPT_EVENTS();
-
-    // Default gravity is 9.8 along the negative Y axis.
-    _collisionCallback = new CollisionCallback(this);
 }
 
 PhysicsController::~PhysicsController()
 {
-    SAFE_DELETE(_collisionCallback);
     SAFE_DELETE(_ghostPairCallback);
     SAFE_DELETE(_debugDrawer);
     SAFE_DELETE(_listeners);
@@ -360,76 +355,16 @@ bool PhysicsController::sweepTest(PhysicsCollisionObject* object, const Vector3&
     return false;
 }
 
-btScalar PhysicsController::CollisionCallback::addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* a, int partIdA, int indexA, 
+btScalar PhysicsController::CollisionCallback::addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* a, int partIdA, int indexA,
     const btCollisionObjectWrapper* b, int partIdB, int indexB)
 {
-    GP_ASSERT(_pc);
-
-    // Get pointers to the PhysicsCollisionObject objects.
-    PhysicsCollisionObject* objectA = _pc->getCollisionObject(a->m_collisionObject);
-    PhysicsCollisionObject* objectB = _pc->getCollisionObject(b->m_collisionObject);
-
-    // If the given collision object pair has collided in the past, then
-    // we notify the listeners only if the pair was not colliding
-    // during the previous frame. Otherwise, it's a new pair, so add a
-    // new entry to the cache with the appropriate listeners and notify them.
-    PhysicsCollisionObject::CollisionPair pair(objectA, objectB);
-
-    CollisionInfo* collisionInfo;
-    if (_pc->_collisionStatus.count(pair) > 0)
+    // Contact tests also report points that are close but not yet touching.
+    if (!_colliding && cp.getDistance() <= 0)
     {
-        collisionInfo = &_pc->_collisionStatus[pair];
+        _colliding = true;
+        _contactPointA.set(cp.getPositionWorldOnA().x(), cp.getPositionWorldOnA().y(), cp.getPositionWorldOnA().z());
+        _contactPointB.set(cp.getPositionWorldOnB().x(), cp.getPositionWorldOnB().y(), cp.getPositionWorldOnB().z());
     }
-    else
-    {
-        // Add a new collision pair for these objects.
-        collisionInfo = &_pc->_collisionStatus[pair];
-
-        // Add the appropriate listeners.
-        PhysicsCollisionObject::CollisionPair p1(pair.objectA, NULL);
-        if (_pc->_collisionStatus.count(p1) > 0)
-        {
-            const CollisionInfo& ci = _pc->_collisionStatus[p1];
-            std::vector<PhysicsCollisionObject::CollisionListener*>::const_iterator iter = ci._listeners.begin();
-            for (; iter != ci._listeners.end(); iter++)
-            {
-                GP_ASSERT(*iter);
-                collisionInfo->_listeners.push_back(*iter);
-            }
-        }
-        PhysicsCollisionObject::CollisionPair p2(pair.objectB, NULL);
-        if (_pc->_collisionStatus.count(p2) > 0)
-        {
-            const CollisionInfo& ci = _pc->_collisionStatus[p2];
-            std::vector<PhysicsCollisionObject::CollisionListener*>::const_iterator iter = ci._listeners.begin();
-            for (; iter != ci._listeners.end(); iter++)
-            {
-                GP_ASSERT(*iter);
-                collisionInfo->_listeners.push_back(*iter);
-            }
-        }
-    }
-
-    // Fire collision event.
-    if ((collisionInfo->_status & COLLISION) == 0)
-    {
-        std::vector<PhysicsCollisionObject::CollisionListener*>::const_iterator iter = collisionInfo->_listeners.begin();
-        for (; iter != collisionInfo->_listeners.end(); iter++)
-        {
-            GP_ASSERT(*iter);
-            if ((collisionInfo->_status & REMOVE) == 0)
-            {
-                (*iter)->collisionEvent(PhysicsCollisionObject::CollisionListener::COLLIDING, pair, Vector3(cp.getPositionWorldOnA().x(), cp.getPositionWorldOnA().y(), cp.getPositionWorldOnA().z()),
-                    Vector3(cp.getPositionWorldOnB().x(), cp.getPositionWorldOnB().y(), cp.getPositionWorldOnB().z()));
-            }
-        }
-    }
-
-    // Update the collision status cache (we remove the dirty bit
-    // set in the controller's update so that this particular collision pair's
-    // status is not reset to 'no collision' when the controller's update completes).
-    collisionInfo->_status &= ~DIRTY;
-    collisionInfo->_status |= COLLISION;
     return 0.0f;
 }
 
@@ -492,35 +427,7 @@ void PhysicsController::update(float elapsedTime)
     if (_listeners || hasScriptListener(GP_GET_SCRIPT_EVENT(PhysicsController, statusEvent)))
     {
         Listener::EventType oldStatus = _status;
-
-        if (_status == Listener::DEACTIVATED)
-        {
-            for (int i = 0; i < _world->getNumCollisionObjects(); i++)
-            {
-                GP_ASSERT(_world->getCollisionObjectArray()[i]);
-                if (_world->getCollisionObjectArray()[i]->isActive())
-                {
-                    _status = Listener::ACTIVATED;
-                    break;
-                }
-            }
-        }
-        else
-        {
-            bool allInactive = true;
-            for (int i = 0; i < _world->getNumCollisionObjects(); i++)
-            {
-                GP_ASSERT(_world->getCollisionObjectArray()[i]);
-                if (_world->getCollisionObjectArray()[i]->isActive())
-                {
-                    allInactive = false;
-                    break;
-                }
-            }
-
-            if (allInactive)
-                _status = Listener::DEACTIVATED;
-        }
+        _status = isWorldActive() ? Listener::ACTIVATED : Listener::DEACTIVATED;
 
         // If the status has changed, notify our listeners.
         if (oldStatus != _status)
@@ -538,76 +445,243 @@ void PhysicsController::update(float elapsedTime)
         }
     }
 
-    // All statuses are set with the DIRTY bit before collision processing occurs.
-    // During collision processing, if a collision occurs, the status is 
-    // set to COLLISION and the DIRTY bit is cleared. Then, after collision processing 
-    // is finished, if a given status is still dirty, the COLLISION bit is cleared.
-    //
-    // If an entry was marked for removal in the last frame, fire NOT_COLLIDING if appropriate and remove it now.
+    updateCollisionStatus();
+
+    _isUpdating = false;
+}
+
+// Whether the dispatcher processes the pair, keeping a manifold for it whenever the objects overlap.
+static bool isDispatched(btCollisionDispatcher* dispatcher, const btCollisionObject* a, const btCollisionObject* b)
+{
+    const btBroadphaseProxy* proxyA = a->getBroadphaseHandle();
+    const btBroadphaseProxy* proxyB = b->getBroadphaseHandle();
+    if (proxyA == NULL || proxyB == NULL)
+        return false;
 
-    // Dirty the collision status cache entries.
-    std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo>::iterator iter = _collisionStatus.begin();
-    for (; iter != _collisionStatus.end();)
+    // The broadphase only pairs objects whose groups are in each other's masks.
+    if ((proxyA->m_collisionFilterGroup & proxyB->m_collisionFilterMask) == 0 ||
+        (proxyB->m_collisionFilterGroup & proxyA->m_collisionFilterMask) == 0)
+        return false;
+
+    // The dispatcher skips pairs of static or kinematic objects.
+    return dispatcher->needsCollision(a, b);
+}
+
+// Whether the world bounding boxes of two collision objects overlap.
+static bool overlapAabbs(const btCollisionObject* a, const btCollisionObject* b)
+{
+    btVector3 minA, maxA, minB, maxB;
+    a->getCollisionShape()->getAabb(a->getWorldTransform(), minA, maxA);
+    b->getCollisionShape()->getAabb(b->getWorldTransform(), minB, maxB);
+    return TestAabbAgainstAabb2(minA, maxA, minB, maxB);
+}
+
+void PhysicsController::updateCollisionStatus()
+{
+    // If an entry was marked for removal in the last frame, fire NOT_COLLIDING if appropriate and remove it now.
+    // (Listeners may remove more entries while being notified, so the list is indexed rather than iterated.)
+    for (size_t i = 0; i < _removedPairs.size(); i++)
     {
-        if ((iter->second._status & REMOVE) != 0)
+        CollisionStatusTable::Entry* entry = _collisionStatus.find(_removedPairs[i]);
+        if (entry == NULL || (entry->info._status & REMOVE) == 0)
+            continue;
+
+        PhysicsCollisionObject::CollisionPair pair = entry->pair;
+        std::vector<PhysicsCollisionObject::CollisionListener*> listeners;
+        if ((entry->info._status & COLLISION) != 0 && pair.objectB)
+            listeners.swap(entry->info._listeners);
+        _collisionStatus.erase(pair);
+
+        PhysicsCollisionObject::CollisionPair cp(pair.objectA, NULL);
+        for (size_t j = 0; j < listeners.size(); j++)
         {
-            if ((iter->second._status & COLLISION) != 0 && iter->first.objectB)
-            {
-                size_t size = iter->second._listeners.size();
-                for (size_t i = 0; i < size; i++)
-                {
-                    PhysicsCollisionObject::CollisionPair cp(iter->first.objectA, NULL);
-                    iter->second._listeners[i]->collisionEvent(PhysicsCollisionObject::CollisionListener::NOT_COLLIDING, cp);
-                }
-            }
-
-            std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo>::iterator eraseIter = iter;
-            iter++;
-            _collisionStatus.erase(eraseIter);
+            listeners[j]->collisionEvent(PhysicsCollisionObject::CollisionListener::NOT_COLLIDING, cp);
         }
-        else
+    }
+    _removedPairs.clear();
+
+    // Every pair found in contact this frame is stamped with the frame number. Pairs that
+    // were colliding but were not stamped have stopped colliding.
+    _collisionFrame++;
+
+    if (_collisionStatus.size() == 0)
+    {
+        _collidingPairs.clear();
+        return;
+    }
+
+    // The dispatcher keeps a contact manifold for every overlapping pair of objects, so all
+    // collisions of the step are found without running separate contact tests per registered pair.
+    GP_ASSERT(_dispatcher);
+    int manifoldCount = _dispatcher->getNumManifolds();
+    for (int i = 0; i < manifoldCount; i++)
+    {
+        btPersistentManifold* manifold = _dispatcher->getManifoldByIndexInternal(i);
+        GP_ASSERT(manifold);
+        PhysicsCollisionObject* objectA = getCollisionObject(manifold->getBody0());
+        PhysicsCollisionObject* objectB = getCollisionObject(manifold->getBody1());
+        if (objectA == NULL || objectB == NULL)
+            continue;
+
+        // A pair registered in particular is not tested again below if it has a manifold.
+        PhysicsCollisionObject::CollisionPair pair(objectA, objectB);
+        CollisionStatusTable::Entry* entry = _collisionStatus.find(pair);
+        if (entry)
+            entry->info._manifoldFrame = _collisionFrame;
+
+        // Manifolds also keep points that are close but not yet touching.
+        int contactCount = manifold->getNumContacts();
+        int contact = 0;
+        while (contact < contactCount && manifold->getContactPoint(contact).getDistance() > 0)
+            contact++;
+        if (contact == contactCount)
+            continue;
+
+        const btManifoldPoint& point = manifold->getContactPoint(contact);
+        Vector3 pointA(point.getPositionWorldOnA().x(), point.getPositionWorldOnA().y(), point.getPositionWorldOnA().z());
+        Vector3 pointB(point.getPositionWorldOnB().x(), point.getPositionWorldOnB().y(), point.getPositionWorldOnB().z());
+
+        // Listeners registered for this pair in particular.
+        if (entry && (entry->info._status & (REGISTERED | REMOVE)) == REGISTERED)
+            touchCollisionPair(pair, pointA, pointB);
+
+        // Listeners registered for all collisions of either object.
+        entry = _collisionStatus.find(PhysicsCollisionObject::CollisionPair(objectA, NULL));
+        if (entry && (entry->info._status & (REGISTERED | REMOVE)) == REGISTERED)
+            touchCollisionPair(pair, pointA, pointB);
+
+        entry = _collisionStatus.find(PhysicsCollisionObject::CollisionPair(objectB, NULL));
+        if (entry && (entry->info._status & (REGISTERED | REMOVE)) == REGISTERED)
+            touchCollisionPair(pair, pointA, pointB);
+    }
+
+    // The dispatcher creates no manifold for pairs of static or kinematic objects, or for pairs
+    // filtered out by their collision groups and masks, so only those are tested directly, and
+    // only once their bounding boxes overlap. Any other pair without a manifold is not in contact.
+    for (size_t i = 0; i < _registeredPairs.size();)
+    {
+        CollisionStatusTable::Entry* entry = _collisionStatus.find(_registeredPairs[i]);
+        if (entry == NULL || (entry->info._status & (REGISTERED | REMOVE)) != REGISTERED)
         {
-            iter->second._status |= DIRTY;
-            iter++;
+            _registeredPairs[i] = _registeredPairs.back();
+            _registeredPairs.pop_back();
+            continue;
         }
+        i++;
+
+        // The pair may be listed twice if it was removed and added again.
+        if (entry->info._manifoldFrame == _collisionFrame)
+            continue;
+        entry->info._manifoldFrame = _collisionFrame;
+
+        PhysicsCollisionObject::CollisionPair pair = entry->pair;
+        btCollisionObject* objectA = pair.objectA->getCollisionObject();
+        btCollisionObject* objectB = pair.objectB->getCollisionObject();
+        GP_ASSERT(objectA && objectB);
+        if (!overlapAabbs(objectA, objectB))
+            continue;
+        if (isDispatched(_dispatcher, objectA, objectB))
+            continue;
+
+        CollisionCallback callback;
+        _world->contactPairTest(objectA, objectB, callback);
+        if (callback._colliding)
+            touchCollisionPair(pair, callback._contactPointA, callback._contactPointB);
     }
 
-    // Go through the collision status cache and perform all registered collision tests.
-    iter = _collisionStatus.begin();
-    for (; iter != _collisionStatus.end(); iter++)
+    // Only the pairs that were colliding need to be checked for the end of their collision.
+    for (size_t i = 0; i < _collidingPairs.size();)
     {
-        // If this collision pair was one that was registered for listening, then perform the collision test.
-        // (In the case where we register for all collisions with a rigid body, there will be a lot
-        // of collision pairs in the status cache that we did not explicitly register for.)
-        if ((iter->second._status & REGISTERED) != 0 && (iter->second._status & REMOVE) == 0)
+        CollisionStatusTable::Entry* entry = _collisionStatus.find(_collidingPairs[i]);
+        if (entry && entry->info._frame == _collisionFrame)
         {
-            if (iter->first.objectB)
-                _world->contactPairTest(iter->first.objectA->getCollisionObject(), iter->first.objectB->getCollisionObject(), *_collisionCallback);
-            else
-                _world->contactTest(iter->first.objectA->getCollisionObject(), *_collisionCallback);
+            i++;
+            continue;
+        }
+
+        _collidingPairs[i] = _collidingPairs.back();
+        _collidingPairs.pop_back();
+
+        // The entry may have been removed, or listed twice if it was removed and added again.
+        if (entry == NULL || (entry->info._status & COLLISION) == 0)
+            continue;
+
+        entry->info._status &= ~COLLISION;
+        if (entry->pair.objectB)
+        {
+            PhysicsCollisionObject::CollisionPair pair = entry->pair;
+            std::vector<PhysicsCollisionObject::CollisionListener*> listeners(entry->info._listeners);
+            for (size_t j = 0; j < listeners.size(); j++)
+            {
+                listeners[j]->collisionEvent(PhysicsCollisionObject::CollisionListener::NOT_COLLIDING, pair);
+            }
         }
     }
+}
 
-    // Update all the collision status cache entries.
-    iter = _collisionStatus.begin();
-    for ( ; iter != _collisionStatus.end(); iter++)
+void PhysicsController::touchCollisionPair(const PhysicsCollisionObject::CollisionPair& pair, const Vector3& contactPointA, const Vector3& contactPointB)
+{
+    // If the given collision object pair has collided in the past, then
+    // we notify the listeners only if the pair was not colliding
+    // during the previous frame. Otherwise, it's a new pair, so add a
+    // new entry to the cache with the appropriate listeners and notify them.
+    bool inserted;
+    CollisionStatusTable::Entry* entry = _collisionStatus.insert(pair, &inserted);
+    if (inserted)
     {
-        if ((iter->second._status & DIRTY) != 0)
+        // Add the appropriate listeners.
+        CollisionStatusTable::Entry* e1 = _collisionStatus.find(PhysicsCollisionObject::CollisionPair(pair.objectA, NULL));
+        if (e1)
+            entry->info._listeners.insert(entry->info._listeners.end(), e1->info._listeners.begin(), e1->info._listeners.end());
+        CollisionStatusTable::Entry* e2 = _collisionStatus.find(PhysicsCollisionObject::CollisionPair(pair.objectB, NULL));
+        if (e2)
+            entry->info._listeners.insert(entry->info._listeners.end(), e2->info._listeners.begin(), e2->info._listeners.end());
+    }
+
+    // A pair is reported once per frame, even if listeners are registered for both of its objects.
+    if (entry->info._frame == _collisionFrame)
+        return;
+    entry->info._frame = _collisionFrame;
+
+    // Fire collision event.
+    if ((entry->info._status & COLLISION) == 0)
+    {
+        entry->info._status |= COLLISION;
+        _collidingPairs.push_back(entry->pair);
+
+        if ((entry->info._status & REMOVE) == 0)
         {
-            if ((iter->second._status & COLLISION) != 0 && iter->first.objectB)
+            // Listeners may register new listeners, which can move the entry.
+            std::vector<PhysicsCollisionObject::CollisionListener*> listeners(entry->info._listeners);
+            for (size_t i = 0; i < listeners.size(); i++)
             {
-                size_t size = iter->second._listeners.size();
-                for (size_t i = 0; i < size; i++)
-                {
-                    iter->second._listeners[i]->collisionEvent(PhysicsCollisionObject::CollisionListener::NOT_COLLIDING, iter->first);
-                }
+                GP_ASSERT(listeners[i]);
+                listeners[i]->collisionEvent(PhysicsCollisionObject::CollisionListener::COLLIDING, pair, contactPointA, contactPointB);
             }
-
-            iter->second._status &= ~COLLISION;
         }
     }
+}
 
-    _isUpdating = false;
+bool PhysicsController::isWorldActive()
+{
+    // Objects stay active over many frames, so the object found active last time
+    // usually confirms the status without scanning the world. A world where all
+    // objects are asleep is still scanned every frame.
+    if (_activeObject && _activeObject->isActive())
+        return true;
+
+    _activeObject = NULL;
+    for (int i = 0; i < _world->getNumCollisionObjects(); i++)
+    {
+        const btCollisionObject* object = _world->getCollisionObjectArray()[i];
+        GP_ASSERT(object);
+        if (object->isActive())
+        {
+            _activeObject = object;
+            return true;
+        }
+    }
+    return false;
 }
 
 void PhysicsController::addCollisionListener(PhysicsCollisionObject::CollisionListener* listener, PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB)
@@ -619,8 +693,10 @@ void PhysicsController::addCollisionListener(PhysicsCollisionObject::CollisionLi
     PhysicsCollisionObject::CollisionPair pair(objectA, objectB);
 
     // Add the listener and ensure the status includes that this collision pair is registered.
-    CollisionInfo& info = _collisionStatus[pair];
+    CollisionInfo& info = _collisionStatus.insert(pair)->info;
     info._listeners.push_back(listener);
+    if (objectA && objectB && (info._status & PhysicsController::REGISTERED) == 0)
+        _registeredPairs.push_back(pair);
     info._status |= PhysicsController::REGISTERED;
 }
 
@@ -631,9 +707,11 @@ void PhysicsController::removeCollisionListener(PhysicsCollisionObject::Collisio
     PhysicsCollisionObject::CollisionPair pair(objectA, objectB);
 
     // Mark the collision pair for these objects for removal.
-    if (_collisionStatus.count(pair) > 0)
+    CollisionStatusTable::Entry* entry = _collisionStatus.find(pair);
+    if (entry && (entry->info._status & REMOVE) == 0)
     {
-        _collisionStatus[pair]._status |= REMOVE;
+        entry->info._status |= REMOVE;
+        _removedPairs.push_back(pair);
     }
 }
 
@@ -678,6 +756,9 @@ void PhysicsController::removeCollisionObject(PhysicsCollisionObject* object, bo
     // Remove the collision object from the world.
     if (object->getCollisionObject())
     {
+        if (_activeObject == object->getCollisionObject())
+            _activeObject = NULL;
+
         switch (object->getType())
         {
         case PhysicsCollisionObject::RIGID_BODY:
@@ -698,11 +779,14 @@ void PhysicsController::removeCollisionObject(PhysicsCollisionObject* object, bo
     // Find all references to the object in the collision status cache and mark them for removal.
     if (removeListeners)
     {
-        std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo>::iterator iter = _collisionStatus.begin();
-        for (; iter != _collisionStatus.end(); iter++)
+        for (unsigned int i = 0; i < _collisionStatus.getCapacity(); i++)
         {
-            if (iter->first.objectA == object || iter->first.objectB == object)
-                iter->second._status |= REMOVE;
+            CollisionStatusTable::Entry& entry = _collisionStatus.getSlot(i);
+            if (entry.used && (entry.pair.objectA == object || entry.pair.objectB == object) && (entry.info._status & REMOVE) == 0)
+            {
+                entry.info._status |= REMOVE;
+                _removedPairs.push_back(entry.pair);
+            }
         }
     }
 }
@@ -714,6 +798,135 @@ PhysicsCollisionObject* PhysicsController::getCollisionObject(const btCollisionO
     return reinterpret_cast<PhysicsCollisionObject*>(collisionObject->getUserPointer());
 }
 
+PhysicsController::CollisionStatusTable::CollisionStatusTable()
+    : _size(0)
+{
+}
+
+PhysicsController::CollisionStatusTable::Entry* PhysicsController::CollisionStatusTable::find(const PhysicsCollisionObject::CollisionPair& pair)
+{
+    if (_size == 0)
+        return NULL;
+
+    Entry& entry = _slots[findSlot(pair)];
+    return entry.used ? &entry : NULL;
+}
+
+PhysicsController::CollisionStatusTable::Entry* PhysicsController::CollisionStatusTable::insert(const PhysicsCollisionObject::CollisionPair& pair, bool* inserted)
+{
+    // Keep the table at most half full so that probe sequences stay short.
+    if ((_size + 1) * 2 > _slots.size())
+        grow();
+
+    Entry& entry = _slots[findSlot(pair)];
+    if (inserted)
+        *inserted = !entry.used;
+    if (!entry.used)
+    {
+        entry.pair = pair;
+        entry.used = true;
+        _size++;
+    }
+    return &entry;
+}
+
+void PhysicsController::CollisionStatusTable::erase(const PhysicsCollisionObject::CollisionPair& pair)
+{
+    if (_size == 0)
+        return;
+
+    unsigned int mask = (unsigned int)_slots.size() - 1;
+    unsigned int i = findSlot(pair);
+    if (!_slots[i].used)
+        return;
+
+    // Shift the following entries of the probe sequence back into the hole so that
+    // lookups never need tombstones.
+    unsigned int j = i;
+    for (;;)
+    {
+        j = (j + 1) & mask;
+        if (!_slots[j].used)
+            break;
+
+        // Leave the entry if its home slot lies cyclically within (i, j].
+        unsigned int k = hash(_slots[j].pair) & mask;
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+
+        std::swap(_slots[i], _slots[j]);
+        i = j;
+    }
+    _slots[i] = Entry();
+    _size--;
+}
+
+unsigned int PhysicsController::CollisionStatusTable::size() const
+{
+    return _size;
+}
+
+unsigned int PhysicsController::CollisionStatusTable::getCapacity() const
+{
+    return (unsigned int)_slots.size();
+}
+
+PhysicsController::CollisionStatusTable::Entry& PhysicsController::CollisionStatusTable::getSlot(unsigned int index)
+{
+    GP_ASSERT(index < _slots.size());
+    return _slots[index];
+}
+
+unsigned int PhysicsController::CollisionStatusTable::hash(const PhysicsCollisionObject::CollisionPair& pair)
+{
+    // Order the objects so that (A, B) and (B, A) hash the same.
+    size_t a = (size_t)pair.objectA;
+    size_t b = (size_t)pair.objectB;
+    if (a > b)
+        std::swap(a, b);
+
+    // The low bits of the pointers are always zero (alignment).
+    size_t h = (a >> 3) * 2654435761u + (b >> 3);
+    h ^= h >> 15;
+    h *= 2246822519u;
+    h ^= h >> 13;
+    return (unsigned int)h;
+}
+
+unsigned int PhysicsController::CollisionStatusTable::findSlot(const PhysicsCollisionObject::CollisionPair& pair) const
+{
+    GP_ASSERT(!_slots.empty());
+
+    unsigned int mask = (unsigned int)_slots.size() - 1;
+    unsigned int i = hash(pair) & mask;
+    while (_slots[i].used)
+    {
+        const PhysicsCollisionObject::CollisionPair& p = _slots[i].pair;
+        if ((p.objectA == pair.objectA && p.objectB == pair.objectB) || (p.objectA == pair.objectB && p.objectB == pair.objectA))
+            break;
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void PhysicsController::CollisionStatusTable::grow()
+{
+    std::vector<Entry> slots(_slots.empty() ? 32 : _slots.size() * 2);
+    slots.swap(_slots);
+
+    unsigned int mask = (unsigned int)_slots.size() - 1;
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+        if (!slots[i].used)
+            continue;
+
+        unsigned int j = hash(slots[i].pair) & mask;
+        while (_slots[j].used)
+            j = (j + 1) & mask;
+        std::swap(_slots[j], slots[i]);
+    }
+}
+
 static void getBoundingBox(Node* node, BoundingBox* out, bool merge = false)
 {
     GP_ASSERT(node);
@@ -894,10 +1107,13 @@ PhysicsCollisionShape* PhysicsController::createShape(Node* node, const PhysicsC
             else
             {
                 // Build the heightfield from an attached terrain's height array
-                if (dynamic_cast<Terrain*>(node->getDrawable()) == NULL)
+                Terrain* terrain = dynamic_cast<Terrain*>(node->getDrawable());
+                if (terrain == NULL)
                     GP_ERROR("Empty heightfield collision shapes can only be used on nodes that have an attached Terrain.");
+                else if (terrain->isTiled())
+                    collisionShape = createTiledHeightfield(node, terrain, centerOfMassOffset);
                 else
-                    collisionShape = createHeightfield(node, dynamic_cast<Terrain*>(node->getDrawable())->_heightfield, centerOfMassOffset);
+                    collisionShape = createHeightfield(node, terrain->_heightfield, centerOfMassOffset);
             }
         }
         break;
@@ -1057,6 +1273,7 @@ PhysicsCollisionShape* PhysicsController::createHeightfield(Node* node, HeightFi
     heightfieldData->inverseIsDirty = true;
     heightfieldData->minHeight = minHeight;
     heightfieldData->maxHeight = maxHeight;
+    heightfieldData->terrain = NULL;
 
     // Create the bullet terrain shape
     btHeightfieldTerrainShape* terrainShape = bullet_new<btHeightfieldTerrainShape>(
@@ -1074,6 +1291,41 @@ PhysicsCollisionShape* PhysicsController::createHeightfield(Node* node, HeightFi
     return shape;
 }
 
+PhysicsCollisionShape* PhysicsController::createTiledHeightfield(Node* node, Terrain* terrain, Vector3* centerOfMassOffset)
+{
+    GP_ASSERT(node);
+    GP_ASSERT(terrain);
+    GP_ASSERT(centerOfMassOffset);
+
+    // Compute initial heightfield scale from the world scale and the terrain's local scale
+    Vector3 scale;
+    node->getWorldMatrix().getScale(&scale);
+    const Vector3& tScale = terrain->_localScale;
+    scale.set(scale.x * tScale.x, scale.y * tScale.y, scale.z * tScale.z);
+
+    // The heightfields of the tiles are positioned within a compound shape as the terrain
+    // loads and evicts them, so the shape needs no center of mass offset.
+    centerOfMassOffset->set(0, 0, 0);
+
+    PhysicsCollisionShape::HeightfieldData* heightfieldData = new PhysicsCollisionShape::HeightfieldData();
+    heightfieldData->heightfield = NULL;
+    heightfieldData->inverseIsDirty = true;
+    heightfieldData->minHeight = 0.0f;
+    heightfieldData->maxHeight = 0.0f;
+    heightfieldData->terrain = terrain;
+
+    btCompoundShape* compoundShape = bullet_new<btCompoundShape>();
+    compoundShape->setLocalScaling(BV(scale));
+
+    PhysicsCollisionShape* shape = new PhysicsCollisionShape(PhysicsCollisionShape::SHAPE_HEIGHTFIELD, compoundShape);
+    shape->_shapeData.heightfieldData = heightfieldData;
+    terrain->setCollisionShape(shape);
+
+    _shapes.push_back(shape);
+
+    return shape;
+}
+
 PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3& scale, bool dynamic)
 {
     GP_ASSERT(mesh);
@@ -1136,9 +1388,8 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
     int vertexStride = data->vertexFormat.getVertexSize();
     for (unsigned int i = 0; i < data->vertexCount; i++)
     {
-        v.set(*((float*)&data->vertexData[i * vertexStride + 0 * sizeof(float)]),
-                *((float*)&data->vertexData[i * vertexStride + 1 * sizeof(float)]),
-                *((float*)&data->vertexData[i * vertexStride + 2 * sizeof(float)]));
+        // Vertex data of a memory-mapped bundle is not necessarily aligned.
+        memcpy(&v.x, &data->vertexData[i * vertexStride], sizeof(float) * 3);
         v *= m;
         memcpy(&(shapeMeshData->vertexData[i * 3]), &v, sizeof(float) * 3);
     }
@@ -1200,8 +1451,19 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
 
                 // Move the index data into the rigid body's local buffer.
                 // Set it to NULL in the MeshPartData so it is not released when the data is freed.
-                shapeMeshData->indexData.push_back(meshPart->indexData);
-                meshPart->indexData = NULL;
+                // Index data that points into a memory-mapped bundle is copied instead.
+                if (data->mapping)
+                {
+                    unsigned int indexByteCount = meshPart->indexCount * indexStride;
+                    unsigned char* indexData = new unsigned char[indexByteCount];
+                    memcpy(indexData, meshPart->indexData, indexByteCount);
+                    shapeMeshData->indexData.push_back(indexData);
+                }
+                else
+                {
+                    shapeMeshData->indexData.push_back(meshPart->indexData);
+                    meshPart->indexData = NULL;
+                }
 
                 // Create a btIndexedMesh object for the current mesh part.
                 btIndexedMesh indexedMesh;
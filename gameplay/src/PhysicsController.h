@@ -16,6 +16,7 @@ namespace gameplay
 {
 
 class ScriptListener;
+class Terrain;
 
 /**
  * Defines a class for controlling game physics.
@@ -343,42 +344,131 @@ public:
 
 private:
 
+    // Internal constants for the collision status cache.
+    static const int COLLISION;
+    static const int REGISTERED;
+    static const int REMOVE;
+
+    // Represents the collision listeners and status for a given collision pair (used by the collision status cache).
+    struct CollisionInfo
+    {
+        CollisionInfo() : _status(0), _frame(0), _manifoldFrame(0) { }
+
+        std::vector<PhysicsCollisionObject::CollisionListener*> _listeners;
+        int _status;
+        unsigned int _frame;
+        unsigned int _manifoldFrame;
+    };
+
     /**
      * Internal class used to integrate with Bullet collision callbacks.
+     *
+     * Records the first penetrating contact point found by a contact test.
      */
     class CollisionCallback : public btCollisionWorld::ContactResultCallback
     {
     public:
+
         /**
          * Constructor.
-         * 
-         * @param pc The physics controller that owns the callback.
          */
-        CollisionCallback(PhysicsController* pc) : _pc(pc) {}
+        CollisionCallback() : _colliding(false) {}
+
+        bool _colliding;
+        Vector3 _contactPointA;
+        Vector3 _contactPointB;
 
     protected:
+
+        /**
+         * Internal function used for Bullet integration (do not use or override).
+         */
+        btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* a, int partIdA, int indexA, const btCollisionObjectWrapper* b, int partIdB, int indexB);
+    };
+
+    /**
+     * Open-addressed hash table of the collision status of collision pairs.
+     *
+     * Pairs are hashed independently of the order of their objects, so (A, B) and (B, A)
+     * share the same entry. Entry pointers remain valid until the next insertion or removal.
+     */
+    class CollisionStatusTable
+    {
+    public:
+
+        /**
+         * An entry of the table.
+         */
+        struct Entry
+        {
+            Entry() : pair(NULL, NULL), used(false) { }
+
+            PhysicsCollisionObject::CollisionPair pair;
+            CollisionInfo info;
+            bool used;
+        };
+
+        /**
+         * Constructor.
+         */
+        CollisionStatusTable();
+
+        /**
+         * Finds the entry of the given pair.
+         *
+         * @return The entry, or NULL if the pair is not in the table.
+         */
+        Entry* find(const PhysicsCollisionObject::CollisionPair& pair);
+
         /**
-            * Internal function used for Bullet integration (do not use or override).
-            */
-        btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* a, int partIdA, int indexA, const btCollisionObjectWrapper* b, int partIdB, int indexB);    
+         * Finds the entry of the given pair, adding it if the pair is not in the table.
+         *
+         * @param pair The pair.
+         * @param inserted Optionally set to whether the entry was added.
+         *
+         * @return The entry.
+         */
+        Entry* insert(const PhysicsCollisionObject::CollisionPair& pair, bool* inserted = NULL);
+
+        /**
+         * Removes the entry of the given pair, if any.
+         */
+        void erase(const PhysicsCollisionObject::CollisionPair& pair);
+
+        /**
+         * Gets the number of entries in the table.
+         */
+        unsigned int size() const;
+
+        /**
+         * Gets the number of slots of the table (used to iterate over all entries).
+         */
+        unsigned int getCapacity() const;
+
+        /**
+         * Gets the slot at the given index (which is in use if its 'used' flag is set).
+         */
+        Entry& getSlot(unsigned int index);
 
     private:
-        PhysicsController* _pc;
-    };
 
-    // Internal constants for the collision status cache.
-    static const int DIRTY;
-    static const int COLLISION;
-    static const int REGISTERED;
-    static const int REMOVE;
+        /**
+         * Hashes the given pair independently of the order of its objects.
+         */
+        static unsigned int hash(const PhysicsCollisionObject::CollisionPair& pair);
 
-    // Represents the collision listeners and status for a given collision pair (used by the collision status cache).
-    struct CollisionInfo
-    {
-        CollisionInfo() : _status(0) { }
+        /**
+         * Gets the slot of the given pair, or the empty slot where it would be inserted.
+         */
+        unsigned int findSlot(const PhysicsCollisionObject::CollisionPair& pair) const;
 
-        std::vector<PhysicsCollisionObject::CollisionListener*> _listeners;
-        int _status;
+        /**
+         * Doubles the number of slots of the table and reinserts all entries.
+         */
+        void grow();
+
+        std::vector<Entry> _slots;
+        unsigned int _size;
     };
 
     /**
@@ -428,6 +518,21 @@ private:
     // Removes the given collision object from the simulated physics world.
     void removeCollisionObject(PhysicsCollisionObject* object, bool removeListeners);
     
+    /**
+     * Updates the collision status cache from the contact manifolds of the last simulation step.
+     */
+    void updateCollisionStatus();
+
+    /**
+     * Marks the given pair as colliding in the current frame and notifies its listeners if it just started colliding.
+     */
+    void touchCollisionPair(const PhysicsCollisionObject::CollisionPair& pair, const Vector3& contactPointA, const Vector3& contactPointB);
+
+    /**
+     * Determines whether any collision object in the world is active.
+     */
+    bool isWorldActive();
+
     // Gets the corresponding GamePlay object for the given Bullet object.
     PhysicsCollisionObject* getCollisionObject(const btCollisionObject* collisionObject) const;
 
@@ -447,6 +552,9 @@ private:
     // Creates a heightfield collision shape.
     PhysicsCollisionShape* createHeightfield(Node* node, HeightField* heightfield, Vector3* centerOfMassOffset);
 
+    // Creates a heightfield collision shape that holds the resident tiles of a tiled terrain.
+    PhysicsCollisionShape* createTiledHeightfield(Node* node, Terrain* terrain, Vector3* centerOfMassOffset);
+
     // Creates a triangle mesh collision shape.
     PhysicsCollisionShape* createMesh(Mesh* mesh, const Vector3& scale, bool dynamic);
 
@@ -555,8 +663,12 @@ private:
     Listener::EventType _status;
     std::vector<Listener*>* _listeners;
     Vector3 _gravity;
-    std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo> _collisionStatus;
-    CollisionCallback* _collisionCallback;
+    CollisionStatusTable _collisionStatus;
+    std::vector<PhysicsCollisionObject::CollisionPair> _collidingPairs;
+    std::vector<PhysicsCollisionObject::CollisionPair> _registeredPairs;
+    std::vector<PhysicsCollisionObject::CollisionPair> _removedPairs;
+    unsigned int _collisionFrame;
+    const btCollisionObject* _activeObject;
 };
 
 }
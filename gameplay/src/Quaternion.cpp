@@ -1,9 +1,18 @@
 #include "Base.h"
 #include "Quaternion.h"
+#include "MathUtil.h"
 
 namespace gameplay
 {
 
+#ifdef GP_USE_SSE
+// Selects the lanes of a where mask is set, and the lanes of b elsewhere.
+static inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+#endif
+
 Quaternion::Quaternion()
     : x(0.0f), y(0.0f), z(0.0f), w(1.0f)
 {
@@ -169,15 +178,7 @@ void Quaternion::multiply(const Quaternion& q1, const Quaternion& q2, Quaternion
 {
     GP_ASSERT(dst);
 
-    float x = q1.w * q2.x + q1.x * q2.w + q1.y * q2.z - q1.z * q2.y;
-    float y = q1.w * q2.y - q1.x * q2.z + q1.y * q2.w + q1.z * q2.x;
-    float z = q1.w * q2.z + q1.x * q2.y - q1.y * q2.x + q1.z * q2.w;
-    float w = q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z;
-
-    dst->x = x;
-    dst->y = y;
-    dst->z = z;
-    dst->w = w;
+    MathUtil::multiplyQuaternion(&q1.x, &q2.x, &dst->x);
 }
 
 void Quaternion::normalize()
@@ -432,6 +433,97 @@ void Quaternion::slerp(float q1x, float q1y, float q1z, float q1w, float q2x, fl
     *dstz = z * f1;
 }
 
+void Quaternion::slerpArray(const float* q1, const float* q2, const float* t, float* dst, unsigned int count, unsigned int stride)
+{
+    GP_ASSERT(q1 && q2 && t && dst);
+
+    unsigned int i = 0;
+#ifdef GP_USE_SSE
+    // Vectorized form of the fast slerp implementation of slerp() above.
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 ax = _mm_loadu_ps(q1 + i);
+        __m128 ay = _mm_loadu_ps(q1 + stride + i);
+        __m128 az = _mm_loadu_ps(q1 + 2 * stride + i);
+        __m128 aw = _mm_loadu_ps(q1 + 3 * stride + i);
+        __m128 bx = _mm_loadu_ps(q2 + i);
+        __m128 by = _mm_loadu_ps(q2 + stride + i);
+        __m128 bz = _mm_loadu_ps(q2 + 2 * stride + i);
+        __m128 bw = _mm_loadu_ps(q2 + 3 * stride + i);
+        __m128 s = _mm_loadu_ps(t + i);
+
+        __m128 cosTheta = _mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bw), _mm_mul_ps(ax, bx)), _mm_add_ps(_mm_mul_ps(ay, by), _mm_mul_ps(az, bz)));
+
+        // Fold theta and t.
+        __m128 alpha = _mm_or_ps(one, _mm_and_ps(_mm_cmplt_ps(cosTheta, zero), signMask));
+        __m128 halfY = _mm_add_ps(one, _mm_mul_ps(alpha, cosTheta));
+        __m128 f2b = _mm_sub_ps(s, half);
+        __m128 u = _mm_andnot_ps(signMask, f2b);
+        __m128 f2a = _mm_sub_ps(u, f2b);
+        f2b = _mm_add_ps(f2b, u);
+        u = _mm_add_ps(u, u);
+        __m128 f1 = _mm_sub_ps(one, u);
+
+        // One iteration of Newton to get 1-cos(theta / 2).
+        __m128 halfSecHalfTheta = _mm_sub_ps(_mm_set1_ps(1.09f), _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(0.476537f), _mm_mul_ps(_mm_set1_ps(0.0903321f), halfY)), halfY));
+        halfSecHalfTheta = _mm_mul_ps(halfSecHalfTheta, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(halfY, _mm_mul_ps(halfSecHalfTheta, halfSecHalfTheta))));
+        __m128 versHalfTheta = _mm_sub_ps(one, _mm_mul_ps(halfY, halfSecHalfTheta));
+
+        // Series expansions of the coefficients.
+        __m128 sqNotU = _mm_mul_ps(f1, f1);
+        __m128 ratio2 = _mm_mul_ps(_mm_set1_ps(0.0000440917108f), versHalfTheta);
+        __m128 ratio1 = _mm_add_ps(_mm_set1_ps(-0.00158730159f), _mm_mul_ps(_mm_sub_ps(sqNotU, _mm_set1_ps(16.0f)), ratio2));
+        ratio1 = _mm_add_ps(_mm_set1_ps(0.0333333333f), _mm_mul_ps(_mm_mul_ps(ratio1, _mm_sub_ps(sqNotU, _mm_set1_ps(9.0f))), versHalfTheta));
+        ratio1 = _mm_add_ps(_mm_set1_ps(-0.333333333f), _mm_mul_ps(_mm_mul_ps(ratio1, _mm_sub_ps(sqNotU, _mm_set1_ps(4.0f))), versHalfTheta));
+        ratio1 = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(ratio1, _mm_sub_ps(sqNotU, one)), versHalfTheta));
+
+        __m128 sqU = _mm_mul_ps(u, u);
+        ratio2 = _mm_add_ps(_mm_set1_ps(-0.00158730159f), _mm_mul_ps(_mm_sub_ps(sqU, _mm_set1_ps(16.0f)), ratio2));
+        ratio2 = _mm_add_ps(_mm_set1_ps(0.0333333333f), _mm_mul_ps(_mm_mul_ps(ratio2, _mm_sub_ps(sqU, _mm_set1_ps(9.0f))), versHalfTheta));
+        ratio2 = _mm_add_ps(_mm_set1_ps(-0.333333333f), _mm_mul_ps(_mm_mul_ps(ratio2, _mm_sub_ps(sqU, _mm_set1_ps(4.0f))), versHalfTheta));
+        ratio2 = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(ratio2, _mm_sub_ps(sqU, one)), versHalfTheta));
+
+        // Perform the bisection and resolve the folding.
+        f1 = _mm_mul_ps(f1, _mm_mul_ps(ratio1, halfSecHalfTheta));
+        f2a = _mm_mul_ps(f2a, ratio2);
+        f2b = _mm_mul_ps(f2b, ratio2);
+        alpha = _mm_mul_ps(alpha, _mm_add_ps(f1, f2a));
+        __m128 beta = _mm_add_ps(f1, f2b);
+
+        __m128 x = _mm_add_ps(_mm_mul_ps(alpha, ax), _mm_mul_ps(beta, bx));
+        __m128 y = _mm_add_ps(_mm_mul_ps(alpha, ay), _mm_mul_ps(beta, by));
+        __m128 z = _mm_add_ps(_mm_mul_ps(alpha, az), _mm_mul_ps(beta, bz));
+        __m128 w = _mm_add_ps(_mm_mul_ps(alpha, aw), _mm_mul_ps(beta, bw));
+
+        // Correct the length of the result.
+        __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w, w), _mm_mul_ps(x, x)), _mm_add_ps(_mm_mul_ps(y, y), _mm_mul_ps(z, z)));
+        f1 = _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(half, lengthSq));
+        x = _mm_mul_ps(x, f1);
+        y = _mm_mul_ps(y, f1);
+        z = _mm_mul_ps(z, f1);
+        w = _mm_mul_ps(w, f1);
+
+        // Return the inputs where slerp() does: q2 when t is 1, q1 when t is 0 or the quaternions are equal.
+        __m128 second = _mm_cmpeq_ps(s, one);
+        __m128 first = _mm_or_ps(_mm_cmpeq_ps(s, zero), _mm_and_ps(_mm_and_ps(_mm_cmpeq_ps(ax, bx), _mm_cmpeq_ps(ay, by)), _mm_and_ps(_mm_cmpeq_ps(az, bz), _mm_cmpeq_ps(aw, bw))));
+        _mm_storeu_ps(dst + i,              select(first, ax, select(second, bx, x)));
+        _mm_storeu_ps(dst + stride + i,     select(first, ay, select(second, by, y)));
+        _mm_storeu_ps(dst + 2 * stride + i, select(first, az, select(second, bz, z)));
+        _mm_storeu_ps(dst + 3 * stride + i, select(first, aw, select(second, bw, w)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        slerp(q1[i], q1[stride + i], q1[2 * stride + i], q1[3 * stride + i],
+              q2[i], q2[stride + i], q2[2 * stride + i], q2[3 * stride + i], t[i],
+              dst + i, dst + stride + i, dst + 2 * stride + i, dst + 3 * stride + i);
+    }
+}
+
 void Quaternion::slerpForSquad(const Quaternion& q1, const Quaternion& q2, float t, Quaternion* dst)
 {
     GP_ASSERT(dst);
@@ -42,6 +42,7 @@ class Quaternion
 {
     friend class Curve;
     friend class Transform;
+    friend class AnimationClip;
 
 public:
 
@@ -413,6 +414,24 @@ private:
     static void slerp(float q1x, float q1y, float q1z, float q1w, float q2x, float q2y, float q2z, float q2w, float t, float* dstx, float* dsty, float* dstz, float* dstw);
 
     static void slerpForSquad(const Quaternion& q1, const Quaternion& q2, float t, Quaternion* dst);
+
+    /**
+     * Interpolates between arrays of quaternions using spherical linear interpolation.
+     *
+     * The quaternions are stored as structures of arrays: the x, y, z and w components
+     * of the quaternion at index i are at i, stride + i, 2 * stride + i and 3 * stride + i.
+     * This gives the same results as slerp() on each quaternion, interpolating four
+     * quaternions at a time when SIMD instructions are available. The destination may
+     * be the same array as q1 or q2.
+     *
+     * @param q1 The first quaternions.
+     * @param q2 The second quaternions.
+     * @param t The interpolation coefficients.
+     * @param dst The array to store the results in.
+     * @param count The number of quaternions.
+     * @param stride The number of floats between two components of a quaternion.
+     */
+    static void slerpArray(const float* q1, const float* q2, const float* t, float* dst, unsigned int count, unsigned int stride);
 };
 
 }
@@ -0,0 +1,407 @@
+#include "Base.h"
+#include "RenderQueue.h"
+#include "Camera.h"
+#include "Drawable.h"
+#include "Model.h"
+#include "Node.h"
+#include "Pass.h"
+#include "Scene.h"
+
+// Layers of the sort key (its two most significant bits)
+#define LAYER_OPAQUE        0ULL
+#define LAYER_DRAWABLE      1ULL
+#define LAYER_BLENDED       2ULL
+
+// Largest pass index distinguished by the sort key
+#define PASS_INDEX_MAX      15ULL
+
+namespace gameplay
+{
+
+/**
+ * Backend issuing the graphics calls of the packets.
+ */
+class GraphicsBackend : public RenderQueue::Backend
+{
+public:
+
+    void bindEffect(Effect* effect)
+    {
+        effect->bind();
+    }
+
+    void bindPass(Pass* pass, bool bindState, bool bindSamplers)
+    {
+        pass->bindParameters(bindState, bindSamplers);
+    }
+
+    void bindVertexAttributes(VertexAttributeBinding* binding)
+    {
+        binding->bind();
+    }
+
+    void unbindVertexAttributes(VertexAttributeBinding* binding)
+    {
+        binding->unbind();
+    }
+
+    void draw(const RenderQueue::Packet& packet)
+    {
+        RenderQueue::draw(packet);
+    }
+};
+
+/**
+ * Backend issuing no graphics calls.
+ */
+class NullBackend : public RenderQueue::Backend
+{
+public:
+
+    void bindEffect(Effect* effect)
+    {
+    }
+
+    void bindPass(Pass* pass, bool bindState, bool bindSamplers)
+    {
+    }
+
+    void bindVertexAttributes(VertexAttributeBinding* binding)
+    {
+    }
+
+    void unbindVertexAttributes(VertexAttributeBinding* binding)
+    {
+    }
+
+    void draw(const RenderQueue::Packet& packet)
+    {
+    }
+};
+
+static GraphicsBackend __graphicsBackend;
+static NullBackend __nullBackend;
+
+// Folds a pointer into a 16-bit sort key.
+static unsigned long long getPointerKey(const void* pointer)
+{
+    size_t key = (size_t)pointer;
+    key ^= key >> 16;
+    key *= 2654435761u;
+    return (key >> 16) & 0xFFFF;
+}
+
+RenderQueue::RenderQueue()
+    : _backend(&__graphicsBackend), _depthScale(0), _sorted(false)
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+RenderQueue::Backend* RenderQueue::getGraphicsBackend()
+{
+    return &__graphicsBackend;
+}
+
+RenderQueue::Backend* RenderQueue::getNullBackend()
+{
+    return &__nullBackend;
+}
+
+void RenderQueue::draw(const Packet& packet)
+{
+    if (packet.model)
+    {
+        packet.model->drawPart(packet.part, packet.wireframe);
+    }
+    else
+    {
+        GP_ASSERT(packet.drawable);
+        packet.drawable->draw(packet.wireframe);
+    }
+}
+
+RenderQueue::Backend* RenderQueue::getBackend() const
+{
+    return _backend;
+}
+
+void RenderQueue::setBackend(Backend* backend)
+{
+    _backend = backend ? backend : &__graphicsBackend;
+}
+
+void RenderQueue::begin(Camera* camera)
+{
+    _packets.clear();
+    _order.clear();
+    _states.clear();
+    _stateIds.clear();
+    _sorted = false;
+
+    _cameraPosition.set(0, 0, 0);
+    _depthScale = 0;
+    if (camera)
+    {
+        if (camera->getNode())
+            _cameraPosition = camera->getNode()->getTranslationWorld();
+        if (camera->getFarPlane() > 0)
+            _depthScale = 1.0f / camera->getFarPlane();
+    }
+}
+
+void RenderQueue::submit(Scene* scene, bool wireframe)
+{
+    GP_ASSERT(scene);
+    scene->visit(this, &RenderQueue::submitNode, wireframe);
+}
+
+bool RenderQueue::submitNode(Node* node, bool wireframe)
+{
+    Drawable* drawable = node->getDrawable();
+    if (drawable)
+        drawable->submit(this, wireframe);
+    return true;
+}
+
+void RenderQueue::submit(Model* model, MeshPart* part, Pass* pass, unsigned int passIndex, bool wireframe)
+{
+    GP_ASSERT(model);
+    GP_ASSERT(pass);
+    GP_ASSERT(pass->getEffect());
+
+    Packet packet;
+    packet.pass = pass;
+    packet.effect = pass->getEffect();
+    packet.model = model;
+    packet.part = part;
+    packet.drawable = NULL;
+    packet.wireframe = wireframe;
+
+    bool blended;
+    packet.stateKey = pass->getStateKey(&blended);
+    submit(packet, passIndex, blended, getDepth(model));
+}
+
+void RenderQueue::submit(const Packet& packet, unsigned int passIndex, bool blended, float depth)
+{
+    GP_ASSERT(packet.pass);
+    GP_ASSERT(packet.effect);
+
+    // Sort key layout, from the most significant bits:
+    // opaque:  layer (2) | pass index (4) | effect (16) | textures and state (16) | depth (16)
+    // blended: layer (2) | inverted depth (16) | pass index (4) | effect (16) | textures and state (16)
+    unsigned long long passKey = std::min((unsigned long long)passIndex, PASS_INDEX_MAX);
+    unsigned long long effectKey = getPointerKey(packet.effect);
+    unsigned long long stateKey = (packet.stateKey ^ (packet.stateKey >> 16)) & 0xFFFF;
+    unsigned long long depthKey = (unsigned long long)(std::min(std::max(depth, 0.0f), 1.0f) * 65535.0f);
+
+    _packets.push_back(packet);
+    Packet& p = _packets.back();
+    p.stateId = getStateId(packet.pass, packet.stateKey);
+    if (blended)
+        p.key = (LAYER_BLENDED << 62) | ((0xFFFF - depthKey) << 46) | (passKey << 42) | (effectKey << 26) | (stateKey << 10);
+    else
+        p.key = (LAYER_OPAQUE << 62) | (passKey << 58) | (effectKey << 42) | (stateKey << 26) | (depthKey << 10);
+    _sorted = false;
+}
+
+void RenderQueue::submit(Drawable* drawable, bool wireframe)
+{
+    GP_ASSERT(drawable);
+
+    Packet packet;
+    packet.pass = NULL;
+    packet.effect = NULL;
+    packet.model = NULL;
+    packet.part = NULL;
+    packet.drawable = drawable;
+    packet.stateKey = 0;
+    packet.stateId = 0;
+    packet.wireframe = wireframe;
+
+    // Drawables drawn as a whole keep their submission order.
+    packet.key = (LAYER_DRAWABLE << 62) | (unsigned long long)_packets.size();
+
+    _packets.push_back(packet);
+    _sorted = false;
+}
+
+unsigned int RenderQueue::getPacketCount() const
+{
+    return (unsigned int)_packets.size();
+}
+
+unsigned int RenderQueue::execute()
+{
+    GP_ASSERT(_backend);
+
+    if (!_sorted)
+        sort();
+
+    _statistics = Statistics();
+
+    Effect* currentEffect = NULL;
+    Pass* currentPass = NULL;
+    unsigned int currentStateId = 0;
+    VertexAttributeBinding* currentBinding = NULL;
+    for (size_t i = 0, count = _order.size(); i < count; ++i)
+    {
+        const Packet& packet = _packets[_order[i]];
+        _statistics.packets++;
+
+        if (packet.pass == NULL)
+        {
+            // Drawables drawn as a whole bind their own state.
+            if (currentBinding)
+            {
+                _backend->unbindVertexAttributes(currentBinding);
+                currentBinding = NULL;
+            }
+            currentPass = NULL;
+            currentEffect = NULL;
+
+            _backend->draw(packet);
+            _statistics.drawCalls++;
+            continue;
+        }
+
+        Effect* effect = packet.effect;
+        bool effectChanged = effect != currentEffect;
+        if (effectChanged)
+        {
+            _backend->bindEffect(effect);
+            currentEffect = effect;
+            _statistics.effectBinds++;
+        }
+
+        // Consecutive parts drawn with the same pass share its bind. Otherwise the render state
+        // and textures are only bound if they differ from those of the pass bound last. Texture
+        // units are assigned by the effect, so the textures are bound again for a new effect.
+        Pass* pass = packet.pass;
+        if (pass != currentPass)
+        {
+            bool bindState = currentPass == NULL || packet.stateId != currentStateId;
+            bool bindSamplers = bindState || effectChanged;
+            _backend->bindPass(pass, bindState, bindSamplers);
+            currentPass = pass;
+            currentStateId = packet.stateId;
+            _statistics.passBinds++;
+            if (bindState)
+                _statistics.stateChanges++;
+            if (bindSamplers)
+                _statistics.samplerBinds++;
+        }
+
+        // Passes of models sharing a mesh and effect share their vertex attribute binding.
+        VertexAttributeBinding* binding = pass->getVertexAttributeBinding();
+        if (binding != currentBinding)
+        {
+            if (currentBinding)
+            {
+                _backend->unbindVertexAttributes(currentBinding);
+            }
+            if (binding)
+            {
+                _backend->bindVertexAttributes(binding);
+                _statistics.vertexAttributeBinds++;
+            }
+            currentBinding = binding;
+        }
+
+        _backend->draw(packet);
+        _statistics.drawCalls++;
+    }
+
+    if (currentBinding)
+    {
+        _backend->unbindVertexAttributes(currentBinding);
+    }
+
+    return _statistics.drawCalls;
+}
+
+const RenderQueue::Statistics& RenderQueue::getStatistics() const
+{
+    return _statistics;
+}
+
+float RenderQueue::getDepth(Drawable* drawable) const
+{
+    Node* node = drawable->getNode();
+    if (node == NULL || _depthScale == 0)
+        return 0;
+
+    float depth = node->getTranslationWorld().distance(_cameraPosition) * _depthScale;
+    return depth < 1.0f ? depth : 1.0f;
+}
+
+unsigned int RenderQueue::getStateId(Pass* pass, unsigned int stateKey)
+{
+    GP_ASSERT(pass);
+
+    // Passes with the same key are compared with the first pass of each state with that
+    // key, which are few and stay in the cache, so executing the queue only compares ids.
+    std::unordered_map<unsigned int, int>::iterator itr = _stateIds.find(stateKey);
+    int first = itr != _stateIds.end() ? itr->second : -1;
+    for (int id = first; id != -1; id = _states[id].next)
+    {
+        Pass* statePass = _states[id].pass;
+        if (statePass == pass || (pass->hasSameState(statePass) && pass->hasSameSamplers(statePass)))
+            return (unsigned int)id;
+    }
+
+    State state;
+    state.pass = pass;
+    state.next = first;
+    _states.push_back(state);
+    int id = (int)_states.size() - 1;
+    _stateIds[stateKey] = id;
+    return (unsigned int)id;
+}
+
+void RenderQueue::sort()
+{
+    size_t count = _packets.size();
+    _order.resize(count);
+    _sortBuffer.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        _order[i] = (unsigned int)i;
+    }
+
+    // LSD radix sort of the packet indices by key, one byte per pass (which is stable,
+    // so drawables drawn as a whole keep their order). Bytes that are the same for
+    // all the keys are skipped.
+    unsigned int histogram[256];
+    for (unsigned int shift = 0; shift < 64 && count > 1; shift += 8)
+    {
+        memset(histogram, 0, sizeof(histogram));
+        for (size_t i = 0; i < count; ++i)
+        {
+            histogram[(_packets[i].key >> shift) & 0xFF]++;
+        }
+        if (histogram[(_packets[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        unsigned int offset = 0;
+        for (unsigned int j = 0; j < 256; ++j)
+        {
+            unsigned int bucketSize = histogram[j];
+            histogram[j] = offset;
+            offset += bucketSize;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            unsigned int index = _order[i];
+            _sortBuffer[histogram[(_packets[index].key >> shift) & 0xFF]++] = index;
+        }
+        _order.swap(_sortBuffer);
+    }
+
+    _sorted = true;
+}
+
+}
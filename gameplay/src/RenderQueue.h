@@ -0,0 +1,367 @@
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include "Vector3.h"
+
+namespace gameplay
+{
+
+class Camera;
+class Drawable;
+class Effect;
+class MeshPart;
+class Model;
+class Node;
+class Pass;
+class Scene;
+class VertexAttributeBinding;
+
+/**
+ * Defines a queue of draw packets that are sorted by render state before being drawn.
+ *
+ * Drawing a scene node by node binds the effect, textures and render state of every
+ * pass of every model, even when consecutive models share them. Instead, drawables
+ * can submit one packet per pass and mesh part to a render queue while the scene
+ * is visited. The queue then sorts the packets so that packets sharing an effect,
+ * textures and render state are drawn together, and only binds the effect, render
+ * state, textures and vertex attributes that differ from those of the packet drawn
+ * before:
+ *
+ * @code
+ * _queue.begin(scene->getActiveCamera());
+ * _queue.submit(scene);
+ * _queue.execute();
+ * @endcode
+ *
+ * Opaque packets are drawn first, sorted by pass index (so that the passes of a technique
+ * are drawn in order), effect, textures, render state and then front to back. Drawables that do not submit packets of their own (such as particle
+ * emitters or text) are drawn next, in the order they were submitted. Blended packets
+ * are drawn last, back to front, and then by pass index and effect.
+ *
+ * The queue issues the actual binds and draw calls through a Backend. The null backend
+ * issues no graphics calls at all, so that the number of draw calls and binds reported
+ * by the queue statistics can be measured on machines without a GPU.
+ *
+ * @script{ignore}
+ */
+class RenderQueue
+{
+public:
+
+    /**
+     * A packet drawing a mesh part (or a whole mesh) with a single pass.
+     */
+    struct Packet
+    {
+        /**
+         * The sort key of the packet.
+         */
+        unsigned long long key;
+
+        /**
+         * The pass to draw with (NULL for drawables drawn as a whole).
+         */
+        Pass* pass;
+
+        /**
+         * The effect of the pass (NULL for drawables drawn as a whole).
+         */
+        Effect* effect;
+
+        /**
+         * The model to draw (NULL for drawables drawn as a whole).
+         */
+        Model* model;
+
+        /**
+         * The mesh part to draw, or NULL to draw the mesh vertices without indices.
+         */
+        MeshPart* part;
+
+        /**
+         * The drawable drawn as a whole (NULL for model packets).
+         */
+        Drawable* drawable;
+
+        /**
+         * Texture set and render state key (used to sort the packets).
+         */
+        unsigned int stateKey;
+
+        /**
+         * Identifies the texture set and render state of the pass within the queue (packets
+         * with the same state id share them). Set when the packet is submitted.
+         */
+        unsigned int stateId;
+
+        /**
+         * Whether to draw the wireframe only.
+         */
+        bool wireframe;
+    };
+
+    /**
+     * The numbers of packets, binds and draw calls of the last execution of the queue.
+     */
+    struct Statistics
+    {
+        /**
+         * Constructor.
+         */
+        Statistics() : packets(0), drawCalls(0), effectBinds(0), passBinds(0), stateChanges(0), samplerBinds(0), vertexAttributeBinds(0) { }
+
+        /**
+         * The number of packets executed.
+         */
+        unsigned int packets;
+
+        /**
+         * The number of draw calls issued (a drawable drawn as a whole counts as one).
+         */
+        unsigned int drawCalls;
+
+        /**
+         * The number of effects bound.
+         */
+        unsigned int effectBinds;
+
+        /**
+         * The number of passes whose material parameters were bound.
+         */
+        unsigned int passBinds;
+
+        /**
+         * The number of passes whose render state was bound.
+         */
+        unsigned int stateChanges;
+
+        /**
+         * The number of passes whose samplers were bound.
+         */
+        unsigned int samplerBinds;
+
+        /**
+         * The number of vertex attribute bindings bound.
+         */
+        unsigned int vertexAttributeBinds;
+    };
+
+    /**
+     * Issues the binds and draw calls of the packets of a render queue.
+     */
+    class Backend
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Backend() { }
+
+        /**
+         * Binds the given effect.
+         */
+        virtual void bindEffect(Effect* effect) = 0;
+
+        /**
+         * Binds the material parameters of the given pass (see Pass::bindParameters).
+         */
+        virtual void bindPass(Pass* pass, bool bindState, bool bindSamplers) = 0;
+
+        /**
+         * Binds the given vertex attribute binding.
+         */
+        virtual void bindVertexAttributes(VertexAttributeBinding* binding) = 0;
+
+        /**
+         * Unbinds the given vertex attribute binding.
+         */
+        virtual void unbindVertexAttributes(VertexAttributeBinding* binding) = 0;
+
+        /**
+         * Draws the given packet (see RenderQueue::draw).
+         */
+        virtual void draw(const Packet& packet) = 0;
+    };
+
+    /**
+     * Gets the backend issuing graphics calls (used by default).
+     *
+     * @return The graphics backend.
+     */
+    static Backend* getGraphicsBackend();
+
+    /**
+     * Gets the backend issuing no graphics calls at all.
+     *
+     * @return The null backend.
+     */
+    static Backend* getNullBackend();
+
+    /**
+     * Issues the draw calls of the given packet with the currently bound state.
+     *
+     * @param packet The packet to draw.
+     */
+    static void draw(const Packet& packet);
+
+    /**
+     * Constructor.
+     */
+    RenderQueue();
+
+    /**
+     * Destructor.
+     */
+    ~RenderQueue();
+
+    /**
+     * Gets the backend of the queue.
+     *
+     * @return The backend.
+     */
+    Backend* getBackend() const;
+
+    /**
+     * Sets the backend of the queue.
+     *
+     * @param backend The backend, or NULL to use the graphics backend.
+     */
+    void setBackend(Backend* backend);
+
+    /**
+     * Clears the queue and starts submitting the packets of a new frame.
+     *
+     * @param camera The camera the packets are drawn with (used to sort by depth), or NULL.
+     */
+    void begin(Camera* camera);
+
+    /**
+     * Submits the drawables of all the nodes of a scene.
+     *
+     * The nodes are visited in the same order as Scene::visit.
+     *
+     * @param scene The scene.
+     * @param wireframe true to draw the wireframe only.
+     */
+    void submit(Scene* scene, bool wireframe = false);
+
+    /**
+     * Submits a packet drawing the given mesh part of a model with the given pass.
+     *
+     * @param model The model.
+     * @param part The mesh part, or NULL if the mesh of the model has no parts.
+     * @param pass The pass.
+     * @param passIndex The index of the pass in its technique.
+     * @param wireframe true to draw the wireframe only.
+     */
+    void submit(Model* model, MeshPart* part, Pass* pass, unsigned int passIndex, bool wireframe = false);
+
+    /**
+     * Submits a packet whose pass, effect and state key are already set.
+     *
+     * The key and state id of the packet are computed from the given parameters and
+     * its pass. The other submit methods use this method.
+     *
+     * @param packet The packet to submit (its key and state id are ignored).
+     * @param passIndex The index of the pass in its technique.
+     * @param blended true if the pass blends with what is already drawn.
+     * @param depth The normalized distance to the camera, from 0 to 1.
+     */
+    void submit(const Packet& packet, unsigned int passIndex, bool blended, float depth);
+
+    /**
+     * Submits a drawable that is drawn as a whole by calling its draw method.
+     *
+     * @param drawable The drawable.
+     * @param wireframe true to draw the wireframe only.
+     */
+    void submit(Drawable* drawable, bool wireframe = false);
+
+    /**
+     * Gets the number of packets submitted since begin was called.
+     *
+     * @return The number of packets.
+     */
+    unsigned int getPacketCount() const;
+
+    /**
+     * Sorts and draws the submitted packets.
+     *
+     * The packets remain in the queue, so they can be executed again until begin is called
+     * (as long as the materials they are drawn with do not change).
+     *
+     * @return The number of draw calls issued.
+     */
+    unsigned int execute();
+
+    /**
+     * Gets the statistics of the last execution of the queue.
+     *
+     * @return The statistics.
+     */
+    const Statistics& getStatistics() const;
+
+private:
+
+    /**
+     * Hidden copy constructor.
+     */
+    RenderQueue(const RenderQueue& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    RenderQueue& operator=(const RenderQueue&);
+
+    /**
+     * Gets the normalized distance of a model to the camera, from 0 to 1.
+     */
+    float getDepth(Drawable* drawable) const;
+
+    /**
+     * Submits the drawable of a node (used by Scene::visit).
+     */
+    bool submitNode(Node* node, bool wireframe);
+
+    /**
+     * Gets the state id of the given pass, whose texture set and render state have the given key.
+     */
+    unsigned int getStateId(Pass* pass, unsigned int stateKey);
+
+    /**
+     * Sorts the packet order by key.
+     */
+    void sort();
+
+    /**
+     * A distinct texture set and render state of the packets.
+     */
+    struct State
+    {
+        /**
+         * The first pass submitted with this state.
+         */
+        Pass* pass;
+
+        /**
+         * The next state with the same key, or -1.
+         */
+        int next;
+    };
+
+    Backend* _backend;
+    std::vector<Packet> _packets;
+    std::vector<unsigned int> _order;
+    std::vector<unsigned int> _sortBuffer;
+    std::vector<State> _states;
+    std::unordered_map<unsigned int, int> _stateIds;
+    Vector3 _cameraPosition;
+    float _depthScale;
+    bool _sorted;
+    Statistics _statistics;
+};
+
+}
+
+#endif
@@ -401,24 +401,28 @@ const Vector3& RenderState::autoBindingGetAmbientColor() const
     return scene ? scene->getAmbientColor() : Vector3::zero();
 }
 
-void RenderState::bind(Pass* pass)
+void RenderState::bind(Pass* pass, bool bindState, bool bindSamplers)
 {
     GP_ASSERT(pass);
 
-    // Get the combined modified state bits for our RenderState hierarchy.
-    long stateOverrideBits = _state ? _state->_bits : 0;
-    RenderState* rs = _parent;
-    while (rs)
+    RenderState* rs;
+    if (bindState)
     {
-        if (rs->_state)
+        // Get the combined modified state bits for our RenderState hierarchy.
+        long stateOverrideBits = _state ? _state->_bits : 0;
+        rs = _parent;
+        while (rs)
         {
-            stateOverrideBits |= rs->_state->_bits;
+            if (rs->_state)
+            {
+                stateOverrideBits |= rs->_state->_bits;
+            }
+            rs = rs->_parent;
         }
-        rs = rs->_parent;
-    }
 
-    // Restore renderer state to its default, except for explicitly specified states
-    StateBlock::restore(stateOverrideBits);
+        // Restore renderer state to its default, except for explicitly specified states
+        StateBlock::restore(stateOverrideBits);
+    }
 
     // Apply parameter bindings and renderer state for the entire hierarchy, top-down.
     rs = NULL;
@@ -427,17 +431,75 @@ void RenderState::bind(Pass* pass)
     {
         for (size_t i = 0, count = rs->_parameters.size(); i < count; ++i)
         {
-            GP_ASSERT(rs->_parameters[i]);
-            rs->_parameters[i]->bind(effect);
+            MaterialParameter* parameter = rs->_parameters[i];
+            GP_ASSERT(parameter);
+            if (bindSamplers || (parameter->_type != MaterialParameter::SAMPLER && parameter->_type != MaterialParameter::SAMPLER_ARRAY))
+            {
+                parameter->bind(effect);
+            }
         }
 
-        if (rs->_state)
+        if (bindState && rs->_state)
         {
             rs->_state->bindNoRestore();
         }
     }
 }
 
+bool RenderState::hasSameState(const RenderState* other) const
+{
+    GP_ASSERT(other);
+
+    const RenderState* rs = this;
+    for (; rs && other; rs = rs->_parent, other = other->_parent)
+    {
+        if (!StateBlock::isEqual(rs->_state, other->_state))
+            return false;
+    }
+    return rs == NULL && other == NULL;
+}
+
+bool RenderState::hasSameSamplers(const RenderState* other) const
+{
+    GP_ASSERT(other);
+
+    const RenderState* rs = this;
+    for (; rs && other; rs = rs->_parent, other = other->_parent)
+    {
+        // Compare the samplers of both RenderStates in order, skipping the other parameters.
+        // Sampler arrays are never considered the same.
+        size_t i = 0, j = 0;
+        size_t count = rs->_parameters.size(), otherCount = other->_parameters.size();
+        while (true)
+        {
+            while (i < count && rs->_parameters[i]->_type != MaterialParameter::SAMPLER)
+            {
+                if (rs->_parameters[i]->_type == MaterialParameter::SAMPLER_ARRAY)
+                    return false;
+                i++;
+            }
+            while (j < otherCount && other->_parameters[j]->_type != MaterialParameter::SAMPLER)
+            {
+                if (other->_parameters[j]->_type == MaterialParameter::SAMPLER_ARRAY)
+                    return false;
+                j++;
+            }
+            if (i == count || j == otherCount)
+            {
+                if (i != count || j != otherCount)
+                    return false;
+                break;
+            }
+
+            const MaterialParameter* parameter = rs->_parameters[i++];
+            const MaterialParameter* otherParameter = other->_parameters[j++];
+            if (parameter->_value.samplerValue != otherParameter->_value.samplerValue || parameter->_name != otherParameter->_name)
+                return false;
+        }
+    }
+    return rs == NULL && other == NULL;
+}
+
 RenderState* RenderState::getTopmost(RenderState* below)
 {
     RenderState* rs = this;
@@ -460,6 +522,58 @@ RenderState* RenderState::getTopmost(RenderState* below)
     return NULL;
 }
 
+unsigned int RenderState::getStateKey(bool* blended) const
+{
+    GP_ASSERT(blended);
+
+    // FNV-1a over the texture handles and the explicitly set states of the hierarchy.
+    unsigned int key = 2166136261u;
+#define STATE_KEY_ADD(value) key = (key ^ (unsigned int)(value)) * 16777619u
+    *blended = false;
+    bool blendSet = false;
+    for (const RenderState* rs = this; rs; rs = rs->_parent)
+    {
+        for (size_t i = 0, count = rs->_parameters.size(); i < count; ++i)
+        {
+            Texture::Sampler* sampler = rs->_parameters[i]->getSampler();
+            if (sampler && sampler->getTexture())
+            {
+                STATE_KEY_ADD(sampler->getTexture()->getHandle());
+            }
+        }
+
+        const StateBlock* state = rs->_state;
+        if (state && state->_bits)
+        {
+            STATE_KEY_ADD(state->_bits);
+            STATE_KEY_ADD(state->_cullFaceEnabled | (state->_depthTestEnabled << 1) | (state->_depthWriteEnabled << 2) |
+                (state->_blendEnabled << 3) | (state->_stencilTestEnabled << 4));
+            STATE_KEY_ADD(state->_depthFunction);
+            STATE_KEY_ADD(state->_blendSrc);
+            STATE_KEY_ADD(state->_blendDst);
+            STATE_KEY_ADD(state->_cullFaceSide);
+            STATE_KEY_ADD(state->_frontFace);
+            STATE_KEY_ADD(state->_stencilWrite);
+            STATE_KEY_ADD(state->_stencilFunction);
+            STATE_KEY_ADD(state->_stencilFunctionRef);
+            STATE_KEY_ADD(state->_stencilFunctionMask);
+            STATE_KEY_ADD(state->_stencilOpSfail);
+            STATE_KEY_ADD(state->_stencilOpDpfail);
+            STATE_KEY_ADD(state->_stencilOpDppass);
+
+            // The state closest to the pass overrides its parents.
+            if ((state->_bits & RS_BLEND) && !blendSet)
+            {
+                *blended = state->_blendEnabled;
+                blendSet = true;
+            }
+        }
+    }
+#undef STATE_KEY_ADD
+
+    return key;
+}
+
 void RenderState::cloneInto(RenderState* renderState, NodeCloneContext& context) const
 {
     GP_ASSERT(renderState);
@@ -622,6 +736,38 @@ void RenderState::StateBlock::bindNoRestore()
     _defaultState->_bits |= _bits;
 }
 
+bool RenderState::StateBlock::isEqual(const StateBlock* a, const StateBlock* b)
+{
+    if (a == b)
+        return true;
+
+    // A missing state block sets no states, like one with no bits set.
+    long bitsA = a ? a->_bits : 0;
+    long bitsB = b ? b->_bits : 0;
+    if (bitsA != bitsB)
+        return false;
+    if (bitsA == 0)
+        return true;
+
+    return a->_cullFaceEnabled == b->_cullFaceEnabled &&
+        a->_depthTestEnabled == b->_depthTestEnabled &&
+        a->_depthWriteEnabled == b->_depthWriteEnabled &&
+        a->_depthFunction == b->_depthFunction &&
+        a->_blendEnabled == b->_blendEnabled &&
+        a->_blendSrc == b->_blendSrc &&
+        a->_blendDst == b->_blendDst &&
+        a->_cullFaceSide == b->_cullFaceSide &&
+        a->_frontFace == b->_frontFace &&
+        a->_stencilTestEnabled == b->_stencilTestEnabled &&
+        a->_stencilWrite == b->_stencilWrite &&
+        a->_stencilFunction == b->_stencilFunction &&
+        a->_stencilFunctionRef == b->_stencilFunctionRef &&
+        a->_stencilFunctionMask == b->_stencilFunctionMask &&
+        a->_stencilOpSfail == b->_stencilOpSfail &&
+        a->_stencilOpDpfail == b->_stencilOpDpfail &&
+        a->_stencilOpDppass == b->_stencilOpDppass;
+}
+
 void RenderState::StateBlock::restore(long stateOverrideBits)
 {
     GP_ASSERT(_defaultState);
@@ -23,6 +23,7 @@ class RenderState : public Ref
     friend class Technique;
     friend class Pass;
     friend class Model;
+    friend class RenderQueue;
 
 public:
 
@@ -438,6 +439,8 @@ public:
 
         static void restore(long stateOverrideBits);
 
+        static bool isEqual(const StateBlock* a, const StateBlock* b);
+
         static void enableDepthWrite();
 
         void cloneInto(StateBlock* state);
@@ -604,8 +607,12 @@ protected:
     /**
      * Binds the render state for this RenderState and any of its parents, top-down, 
      * for the given pass.
+     *
+     * @param pass The pass to bind the material parameters for.
+     * @param bindState false to leave the currently bound render state as it is.
+     * @param bindSamplers false to leave the currently bound textures as they are.
      */
-    void bind(Pass* pass);
+    void bind(Pass* pass, bool bindState = true, bool bindSamplers = true);
 
     /**
      * Returns the topmost RenderState in the hierarchy below the given RenderState.
@@ -632,6 +639,36 @@ private:
      */
     RenderState& operator=(const RenderState&);
 
+    /**
+     * Computes a key identifying the textures and render state bound by this RenderState
+     * and its parents (used to sort draw packets by state).
+     *
+     * @param blended Set to whether the resulting render state enables blending.
+     *
+     * @return The state key.
+     */
+    unsigned int getStateKey(bool* blended) const;
+
+    /**
+     * Determines whether this RenderState and its parents apply the same render state as
+     * the given RenderState and its parents (used to skip redundant state binds).
+     *
+     * @param other The RenderState to compare with.
+     *
+     * @return true if binding either RenderState applies the same render state.
+     */
+    bool hasSameState(const RenderState* other) const;
+
+    /**
+     * Determines whether this RenderState and its parents bind the same samplers to the same
+     * uniforms as the given RenderState and its parents (used to skip redundant texture binds).
+     *
+     * @param other The RenderState to compare with.
+     *
+     * @return true if binding either RenderState binds the same samplers.
+     */
+    bool hasSameSamplers(const RenderState* other) const;
+
     // Internal auto binding handler methods.
     const Matrix& autoBindingGetWorldMatrix() const;
     const Matrix& autoBindingGetViewMatrix() const;
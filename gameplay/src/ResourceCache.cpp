@@ -0,0 +1,75 @@
+#include "Base.h"
+#include "ResourceCache.h"
+
+namespace gameplay
+{
+
+// Returns the string table shared by all caches. Interned strings are never freed
+// so the keys remain valid for the lifetime of the process.
+static std::unordered_set<std::string>& getStringTable()
+{
+    static std::unordered_set<std::string> __strings;
+    return __strings;
+}
+
+ResourceCache::ResourceCache()
+{
+}
+
+ResourceCache::~ResourceCache()
+{
+}
+
+ResourceCache::Key ResourceCache::intern(const char* path)
+{
+    GP_ASSERT(path);
+
+    return &*getStringTable().insert(path).first;
+}
+
+ResourceCache::Key ResourceCache::lookup(const char* path)
+{
+    GP_ASSERT(path);
+
+    std::unordered_set<std::string>& strings = getStringTable();
+    std::unordered_set<std::string>::const_iterator itr = strings.find(path);
+    return itr == strings.end() ? NULL : &*itr;
+}
+
+Ref* ResourceCache::find(const char* path) const
+{
+    Key key = lookup(path);
+    if (key == NULL)
+        return NULL;
+
+    std::unordered_map<Key, Ref*>::const_iterator itr = _resources.find(key);
+    return itr == _resources.end() ? NULL : itr->second;
+}
+
+ResourceCache::Key ResourceCache::add(const char* path, Ref* resource)
+{
+    GP_ASSERT(resource);
+
+    Key key = intern(path);
+    _resources[key] = resource;
+    return key;
+}
+
+void ResourceCache::remove(Key key, Ref* resource)
+{
+    if (key == NULL)
+        return;
+
+    std::unordered_map<Key, Ref*>::iterator itr = _resources.find(key);
+    if (itr != _resources.end() && itr->second == resource)
+    {
+        _resources.erase(itr);
+    }
+}
+
+unsigned int ResourceCache::getCount() const
+{
+    return (unsigned int)_resources.size();
+}
+
+}
@@ -0,0 +1,110 @@
+#ifndef RESOURCECACHE_H_
+#define RESOURCECACHE_H_
+
+#include "Ref.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a hash table of shared resources (such as textures, fonts and effects)
+ * keyed by path.
+ *
+ * Paths are interned into a string table shared by all caches, so each distinct
+ * path is stored only once. Entries are keyed by the interned string, which allows
+ * a resource to remember its key and be removed without hashing its path again.
+ *
+ * @script{ignore}
+ */
+class ResourceCache
+{
+public:
+
+    /**
+     * An interned path.
+     */
+    typedef const std::string* Key;
+
+    /**
+     * Constructor.
+     */
+    ResourceCache();
+
+    /**
+     * Destructor.
+     */
+    ~ResourceCache();
+
+    /**
+     * Returns the interned string for the specified path, adding it to the string table if needed.
+     *
+     * @param path The path to intern.
+     *
+     * @return The interned path.
+     */
+    static Key intern(const char* path);
+
+    /**
+     * Finds the resource cached for the specified path.
+     *
+     * The reference count of the returned resource is not changed.
+     *
+     * @param path The path of the resource.
+     *
+     * @return The cached resource, or NULL if no resource is cached for the path.
+     */
+    Ref* find(const char* path) const;
+
+    /**
+     * Adds a resource to the cache, replacing any resource cached for the same path.
+     *
+     * The cache does not hold a reference to the resource. Resources must remove
+     * themselves from the cache when they are destroyed.
+     *
+     * @param path The path of the resource.
+     * @param resource The resource to cache.
+     *
+     * @return The interned path that the resource is cached under.
+     */
+    Key add(const char* path, Ref* resource);
+
+    /**
+     * Removes a resource from the cache.
+     *
+     * Nothing is removed if a different resource is cached under the key.
+     *
+     * @param key The interned path returned by add().
+     * @param resource The cached resource.
+     */
+    void remove(Key key, Ref* resource);
+
+    /**
+     * Gets the number of resources in the cache.
+     *
+     * @return The number of cached resources.
+     */
+    unsigned int getCount() const;
+
+private:
+
+    /**
+     * Hidden copy constructor.
+     */
+    ResourceCache(const ResourceCache& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    ResourceCache& operator=(const ResourceCache&);
+
+    /**
+     * Returns the interned string for the specified path, or NULL if the path was never interned.
+     */
+    static Key lookup(const char* path);
+
+    std::unordered_map<Key, Ref*> _resources;
+};
+
+}
+
+#endif
@@ -61,7 +61,7 @@ static bool endsWith(const char* str, const char* suffix, bool ignoreCase)
 
 Scene::Scene()
     : _id(""), _activeCamera(NULL), _firstNode(NULL), _lastNode(NULL), _nodeCount(0), _bindAudioListenerToCamera(true), 
-      _nextItr(NULL), _nextReset(true)
+      _nextItr(NULL), _nextReset(true), _transformStore(NULL), _spatialIndex(NULL)
 {
     __sceneList.push_back(this);
 }
@@ -83,6 +83,9 @@ Scene::~Scene()
     // Remove all nodes from the scene
     removeAllNodes();
 
+    SAFE_DELETE(_transformStore);
+    SAFE_DELETE(_spatialIndex);
+
     // Remove the scene from global list
     std::vector<Scene*>::iterator itr = std::find(__sceneList.begin(), __sceneList.end(), this);
     if (itr != __sceneList.end())
@@ -112,6 +115,15 @@ Scene* Scene::load(const char* filePath)
     return SceneLoader::load(filePath);
 }
 
+AsyncSceneLoader* Scene::loadAsync(const char* filePath, const AsyncSceneLoader::Callback& callback)
+{
+    GP_ASSERT(filePath);
+
+    AsyncSceneLoader* loader = new AsyncSceneLoader(filePath, callback);
+    loader->start(endsWith(filePath, ".gpb", true));
+    return loader;
+}
+
 Scene* Scene::getScene(const char* id)
 {
     if (id == NULL)
@@ -272,6 +284,15 @@ void Scene::addNode(Node* node)
 
     ++_nodeCount;
 
+    if (_transformStore)
+    {
+        _transformStore->invalidate();
+    }
+    if (_spatialIndex)
+    {
+        _spatialIndex->invalidate();
+    }
+
     // If we don't have an active camera set, then check for one and set it.
     if (_activeCamera == NULL)
     {
@@ -385,6 +406,61 @@ void Scene::setAmbientColor(float red, float green, float blue)
     _ambientColor.set(red, green, blue);
 }
 
+void Scene::setTransformStoreEnabled(bool enabled)
+{
+    if (enabled == (_transformStore != NULL))
+        return;
+
+    if (enabled)
+    {
+        // Nodes are attached to the store the next time it is updated.
+        _transformStore = new TransformStore(this);
+    }
+    else
+    {
+        for (Node* node = _firstNode; node != NULL; node = node->_nextSibling)
+        {
+            node->detachTransformStore();
+        }
+        SAFE_DELETE(_transformStore);
+    }
+}
+
+bool Scene::isTransformStoreEnabled() const
+{
+    return _transformStore != NULL;
+}
+
+TransformStore* Scene::getTransformStore() const
+{
+    return _transformStore;
+}
+
+SpatialIndex* Scene::getSpatialIndex()
+{
+    if (_spatialIndex == NULL)
+    {
+        // Nodes are attached to the index the first time it is updated.
+        _spatialIndex = new SpatialIndex(this);
+    }
+    return _spatialIndex;
+}
+
+unsigned int Scene::cull(const Frustum& frustum, std::vector<Node*>& nodes)
+{
+    return getSpatialIndex()->cull(frustum, nodes);
+}
+
+unsigned int Scene::queryRadius(const Vector3& center, float radius, std::vector<Node*>& nodes)
+{
+    return getSpatialIndex()->queryRadius(BoundingSphere(center, radius), nodes);
+}
+
+unsigned int Scene::queryRay(const Ray& ray, std::vector<Node*>& nodes, float maxDistance)
+{
+    return getSpatialIndex()->queryRay(ray, nodes, maxDistance);
+}
+
 void Scene::update(float elapsedTime)
 {
     for (Node* node = _firstNode; node != NULL; node = node->_nextSibling)
@@ -392,6 +468,12 @@ void Scene::update(float elapsedTime)
         if (node->isEnabled())
             node->update(elapsedTime);
     }
+
+    // Resolve all transforms changed during this update in one batched pass.
+    if (_transformStore)
+    {
+        _transformStore->update();
+    }
 }
 
 void Scene::reset()
@@ -6,6 +6,9 @@
 #include "ScriptController.h"
 #include "Light.h"
 #include "Model.h"
+#include "TransformStore.h"
+#include "SpatialIndex.h"
+#include "AsyncSceneLoader.h"
 
 namespace gameplay
 {
@@ -39,6 +42,24 @@ public:
      */
     static Scene* load(const char* filePath);
 
+    /**
+     * Loads a scene from the given '.scene' or '.gpb' file without stalling the game.
+     *
+     * The file is read on the game's job system and the nodes of the scene are created
+     * on the main thread over the following frames. The callback is invoked on the main
+     * thread once the scene has been loaded.
+     *
+     * @param filePath The path to the '.scene' or '.gpb' file to load from.
+     * @param callback The function invoked with the loaded scene, or NULL if the scene
+     *      could not be loaded. The callback owns a reference to the scene.
+     *
+     * @return The loader tracking the progress of the load. The caller owns a reference
+     *      to the loader and must release it when it is no longer needed.
+     * @see AsyncSceneLoader
+     * @script{ignore}
+     */
+    static AsyncSceneLoader* loadAsync(const char* filePath, const AsyncSceneLoader::Callback& callback);
+
     /**
      * Gets a currently active scene.
      *
@@ -177,6 +198,88 @@ public:
      */
     void setAmbientColor(float red, float green, float blue);
 
+    /**
+     * Enables or disables the flat transform store for this scene.
+     *
+     * When enabled, the local and world matrices of all nodes in the scene are kept
+     * in contiguous, parent-sorted arrays and world matrices are resolved in a single
+     * linear pass over the dirty ranges (once per frame from update(), or on demand
+     * when a world matrix is queried). This is significantly faster than the default
+     * lazy, per-node resolution for scenes with large numbers of nodes.
+     *
+     * The transform store is disabled by default.
+     *
+     * @param enabled true to enable the transform store, false to disable it.
+     */
+    void setTransformStoreEnabled(bool enabled);
+
+    /**
+     * Determines if the flat transform store is enabled for this scene.
+     *
+     * @return true if the transform store is enabled, false otherwise.
+     */
+    bool isTransformStoreEnabled() const;
+
+    /**
+     * Gets the flat transform store for this scene.
+     *
+     * @return The transform store, or NULL if the transform store is not enabled.
+     * @script{ignore}
+     */
+    TransformStore* getTransformStore() const;
+
+    /**
+     * Gets the spatial index of the drawables of this scene.
+     *
+     * The index is created by the first query and is then kept up to date as
+     * nodes are moved, added and removed.
+     *
+     * @return The spatial index.
+     * @script{ignore}
+     */
+    SpatialIndex* getSpatialIndex();
+
+    /**
+     * Appends the enabled nodes whose drawable intersects the given frustum.
+     *
+     * Unlike getNext(), which only culls the nodes without a drawable, light or camera,
+     * this culls every model and terrain against the frustum, using the spatial index
+     * of the scene. Drawables without bounds (such as particle emitters) are always
+     * appended.
+     *
+     * @param frustum The frustum (typically the frustum of the active camera).
+     * @param nodes The vector the visible nodes are appended to.
+     *
+     * @return The number of nodes appended.
+     * @script{ignore}
+     */
+    unsigned int cull(const Frustum& frustum, std::vector<Node*>& nodes);
+
+    /**
+     * Appends the enabled nodes whose model or terrain is within the given distance of a point.
+     *
+     * @param center The point.
+     * @param radius The distance.
+     * @param nodes The vector the nodes are appended to.
+     *
+     * @return The number of nodes appended.
+     * @script{ignore}
+     */
+    unsigned int queryRadius(const Vector3& center, float radius, std::vector<Node*>& nodes);
+
+    /**
+     * Appends the enabled nodes whose model or terrain bounds are hit by the given ray,
+     * nearest first.
+     *
+     * @param ray The ray.
+     * @param nodes The vector the nodes are appended to.
+     * @param maxDistance The maximum distance of the hits along the ray.
+     *
+     * @return The number of nodes appended.
+     * @script{ignore}
+     */
+    unsigned int queryRay(const Ray& ray, std::vector<Node*>& nodes, float maxDistance = FLT_MAX);
+
     /**
      * Updates all active nodes in the scene.
      *
@@ -308,6 +411,8 @@ private:
     bool _bindAudioListenerToCamera;
     Node* _nextItr;
     bool _nextReset;
+    TransformStore* _transformStore;
+    SpatialIndex* _spatialIndex;
 };
 
 template <class T>
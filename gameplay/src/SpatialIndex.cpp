@@ -0,0 +1,662 @@
+#include "Base.h"
+#include "SpatialIndex.h"
+#include "Scene.h"
+#include "Node.h"
+#include "Terrain.h"
+#ifdef GP_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// Margin added around the bounds of a leaf, relative to the radius of its node
+#define LEAF_MARGIN 0.25f
+
+// Height above which the tree is rebuilt, in addition to the height of a balanced tree
+#define HEIGHT_SLACK 8
+
+// Distance of the padding planes, which every volume is in front of
+#define PLANE_FAR 1.0e30f
+
+// Results of the classification of a volume against the planes of a frustum
+#define OUTSIDE -1
+#define INTERSECTING 0
+#define INSIDE 1
+
+namespace gameplay
+{
+
+struct SpatialIndex::Planes
+{
+    // Six frustum planes padded to eight: normals, distances and absolute normals.
+    float nx[8];
+    float ny[8];
+    float nz[8];
+    float d[8];
+    float ax[8];
+    float ay[8];
+    float az[8];
+
+    Planes(const Frustum& frustum)
+    {
+        const Plane* planes[6] =
+        {
+            &frustum.getNear(), &frustum.getFar(), &frustum.getLeft(),
+            &frustum.getRight(), &frustum.getBottom(), &frustum.getTop()
+        };
+        for (unsigned int i = 0; i < 8; ++i)
+        {
+            if (i < 6)
+            {
+                const Vector3& normal = planes[i]->getNormal();
+                nx[i] = normal.x;
+                ny[i] = normal.y;
+                nz[i] = normal.z;
+                d[i] = planes[i]->getDistance();
+            }
+            else
+            {
+                nx[i] = ny[i] = nz[i] = 0;
+                d[i] = PLANE_FAR;
+            }
+            ax[i] = fabsf(nx[i]);
+            ay[i] = fabsf(ny[i]);
+            az[i] = fabsf(nz[i]);
+        }
+    }
+};
+
+// The scalar classifications, which the SSE classifications are checked against in debug builds.
+#if !defined(GP_USE_SSE) || defined(_DEBUG)
+
+// Classifies a box (center and half extents) against the planes of a frustum, one plane at a time.
+static int classifyBoxScalar(const float* nx, const float* ny, const float* nz, const float* d,
+                             const float* ax, const float* ay, const float* az, const Vector3& center, const Vector3& extents)
+{
+    int result = INSIDE;
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        float distance = nx[i] * center.x + ny[i] * center.y + nz[i] * center.z + d[i];
+        float reach = ax[i] * extents.x + ay[i] * extents.y + az[i] * extents.z;
+        if (distance + reach < 0)
+            return OUTSIDE;
+        if (distance < reach)
+            result = INTERSECTING;
+    }
+    return result;
+}
+
+// Classifies a sphere against the planes of a frustum, one plane at a time.
+static int classifySphereScalar(const float* nx, const float* ny, const float* nz, const float* d, const BoundingSphere& sphere)
+{
+    int result = INSIDE;
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        float distance = nx[i] * sphere.center.x + ny[i] * sphere.center.y + nz[i] * sphere.center.z + d[i];
+        if (distance + sphere.radius < 0)
+            return OUTSIDE;
+        if (distance < sphere.radius)
+            result = INTERSECTING;
+    }
+    return result;
+}
+
+#endif
+
+// Classifies a box (center and half extents) against the planes of a frustum.
+static int classifyBox(const float* nx, const float* ny, const float* nz, const float* d,
+                       const float* ax, const float* ay, const float* az, const Vector3& center, const Vector3& extents)
+{
+#ifdef GP_USE_SSE
+    // Four planes at a time; the bits of the masks are the planes, and the padding planes always pass.
+    __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+    __m128 ex = _mm_set1_ps(extents.x), ey = _mm_set1_ps(extents.y), ez = _mm_set1_ps(extents.z);
+    int outside = 0;
+    int inside = 0;
+    for (unsigned int i = 0; i < 8; i += 4)
+    {
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(nx + i), cx), _mm_mul_ps(_mm_loadu_ps(ny + i), cy)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(nz + i), cz), _mm_loadu_ps(d + i)));
+        __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(ax + i), ex), _mm_mul_ps(_mm_loadu_ps(ay + i), ey)),
+                                  _mm_mul_ps(_mm_loadu_ps(az + i), ez));
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, reach), _mm_setzero_ps())) << i;
+        inside |= _mm_movemask_ps(_mm_cmpge_ps(distance, reach)) << i;
+    }
+    int result = outside ? OUTSIDE : ((inside & 0x3F) == 0x3F ? INSIDE : INTERSECTING);
+    GP_ASSERT(result == classifyBoxScalar(nx, ny, nz, d, ax, ay, az, center, extents));
+    return result;
+#else
+    return classifyBoxScalar(nx, ny, nz, d, ax, ay, az, center, extents);
+#endif
+}
+
+// Classifies a sphere against the planes of a frustum.
+static int classifySphere(const float* nx, const float* ny, const float* nz, const float* d, const BoundingSphere& sphere)
+{
+#ifdef GP_USE_SSE
+    // Four planes at a time; the bits of the masks are the planes, and the padding planes always pass.
+    __m128 cx = _mm_set1_ps(sphere.center.x), cy = _mm_set1_ps(sphere.center.y), cz = _mm_set1_ps(sphere.center.z);
+    __m128 radius = _mm_set1_ps(sphere.radius);
+    int outside = 0;
+    int inside = 0;
+    for (unsigned int i = 0; i < 8; i += 4)
+    {
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(nx + i), cx), _mm_mul_ps(_mm_loadu_ps(ny + i), cy)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(nz + i), cz), _mm_loadu_ps(d + i)));
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps())) << i;
+        inside |= _mm_movemask_ps(_mm_cmpge_ps(distance, radius)) << i;
+    }
+    int result = outside ? OUTSIDE : ((inside & 0x3F) == 0x3F ? INSIDE : INTERSECTING);
+    GP_ASSERT(result == classifySphereScalar(nx, ny, nz, d, sphere));
+    return result;
+#else
+    return classifySphereScalar(nx, ny, nz, d, sphere);
+#endif
+}
+
+// Returns half the surface area of a box (the cost of visiting it).
+static float getArea(const BoundingBox& box)
+{
+    float x = box.max.x - box.min.x;
+    float y = box.max.y - box.min.y;
+    float z = box.max.z - box.min.z;
+    return x * y + y * z + z * x;
+}
+
+// Returns the half surface area of the union of two boxes.
+static float getMergedArea(const BoundingBox& a, const BoundingBox& b)
+{
+    BoundingBox box(a);
+    box.merge(b);
+    return getArea(box);
+}
+
+// Returns true if the box a contains the box b.
+static bool contains(const BoundingBox& a, const BoundingBox& b)
+{
+    return a.min.x <= b.min.x && a.min.y <= b.min.y && a.min.z <= b.min.z &&
+           a.max.x >= b.max.x && a.max.y >= b.max.y && a.max.z >= b.max.z;
+}
+
+// Returns true if the sphere intersects the box.
+static bool intersects(const BoundingSphere& sphere, const BoundingBox& box)
+{
+    float dx = std::max(std::max(box.min.x - sphere.center.x, sphere.center.x - box.max.x), 0.0f);
+    float dy = std::max(std::max(box.min.y - sphere.center.y, sphere.center.y - box.max.y), 0.0f);
+    float dz = std::max(std::max(box.min.z - sphere.center.z, sphere.center.z - box.max.z), 0.0f);
+    return dx * dx + dy * dy + dz * dz <= sphere.radius * sphere.radius;
+}
+
+SpatialIndex::SpatialIndex(Scene* scene)
+    : _scene(scene), _root(-1), _freeList(-1), _layoutDirty(true)
+{
+}
+
+SpatialIndex::~SpatialIndex()
+{
+}
+
+unsigned int SpatialIndex::getNodeCount() const
+{
+    return (unsigned int)_proxies.size();
+}
+
+unsigned int SpatialIndex::getHeight() const
+{
+    return _root == -1 ? 0 : (unsigned int)_tree[_root].height + 1;
+}
+
+void SpatialIndex::invalidate()
+{
+    _layoutDirty = true;
+}
+
+void SpatialIndex::setMoved(int proxy)
+{
+    if (proxy < 0 || proxy >= (int)_proxies.size() || _proxies[proxy].moved)
+        return;
+
+    _proxies[proxy].moved = true;
+    _moved.push_back(proxy);
+}
+
+void SpatialIndex::update()
+{
+    if (_layoutDirty)
+    {
+        rebuild();
+        return;
+    }
+    if (_moved.empty())
+        return;
+
+    for (size_t i = 0, count = _moved.size(); i < count; ++i)
+    {
+        Proxy& proxy = _proxies[_moved[i]];
+        proxy.moved = false;
+        proxy.node->computeBounds(&proxy.bounds);
+
+        // Nodes that are still within the margin of their leaf stay where they are.
+        BoundingBox box;
+        box.set(proxy.bounds);
+        if (contains(_tree[proxy.leaf].box, box))
+            continue;
+
+        removeLeaf(proxy.leaf);
+        getFatBox(proxy.bounds, &_tree[proxy.leaf].box);
+        insertLeaf(proxy.leaf);
+    }
+    _moved.clear();
+
+    // Rebuild the tree if moving leaves has unbalanced it too much.
+    unsigned int balancedHeight = 0;
+    while ((1u << balancedHeight) < _proxies.size())
+    {
+        ++balancedHeight;
+    }
+    if (getHeight() > balancedHeight + HEIGHT_SLACK)
+    {
+        build();
+    }
+}
+
+void SpatialIndex::rebuild()
+{
+    _layoutDirty = false;
+
+    _proxies.clear();
+    _unbounded.clear();
+    _moved.clear();
+    for (Node* node = _scene->getFirstNode(); node != NULL; node = node->getNextSibling())
+    {
+        add(node);
+    }
+
+    build();
+}
+
+void SpatialIndex::add(Node* node)
+{
+    node->_spatialIndex = this;
+    node->_spatialProxy = -1;
+
+    Drawable* drawable = node->getDrawable();
+    if (drawable)
+    {
+        // Only the bounds of models and terrains are known.
+        Proxy proxy;
+        bool bounded = dynamic_cast<Model*>(drawable) || dynamic_cast<Terrain*>(drawable);
+        if (bounded && node->computeBounds(&proxy.bounds))
+        {
+            node->_spatialProxy = (int)_proxies.size();
+            proxy.node = node;
+            proxy.leaf = -1;
+            proxy.moved = false;
+            _proxies.push_back(proxy);
+        }
+        else
+        {
+            _unbounded.push_back(node);
+        }
+    }
+
+    // Nodes attached to the joints of a skinned model are part of the scene too.
+    Model* model = dynamic_cast<Model*>(drawable);
+    if (model && model->getSkin() && model->getSkin()->_rootNode)
+    {
+        add(model->getSkin()->_rootNode);
+    }
+
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        add(child);
+    }
+}
+
+void SpatialIndex::build()
+{
+    _tree.clear();
+    _root = -1;
+    _freeList = -1;
+
+    unsigned int count = (unsigned int)_proxies.size();
+    if (count == 0)
+        return;
+
+    std::vector<unsigned int> order(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Proxy& proxy = _proxies[i];
+        proxy.leaf = allocateNode();
+        getFatBox(proxy.bounds, &_tree[proxy.leaf].box);
+        _tree[proxy.leaf].proxy = (int)i;
+        order[i] = i;
+    }
+
+    _root = build(&order[0], &order[0] + count, -1);
+}
+
+int SpatialIndex::build(unsigned int* first, unsigned int* last, int parent)
+{
+    if (last - first == 1)
+    {
+        int leaf = _proxies[*first].leaf;
+        _tree[leaf].parent = parent;
+        return leaf;
+    }
+
+    // Split the proxies in two halves along the longest axis of their centers.
+    BoundingBox centers(_proxies[*first].bounds.center, _proxies[*first].bounds.center);
+    for (unsigned int* i = first + 1; i < last; ++i)
+    {
+        const Vector3& center = _proxies[*i].bounds.center;
+        centers.min.set(std::min(centers.min.x, center.x), std::min(centers.min.y, center.y), std::min(centers.min.z, center.z));
+        centers.max.set(std::max(centers.max.x, center.x), std::max(centers.max.y, center.y), std::max(centers.max.z, center.z));
+    }
+    Vector3 size = centers.max - centers.min;
+    int axis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+
+    unsigned int* middle = first + (last - first) / 2;
+    const std::vector<Proxy>& proxies = _proxies;
+    std::nth_element(first, middle, last, [&proxies, axis](unsigned int a, unsigned int b)
+    {
+        const Vector3& ca = proxies[a].bounds.center;
+        const Vector3& cb = proxies[b].bounds.center;
+        return axis == 0 ? ca.x < cb.x : (axis == 1 ? ca.y < cb.y : ca.z < cb.z);
+    });
+
+    int index = allocateNode();
+    int child0 = build(first, middle, index);
+    int child1 = build(middle, last, index);
+
+    TreeNode& node = _tree[index];
+    node.parent = parent;
+    node.children[0] = child0;
+    node.children[1] = child1;
+    node.box.set(_tree[child0].box);
+    node.box.merge(_tree[child1].box);
+    node.height = 1 + std::max(_tree[child0].height, _tree[child1].height);
+    return index;
+}
+
+int SpatialIndex::allocateNode()
+{
+    int index;
+    if (_freeList != -1)
+    {
+        index = _freeList;
+        _freeList = _tree[index].parent;
+    }
+    else
+    {
+        index = (int)_tree.size();
+        _tree.push_back(TreeNode());
+    }
+
+    TreeNode& node = _tree[index];
+    node.parent = -1;
+    node.children[0] = node.children[1] = -1;
+    node.proxy = -1;
+    node.height = 0;
+    return index;
+}
+
+void SpatialIndex::freeNode(int index)
+{
+    _tree[index].parent = _freeList;
+    _tree[index].height = -1;
+    _freeList = index;
+}
+
+void SpatialIndex::insertLeaf(int leaf)
+{
+    if (_root == -1)
+    {
+        _root = leaf;
+        _tree[leaf].parent = -1;
+        return;
+    }
+
+    // Descend to the sibling whose union with the leaf adds the least surface area to the tree.
+    const BoundingBox leafBox = _tree[leaf].box;
+    int index = _root;
+    while (_tree[index].proxy == -1)
+    {
+        const TreeNode& node = _tree[index];
+        float area = getArea(node.box);
+        float mergedArea = getMergedArea(node.box, leafBox);
+
+        // Cost of making a new parent for this node and the leaf, and cost of pushing the leaf further down.
+        float cost = 2.0f * mergedArea;
+        float inheritanceCost = 2.0f * (mergedArea - area);
+
+        float childCosts[2];
+        for (unsigned int i = 0; i < 2; ++i)
+        {
+            const TreeNode& child = _tree[node.children[i]];
+            childCosts[i] = getMergedArea(child.box, leafBox) + inheritanceCost;
+            if (child.proxy == -1)
+            {
+                childCosts[i] -= getArea(child.box);
+            }
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+            break;
+
+        index = childCosts[0] < childCosts[1] ? node.children[0] : node.children[1];
+    }
+
+    int sibling = index;
+    int oldParent = _tree[sibling].parent;
+    int newParent = allocateNode();
+
+    TreeNode& parent = _tree[newParent];
+    parent.parent = oldParent;
+    parent.children[0] = sibling;
+    parent.children[1] = leaf;
+    parent.box.set(_tree[sibling].box);
+    parent.box.merge(leafBox);
+    parent.height = _tree[sibling].height + 1;
+
+    if (oldParent != -1)
+    {
+        TreeNode& node = _tree[oldParent];
+        node.children[node.children[0] == sibling ? 0 : 1] = newParent;
+    }
+    else
+    {
+        _root = newParent;
+    }
+    _tree[sibling].parent = newParent;
+    _tree[leaf].parent = newParent;
+
+    refit(oldParent);
+}
+
+void SpatialIndex::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = -1;
+        return;
+    }
+
+    int parent = _tree[leaf].parent;
+    int grandParent = _tree[parent].parent;
+    int sibling = _tree[parent].children[_tree[parent].children[0] == leaf ? 1 : 0];
+
+    if (grandParent != -1)
+    {
+        TreeNode& node = _tree[grandParent];
+        node.children[node.children[0] == parent ? 0 : 1] = sibling;
+        _tree[sibling].parent = grandParent;
+        refit(grandParent);
+    }
+    else
+    {
+        _root = sibling;
+        _tree[sibling].parent = -1;
+    }
+    freeNode(parent);
+    _tree[leaf].parent = -1;
+}
+
+void SpatialIndex::refit(int index)
+{
+    while (index != -1)
+    {
+        TreeNode& node = _tree[index];
+        const TreeNode& child0 = _tree[node.children[0]];
+        const TreeNode& child1 = _tree[node.children[1]];
+        node.box.set(child0.box);
+        node.box.merge(child1.box);
+        node.height = 1 + std::max(child0.height, child1.height);
+        index = node.parent;
+    }
+}
+
+void SpatialIndex::getFatBox(const BoundingSphere& bounds, BoundingBox* box)
+{
+    GP_ASSERT(box);
+
+    float radius = bounds.radius * (1.0f + LEAF_MARGIN);
+    box->set(bounds.center.x - radius, bounds.center.y - radius, bounds.center.z - radius,
+             bounds.center.x + radius, bounds.center.y + radius, bounds.center.z + radius);
+}
+
+bool SpatialIndex::addResult(int proxy, std::vector<Node*>& nodes) const
+{
+    Node* node = _proxies[proxy].node;
+    if (!node->isEnabledInHierarchy())
+        return false;
+
+    nodes.push_back(node);
+    return true;
+}
+
+unsigned int SpatialIndex::cull(const Frustum& frustum, std::vector<Node*>& nodes)
+{
+    update();
+
+    unsigned int count = 0;
+    for (size_t i = 0, unboundedCount = _unbounded.size(); i < unboundedCount; ++i)
+    {
+        if (_unbounded[i]->isEnabledInHierarchy())
+        {
+            nodes.push_back(_unbounded[i]);
+            ++count;
+        }
+    }
+    if (_root == -1)
+        return count;
+
+    Planes planes(frustum);
+
+    // The stack holds tree node indices, with the lowest bit set for subtrees entirely inside the frustum.
+    _stack.clear();
+    _stack.push_back(_root << 1);
+    while (!_stack.empty())
+    {
+        int entry = _stack.back();
+        _stack.pop_back();
+
+        const TreeNode& node = _tree[entry >> 1];
+        bool inside = (entry & 1) != 0;
+        if (node.proxy != -1)
+        {
+            if (inside || classifySphere(planes.nx, planes.ny, planes.nz, planes.d, _proxies[node.proxy].bounds) != OUTSIDE)
+            {
+                if (addResult(node.proxy, nodes))
+                    ++count;
+            }
+            continue;
+        }
+
+        if (!inside)
+        {
+            Vector3 center = (node.box.min + node.box.max) * 0.5f;
+            Vector3 extents = (node.box.max - node.box.min) * 0.5f;
+            int result = classifyBox(planes.nx, planes.ny, planes.nz, planes.d, planes.ax, planes.ay, planes.az, center, extents);
+            if (result == OUTSIDE)
+                continue;
+            inside = (result == INSIDE);
+        }
+        _stack.push_back((node.children[0] << 1) | (inside ? 1 : 0));
+        _stack.push_back((node.children[1] << 1) | (inside ? 1 : 0));
+    }
+    return count;
+}
+
+unsigned int SpatialIndex::queryRadius(const BoundingSphere& sphere, std::vector<Node*>& nodes)
+{
+    update();
+    if (_root == -1)
+        return 0;
+
+    unsigned int count = 0;
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const TreeNode& node = _tree[_stack.back()];
+        _stack.pop_back();
+
+        if (!intersects(sphere, node.box))
+            continue;
+
+        if (node.proxy != -1)
+        {
+            if (_proxies[node.proxy].bounds.intersects(sphere) && addResult(node.proxy, nodes))
+                ++count;
+        }
+        else
+        {
+            _stack.push_back(node.children[0]);
+            _stack.push_back(node.children[1]);
+        }
+    }
+    return count;
+}
+
+unsigned int SpatialIndex::queryRay(const Ray& ray, std::vector<Node*>& nodes, float maxDistance)
+{
+    update();
+    if (_root == -1)
+        return 0;
+
+    _hits.clear();
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const TreeNode& node = _tree[_stack.back()];
+        _stack.pop_back();
+
+        float distance = ray.intersects(node.box);
+        if (distance == Ray::INTERSECTS_NONE || distance > maxDistance)
+            continue;
+
+        if (node.proxy != -1)
+        {
+            Node* hit = _proxies[node.proxy].node;
+            distance = ray.intersects(_proxies[node.proxy].bounds);
+            if (distance != Ray::INTERSECTS_NONE && distance <= maxDistance && hit->isEnabledInHierarchy())
+            {
+                _hits.push_back(std::make_pair(distance, hit));
+            }
+        }
+        else
+        {
+            _stack.push_back(node.children[0]);
+            _stack.push_back(node.children[1]);
+        }
+    }
+
+    std::sort(_hits.begin(), _hits.end());
+    for (size_t i = 0, count = _hits.size(); i < count; ++i)
+    {
+        nodes.push_back(_hits[i].second);
+    }
+    return (unsigned int)_hits.size();
+}
+
+}
@@ -0,0 +1,225 @@
+#ifndef SPATIALINDEX_H_
+#define SPATIALINDEX_H_
+
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+#include "Frustum.h"
+#include "Ray.h"
+
+namespace gameplay
+{
+
+class Scene;
+class Node;
+
+/**
+ * Defines a bounding volume hierarchy of the drawables of a scene.
+ *
+ * The index keeps the world-space bounds of every node with a model or terrain in
+ * a dynamic tree of axis-aligned boxes, so that frustum, radius and ray queries only
+ * visit the branches of the tree that can contain results, instead of every node of
+ * the scene.
+ *
+ * The index is maintained incrementally: nodes whose transform or bounds change are
+ * only marked as moved, and are moved in the tree before the next query. The leaves
+ * of the tree are slightly larger than the bounds of their node, so that nodes moving
+ * by small amounts do not need to be moved in the tree at all. Adding and removing
+ * nodes (or drawables) rebuilds the whole tree before the next query.
+ *
+ * Drawables without known bounds (such as particle emitters, text or forms) are never
+ * culled: they are always returned by frustum queries, and never by radius or ray queries.
+ *
+ * @see Scene::cull
+ * @script{ignore}
+ */
+class SpatialIndex
+{
+    friend class Scene;
+    friend class Node;
+
+public:
+
+    /**
+     * Gets the number of nodes with bounds held by the index.
+     *
+     * @return The number of nodes in the tree.
+     */
+    unsigned int getNodeCount() const;
+
+    /**
+     * Gets the height of the tree.
+     *
+     * @return The height of the tree (0 if it is empty).
+     */
+    unsigned int getHeight() const;
+
+    /**
+     * Appends the enabled nodes whose drawable intersects the given frustum.
+     *
+     * @param frustum The frustum.
+     * @param nodes The vector the visible nodes are appended to.
+     *
+     * @return The number of nodes appended.
+     */
+    unsigned int cull(const Frustum& frustum, std::vector<Node*>& nodes);
+
+    /**
+     * Appends the enabled nodes whose drawable intersects the given sphere.
+     *
+     * @param sphere The sphere.
+     * @param nodes The vector the nodes are appended to.
+     *
+     * @return The number of nodes appended.
+     */
+    unsigned int queryRadius(const BoundingSphere& sphere, std::vector<Node*>& nodes);
+
+    /**
+     * Appends the enabled nodes whose drawable bounds are hit by the given ray,
+     * sorted by the distance of the hit.
+     *
+     * @param ray The ray.
+     * @param nodes The vector the nodes are appended to.
+     * @param maxDistance The maximum distance of the hits along the ray.
+     *
+     * @return The number of nodes appended.
+     */
+    unsigned int queryRay(const Ray& ray, std::vector<Node*>& nodes, float maxDistance = FLT_MAX);
+
+    /**
+     * Rebuilds the index if nodes have been added or removed and moves the nodes
+     * that have changed in the tree.
+     *
+     * This is called automatically before each query.
+     */
+    void update();
+
+private:
+
+    /**
+     * A node of the scene held by the index.
+     */
+    struct Proxy
+    {
+        Node* node;
+        BoundingSphere bounds;
+        int leaf;
+        bool moved;
+    };
+
+    /**
+     * A node of the tree. Leaves reference a proxy, other nodes have two children.
+     */
+    struct TreeNode
+    {
+        BoundingBox box;
+        int parent;
+        int children[2];
+        int proxy;
+        int height;
+    };
+
+    /**
+     * The planes of a frustum, laid out for testing them all at once.
+     */
+    struct Planes;
+
+    /**
+     * Constructor.
+     */
+    SpatialIndex(Scene* scene);
+
+    /**
+     * Hidden copy constructor.
+     */
+    SpatialIndex(const SpatialIndex& copy);
+
+    /**
+     * Destructor.
+     */
+    ~SpatialIndex();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    SpatialIndex& operator=(const SpatialIndex&);
+
+    /**
+     * Marks the index as invalid so that it is rebuilt before the next query.
+     */
+    void invalidate();
+
+    /**
+     * Marks the proxy at the specified index as moved.
+     */
+    void setMoved(int proxy);
+
+    /**
+     * Gathers the proxies from the scene and builds the tree.
+     */
+    void rebuild();
+
+    /**
+     * Attaches the specified node and its descendants to the index.
+     */
+    void add(Node* node);
+
+    /**
+     * Builds a balanced tree of all the proxies.
+     */
+    void build();
+
+    /**
+     * Builds the subtree of the proxies in the range [first, last).
+     */
+    int build(unsigned int* first, unsigned int* last, int parent);
+
+    /**
+     * Allocates a tree node.
+     */
+    int allocateNode();
+
+    /**
+     * Frees a tree node.
+     */
+    void freeNode(int index);
+
+    /**
+     * Inserts the specified leaf in the tree.
+     */
+    void insertLeaf(int leaf);
+
+    /**
+     * Removes the specified leaf from the tree.
+     */
+    void removeLeaf(int leaf);
+
+    /**
+     * Recomputes the boxes and heights of the specified node and its ancestors.
+     */
+    void refit(int index);
+
+    /**
+     * Gets the box of a leaf enclosing the specified bounds.
+     */
+    static void getFatBox(const BoundingSphere& bounds, BoundingBox* box);
+
+    /**
+     * Appends the node of a proxy if it is enabled.
+     */
+    bool addResult(int proxy, std::vector<Node*>& nodes) const;
+
+    Scene* _scene;
+    std::vector<Proxy> _proxies;
+    std::vector<Node*> _unbounded;
+    std::vector<TreeNode> _tree;
+    std::vector<int> _moved;
+    std::vector<int> _stack;
+    std::vector<std::pair<float, Node*> > _hits;
+    int _root;
+    int _freeList;
+    bool _layoutDirty;
+};
+
+}
+
+#endif
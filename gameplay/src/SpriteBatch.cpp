@@ -355,6 +355,36 @@ void SpriteBatch::draw(SpriteBatch::SpriteVertex* vertices, unsigned int vertexC
     _batch->add(vertices, vertexCount, indices, indexCount);
 }
 
+unsigned int SpriteBatch::getVertexCount() const
+{
+    return _batch->_vertexCount;
+}
+
+unsigned int SpriteBatch::getIndexCount() const
+{
+    return _batch->_indexCount;
+}
+
+void SpriteBatch::copyVertices(unsigned int vertexStart, unsigned int indexStart, std::vector<SpriteBatch::SpriteVertex>* vertices, std::vector<unsigned short>* indices) const
+{
+    GP_ASSERT(vertices);
+    GP_ASSERT(indices);
+    GP_ASSERT(vertexStart <= _batch->_vertexCount && indexStart <= _batch->_indexCount);
+
+    const SpriteVertex* v = reinterpret_cast<const SpriteVertex*>(_batch->_vertices);
+    vertices->assign(v + vertexStart, v + _batch->_vertexCount);
+
+    // A strip added to a non-empty batch begins with two degenerate indices that join it to the
+    // previous strip, which do not belong to the copied geometry.
+    if (vertexStart > 0 && vertexStart < _batch->_vertexCount)
+        indexStart += 2;
+
+    unsigned int indexCount = _batch->_indexCount > indexStart ? _batch->_indexCount - indexStart : 0;
+    indices->resize(indexCount);
+    for (unsigned int i = 0; i < indexCount; ++i)
+        (*indices)[i] = _batch->_indices[indexStart + i] - vertexStart;
+}
+
 void SpriteBatch::draw(float x, float y, float z, float width, float height, float u1, float v1, float u2, float v2, const Vector4& color, bool positionIsCenter)
 {
     // Treat the given position as the center if the user specified it as such.
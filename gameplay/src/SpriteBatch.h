@@ -298,6 +298,35 @@ public:
      * @param indexCount The number of indices within the index array.
      */
     void draw(SpriteBatch::SpriteVertex* vertices, unsigned int vertexCount, unsigned short* indices, unsigned int indexCount);
+
+    /**
+     * Gets the number of vertices drawn into the batch since the last call to start().
+     *
+     * @return The number of vertices in the batch.
+     */
+    unsigned int getVertexCount() const;
+
+    /**
+     * Gets the number of indices drawn into the batch since the last call to start().
+     *
+     * @return The number of indices in the batch.
+     */
+    unsigned int getIndexCount() const;
+
+    /**
+     * Copies the vertices and indices drawn into the batch after the given vertex and index counts.
+     *
+     * This is for more advanced usage. The copied geometry forms a single triangle strip that can
+     * be drawn again later with draw(SpriteBatch::SpriteVertex*, unsigned int, unsigned short*, unsigned int),
+     * without recomputing (or re-clipping) the sprites it was built from.
+     *
+     * @param vertexStart The vertex count of the batch before the geometry to copy was drawn.
+     * @param indexStart The index count of the batch before the geometry to copy was drawn.
+     * @param vertices Populated with the copied vertices.
+     * @param indices Populated with the copied indices, relative to the first copied vertex.
+     * @script{ignore}
+     */
+    void copyVertices(unsigned int vertexStart, unsigned int indexStart, std::vector<SpriteBatch::SpriteVertex>* vertices, std::vector<unsigned short>* indices) const;
     
     /**
      * Finishes sprite drawing.
@@ -155,6 +155,20 @@ public:
      */
     virtual bool rewind() = 0;
 
+    /**
+     * Returns a pointer to the contents of the stream if the whole stream is
+     * available in contiguous memory, such as a memory-mapped file.
+     *
+     * This allows readers to use data directly instead of copying it with read().
+     * The pointer remains valid until the stream is closed or destroyed.
+     *
+     * @return A pointer to the first byte of the stream, or NULL if the stream
+     *         is not backed by contiguous memory.
+     *
+     * @see FileSystem::MAP
+     */
+    virtual const unsigned char* getData() { return NULL; }
+
 protected:
     Stream() {};
 private:
@@ -2,7 +2,11 @@
 #include "Terrain.h"
 #include "TerrainPatch.h"
 #include "Node.h"
+#include "Scene.h"
 #include "FileSystem.h"
+#include "Game.h"
+#include "PhysicsCollisionShape.h"
+#include "BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h"
 
 namespace gameplay
 {
@@ -22,23 +26,68 @@ static const unsigned int DEFAULT_TERRAIN_PATCH_SIZE = 32;
 //
 static const float DEFAULT_TERRAIN_HEIGHT_RATIO = 0.3f;
 
+// The default maximum screen-space error, in pixels, of the level of detail of terrain patches.
+static const float DEFAULT_TERRAIN_PIXEL_ERROR = 2.0f;
+
+// The fraction of the distance range of a level of detail at which its vertices start
+// to geomorph towards the next coarser level.
+#define TERRAIN_MORPH_START 0.5f
+
+// The default distance from the camera, in terrain units, within which the tiles of a
+// tiled terrain are loaded.
+static const float DEFAULT_TERRAIN_LOAD_DISTANCE = 1000.0f;
+
+// The default memory budget of the resident tiles of a tiled terrain, in megabytes.
+static const unsigned int DEFAULT_TERRAIN_MEMORY_BUDGET = 256;
+
+// The maximum number of tiles that are loaded concurrently.
+#define TERRAIN_MAX_TILE_LOADS 2
+
+// The maximum time, in milliseconds, spent building tile patches per frame (at least one
+// patch is built per frame while tiles are waiting).
+#define TERRAIN_TILE_BUILD_BUDGET 4.0
+
 // Terrain dirty flags
 static const unsigned int DIRTY_FLAG_INVERSE_WORLD = 1;
 
 static float getDefaultHeight(unsigned int width, unsigned int height);
 
+static void loadLayers(Terrain* terrain, Properties* properties);
+
+static std::string getTilePath(const std::string& pattern, unsigned int column, unsigned int row);
+
 Terrain::Terrain() : Drawable(),
-    _heightfield(NULL), _normalMap(NULL), _flags(FRUSTUM_CULLING | LEVEL_OF_DETAIL),
+    _heightfield(NULL), _patchColumnCount(0), _patchRowCount(0), _patchSize(0), _detailLevels(1), _skirtScale(0.0f),
+    _tileColumnCount(0), _tileRowCount(0), _tileSize(0), _loadDistance(DEFAULT_TERRAIN_LOAD_DISTANCE),
+    _memoryBudget((size_t)DEFAULT_TERRAIN_MEMORY_BUDGET * 1024 * 1024), _memoryUsage(0), _tileMemoryEstimate(0),
+    _collisionShape(NULL), _pixelError(DEFAULT_TERRAIN_PIXEL_ERROR),
+    _normalMap(NULL), _flags(FRUSTUM_CULLING | LEVEL_OF_DETAIL),
     _dirtyFlags(DIRTY_FLAG_INVERSE_WORLD)
 {
 }
 
 Terrain::~Terrain()
 {
+    // Pending tile loads hold a reference to the terrain, so all tiles are idle here.
+    if (_collisionShape)
+    {
+        GP_ASSERT(_collisionShape->_shapeData.heightfieldData);
+        _collisionShape->_shapeData.heightfieldData->terrain = NULL;
+        setCollisionShape(NULL);
+    }
+    for (size_t i = 0, count = _tiles.size(); i < count; ++i)
+    {
+        unloadTile(_tiles[i]);
+        SAFE_DELETE(_tiles[i]);
+    }
     for (size_t i = 0, count = _patches.size(); i < count; ++i)
     {
         SAFE_DELETE(_patches[i]);
     }
+    for (size_t i = 0, count = _indexSets.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_indexSets[i]);
+    }
     SAFE_RELEASE(_normalMap);
     SAFE_RELEASE(_heightfield);
 }
@@ -66,6 +115,8 @@ Terrain* Terrain::create(const char* path, Properties* properties)
     float skirtScale = 0;
     const char* normalMap = NULL;
     std::string materialPath;
+    std::string tilePath;
+    int tileColumns = 0, tileRows = 0, tileSize = 0;
 
     if (!p && path)
     {
@@ -87,9 +138,25 @@ Terrain* Terrain::create(const char* path, Properties* properties)
         return NULL;
     }
 
-    // Read heightmap info
-    Properties* pHeightmap = pTerrain->getNamespace("heightmap", true);
-    if (pHeightmap)
+    // Read tiles info
+    Properties* pTiles = pTerrain->getNamespace("tiles", true);
+    Properties* pHeightmap = pTiles ? NULL : pTerrain->getNamespace("heightmap", true);
+    if (pTiles)
+    {
+        // The tile path is a pattern, so it is not resolved as a file
+        tilePath = pTiles->getString("path", "");
+        tileColumns = pTiles->getInt("columns");
+        tileRows = pTiles->getInt("rows");
+        tileSize = pTiles->getInt("size");
+        if (tilePath.empty() || tileColumns <= 0 || tileRows <= 0 || tileSize <= 0)
+        {
+            GP_WARN("Invalid or missing 'path', 'columns', 'rows' or 'size' property in tiles section of terrain definition: %s", path);
+            if (!externalProperties)
+                SAFE_DELETE(p);
+            return NULL;
+        }
+    }
+    else if (pHeightmap)
     {
         // Read heightmap path
         std::string heightmap;
@@ -198,7 +265,7 @@ Terrain* Terrain::create(const char* path, Properties* properties)
     // Read 'material'
     materialPath = pTerrain->getString("material", "");
 
-    if (heightfield == NULL)
+    if (heightfield == NULL && !pTiles)
     {
         GP_WARN("Failed to read heightfield heights for terrain definition: %s", path);
         if (!externalProperties)
@@ -206,14 +273,21 @@ Terrain* Terrain::create(const char* path, Properties* properties)
         return NULL;
     }
 
+    // The dimensions of the terrain in heights
+    unsigned int columnCount = pTiles ? tileColumns * tileSize + 1 : heightfield->getColumnCount();
+    unsigned int rowCount = pTiles ? tileRows * tileSize + 1 : heightfield->getRowCount();
+
     if (terrainSize.isZero())
     {
-        terrainSize.set(heightfield->getColumnCount(), getDefaultHeight(heightfield->getColumnCount(), heightfield->getRowCount()), heightfield->getRowCount());
+        terrainSize.set(columnCount, getDefaultHeight(columnCount, rowCount), rowCount);
     }
 
-    if (patchSize <= 0 || patchSize > (int)heightfield->getColumnCount() || patchSize > (int)heightfield->getRowCount())
+    // Patches of tiled terrains cannot span tiles
+    unsigned int patchColumnCount = pTiles ? tileSize + 1 : columnCount;
+    unsigned int patchRowCount = pTiles ? tileSize + 1 : rowCount;
+    if (patchSize <= 0 || patchSize > (int)patchColumnCount || patchSize > (int)patchRowCount)
     {
-        patchSize = std::min(heightfield->getRowCount(), std::min(heightfield->getColumnCount(), DEFAULT_TERRAIN_PATCH_SIZE));
+        patchSize = std::min(patchRowCount, std::min(patchColumnCount, DEFAULT_TERRAIN_PATCH_SIZE));
     }
 
     if (detailLevels <= 0)
@@ -223,10 +297,33 @@ Terrain* Terrain::create(const char* path, Properties* properties)
         skirtScale = 0;
 
     // Compute terrain scale
-    Vector3 scale(terrainSize.x / (heightfield->getColumnCount()-1), terrainSize.y, terrainSize.z / (heightfield->getRowCount()-1));
+    Vector3 scale(terrainSize.x / (columnCount-1), terrainSize.y, terrainSize.z / (rowCount-1));
 
     // Create terrain
-    Terrain* terrain = create(heightfield, scale, (unsigned int)patchSize, (unsigned int)detailLevels, skirtScale, normalMap, materialPath.c_str(), pTerrain);
+    Terrain* terrain;
+    if (pTiles)
+    {
+        if (normalMap)
+            GP_WARN("Normal maps are not supported for tiled terrains: %s", path);
+        terrain = createTiled(tilePath.c_str(), (unsigned int)tileColumns, (unsigned int)tileRows, (unsigned int)tileSize,
+            scale, (unsigned int)patchSize, (unsigned int)detailLevels, skirtScale, materialPath.c_str(), pTerrain);
+
+        // Read tile streaming parameters
+        if (pTiles->exists("loadDistance"))
+            terrain->setLoadDistance(pTiles->getFloat("loadDistance"));
+        if (pTiles->exists("memoryBudget"))
+            terrain->setMemoryBudget((size_t)pTiles->getInt("memoryBudget") * 1024 * 1024);
+    }
+    else
+    {
+        terrain = create(heightfield, scale, (unsigned int)patchSize, (unsigned int)detailLevels, skirtScale, normalMap, materialPath.c_str(), pTerrain);
+    }
+
+    // Read 'pixelError'
+    if (terrain && pTerrain->exists("pixelError"))
+    {
+        terrain->setPixelError(pTerrain->getFloat("pixelError"));
+    }
 
     if (!externalProperties)
         SAFE_DELETE(p);
@@ -275,13 +372,13 @@ Terrain* Terrain::create(HeightField* heightfield, const Vector3& scale,
 
     // Create terrain patches
     unsigned int x1, x2, z1, z2;
-    unsigned int row = 0, column = 0;
+    unsigned int row = 0;
     for (unsigned int z = 0; z < height-1; z = z2, ++row)
     {
         z1 = z;
         z2 = std::min(z1 + patchSize, height-1);
 
-        for (unsigned int x = 0; x < width-1; x = x2, ++column)
+        for (unsigned int x = 0, column = 0; x < width-1; x = x2, ++column)
         {
             x1 = x;
             x2 = std::min(x1 + patchSize, width-1);
@@ -294,83 +391,74 @@ Terrain* Terrain::create(HeightField* heightfield, const Vector3& scale,
             bounds.merge(patch->getBoundingBox(false));
         }
     }
+    // A heightfield less than two samples high has no patches.
+    terrain->_patchColumnCount = row > 0 ? terrain->_patches.size() / row : 0;
+
+    terrain->_patchRowCount = row;
+    terrain->_patchGrid = terrain->_patches;
 
     // Read additional layer information from properties (if specified)
     if (properties)
-    {
-        // Parse terrain layers
-        Properties* lp;
-        int index = -1;
-        while ((lp = properties->getNextNamespace()) != NULL)
-        {
-            if (strcmp(lp->getNamespace(), "layer") == 0)
-            {
-                // If there is no explicitly specified index for this layer, assume it's the 'next' layer
-                if (lp->exists("index"))
-                    index = lp->getInt("index");
-                else
-                    ++index;
-
-                std::string textureMap;
-                const char* textureMapPtr = NULL;
-                std::string blendMap;
-                const char* blendMapPtr = NULL;
-                Vector2 textureRepeat;
-                int blendChannel = 0;
-                int row = -1, column = -1;
-                Vector4 temp;
-
-                // Read layer textures
-                Properties* t = lp->getNamespace("texture", true);
-                if (t)
-                {
-                    if (t->getPath("path", &textureMap))
-                    {
-                        textureMapPtr = textureMap.c_str();
-                    }
-                    if (!t->getVector2("repeat", &textureRepeat))
-                        textureRepeat.set(1,1);
-                }
+        loadLayers(terrain, properties);
 
-                Properties* b = lp->getNamespace("blend", true);
-                if (b)
-                {
-                    if (b->getPath("path", &blendMap))
-                    {
-                        blendMapPtr = blendMap.c_str();
-                    }
-                    const char* channel = b->getString("channel");
-                    if (channel && strlen(channel) > 0)
-                    {
-                        char c = std::toupper(channel[0]);
-                        if (c == 'R' || c == '0')
-                            blendChannel = 0;
-                        else if (c == 'G' || c == '1')
-                            blendChannel = 1;
-                        else if (c == 'B' || c == '2')
-                            blendChannel = 2;
-                        else if (c == 'A' || c == '3')
-                            blendChannel = 3;
-                    }
-                }
+    // Load materials for all patches
+    for (size_t i = 0, count = terrain->_patches.size(); i < count; ++i)
+        terrain->_patches[i]->updateMaterial();
 
-                // Get patch row/columns that this layer applies to.
-                if (lp->exists("row"))
-                    row = lp->getInt("row");
-                if (lp->exists("column"))
-                    column = lp->getInt("column");
+    return terrain;
+}
 
-                if (!terrain->setLayer(index, textureMapPtr, textureRepeat, blendMapPtr, blendChannel, row, column))
-                {
-                    GP_WARN("Failed to load terrain layer: %s", textureMap.c_str());
-                }
-            }
+Terrain* Terrain::createTiled(const char* tilePath, unsigned int tileColumns, unsigned int tileRows, unsigned int tileSize,
+    const Vector3& scale, unsigned int patchSize, unsigned int detailLevels, float skirtScale,
+    const char* materialPath, Properties* properties)
+{
+    GP_ASSERT(tilePath && tileColumns > 0 && tileRows > 0 && tileSize > 0);
+    GP_ASSERT(patchSize > 0 && patchSize <= tileSize);
+
+    Terrain* terrain = new Terrain();
+    terrain->_materialPath = (materialPath == NULL || strlen(materialPath) == 0) ? TERRAIN_MATERIAL : materialPath;
+    terrain->_localScale.set(scale);
+    terrain->_tilePath = tilePath;
+    terrain->_tileColumnCount = tileColumns;
+    terrain->_tileRowCount = tileRows;
+    terrain->_tileSize = tileSize;
+    terrain->_patchSize = patchSize;
+    terrain->_detailLevels = detailLevels;
+    terrain->_skirtScale = skirtScale;
+
+    // Patches are built as their tiles are loaded, at the same rows and columns as they would
+    // have in a single heightfield.
+    unsigned int tilePatchCount = (tileSize + patchSize - 1) / patchSize;
+    terrain->_patchColumnCount = tileColumns * tilePatchCount;
+    terrain->_patchRowCount = tileRows * tilePatchCount;
+    terrain->_patchGrid.resize(terrain->_patchColumnCount * terrain->_patchRowCount, NULL);
+    for (unsigned int row = 0; row < tileRows; ++row)
+    {
+        for (unsigned int column = 0; column < tileColumns; ++column)
+        {
+            Tile* tile = new Tile();
+            tile->row = row;
+            tile->column = column;
+            terrain->_tiles.push_back(tile);
         }
     }
 
-    // Load materials for all patches
-    for (size_t i = 0, count = terrain->_patches.size(); i < count; ++i)
-        terrain->_patches[i]->updateMaterial();
+    // Estimate the memory of a tile from its heights and the vertices of all levels, until
+    // the first tile is built.
+    size_t heightCount = (tileSize + 1) * (tileSize + 1);
+    size_t vertexCount = 0;
+    for (unsigned int i = 0; i < detailLevels; ++i)
+        vertexCount += heightCount >> (i * 2);
+    terrain->_tileMemoryEstimate = heightCount * sizeof(float) + vertexCount * 10 * sizeof(float);
+
+    // The bounds of tiled terrains cover the full range of heights
+    float halfWidth = tileColumns * tileSize * 0.5f;
+    float halfHeight = tileRows * tileSize * 0.5f;
+    terrain->_boundingBox.set(Vector3(-halfWidth * scale.x, 0.0f, -halfHeight * scale.z), Vector3(halfWidth * scale.x, scale.y, halfHeight * scale.z));
+
+    // Layers are kept to be set on the patches of each tile once it is built
+    if (properties)
+        loadLayers(terrain, properties);
 
     return terrain;
 }
@@ -429,15 +517,39 @@ bool Terrain::setLayer(int index, const char* texturePath, const Vector2& textur
     if (!texturePath)
         return false;
 
+    // Keep the layers of tiled terrains to set them on the patches of tiles that are built later
+    if (isTiled())
+    {
+        LayerDefinition layer;
+        layer.index = index;
+        layer.texturePath = texturePath;
+        layer.textureRepeat = textureRepeat;
+        layer.blendPath = blendPath ? blendPath : "";
+        layer.blendChannel = blendChannel;
+        layer.row = row;
+        layer.column = column;
+        size_t i = 0;
+        while (i < _layers.size() && _layers[i].index != index)
+            ++i;
+        if (i < _layers.size())
+            _layers[i] = layer;
+        else
+            _layers.push_back(layer);
+    }
+
     // Set layer on applicable patches
     bool result = true;
+    unsigned int tilePatchCount = isTiled() ? (_tileSize + _patchSize - 1) / _patchSize : 1;
     for (size_t i = 0, count = _patches.size(); i < count; ++i)
     {
         TerrainPatch* patch = _patches[i];
 
         if ((row == -1 || (int)patch->_row == row) && (column == -1 || (int)patch->_column == column))
         {
-            if (!patch->setLayer(index, texturePath, textureRepeat, blendPath, blendChannel))
+            std::string tileBlendPath;
+            if (isTiled() && blendPath && strstr(blendPath, "%d"))
+                tileBlendPath = getTilePath(blendPath, patch->_column / tilePatchCount, patch->_row / tilePatchCount);
+            if (!patch->setLayer(index, texturePath, textureRepeat, tileBlendPath.empty() ? blendPath : tileBlendPath.c_str(), blendChannel))
                 result = false;
         }
     }
@@ -490,6 +602,61 @@ TerrainPatch* Terrain::getPatch(unsigned int index) const
     return _patches[index];
 }
 
+void Terrain::setPixelError(float pixelError)
+{
+    GP_ASSERT(pixelError > 0.0f);
+    _pixelError = pixelError;
+}
+
+float Terrain::getPixelError() const
+{
+    return _pixelError;
+}
+
+bool Terrain::isTiled() const
+{
+    return _tileSize > 0;
+}
+
+unsigned int Terrain::getResidentTileCount() const
+{
+    if (!isTiled())
+        return 1;
+
+    unsigned int count = 0;
+    for (size_t i = 0, tileCount = _tiles.size(); i < tileCount; ++i)
+    {
+        if (_tiles[i]->state == Tile::RESIDENT)
+            ++count;
+    }
+    return count;
+}
+
+float Terrain::getLoadDistance() const
+{
+    return _loadDistance;
+}
+
+void Terrain::setLoadDistance(float distance)
+{
+    _loadDistance = distance;
+}
+
+size_t Terrain::getMemoryBudget() const
+{
+    return _memoryBudget;
+}
+
+void Terrain::setMemoryBudget(size_t budget)
+{
+    _memoryBudget = budget;
+}
+
+size_t Terrain::getMemoryUsage() const
+{
+    return _memoryUsage;
+}
+
 const BoundingBox& Terrain::getBoundingBox() const
 {
     return _boundingBox;
@@ -497,9 +664,17 @@ const BoundingBox& Terrain::getBoundingBox() const
 
 float Terrain::getHeight(float x, float z) const
 {
+    return getHeight(x, z, NULL);
+}
+
+float Terrain::getHeight(float x, float z, bool* resident) const
+{
+    if (resident)
+        *resident = true;
+
     // Calculate the correct x, z position relative to the heightfield data.
-    float cols = _heightfield->getColumnCount();
-    float rows = _heightfield->getRowCount();
+    float cols = isTiled() ? _tileColumnCount * _tileSize + 1 : _heightfield->getColumnCount();
+    float rows = isTiled() ? _tileRowCount * _tileSize + 1 : _heightfield->getRowCount();
 
     GP_ASSERT(cols > 0);
     GP_ASSERT(rows > 0);
@@ -511,8 +686,25 @@ float Terrain::getHeight(float x, float z) const
     x = v.x + (cols - 1) * 0.5f;
     z = v.z + (rows - 1) * 0.5f;
 
-    // Get the unscaled height value from the HeightField
-    float height = _heightfield->getHeight(x, z);
+    // Get the unscaled height value from the HeightField (of the tile containing the point)
+    float height;
+    if (isTiled())
+    {
+        int column = MATH_CLAMP((int)floor(x / _tileSize), 0, (int)_tileColumnCount - 1);
+        int row = MATH_CLAMP((int)floor(z / _tileSize), 0, (int)_tileRowCount - 1);
+        Tile* tile = _tiles[row * _tileColumnCount + column];
+        if (tile->state != Tile::RESIDENT)
+        {
+            if (resident)
+                *resident = false;
+            return 0.0f;
+        }
+        height = tile->heightfield->getHeight(x - column * _tileSize, z - row * _tileSize);
+    }
+    else
+    {
+        height = _heightfield->getHeight(x, z);
+    }
 
     // Apply world scale to the height value
     if (_node)
@@ -528,8 +720,511 @@ float Terrain::getHeight(float x, float z) const
     return height;
 }
 
+const TerrainPatch::IndexSet* Terrain::getIndexSet(unsigned int columns, unsigned int rows, bool skirt)
+{
+    for (size_t i = 0, count = _indexSets.size(); i < count; ++i)
+    {
+        TerrainPatch::IndexSet* indexSet = _indexSets[i];
+        if (indexSet->columns == columns && indexSet->rows == rows && indexSet->skirt == skirt)
+            return indexSet;
+    }
+    TerrainPatch::IndexSet* indexSet = TerrainPatch::createIndexSet(columns, rows, skirt);
+    _indexSets.push_back(indexSet);
+    return indexSet;
+}
+
+void Terrain::updateLevels(Camera* camera)
+{
+    GP_ASSERT(camera);
+
+    size_t patchCount = _patches.size();
+    if (!isFlagSet(LEVEL_OF_DETAIL))
+    {
+        for (size_t i = 0; i < patchCount; ++i)
+        {
+            TerrainPatch* patch = _patches[i];
+            patch->_level = 0;
+            patch->_morph = 0.0f;
+            patch->_edgeMorph.set(0.0f, 0.0f, 0.0f, 0.0f);
+            patch->_edgeMask = 0;
+        }
+        return;
+    }
+
+    // Compute the number of pixels per world unit of height at a unit distance from the
+    // camera (or at any distance for orthographic cameras).
+    GP_ASSERT(camera->getNode());
+    Vector3 cameraPosition = camera->getNode()->getTranslationWorld();
+    float heightScale = 1.0f;
+    if (_node)
+    {
+        Vector3 worldScale;
+        _node->getWorldMatrix().getScale(&worldScale);
+        heightScale = fabs(worldScale.y);
+    }
+    float viewportHeight = Game::getInstance()->getViewport().height;
+    bool perspective = camera->getCameraType() == Camera::PERSPECTIVE;
+    float pixelScale;
+    if (perspective)
+        pixelScale = viewportHeight / (2.0f * tan(MATH_DEG_TO_RAD(camera->getFieldOfView()) * 0.5f)) * heightScale;
+    else
+        pixelScale = viewportHeight / camera->getZoomY() * heightScale;
+
+    // Select the coarsest level of each patch whose projected error is within the pixel
+    // error. The inverse of the projection scale (proportional to the distance for
+    // perspective cameras) is used to geomorph the level as it approaches the next one.
+    for (size_t i = 0; i < patchCount; ++i)
+    {
+        TerrainPatch* patch = _patches[i];
+        float inverseScale = 1.0f;
+        if (perspective)
+        {
+            const BoundingBox& bounds = patch->getBoundingBox(true);
+            Vector3 closest(MATH_CLAMP(cameraPosition.x, bounds.min.x, bounds.max.x),
+                            MATH_CLAMP(cameraPosition.y, bounds.min.y, bounds.max.y),
+                            MATH_CLAMP(cameraPosition.z, bounds.min.z, bounds.max.z));
+            inverseScale = std::max(cameraPosition.distance(closest), MATH_EPSILON);
+        }
+        inverseScale /= pixelScale;
+
+        unsigned int levelCount = patch->_levels.size();
+        unsigned int level = 0;
+        while (level + 1 < levelCount && patch->_levels[level + 1]->error <= _pixelError * inverseScale)
+            ++level;
+        patch->_level = level;
+
+        patch->_morph = 0.0f;
+        if (level + 1 < levelCount)
+        {
+            float start = patch->_levels[level]->error / _pixelError;
+            float end = patch->_levels[level + 1]->error / _pixelError;
+            float f = (inverseScale - start) / (end - start);
+            patch->_morph = MATH_CLAMP((f - TERRAIN_MORPH_START) / (1.0f - TERRAIN_MORPH_START), 0.0f, 1.0f);
+        }
+    }
+
+    // Stitching requires neighboring patches to be at most one level apart, so refine the
+    // patches that are too coarse until no more change. A refined patch is fully morphed
+    // towards its next coarser level, which it would otherwise have been drawn with.
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 0; i < patchCount; ++i)
+        {
+            TerrainPatch* patch = _patches[i];
+            int row = patch->_row, column = patch->_column;
+            TerrainPatch* neighbors[4] =
+            {
+                findPatch(row - 1, column), findPatch(row + 1, column), findPatch(row, column - 1), findPatch(row, column + 1)
+            };
+            unsigned int level = patch->_level;
+            for (unsigned int e = 0; e < 4; ++e)
+            {
+                if (neighbors[e])
+                    level = std::min(level, neighbors[e]->_level + 1);
+            }
+            if (level != patch->_level)
+            {
+                patch->_level = level;
+                patch->_morph = 1.0f;
+                changed = true;
+            }
+        }
+    }
+
+    // Select the stitched edges of each patch and the morph factors of its edge vertices,
+    // which must match on both sides of an edge (previous row, next row, previous column,
+    // next column).
+    for (size_t i = 0; i < patchCount; ++i)
+    {
+        TerrainPatch* patch = _patches[i];
+        int row = patch->_row, column = patch->_column;
+        TerrainPatch* neighbors[4] =
+        {
+            findPatch(row - 1, column), findPatch(row + 1, column), findPatch(row, column - 1), findPatch(row, column + 1)
+        };
+        float edgeMorph[4];
+        patch->_edgeMask = 0;
+        for (unsigned int e = 0; e < 4; ++e)
+        {
+            TerrainPatch* neighbor = neighbors[e];
+            if (!neighbor)
+            {
+                edgeMorph[e] = patch->_morph;
+            }
+            else if (neighbor->_level == patch->_level)
+            {
+                edgeMorph[e] = std::max(patch->_morph, neighbor->_morph);
+            }
+            else if (neighbor->_level > patch->_level)
+            {
+                // Stitched to the coarser neighbor.
+                patch->_edgeMask |= (1 << e);
+                edgeMorph[e] = 1.0f;
+            }
+            else
+            {
+                // The finer neighbor is stitched to this patch.
+                edgeMorph[e] = 0.0f;
+            }
+        }
+        patch->_edgeMorph.set(edgeMorph);
+    }
+}
+
+TerrainPatch* Terrain::findPatch(int row, int column) const
+{
+    if (row < 0 || column < 0 || row >= (int)_patchRowCount || column >= (int)_patchColumnCount)
+        return NULL;
+    return _patchGrid[row * _patchColumnCount + column];
+}
+
+void Terrain::updateTiles(Camera* camera)
+{
+    GP_ASSERT(camera && camera->getNode());
+
+    // Compute the distance, in terrain units, from the camera to each tile on the X,Z plane.
+    Vector3 position = getInverseWorldMatrix() * camera->getNode()->getTranslationWorld();
+    position.x += _tileColumnCount * _tileSize * 0.5f;
+    position.z += _tileRowCount * _tileSize * 0.5f;
+    std::vector<Tile*> tiles;
+    unsigned int loadCount = 0;
+    for (size_t i = 0, count = _tiles.size(); i < count; ++i)
+    {
+        Tile* tile = _tiles[i];
+        float x1 = (float)(tile->column * _tileSize);
+        float z1 = (float)(tile->row * _tileSize);
+        float dx = std::max(std::max(x1 - position.x, position.x - (x1 + _tileSize)), 0.0f) * _localScale.x;
+        float dz = std::max(std::max(z1 - position.z, position.z - (z1 + _tileSize)), 0.0f) * _localScale.z;
+        tile->distance = sqrt(dx * dx + dz * dz);
+        if (tile->state == Tile::LOADING)
+            ++loadCount;
+        else if (tile->state == Tile::BUILDING || (tile->state == Tile::UNLOADED && tile->distance <= _loadDistance))
+            tiles.push_back(tile);
+    }
+    std::sort(tiles.begin(), tiles.end(), TileDistanceCompare());
+
+    // Start loading the nearest tiles within the load distance, evicting tiles outside of it
+    // when their memory is needed.
+    for (size_t i = 0, count = tiles.size(); i < count && loadCount < TERRAIN_MAX_TILE_LOADS; ++i)
+    {
+        Tile* tile = tiles[i];
+        if (tile->state != Tile::UNLOADED)
+            continue;
+        while (_memoryUsage + _tileMemoryEstimate > _memoryBudget && evictTile(tile->distance))
+        {
+        }
+        if (_memoryUsage + _tileMemoryEstimate > _memoryBudget && _memoryUsage > 0)
+            break;
+        loadTile(tile);
+        ++loadCount;
+    }
+
+    // Build the patches of loaded tiles, nearest first, until the frame budget is used up.
+    double start = Game::getAbsoluteTime();
+    for (size_t i = 0, count = tiles.size(); i < count; ++i)
+    {
+        Tile* tile = tiles[i];
+        while (tile->state == Tile::BUILDING)
+        {
+            buildTilePatch(tile);
+            if (Game::getAbsoluteTime() - start >= TERRAIN_TILE_BUILD_BUDGET)
+                return;
+        }
+    }
+}
+
+void Terrain::loadTile(Tile* tile)
+{
+    GP_ASSERT(tile && tile->state == Tile::UNLOADED);
+
+    // Reserve the memory of the tile until its actual size is known
+    tile->state = Tile::LOADING;
+    tile->memorySize = _tileMemoryEstimate;
+    _memoryUsage += tile->memorySize;
+
+    // Every load holds a reference to the terrain until its result is handed back on the main thread.
+    tile->pendingLoads = 1;
+    addRef();
+    JobSystem* jobSystem = Game::getInstance()->getJobSystem();
+    std::string path = getTilePath(_tilePath, tile->column, tile->row);
+    unsigned int size = _tileSize + 1;
+    jobSystem->run([this, jobSystem, tile, path, size]()
+    {
+        // RAW tiles are read from a memory mapping of the file
+        HeightField* heightfield = HeightField::createFromRAW(path.c_str(), size, size, 0, 1);
+        jobSystem->post(std::bind(&Terrain::finishHeightfieldLoad, this, tile, heightfield),
+                        std::bind(&Terrain::cancelHeightfieldLoad, this, tile, heightfield));
+    });
+
+    // Prefetch the blend maps of the tile, so that building its patches does not wait on them
+    for (size_t i = 0, count = _layers.size(); i < count; ++i)
+    {
+        const std::string& blendPath = _layers[i].blendPath;
+        if (blendPath.find("%d") != std::string::npos)
+        {
+            ++tile->pendingLoads;
+            addRef();
+            Texture::createAsync(getTilePath(blendPath, tile->column, tile->row).c_str(), true,
+                std::bind(&Terrain::finishBlendMapLoad, this, tile, std::placeholders::_1));
+        }
+    }
+}
+
+void Terrain::finishHeightfieldLoad(Tile* tile, HeightField* heightfield)
+{
+    if (heightfield && (heightfield->getColumnCount() != _tileSize + 1 || heightfield->getRowCount() != _tileSize + 1))
+    {
+        GP_WARN("Heightmap of terrain tile (%u, %u) must have %u x %u heights.", tile->column, tile->row, _tileSize + 1, _tileSize + 1);
+        SAFE_RELEASE(heightfield);
+    }
+    else if (!heightfield)
+    {
+        GP_WARN("Failed to load heightmap of terrain tile (%u, %u).", tile->column, tile->row);
+    }
+    tile->heightfield = heightfield;
+    completeTileLoad(tile);
+    release();
+}
+
+void Terrain::cancelHeightfieldLoad(Tile* tile, HeightField* heightfield)
+{
+    // The tile is given up on, as if its heights could not be read.
+    SAFE_RELEASE(heightfield);
+    completeTileLoad(tile);
+    release();
+}
+
+void Terrain::finishBlendMapLoad(Tile* tile, Texture* texture)
+{
+    // Keep the blend map in the texture cache until the patches of the tile have taken it.
+    if (texture)
+        tile->blendMaps.push_back(texture);
+    completeTileLoad(tile);
+    release();
+}
+
+void Terrain::completeTileLoad(Tile* tile)
+{
+    GP_ASSERT(tile->pendingLoads > 0);
+    if (--tile->pendingLoads > 0)
+        return;
+
+    if (tile->heightfield)
+    {
+        tile->state = Tile::BUILDING;
+    }
+    else
+    {
+        // Tiles that fail to load are not retried
+        unloadTile(tile);
+        tile->state = Tile::FAILED;
+    }
+}
+
+void Terrain::buildTilePatch(Tile* tile)
+{
+    GP_ASSERT(tile->state == Tile::BUILDING && tile->heightfield);
+
+    unsigned int tilePatchCount = (_tileSize + _patchSize - 1) / _patchSize;
+    unsigned int i = tile->patches.size();
+    unsigned int x1 = (i % tilePatchCount) * _patchSize;
+    unsigned int z1 = (i / tilePatchCount) * _patchSize;
+    unsigned int x2 = std::min(x1 + _patchSize, _tileSize);
+    unsigned int z2 = std::min(z1 + _patchSize, _tileSize);
+    unsigned int row = tile->row * tilePatchCount + i / tilePatchCount;
+    unsigned int column = tile->column * tilePatchCount + i % tilePatchCount;
+
+    // Patches are positioned in the terrain with the offset of their tile
+    float xOffset = tile->column * _tileSize - _tileColumnCount * _tileSize * 0.5f;
+    float zOffset = tile->row * _tileSize - _tileRowCount * _tileSize * 0.5f;
+    unsigned int maxStep = (unsigned int)std::pow(2.0, (double)(_detailLevels-1));
+    TerrainPatch* patch = TerrainPatch::create(this, 0, row, column, tile->heightfield->getArray(), _tileSize + 1, _tileSize + 1,
+        x1, z1, x2, z2, xOffset, zOffset, maxStep, _skirtScale);
+    tile->patches.push_back(patch);
+
+    for (size_t j = 0, count = _layers.size(); j < count; ++j)
+    {
+        const LayerDefinition& layer = _layers[j];
+        if ((layer.row == -1 || layer.row == (int)row) && (layer.column == -1 || layer.column == (int)column))
+        {
+            std::string blendPath = layer.blendPath.find("%d") != std::string::npos ? getTilePath(layer.blendPath, tile->column, tile->row) : layer.blendPath;
+            if (!patch->setLayer(layer.index, layer.texturePath.c_str(), layer.textureRepeat, blendPath.empty() ? NULL : blendPath.c_str(), layer.blendChannel))
+                GP_WARN("Failed to load terrain layer: %s", layer.texturePath.c_str());
+        }
+    }
+
+    if (tile->patches.size() == tilePatchCount * tilePatchCount)
+        addTile(tile);
+}
+
+void Terrain::addTile(Tile* tile)
+{
+    // Replace the reserved memory of the tile with the size of its heights and vertices,
+    // which is then used as the estimate for the other tiles.
+    size_t memorySize = (_tileSize + 1) * (_tileSize + 1) * sizeof(float);
+    for (size_t i = 0, count = tile->patches.size(); i < count; ++i)
+    {
+        TerrainPatch* patch = tile->patches[i];
+        for (size_t j = 0, levelCount = patch->_levels.size(); j < levelCount; ++j)
+        {
+            Mesh* mesh = patch->_levels[j]->model->getMesh();
+            memorySize += mesh->getVertexCount() * mesh->getVertexSize();
+        }
+    }
+    _memoryUsage = _memoryUsage - tile->memorySize + memorySize;
+    tile->memorySize = memorySize;
+    _tileMemoryEstimate = memorySize;
+
+    for (size_t i = 0, count = tile->patches.size(); i < count; ++i)
+    {
+        TerrainPatch* patch = tile->patches[i];
+        patch->_index = _patches.size();
+        _patches.push_back(patch);
+        _patchGrid[patch->_row * _patchColumnCount + patch->_column] = patch;
+        patch->updateMaterial();
+    }
+    for (size_t i = 0, count = tile->blendMaps.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(tile->blendMaps[i]);
+    }
+    tile->blendMaps.clear();
+    tile->state = Tile::RESIDENT;
+
+    if (_collisionShape)
+        addTileCollisionShape(tile);
+}
+
+void Terrain::unloadTile(Tile* tile)
+{
+    GP_ASSERT(tile->state != Tile::LOADING || tile->pendingLoads == 0);
+
+    if (tile->state == Tile::RESIDENT)
+    {
+        if (tile->collisionShape)
+        {
+            if (_collisionShape)
+                static_cast<btCompoundShape*>(_collisionShape->_shape)->removeChildShape(tile->collisionShape);
+            SAFE_DELETE(tile->collisionShape);
+        }
+
+        // Remove the patches of the tile, keeping the indices of the others in sync
+        unsigned int tilePatchCount = (_tileSize + _patchSize - 1) / _patchSize;
+        size_t count = 0;
+        for (size_t i = 0, patchCount = _patches.size(); i < patchCount; ++i)
+        {
+            TerrainPatch* patch = _patches[i];
+            if (patch->_row / tilePatchCount == tile->row && patch->_column / tilePatchCount == tile->column)
+            {
+                _patchGrid[patch->_row * _patchColumnCount + patch->_column] = NULL;
+            }
+            else
+            {
+                patch->_index = count;
+                _patches[count++] = patch;
+            }
+        }
+        _patches.resize(count);
+    }
+    for (size_t i = 0, count = tile->patches.size(); i < count; ++i)
+    {
+        SAFE_DELETE(tile->patches[i]);
+    }
+    tile->patches.clear();
+    for (size_t i = 0, count = tile->blendMaps.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(tile->blendMaps[i]);
+    }
+    tile->blendMaps.clear();
+    SAFE_RELEASE(tile->heightfield);
+    _memoryUsage -= tile->memorySize;
+    tile->memorySize = 0;
+    tile->state = Tile::UNLOADED;
+}
+
+bool Terrain::evictTile(float distance)
+{
+    Tile* farthest = NULL;
+    for (size_t i = 0, count = _tiles.size(); i < count; ++i)
+    {
+        Tile* tile = _tiles[i];
+        if ((tile->state == Tile::RESIDENT || tile->state == Tile::BUILDING) &&
+            tile->distance > _loadDistance && tile->distance > distance &&
+            (!farthest || tile->distance > farthest->distance))
+        {
+            farthest = tile;
+        }
+    }
+    if (!farthest)
+        return false;
+
+    unloadTile(farthest);
+    return true;
+}
+
+void Terrain::addTileCollisionShape(Tile* tile)
+{
+    GP_ASSERT(_collisionShape && tile->heightfield && !tile->collisionShape);
+
+    float* heights = tile->heightfield->getArray();
+    unsigned int size = _tileSize + 1;
+    float minHeight = FLT_MAX, maxHeight = -FLT_MAX;
+    for (unsigned int i = 0, count = size * size; i < count; ++i)
+    {
+        minHeight = std::min(minHeight, heights[i]);
+        maxHeight = std::max(maxHeight, heights[i]);
+    }
+
+    // Bullet centers heightfields around their origin, so place the tile at its center. Shapes
+    // added to a compound shape do not inherit its scale, so it is applied here.
+    btCompoundShape* compoundShape = static_cast<btCompoundShape*>(_collisionShape->_shape);
+    const btVector3& scale = compoundShape->getLocalScaling();
+    btHeightfieldTerrainShape* shape = bullet_new<btHeightfieldTerrainShape>(
+        (int)size, (int)size, heights, 1.0f, minHeight, maxHeight, 1, PHY_FLOAT, false);
+    shape->setLocalScaling(scale);
+    btTransform transform;
+    transform.setIdentity();
+    transform.setOrigin(btVector3(((tile->column + 0.5f) * _tileSize - _tileColumnCount * _tileSize * 0.5f) * scale.x(),
+                                  (minHeight + maxHeight) * 0.5f * scale.y(),
+                                  ((tile->row + 0.5f) * _tileSize - _tileRowCount * _tileSize * 0.5f) * scale.z()));
+    compoundShape->addChildShape(transform, shape);
+    tile->collisionShape = shape;
+}
+
+void Terrain::setCollisionShape(PhysicsCollisionShape* shape)
+{
+    for (size_t i = 0, count = _tiles.size(); i < count; ++i)
+    {
+        Tile* tile = _tiles[i];
+        if (tile->collisionShape)
+        {
+            static_cast<btCompoundShape*>(_collisionShape->_shape)->removeChildShape(tile->collisionShape);
+            SAFE_DELETE(tile->collisionShape);
+        }
+    }
+    _collisionShape = shape;
+    if (_collisionShape)
+    {
+        for (size_t i = 0, count = _tiles.size(); i < count; ++i)
+        {
+            if (_tiles[i]->state == Tile::RESIDENT)
+                addTileCollisionShape(_tiles[i]);
+        }
+    }
+}
+
 unsigned int Terrain::draw(bool wireframe)
 {
+    Scene* scene = _node ? _node->getScene() : NULL;
+    Camera* camera = scene ? scene->getActiveCamera() : NULL;
+    if (!camera)
+        return 0;
+
+    if (isTiled())
+        updateTiles(camera);
+    updateLevels(camera);
+
     size_t visibleCount = 0;
     for (size_t i = 0, count = _patches.size(); i < count; ++i)
     {
@@ -538,6 +1233,16 @@ unsigned int Terrain::draw(bool wireframe)
     return visibleCount;
 }
 
+Terrain::Tile::Tile() : row(0), column(0), state(UNLOADED), heightfield(NULL), pendingLoads(0),
+    collisionShape(NULL), memorySize(0), distance(0.0f)
+{
+}
+
+bool Terrain::TileDistanceCompare::operator() (const Tile* lhs, const Tile* rhs) const
+{
+    return lhs->distance < rhs->distance;
+}
+
 Drawable* Terrain::clone(NodeCloneContext& context)
 {
     // TODO:
@@ -550,4 +1255,101 @@ static float getDefaultHeight(unsigned int width, unsigned int height)
     return ((width + height) * 0.5f) * DEFAULT_TERRAIN_HEIGHT_RATIO;
 }
 
+static void loadLayers(Terrain* terrain, Properties* properties)
+{
+    // Parse terrain layers
+    Properties* lp;
+    int index = -1;
+    while ((lp = properties->getNextNamespace()) != NULL)
+    {
+        if (strcmp(lp->getNamespace(), "layer") == 0)
+        {
+            // If there is no explicitly specified index for this layer, assume it's the 'next' layer
+            if (lp->exists("index"))
+                index = lp->getInt("index");
+            else
+                ++index;
+
+            std::string textureMap;
+            const char* textureMapPtr = NULL;
+            std::string blendMap;
+            const char* blendMapPtr = NULL;
+            Vector2 textureRepeat;
+            int blendChannel = 0;
+            int row = -1, column = -1;
+            Vector4 temp;
+
+            // Read layer textures
+            Properties* t = lp->getNamespace("texture", true);
+            if (t)
+            {
+                if (t->getPath("path", &textureMap))
+                {
+                    textureMapPtr = textureMap.c_str();
+                }
+                if (!t->getVector2("repeat", &textureRepeat))
+                    textureRepeat.set(1,1);
+            }
+
+            Properties* b = lp->getNamespace("blend", true);
+            if (b)
+            {
+                if (b->getPath("path", &blendMap))
+                {
+                    blendMapPtr = blendMap.c_str();
+                }
+                else if (terrain->isTiled() && b->getString("path") && strstr(b->getString("path"), "%d"))
+                {
+                    // Tiled terrains can have a blend map per tile
+                    blendMap = b->getString("path");
+                    blendMapPtr = blendMap.c_str();
+                }
+                const char* channel = b->getString("channel");
+                if (channel && strlen(channel) > 0)
+                {
+                    char c = std::toupper(channel[0]);
+                    if (c == 'R' || c == '0')
+                        blendChannel = 0;
+                    else if (c == 'G' || c == '1')
+                        blendChannel = 1;
+                    else if (c == 'B' || c == '2')
+                        blendChannel = 2;
+                    else if (c == 'A' || c == '3')
+                        blendChannel = 3;
+                }
+            }
+
+            // Get patch row/columns that this layer applies to.
+            if (lp->exists("row"))
+                row = lp->getInt("row");
+            if (lp->exists("column"))
+                column = lp->getInt("column");
+
+            if (!terrain->setLayer(index, textureMapPtr, textureRepeat, blendMapPtr, blendChannel, row, column))
+            {
+                GP_WARN("Failed to load terrain layer: %s", textureMap.c_str());
+            }
+        }
+    }
+}
+
+static std::string getTilePath(const std::string& pattern, unsigned int column, unsigned int row)
+{
+    // Replace the first %d with the column of the tile and the second with its row
+    std::string path = pattern;
+    unsigned int values[2] = { column, row };
+    size_t position = 0;
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        position = path.find("%d", position);
+        if (position == std::string::npos)
+            break;
+        char value[16];
+        sprintf(value, "%u", values[i]);
+        path.replace(position, 2, value);
+        position += strlen(value);
+    }
+    return path;
+}
+
 }
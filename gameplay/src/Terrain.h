@@ -15,6 +15,7 @@ namespace gameplay
 
 class TerrainPatch;
 class TerrainAutoBindingResolver;
+class PhysicsCollisionShape;
 
 /**
  * Defines a Terrain that is capable of rendering large landscapes from 2D heightmap images.
@@ -61,23 +62,53 @@ class TerrainAutoBindingResolver;
  * flags.
  *
  * Level of detail (LOD) is supported using a technique that is similar to texture mipmapping.
- * A distance-to-camera based test, using a simple screen-space error metric is used to decide
- * the appropriate LOD for a terrain patch. The number of LOD levels is 1 by default (which
- * means only the base level is used), but can be specified via the detailLevels property.
- * Using too large a number for detailLevels can result in excessive popping in the distance
- * for very hilly terrains, so a smaller number (2-3) often works best in these cases.
+ * The number of LOD levels is 1 by default (which means only the base level is used), but can
+ * be specified via the detailLevels property. The geometric error of each level of each patch
+ * (the largest height difference from the full detail heightfield) is computed when the terrain
+ * is created. Each time the terrain is drawn, the levels of all patches are selected in a single
+ * pass as the coarsest levels whose error, projected to the screen, does not exceed the pixel
+ * error of the terrain (see setPixelError and the pixelError property).
  *
- * Finally, when LOD is enabled, cracks can begin to appear between terrain patches of
- * different LOD levels. If the cracks are only minor (depends on your terrain topology
- * and textures used), an acceptable approach might be to simply use a background clear
- * color that closely matches your terrain to make the cracks much less visible. However,
- * often that is not acceptable, so the Terrain class also supports a simple solution called
- * "vertical skirts". When enabled (via the skirtScale parameter in the terrain file), a vertical
- * edge will extend down along the sides of all terrain patches, which fills in the crack.
- * This is a very fast approach as it adds only a small number of triangles per patch and requires
- * zero extra CPU time or draw calls, which are often needed for more complex stitching
- * approaches. In practice, the skirts are often not noticeable at all unless the LOD variation
- * is very large and the terrain is excessively hilly on the edge of a LOD transition.
+ * Neighboring patches never differ by more than one level, and the edge of a patch that borders
+ * a coarser patch is stitched to it with a matching index buffer, so no cracks appear between
+ * levels. Vertical skirts (enabled via the skirtScale parameter in the terrain file) can still
+ * be used to hide any gaps caused by the terrain topology. To avoid popping, vertices geomorph
+ * from their coarser level position as a patch approaches the distance at which it switches
+ * to the next level, which requires the MORPH define of the terrain vertex shader.
+ *
+ * Terrains that are too large to be kept in memory can instead be split into a grid of
+ * heightfield tiles, by specifying a tiles section in place of the heightmap:
+ *
+ * @code
+ * terrain
+ * {
+ *     tiles
+ *     {
+ *         path = res/terrain/height_%d_%d.r16
+ *         columns = 32
+ *         rows = 32
+ *         size = 512
+ *         loadDistance = 2000
+ *         memoryBudget = 256
+ *     }
+ *     size = 16384, 600, 16384
+ *     patchSize = 32
+ *     detailLevels = 3
+ * }
+ * @endcode
+ *
+ * Each tile spans size x size quads and is read from its own heightmap (PNG, RAW8 or RAW16)
+ * of (size + 1) x (size + 1) heights, whose edges are shared with the neighboring tiles. The
+ * first %d in the path is replaced by the column of the tile and the second by its row. The
+ * blend map paths of layers can contain the same pattern to give each tile its own blend maps.
+ * Texture coordinates, and thus layer repeat counts, are relative to each tile, and normal maps
+ * are not supported for tiled terrains.
+ *
+ * Tiles within the load distance (in terrain units) of the active camera are read on the game's
+ * job system and their patches are built over the following frames, nearest tiles first. Tiles
+ * outside of the load distance stay resident until their memory (in megabytes) is needed for
+ * nearer tiles. getHeight and the physics heightfield of a tiled terrain only cover the tiles
+ * that are resident; getHeight can report whether the tile at a point is resident.
  *
  * @see http://gameplay3d.github.io/GamePlay/docs/file-formats.html#wiki-Terrain
  */
@@ -86,6 +117,7 @@ class Terrain : public Ref, public Drawable, private Transform::Listener
     friend class Node;
     friend class PhysicsController;
     friend class PhysicsRigidBody;
+    friend class PhysicsCollisionShape;
     friend class TerrainPatch;
     friend class TerrainAutoBindingResolver;
 
@@ -196,6 +228,76 @@ public:
      */
     unsigned int getPatchCount() const;
 
+    /**
+     * Sets the maximum screen-space error, in pixels, allowed when selecting the level of
+     * detail of terrain patches.
+     *
+     * Larger values draw coarser levels of detail nearer to the camera. The default is 2.
+     *
+     * @param pixelError The maximum screen-space error in pixels.
+     */
+    void setPixelError(float pixelError);
+
+    /**
+     * Gets the maximum screen-space error, in pixels, allowed when selecting the level of
+     * detail of terrain patches.
+     *
+     * @return The maximum screen-space error in pixels.
+     */
+    float getPixelError() const;
+
+    /**
+     * Determines if this terrain is streamed in tiles.
+     *
+     * @return True if the terrain is tiled, false otherwise.
+     */
+    bool isTiled() const;
+
+    /**
+     * Gets the number of tiles whose patches are currently built.
+     *
+     * @return The number of resident tiles, or 1 if the terrain is not tiled.
+     */
+    unsigned int getResidentTileCount() const;
+
+    /**
+     * Gets the distance from the camera, in terrain units, within which tiles are loaded.
+     *
+     * @return The load distance.
+     */
+    float getLoadDistance() const;
+
+    /**
+     * Sets the distance from the camera, in terrain units, within which tiles are loaded.
+     *
+     * @param distance The load distance.
+     */
+    void setLoadDistance(float distance);
+
+    /**
+     * Gets the maximum memory used by the heights and vertices of resident tiles.
+     *
+     * @return The memory budget, in bytes.
+     */
+    size_t getMemoryBudget() const;
+
+    /**
+     * Sets the maximum memory used by the heights and vertices of resident tiles.
+     *
+     * Tiles outside of the load distance are evicted, farthest first, when nearer tiles need
+     * their memory. At least one tile is always loaded, regardless of the budget.
+     *
+     * @param budget The memory budget, in bytes.
+     */
+    void setMemoryBudget(size_t budget);
+
+    /**
+     * Gets the memory used by the heights and vertices of resident tiles.
+     *
+     * @return The memory used, in bytes (0 if the terrain is not tiled).
+     */
+    size_t getMemoryUsage() const;
+
     /**
      * Gets a terrain patch
      */
@@ -215,13 +317,32 @@ public:
      * In this case, an interpolated value will be returned between neighboring heightfield heights.
      * If the specified point lies outside of the terrain, it is clamped to the terrain boundaries.
      *
+     * For tiled terrains, only the heights of resident tiles are known: zero is returned if the
+     * tile containing the point is not resident. Use the overload taking a resident flag to tell
+     * such points apart from points at height zero.
+     *
      * @param x The X coordinate, in world space.
      * @param z The Z coordinate, in world space.
      *
-     * @return The height at the specified point, clamped to the boundaries of the terrain.
+     * @return The height at the specified point, clamped to the boundaries of the terrain, or zero
+     *      if the point lies in a tile that is not resident.
      */
     float getHeight(float x, float z) const;
 
+    /**
+     * Gets the world-space height of the terrain at the specified position on the X,Z plane,
+     * and whether the height is known.
+     *
+     * @param x The X coordinate, in world space.
+     * @param z The Z coordinate, in world space.
+     * @param resident Set to false if the point lies in a tile of a tiled terrain that is not
+     *      resident, in which case zero is returned, or to true otherwise.
+     *
+     * @return The height at the specified point, clamped to the boundaries of the terrain.
+     * @script{ignore}
+     */
+    float getHeight(float x, float z, bool* resident) const;
+
     /**
      * Sets the detail textures information for a terrain layer.
      *
@@ -281,6 +402,56 @@ protected:
 
 private:
 
+    /**
+     * A tile of a tiled terrain.
+     */
+    struct Tile
+    {
+        /**
+         * The streaming state of a tile.
+         */
+        enum State
+        {
+            UNLOADED,
+            LOADING,
+            BUILDING,
+            RESIDENT,
+            FAILED
+        };
+
+        Tile();
+
+        unsigned int row;
+        unsigned int column;
+        State state;
+        HeightField* heightfield;
+        unsigned int pendingLoads;
+        std::vector<Texture*> blendMaps;
+        std::vector<TerrainPatch*> patches;
+        btCollisionShape* collisionShape;
+        size_t memorySize;
+        float distance;
+    };
+
+    /**
+     * A layer definition, kept to apply it to the patches of tiles as they are built.
+     */
+    struct LayerDefinition
+    {
+        int index;
+        std::string texturePath;
+        Vector2 textureRepeat;
+        std::string blendPath;
+        int blendChannel;
+        int row;
+        int column;
+    };
+
+    struct TileDistanceCompare
+    {
+        bool operator() (const Tile* lhs, const Tile* rhs) const;
+    };
+
     /**
      * Constructor.
      */
@@ -313,6 +484,13 @@ private:
      */
     static Terrain* create(const char* path, Properties* properties);
 
+    /**
+     * Internal method for creating a tiled terrain.
+     */
+    static Terrain* createTiled(const char* tilePath, unsigned int tileColumns, unsigned int tileRows, unsigned int tileSize,
+        const Vector3& scale, unsigned int patchSize, unsigned int detailLevels, float skirtScale,
+        const char* materialPath, Properties* properties);
+
     /**
      * @see Transform::Listener::transformChanged.
      */
@@ -329,10 +507,108 @@ private:
      */
     BoundingBox getBoundingBox(bool worldSpace) const;
 
+    /**
+     * Returns the shared index buffers for patch levels with the specified grid of vertices,
+     * creating them on first use.
+     */
+    const TerrainPatch::IndexSet* getIndexSet(unsigned int columns, unsigned int rows, bool skirt);
+
+    /**
+     * Selects the level of detail, geomorph factors and stitched edges of all patches for
+     * the specified camera.
+     */
+    void updateLevels(Camera* camera);
+
+    /**
+     * Returns the patch at the specified row and column, or NULL if it is not resident.
+     */
+    TerrainPatch* findPatch(int row, int column) const;
+
+    /**
+     * Starts loading and building tiles around the specified camera and evicts tiles to
+     * stay within the memory budget.
+     */
+    void updateTiles(Camera* camera);
+
+    /**
+     * Starts reading the heights and blend maps of a tile.
+     */
+    void loadTile(Tile* tile);
+
+    /**
+     * Stores the heights of a tile read on the job system. Runs on the main thread.
+     */
+    void finishHeightfieldLoad(Tile* tile, HeightField* heightfield);
+
+    /**
+     * Drops the heights of a tile read on the job system when the game shuts down before they are stored.
+     */
+    void cancelHeightfieldLoad(Tile* tile, HeightField* heightfield);
+
+    /**
+     * Stores a blend map of a tile loaded asynchronously. Runs on the main thread.
+     */
+    void finishBlendMapLoad(Tile* tile, Texture* texture);
+
+    /**
+     * Moves a tile to the building state once all of its data has been loaded.
+     */
+    void completeTileLoad(Tile* tile);
+
+    /**
+     * Builds the next patch of a tile, and makes the tile resident after its last patch.
+     */
+    void buildTilePatch(Tile* tile);
+
+    /**
+     * Adds the patches of a built tile to the terrain.
+     */
+    void addTile(Tile* tile);
+
+    /**
+     * Removes the patches of a tile and frees its data.
+     */
+    void unloadTile(Tile* tile);
+
+    /**
+     * Unloads the farthest tile outside of the load distance, if any is farther than the
+     * specified distance.
+     */
+    bool evictTile(float distance);
+
+    /**
+     * Creates the collision shape of a resident tile in the terrain's physics heightfield.
+     */
+    void addTileCollisionShape(Tile* tile);
+
+    /**
+     * Sets the compound physics heightfield that tiles add their collision shapes to.
+     */
+    void setCollisionShape(PhysicsCollisionShape* shape);
+
     std::string _materialPath;
     HeightField* _heightfield;
     Vector3 _localScale;
     std::vector<TerrainPatch*> _patches;
+    std::vector<TerrainPatch*> _patchGrid;
+    unsigned int _patchColumnCount;
+    unsigned int _patchRowCount;
+    unsigned int _patchSize;
+    unsigned int _detailLevels;
+    float _skirtScale;
+    std::string _tilePath;
+    std::vector<Tile*> _tiles;
+    unsigned int _tileColumnCount;
+    unsigned int _tileRowCount;
+    unsigned int _tileSize;
+    float _loadDistance;
+    size_t _memoryBudget;
+    size_t _memoryUsage;
+    size_t _tileMemoryEstimate;
+    std::vector<LayerDefinition> _layers;
+    PhysicsCollisionShape* _collisionShape;
+    std::vector<TerrainPatch::IndexSet*> _indexSets;
+    float _pixelError;
     Texture::Sampler* _normalMap;
     unsigned int _flags;
     mutable Matrix _inverseWorldMatrix;
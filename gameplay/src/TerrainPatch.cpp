@@ -15,8 +15,7 @@ template <class T> T clamp(T value, T min, T max) { return value < min ? min : (
 
 #define TERRAINPATCH_DIRTY_MATERIAL 1
 #define TERRAINPATCH_DIRTY_BOUNDS 2
-#define TERRAINPATCH_DIRTY_LEVEL 4
-#define TERRAINPATCH_DIRTY_ALL (TERRAINPATCH_DIRTY_MATERIAL | TERRAINPATCH_DIRTY_BOUNDS | TERRAINPATCH_DIRTY_LEVEL)
+#define TERRAINPATCH_DIRTY_ALL (TERRAINPATCH_DIRTY_MATERIAL | TERRAINPATCH_DIRTY_BOUNDS)
 
 /**
  * Custom material auto-binding resolver for terrain.
@@ -30,7 +29,7 @@ static TerrainAutoBindingResolver __autoBindingResolver;
 static int __currentPatchIndex = -1;
 
 TerrainPatch::TerrainPatch() :
-    _terrain(NULL), _row(0), _column(0), _camera(NULL), _level(0), _bits(TERRAINPATCH_DIRTY_ALL)
+    _terrain(NULL), _row(0), _column(0), _level(0), _morph(0.0f), _edgeMask(0), _bits(TERRAINPATCH_DIRTY_ALL)
 {
 }
 
@@ -48,7 +47,6 @@ TerrainPatch::~TerrainPatch()
     {
         deleteLayer(*_layers.begin());
     }
-    SAFE_RELEASE(_camera);
 }
 
 TerrainPatch* TerrainPatch::create(Terrain* terrain, unsigned int index,
@@ -71,6 +69,13 @@ TerrainPatch* TerrainPatch::create(Terrain* terrain, unsigned int index,
         patch->addLOD(heights, width, height, x1, z1, x2, z2, xOffset, zOffset, step, verticalSkirtSize);
     }
 
+    // The error of a level must be at least the error of the more detailed levels, so
+    // that the screen-space error increases monotonically as detail is removed.
+    for (size_t i = 1, count = patch->_levels.size(); i < count; ++i)
+    {
+        patch->_levels[i]->error = std::max(patch->_levels[i]->error, patch->_levels[i - 1]->error);
+    }
+
     // Set our bounding box using the base LOD mesh
     BoundingBox& bounds = patch->_boundingBox;
     bounds.set(patch->_levels[0]->model->getMesh()->getBoundingBox());
@@ -87,16 +92,6 @@ Material* TerrainPatch::getMaterial(int index) const
 {
     if (index == -1)
     {
-        Scene* scene = _terrain->_node ? _terrain->_node->getScene() : NULL;
-        Camera* camera = scene ? scene->getActiveCamera() : NULL;
-        if (!camera)
-        {
-            _level = const_cast<TerrainPatch*>(this)->computeLOD(camera, getBoundingBox(true));
-        }
-        else
-        {
-            _level = 0;
-        }
         return _levels[_level]->model->getMaterial();
     }
     return _levels[index]->model->getMaterial();
@@ -124,6 +119,9 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
     if (patchWidth < 2 || patchHeight < 2)
         return; // ignore this level, not enough geometry
 
+    // Get the index buffers shared by all patches with this grid size
+    const IndexSet* indexSet = _terrain->getIndexSet(patchWidth, patchHeight, verticalSkirtSize > 0.0f);
+
     if (verticalSkirtSize > 0.0f)
     {
         patchWidth += 2;
@@ -131,7 +129,7 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
     }
 
     unsigned int vertexCount = patchHeight * patchWidth;
-    unsigned int vertexElements = _terrain->_normalMap ? 5 : 8; //<x,y,z>[i,j,k]<u,v>
+    unsigned int vertexElements = _terrain->_normalMap ? 7 : 10; //<x,y,z>[i,j,k]<u,v><morph,edge>
     float* vertices = new float[vertexCount * vertexElements];
     unsigned int index = 0;
     Vector3 min(FLT_MAX, FLT_MAX, FLT_MAX);
@@ -210,6 +208,23 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
                 v[1] = z == z1 ? v[1]-offset : v[1]+offset;
             }
 
+            v += 2;
+
+            // Compute the height difference to the surface of the next coarser level, which the
+            // vertex is morphed towards, and the edge of the patch it is on (1-4) or 0 if none.
+            // Skirt vertices follow the edge vertex they hang from.
+            v[0] = computeHeight(heights, width, x1, z1, x2, z2, step * 2, x, z) - computeHeight(heights, width, x, z);
+            if (z == z1)
+                v[1] = 1.0f;
+            else if (z == z2)
+                v[1] = 2.0f;
+            else if (x == x1)
+                v[1] = 3.0f;
+            else if (x == x2)
+                v[1] = 4.0f;
+            else
+                v[1] = 0.0f;
+
             if (x == x2)
             {
                 if ((verticalSkirtSize == 0) || xskirt)
@@ -247,99 +262,121 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
 
     Vector3 center(min + ((max - min) * 0.5f));
 
+    // Compute the geometric error of this level: the largest vertical distance between
+    // its surface and the heightfield samples it skips.
+    float error = 0.0f;
+    if (step > 1)
+    {
+        for (unsigned int z = z1; z <= z2; ++z)
+        {
+            for (unsigned int x = x1; x <= x2; ++x)
+            {
+                error = std::max(error, fabs(computeHeight(heights, width, x1, z1, x2, z2, step, x, z) - computeHeight(heights, width, x, z)));
+            }
+        }
+    }
+
     // Create mesh
-    VertexFormat::Element elements[3];
+    VertexFormat::Element elements[4];
     elements[0] = VertexFormat::Element(VertexFormat::POSITION, 3);
     if (_terrain->_normalMap)
     {
         elements[1] = VertexFormat::Element(VertexFormat::TEXCOORD0, 2);
+        elements[2] = VertexFormat::Element(VertexFormat::TEXCOORD1, 2);
     }
     else
     {
         elements[1] = VertexFormat::Element(VertexFormat::NORMAL, 3);
         elements[2] = VertexFormat::Element(VertexFormat::TEXCOORD0, 2);
+        elements[3] = VertexFormat::Element(VertexFormat::TEXCOORD1, 2);
     }
-    VertexFormat format(elements, _terrain->_normalMap ? 2 : 3);
+    VertexFormat format(elements, _terrain->_normalMap ? 3 : 4);
     Mesh* mesh = Mesh::createMesh(format, vertexCount);
     mesh->setVertexData(vertices);
     mesh->setBoundingBox(BoundingBox(min, max));
     mesh->setBoundingSphere(BoundingSphere(center, center.distance(max)));
 
-    // Add mesh part for indices
-    unsigned int indexCount =
-        (patchWidth * 2) *      // # indices per row of tris
-        (patchHeight - 1) +     // # rows of tris
-        (patchHeight-2) * 2;    // # degenerate tris
+    SAFE_DELETE_ARRAY(vertices);
+
+    // Create model
+    Model* model = Model::create(mesh);
+    mesh->release();
+
+    // Add this level
+    Level* level = new Level();
+    level->model = model;
+    level->error = error;
+    level->indexSet = indexSet;
+    _levels.push_back(level);
+}
 
-    // Support a maximum number of indices of USHRT_MAX. Any more indices we will require breaking up the
-    // terrain into smaller patches.
-    if (indexCount > USHRT_MAX)
+TerrainPatch::IndexSet* TerrainPatch::createIndexSet(unsigned int columns, unsigned int rows, bool skirt)
+{
+    // Vertices are indexed by their grid coordinates, where (0, 0) to (columns-1, rows-1) are on the
+    // surface and, with skirts, -1 and columns or rows are the skirt vertices around it.
+    int n = (int)columns - 1;
+    int m = (int)rows - 1;
+    int o = skirt ? 1 : 0;
+    unsigned int width = columns + o * 2;
+    if (width * (rows + o * 2) > USHRT_MAX + 1)
     {
-        GP_WARN("Index count of %d for terrain patch exceeds the limit of 65535. Please specifiy a smaller patch size.", indexCount);
-        GP_ASSERT(indexCount <= USHRT_MAX);
+        GP_WARN("Vertex count of %d for terrain patch exceeds the limit of 65536. Please specify a smaller patch size.", width * (rows + o * 2));
     }
 
-    MeshPart* part = mesh->addPart(Mesh::TRIANGLE_STRIP, Mesh::INDEX16, indexCount);
-    unsigned short* indices = new unsigned short[indexCount];
-    index = 0;
-    for (unsigned int z = 0; z < patchHeight-1; ++z)
-    {
-        unsigned int i1 = z * patchWidth;
-        unsigned int i2 = (z+1) * patchWidth;
+    IndexSet* indexSet = new IndexSet();
+    indexSet->columns = columns;
+    indexSet->rows = rows;
+    indexSet->skirt = skirt;
 
-        // Move left to right for even rows and right to left for odd rows.
-        // Note that this results in two degenerate triangles between rows
-        // for stitching purposes, but actually does not require any extra
-        // indices to achieve this.
-        if (z % 2 == 0)
+    std::vector<unsigned short> indices;
+    indices.reserve((n + o * 2) * (m + o * 2) * 6);
+    for (unsigned int mask = 0; mask < 16; ++mask)
+    {
+        // Each bit of the mask stitches an edge (previous row, next row, previous column, next column)
+        // to a neighbor with half the resolution, by moving its odd vertices (and the skirt vertices
+        // below them) onto the previous even vertex. Triangles that become degenerate are dropped.
+        indices.clear();
+        for (int j = -o; j < m + o; ++j)
         {
-            if (z > 0)
+            for (int i = -o; i < n + o; ++i)
             {
-                // Add degenerate indices to connect strips
-                indices[index] = indices[index-1];
-                ++index;
-                indices[index++] = i1;
-            }
-
-            // Add row strip
-            for (unsigned int x = 0; x < patchWidth; ++x)
-            {
-                indices[index++] = i1 + x;
-                indices[index++] = i2 + x;
+                // Split each cell along the diagonal from (i+1, j) to (i, j+1), like the
+                // surface that morph targets are computed from.
+                int corners[4][2] = { { i, j }, { i, j + 1 }, { i + 1, j }, { i + 1, j + 1 } };
+                unsigned short cell[4];
+                for (unsigned int k = 0; k < 4; ++k)
+                {
+                    int x = corners[k][0];
+                    int z = corners[k][1];
+                    if ((((mask & 1) && z <= 0) || ((mask & 2) && z >= m)) && (x & 1) && x > 0 && x < n)
+                        --x;
+                    if ((((mask & 4) && x <= 0) || ((mask & 8) && x >= n)) && (z & 1) && z > 0 && z < m)
+                        --z;
+                    cell[k] = (unsigned short)((z + o) * width + x + o);
+                }
+                static const unsigned int triangles[2][3] = { { 0, 1, 2 }, { 2, 1, 3 } };
+                for (unsigned int t = 0; t < 2; ++t)
+                {
+                    unsigned short a = cell[triangles[t][0]], b = cell[triangles[t][1]], c = cell[triangles[t][2]];
+                    if (a != b && b != c && a != c)
+                    {
+                        indices.push_back(a);
+                        indices.push_back(b);
+                        indices.push_back(c);
+                    }
+                }
             }
         }
-        else
-        {
-            // Add degenerate indices to connect strips
-            if (z > 0)
-            {
-                indices[index] = indices[index-1];
-                ++index;
-                indices[index++] = i2 + ((int)patchWidth-1);
-            }
 
-            // Add row strip
-            for (int x = (int)patchWidth-1; x >= 0; --x)
-            {
-                indices[index++] = i2 + x;
-                indices[index++] = i1 + x;
-            }
-        }
+        IndexBufferHandle buffer;
+        GL_ASSERT( glGenBuffers(1, &buffer) );
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer) );
+        GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned short) * indices.size(), &indices[0], GL_STATIC_DRAW) );
+        indexSet->buffers[mask] = buffer;
+        indexSet->indexCounts[mask] = (unsigned int)indices.size();
     }
-    GP_ASSERT(index == indexCount);
-    part->setIndexData(indices, 0, indexCount);
-
-    SAFE_DELETE_ARRAY(vertices);
-    SAFE_DELETE_ARRAY(indices);
-
-    // Create model
-    Model* model = Model::create(mesh);
-    mesh->release();
 
-    // Add this level
-    Level* level = new Level();
-    level->model = model;
-    _levels.push_back(level);
+    return indexSet;
 }
 
 void TerrainPatch::deleteLayer(Layer* layer)
@@ -494,6 +531,9 @@ std::string TerrainPatch::passCreated(Pass* pass)
     if (_terrain->_normalMap)
         defines << ";NORMAL_MAP";
 
+    if (_levels.size() > 1)
+        defines << ";MORPH";
+
     // Append texture and blend index constants to preprocessor definition.
     // We need to do this since older versions of GLSL only allow sampler arrays
     // to be indexed using constant expressions (otherwise we could simply pass an
@@ -579,11 +619,35 @@ unsigned int TerrainPatch::draw(bool wireframe)
     if (!updateMaterial())
         return 0;
 
-    // Compute the LOD level from the camera's perspective
-    _level = computeLOD(camera, bounds);
-
-    // Draw the model for the current LOD
-    return _levels[_level]->model->draw(wireframe);
+    // Draw the current level, selected by the terrain for all patches, with the index
+    // buffer that stitches its edges to coarser neighbors.
+    Level* level = _levels[_level];
+    IndexBufferHandle buffer = level->indexSet->buffers[_edgeMask];
+    unsigned int indexCount = level->indexSet->indexCounts[_edgeMask];
+    Material* material = level->model->getMaterial();
+    GP_ASSERT(material);
+    Technique* technique = material->getTechnique();
+    GP_ASSERT(technique);
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        pass->bind();
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer) );
+        if (wireframe)
+        {
+            for (unsigned int j = 0; j < indexCount; j += 3)
+            {
+                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, GL_UNSIGNED_SHORT, ((const GLvoid*)(j * sizeof(unsigned short)))) );
+            }
+        }
+        else
+        {
+            GL_ASSERT( glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, 0) );
+        }
+        pass->unbind();
+    }
+    return 1;
 }
 
 const BoundingBox& TerrainPatch::getBoundingBox(bool worldSpace) const
@@ -608,66 +672,22 @@ const BoundingBox& TerrainPatch::getBoundingBox(bool worldSpace) const
 
 void TerrainPatch::cameraChanged(Camera* camera)
 {
-    _bits |= TERRAINPATCH_DIRTY_LEVEL;
+    // Levels are selected for all patches each time the terrain is drawn.
 }
 
-unsigned int TerrainPatch::computeLOD(Camera* camera, const BoundingBox& worldBounds) 
+unsigned int TerrainPatch::getLevel() const
 {
-    if (camera != _camera)
-    {
-        if (_camera != NULL)
-        {
-            _camera->removeListener(this);
-            _camera->release();
-        }
-        _camera = camera;
-        _camera->addRef();
-        _camera->addListener(this);
-        _bits |= TERRAINPATCH_DIRTY_LEVEL;
-    }
-
-    // base level
-    if (!_terrain->isFlagSet(Terrain::LEVEL_OF_DETAIL) || _levels.size() == 0)
-        return 0;
+    return _level;
+}
 
-    if (!(_bits & TERRAINPATCH_DIRTY_LEVEL))
-        return _level;
-
-    _bits &= ~TERRAINPATCH_DIRTY_LEVEL;
-
-    // Compute LOD to use based on very simple distance metric. TODO: Optimize me.
-    Game* game = Game::getInstance();
-    Rectangle vp(0, 0, game->getWidth(), game->getHeight());
-    Vector3 corners[8];
-    Vector2 min(FLT_MAX, FLT_MAX);
-    Vector2 max(-FLT_MAX, -FLT_MAX);
-    worldBounds.getCorners(corners);
-    for (unsigned int i = 0; i < 8; ++i)
-    {
-        const Vector3& corner = corners[i];
-        float x, y;
-        camera->project(vp, corners[i], &x, &y);
-        if (x < min.x)
-            min.x = x;
-        if (y < min.y)
-            min.y = y;
-        if (x > max.x)
-            max.x = x;
-        if (y > max.y)
-            max.y = y;
-    }
-    float area = (max.x - min.x) * (max.y - min.y);
-    float screenArea = game->getWidth() * game->getHeight() / 10.0f;
-    float error = screenArea / area;
-
-    // Level LOD based on distance from camera
-    size_t maxLod = _levels.size()-1;
-    size_t lod = (size_t)error;
-    lod = std::max(lod, (size_t)0);
-    lod = std::min(lod, maxLod);
-    _level = lod;
+float TerrainPatch::getMorph() const
+{
+    return _morph;
+}
 
-    return _level;
+const Vector4& TerrainPatch::getEdgeMorph() const
+{
+    return _edgeMorph;
 }
 
 const Vector3& TerrainPatch::getAmbientColor() const
@@ -686,6 +706,36 @@ float TerrainPatch::computeHeight(float* heights, unsigned int width, unsigned i
     return heights[z * width + x] * _terrain->_localScale.y;
 }
 
+float TerrainPatch::computeHeight(float* heights, unsigned int width,
+                                  unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2,
+                                  unsigned int step, unsigned int x, unsigned int z)
+{
+    // Find the cell of the level with the given step that contains the point. The grid is
+    // clamped to the patch bounds, so the last cell in each direction may be narrower.
+    unsigned int cx1 = x1 + (x - x1) / step * step;
+    unsigned int cz1 = z1 + (z - z1) / step * step;
+    if (cx1 == x2)
+        cx1 -= step;
+    if (cz1 == z2)
+        cz1 -= step;
+    unsigned int cx2 = std::min(cx1 + step, x2);
+    unsigned int cz2 = std::min(cz1 + step, z2);
+    float u = (float)(x - cx1) / (cx2 - cx1);
+    float v = (float)(z - cz1) / (cz2 - cz1);
+
+    // Interpolate on the triangle of the cell that contains the point (cells are split along
+    // the diagonal from (cx2, cz1) to (cx1, cz2)).
+    float h10 = computeHeight(heights, width, cx2, cz1);
+    float h01 = computeHeight(heights, width, cx1, cz2);
+    if (u + v <= 1.0f)
+    {
+        float h00 = computeHeight(heights, width, cx1, cz1);
+        return h00 + u * (h10 - h00) + v * (h01 - h00);
+    }
+    float h11 = computeHeight(heights, width, cx2, cz2);
+    return h11 + (1.0f - u) * (h01 - h11) + (1.0f - v) * (h10 - h11);
+}
+
 TerrainPatch::Layer::Layer() :
     index(0), row(-1), column(-1), textureIndex(-1), blendIndex(-1)
 {
@@ -695,10 +745,27 @@ TerrainPatch::Layer::~Layer()
 {
 }
 
-TerrainPatch::Level::Level() : model(NULL)
+TerrainPatch::Level::Level() : model(NULL), error(0.0f), indexSet(NULL)
 {
 }
 
+TerrainPatch::IndexSet::IndexSet() : columns(0), rows(0), skirt(false)
+{
+    memset(buffers, 0, sizeof(buffers));
+    memset(indexCounts, 0, sizeof(indexCounts));
+}
+
+TerrainPatch::IndexSet::~IndexSet()
+{
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        if (buffers[i])
+        {
+            GL_ASSERT( glDeleteBuffers(1, &buffers[i]) );
+        }
+    }
+}
+
 bool TerrainPatch::LayerCompare::operator() (const Layer* lhs, const Layer* rhs) const
 {
     return (lhs->index < rhs->index);
@@ -737,6 +804,20 @@ bool TerrainAutoBindingResolver::resolveAutoBinding(const char* autoBinding, Nod
             parameter->setValue(terrain->_normalMap);
         return true;
     }
+    else if (strcmp(autoBinding, "TERRAIN_MORPH") == 0)
+    {
+        TerrainPatch* patch = HelperFunctions::getPatch(node);
+        if (patch)
+            parameter->bindValue(patch, &TerrainPatch::getMorph);
+        return true;
+    }
+    else if (strcmp(autoBinding, "TERRAIN_EDGE_MORPH") == 0)
+    {
+        TerrainPatch* patch = HelperFunctions::getPatch(node);
+        if (patch)
+            parameter->bindValue(patch, &TerrainPatch::getEdgeMorph);
+        return true;
+    }
     else if (strcmp(autoBinding, "TERRAIN_ROW") == 0)
     {
         TerrainPatch* patch = HelperFunctions::getPatch(node);
@@ -45,6 +45,13 @@ public:
      */
     void cameraChanged(Camera* camera);
 
+    /**
+     * Gets the level of detail this patch was last drawn with (0 is the most detailed).
+     *
+     * @return The current level of detail.
+     */
+    unsigned int getLevel() const;
+
     /**
      * Internal use only.
      *
@@ -93,9 +100,28 @@ private:
         int blendChannel;
     };
 
+    /**
+     * Index buffers for a grid of vertices, one for each combination of edges that are
+     * stitched to a coarser neighbor. Patches with the same grid share an index set.
+     */
+    struct IndexSet
+    {
+        unsigned int columns;
+        unsigned int rows;
+        bool skirt;
+        IndexBufferHandle buffers[16];
+        unsigned int indexCounts[16];
+
+        IndexSet();
+
+        ~IndexSet();
+    };
+
     struct Level
     {
         Model* model;
+        float error;
+        const IndexSet* indexSet;
 
         Level();
     };
@@ -115,6 +141,7 @@ private:
                 unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2,
                 float xOffset, float zOffset, unsigned int step, float verticalSkirtSize);
 
+    static IndexSet* createIndexSet(unsigned int columns, unsigned int rows, bool skirt);
 
     bool setLayer(int index, const char* texturePath, const Vector2& textureRepeat, const char* blendPath, int blendChannel);
 
@@ -126,14 +153,20 @@ private:
 
     bool updateMaterial();
 
-    unsigned int computeLOD(Camera* camera, const BoundingBox& worldBounds);
-
     const Vector3& getAmbientColor() const;
 
     void setMaterialDirty();
 
     float computeHeight(float* heights, unsigned int width, unsigned int x, unsigned int z);
 
+    float computeHeight(float* heights, unsigned int width,
+                        unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2,
+                        unsigned int step, unsigned int x, unsigned int z);
+
+    float getMorph() const;
+
+    const Vector4& getEdgeMorph() const;
+
     void updateNodeBindings();
 
     std::string passCreated(Pass* pass);
@@ -147,8 +180,10 @@ private:
     std::vector<Texture::Sampler*> _samplers;
     mutable BoundingBox _boundingBox;
     mutable BoundingBox _boundingBoxWorld;
-    mutable Camera* _camera;
-    mutable unsigned int _level;
+    unsigned int _level;
+    float _morph;
+    Vector4 _edgeMorph;
+    unsigned int _edgeMask;
     mutable int _bits;
 };
 
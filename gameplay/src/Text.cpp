@@ -264,10 +264,11 @@ unsigned int Text::draw(bool wireframe)
             clipViewport.y += position.y;
         }
     }
+    // The text is only laid out again when it, its area or its layout settings change.
+    _drawFont->layoutText(&_run, _text.c_str(), Rectangle(position.x, position.y, _width, _height), _size,
+                          _align, _wrap, _rightToLeft);
     _drawFont->start();
-    _drawFont->drawText(_text.c_str(), Rectangle(position.x, position.y, _width, _height),
-                    Vector4(_color.x, _color.y, _color.z, _color.w * _opacity), _size,
-                    _align, _wrap, _rightToLeft, clipViewport);
+    _drawFont->drawText(&_run, Vector4(_color.x, _color.y, _color.z, _color.w * _opacity), clipViewport);
     _drawFont->finish();
     return 1;
 }
@@ -17,6 +17,9 @@ namespace gameplay
  * Defines a text block of characters to be drawn.
  *
  * Text can be attached to a node.
+ *
+ * The text is laid out into a Font::TextRun that the text owns, which is only laid
+ * out again when the text, its size, area, justification or wrapping changes.
  */
 class Text : public Ref, public Drawable, public AnimationTarget
 {
@@ -265,6 +268,7 @@ private:
     Rectangle _clip;
     float _opacity;
     Vector4 _color;
+    Font::TextRun _run;
 };
     
 }
@@ -68,6 +68,7 @@ void TextBox::setCaretLocation(unsigned int index)
     _caretLocation = index;
     if (_caretLocation > _text.length())
         _caretLocation = (unsigned int)_text.length();
+    setDirty(DIRTY_DRAW);
 }
 
 bool TextBox::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex)
@@ -309,6 +310,9 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
 
     _lastKeypress = key;
 
+    // Key presses may have moved the caret.
+    setDirty(DIRTY_DRAW);
+
     return Label::keyEvent(evt, key);
 }
 
@@ -468,6 +472,7 @@ void TextBox::setCaretLocation(int x, int y)
     {
         _caretLocation = _text.length();
     }
+    setDirty(DIRTY_DRAW);
 }
 
 void TextBox::getCaretLocation(Vector2* p)
@@ -481,6 +486,7 @@ void TextBox::getCaretLocation(Vector2* p)
 void TextBox::setPasswordChar(char character)
 {
     _passwordChar = character;
+    setDirty(DIRTY_DRAW);
 }
 
 char TextBox::getPasswordChar() const
@@ -491,6 +497,7 @@ char TextBox::getPasswordChar() const
 void TextBox::setInputMode(InputMode inputMode)
 {
     _inputMode = inputMode;
+    setDirty(DIRTY_DRAW);
 }
 
 TextBox::InputMode TextBox::getInputMode() const
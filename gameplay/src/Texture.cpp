@@ -2,6 +2,7 @@
 #include "Image.h"
 #include "Texture.h"
 #include "FileSystem.h"
+#include "Game.h"
 
 // PVRTC (GL_IMG_texture_compression_pvrtc) : Imagination based gpus
 #ifndef GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG
@@ -47,11 +48,23 @@
 namespace gameplay
 {
 
-static std::vector<Texture*> __textureCache;
+/**
+ * An asynchronous texture load in progress.
+ */
+struct AsyncTextureLoad
+{
+    AsyncTextureLoad() : generateMipmaps(false) { }
+
+    bool generateMipmaps;
+    std::vector<Texture::AsyncCallback> callbacks;
+};
+
+static ResourceCache __textureCache;
+static std::unordered_map<ResourceCache::Key, AsyncTextureLoad> __asyncLoads;
 static TextureHandle __currentTextureId = 0;
 static Texture::Type __currentTextureType = Texture::TEXTURE_2D;
 
-Texture::Texture() : _handle(0), _format(UNKNOWN), _type((Texture::Type)0), _width(0), _height(0), _mipmapped(false), _cached(false), _compressed(false),
+Texture::Texture() : _handle(0), _format(UNKNOWN), _type((Texture::Type)0), _width(0), _height(0), _mipmapped(false), _cacheKey(NULL), _compressed(false),
     _wrapS(Texture::REPEAT), _wrapT(Texture::REPEAT), _wrapR(Texture::REPEAT), _minFilter(Texture::NEAREST_MIPMAP_LINEAR), _magFilter(Texture::LINEAR)
 {
 }
@@ -65,14 +78,7 @@ Texture::~Texture()
     }
 
     // Remove ourself from the texture cache.
-    if (_cached)
-    {
-        std::vector<Texture*>::iterator itr = std::find(__textureCache.begin(), __textureCache.end(), this);
-        if (itr != __textureCache.end())
-        {
-            __textureCache.erase(itr);
-        }
-    }
+    __textureCache.remove(_cacheKey, this);
 }
 
 Texture* Texture::create(const char* path, bool generateMipmaps)
@@ -80,24 +86,20 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     GP_ASSERT( path );
 
     // Search texture cache first.
-    for (size_t i = 0, count = __textureCache.size(); i < count; ++i)
+    Texture* t = static_cast<Texture*>(__textureCache.find(path));
+    if (t)
     {
-        Texture* t = __textureCache[i];
-        GP_ASSERT( t );
-        if (t->_path == path)
+        // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the
+        // texture to generate its mipmap chain if it hasn't already done so.
+        if (generateMipmaps)
         {
-            // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the
-            // texture to generate its mipmap chain if it hasn't already done so.
-            if (generateMipmaps)
-            {
-                t->generateMipmaps();
-            }
+            t->generateMipmaps();
+        }
 
-            // Found a match.
-            t->addRef();
+        // Found a match.
+        t->addRef();
 
-            return t;
-        }
+        return t;
     }
 
     Texture* texture = NULL;
@@ -133,10 +135,9 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     if (texture)
     {
         texture->_path = path;
-        texture->_cached = true;
 
         // Add to texture cache.
-        __textureCache.push_back(texture);
+        texture->_cacheKey = __textureCache.add(path, texture);
 
         return texture;
     }
@@ -145,6 +146,93 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     return NULL;
 }
 
+void Texture::createAsync(const char* path, bool generateMipmaps, const AsyncCallback& callback)
+{
+    GP_ASSERT( path );
+    GP_ASSERT( callback );
+
+    // Only PNG images are decoded by the engine, compressed textures are uploaded as they are read.
+    JobSystem* jobSystem = Game::getInstance()->getJobSystem();
+    const char* ext = strrchr(FileSystem::resolvePath(path), '.');
+    bool png = ext && strlen(ext) == 4 && tolower(ext[1]) == 'p' && tolower(ext[2]) == 'n' && tolower(ext[3]) == 'g';
+    if (!png || !jobSystem || __textureCache.find(path))
+    {
+        callback(create(path, generateMipmaps));
+        return;
+    }
+
+    // Join a load of the same path that is already in flight.
+    ResourceCache::Key key = ResourceCache::intern(path);
+    AsyncTextureLoad& load = __asyncLoads[key];
+    bool pending = !load.callbacks.empty();
+    load.generateMipmaps = load.generateMipmaps || generateMipmaps;
+    load.callbacks.push_back(callback);
+    if (pending)
+        return;
+
+    jobSystem->run([jobSystem, key]()
+    {
+        Image* image = Image::create(key->c_str());
+        jobSystem->post(std::bind(&Texture::finishAsync, key, image), std::bind(&Texture::cancelAsync, key, image));
+    });
+}
+
+void Texture::finishAsync(ResourceCache::Key key, Image* image)
+{
+    std::unordered_map<ResourceCache::Key, AsyncTextureLoad>::iterator itr = __asyncLoads.find(key);
+    GP_ASSERT( itr != __asyncLoads.end() );
+    AsyncTextureLoad load;
+    std::swap(load, itr->second);
+    __asyncLoads.erase(itr);
+
+    // The texture may have been created synchronously while the image was decoding.
+    Texture* texture = static_cast<Texture*>(__textureCache.find(key->c_str()));
+    if (texture)
+    {
+        if (load.generateMipmaps)
+            texture->generateMipmaps();
+        texture->addRef();
+    }
+    else if (image)
+    {
+        texture = create(image, load.generateMipmaps);
+        if (texture)
+        {
+            texture->_path = *key;
+            texture->_cacheKey = __textureCache.add(key->c_str(), texture);
+        }
+    }
+    SAFE_RELEASE(image);
+
+    if (!texture)
+    {
+        GP_WARN("Failed to load texture from file '%s'.", key->c_str());
+    }
+
+    // Every callback owns a reference to the texture (callbacks are passed NULL if the load failed).
+    for (size_t i = 0, count = load.callbacks.size(); i < count; ++i)
+    {
+        if (texture && i > 0)
+            texture->addRef();
+        load.callbacks[i](texture);
+    }
+}
+
+void Texture::cancelAsync(ResourceCache::Key key, Image* image)
+{
+    std::unordered_map<ResourceCache::Key, AsyncTextureLoad>::iterator itr = __asyncLoads.find(key);
+    GP_ASSERT( itr != __asyncLoads.end() );
+    AsyncTextureLoad load;
+    std::swap(load, itr->second);
+    __asyncLoads.erase(itr);
+    SAFE_RELEASE(image);
+
+    for (size_t i = 0, count = load.callbacks.size(); i < count; ++i)
+    {
+        load.callbacks[i](NULL);
+    }
+}
+
 Texture* Texture::create(Image* image, bool generateMipmaps)
 {
     GP_ASSERT( image );
@@ -273,7 +361,7 @@ void Texture::setData(const unsigned char* data)
     // Don't work with any compressed or cached textures
     GP_ASSERT( data );
     GP_ASSERT( (!_compressed) );
-    GP_ASSERT( (!_cached) );
+    GP_ASSERT( (!_cacheKey) );
 
     GL_ASSERT( glBindTexture((GLenum)_type, _handle) );
 
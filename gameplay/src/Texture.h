@@ -3,6 +3,7 @@
 
 #include "Ref.h"
 #include "Stream.h"
+#include "ResourceCache.h"
 
 namespace gameplay
 {
@@ -176,6 +177,33 @@ public:
      */
     static Texture* create(const char* path, bool generateMipmaps = false);
 
+    /**
+     * Defines the callback invoked when an asynchronous texture load has finished.
+     *
+     * The texture is NULL if it could not be loaded. Otherwise the callback owns a
+     * reference to the texture and must release it when it is no longer needed.
+     */
+    typedef std::function<void(Texture* texture)> AsyncCallback;
+
+    /**
+     * Creates a texture from the given image resource without blocking the calling thread.
+     *
+     * PNG images are read and decoded on the game's job system and only the upload to the
+     * graphics device runs on the main thread, at the start of a later frame. Concurrent
+     * requests for the same path share a single load. Textures that are already cached, and
+     * compressed textures, are created immediately.
+     *
+     * This method must be called on the main thread and the callback is always invoked on
+     * the main thread. Loads that have not finished when the game shuts down are cancelled,
+     * and their callbacks invoked with NULL, before Game::finalize is called.
+     *
+     * @param path The image resource path.
+     * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
+     * @param callback The function invoked with the new texture once it has been created.
+     * @script{ignore}
+     */
+    static void createAsync(const char* path, bool generateMipmaps, const AsyncCallback& callback);
+
     /**
      * Creates a texture from the given image.
      *
@@ -320,6 +348,17 @@ private:
 
     static Texture* createCompressedDDS(const char* path);
 
+    /**
+     * Creates the texture for an asynchronous load on the main thread and invokes its callbacks.
+     */
+    static void finishAsync(ResourceCache::Key key, Image* image);
+
+    /**
+     * Cancels an asynchronous load when the game shuts down before the texture is created,
+     * invoking its callbacks with NULL.
+     */
+    static void cancelAsync(ResourceCache::Key key, Image* image);
+
     static GLubyte* readCompressedPVRTC(const char* path, Stream* stream, GLsizei* width, GLsizei* height, GLenum* format, unsigned int* mipMapCount, unsigned int* faceCount, GLenum faces[6]);
 
     static GLubyte* readCompressedPVRTCLegacy(const char* path, Stream* stream, GLsizei* width, GLsizei* height, GLenum* format, unsigned int* mipMapCount, unsigned int* faceCount, GLenum faces[6]);
@@ -333,7 +372,7 @@ private:
     unsigned int _width;
     unsigned int _height;
     bool _mipmapped;
-    bool _cached;
+    ResourceCache::Key _cacheKey;
     bool _compressed;
     Wrap _wrapS;
     Wrap _wrapT;
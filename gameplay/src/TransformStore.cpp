@@ -0,0 +1,395 @@
+#include "Base.h"
+#include "TransformStore.h"
+#include "Scene.h"
+#include "Node.h"
+#include "Game.h"
+
+// Entry flags
+#define ENTRY_DIRTY 1
+#define ENTRY_RESOLVED 2
+#define ENTRY_MOVED 4
+
+// Minimum number of entries to resolve before the work is split across threads.
+#define PARALLEL_THRESHOLD 4096
+
+// Minimum number of entries in a parallel segment.
+#define SEGMENT_MIN_SIZE 256
+
+namespace gameplay
+{
+
+// Returns the number of threads that may resolve transforms in parallel.
+static unsigned int getThreadCount(unsigned int workerCount)
+{
+    JobSystem* jobSystem = Game::getInstance()->getJobSystem();
+    if (jobSystem == NULL || jobSystem->isSingleThreaded())
+        return 1;
+
+    unsigned int threadCount = jobSystem->getWorkerCount() + 1;
+    return workerCount ? std::min(workerCount, threadCount) : threadCount;
+}
+
+TransformStore::TransformStore(Scene* scene)
+    : _scene(scene), _firstDirty(0), _dirtyCount(0), _stamp(0), _updateStamp(0), _notifying(-1), _workerCount(1), _layoutDirty(true)
+{
+}
+
+TransformStore::~TransformStore()
+{
+}
+
+unsigned int TransformStore::getNodeCount() const
+{
+    return (unsigned int)_nodes.size();
+}
+
+unsigned int TransformStore::getWorkerCount() const
+{
+    return _workerCount;
+}
+
+void TransformStore::setWorkerCount(unsigned int count)
+{
+    if (_workerCount != count)
+    {
+        _workerCount = count;
+
+        // The parallel segments depend on the worker count.
+        invalidate();
+    }
+}
+
+void TransformStore::invalidate()
+{
+    _layoutDirty = true;
+}
+
+void TransformStore::setDirty(int index)
+{
+    // The node being notified of its move by the store is already resolved.
+    if (index < 0 || index >= (int)_dirty.size() || index == _notifying)
+        return;
+
+    _changeStamps[index] = ++_stamp;
+    if ((_dirty[index] & ENTRY_DIRTY) == 0)
+    {
+        _dirty[index] |= ENTRY_DIRTY;
+        ++_dirtyCount;
+    }
+    if ((unsigned int)index < _firstDirty)
+    {
+        _firstDirty = (unsigned int)index;
+    }
+}
+
+const Matrix& TransformStore::getWorldMatrix(int index) const
+{
+    GP_ASSERT(index >= 0 && index < (int)_world.size());
+    return _world[index];
+}
+
+bool TransformStore::isPending() const
+{
+    return _layoutDirty || _dirtyCount > 0;
+}
+
+const Matrix& TransformStore::resolve(Node* node)
+{
+    GP_ASSERT(node);
+
+    // The whole store is resolved after its layout changed, since the entries moved.
+    if (_layoutDirty)
+    {
+        update();
+    }
+    GP_ASSERT(node->_transformStore == this);
+
+    int index = node->_transformIndex;
+    GP_ASSERT(index >= 0 && index < (int)_world.size());
+    if (_dirtyCount > 0)
+    {
+        resolveChain((unsigned int)index);
+    }
+    return _world[index];
+}
+
+unsigned int TransformStore::resolveChain(unsigned int index)
+{
+    // Resolve the ancestors first: the entry is stale if it was resolved before the
+    // latest change of its local transform or of the local transform of an ancestor.
+    unsigned int changeStamp = _changeStamps[index];
+    int parent = _parents[index];
+    if (parent >= 0)
+    {
+        changeStamp = std::max(changeStamp, resolveChain((unsigned int)parent));
+    }
+    if (std::max(_resolveStamps[index], _updateStamp) < changeStamp)
+    {
+        // The entry stays dirty, so that the next update still resolves its subtree.
+        if (_dirty[index] & ENTRY_DIRTY)
+        {
+            _local[index] = _nodes[index]->getMatrix();
+        }
+        updateEntry(index);
+        _resolveStamps[index] = _stamp;
+    }
+    return changeStamp;
+}
+
+void TransformStore::rebuild()
+{
+    _layoutDirty = false;
+
+    // Keep the previously resolved world matrices around so that nodes that are not
+    // resolved by the next pass (such as static nodes) keep their current world matrix.
+    std::vector<Matrix> oldWorld;
+    oldWorld.swap(_world);
+
+    size_t capacity = _nodes.size();
+    _nodes.clear();
+    _parents.clear();
+    _subtreeSizes.clear();
+    _local.clear();
+    _dirty.clear();
+    _changeStamps.clear();
+    _resolveStamps.clear();
+    _heads.clear();
+    _segments.clear();
+    _nodes.reserve(capacity);
+    _parents.reserve(capacity);
+    _subtreeSizes.reserve(capacity);
+    _local.reserve(capacity);
+    _world.reserve(capacity);
+    _dirty.reserve(capacity);
+    _changeStamps.reserve(capacity);
+    _resolveStamps.reserve(capacity);
+
+    // Every entry is changed by the rebuild.
+    ++_stamp;
+
+    for (Node* node = _scene->getFirstNode(); node != NULL; node = node->getNextSibling())
+    {
+        add(node, -1, oldWorld);
+    }
+
+    // Everything is resolved again after a rebuild.
+    unsigned int count = (unsigned int)_nodes.size();
+    _firstDirty = 0;
+    _dirtyCount = count;
+
+    // Split the hierarchy into segments that can be resolved independently.
+    unsigned int workers = getThreadCount(_workerCount);
+    if (workers > 1)
+    {
+        unsigned int target = std::max(count / (workers * 4), (unsigned int)SEGMENT_MIN_SIZE);
+        for (unsigned int i = 0; i < count; i += _subtreeSizes[i])
+        {
+            split(i, target);
+        }
+    }
+}
+
+void TransformStore::add(Node* node, int parent, const std::vector<Matrix>& oldWorld)
+{
+    GP_ASSERT(node);
+
+    unsigned int index = (unsigned int)_nodes.size();
+    _nodes.push_back(node);
+    _parents.push_back(parent);
+    _subtreeSizes.push_back(1);
+    _local.push_back(node->getMatrix());
+    if (node->_transformStore == this && node->_transformIndex >= 0 && node->_transformIndex < (int)oldWorld.size())
+        _world.push_back(oldWorld[node->_transformIndex]);
+    else
+        _world.push_back(node->_world);
+    _dirty.push_back(ENTRY_DIRTY);
+    _changeStamps.push_back(_stamp);
+    _resolveStamps.push_back(0);
+
+    node->_transformStore = this;
+    node->_transformIndex = (int)index;
+
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        add(child, (int)index, oldWorld);
+    }
+    _subtreeSizes[index] = (unsigned int)_nodes.size() - index;
+}
+
+void TransformStore::split(unsigned int index, unsigned int target)
+{
+    unsigned int size = _subtreeSizes[index];
+    if (size <= target)
+    {
+        // Merge with the previous segment when it shares the same parent and is still small.
+        if (!_segments.empty())
+        {
+            Segment& last = _segments.back();
+            if (last.parent == _parents[index] && last.end == index && (last.end - last.start) + size <= target)
+            {
+                last.end = index + size;
+                return;
+            }
+        }
+        Segment segment = { index, index + size, _parents[index] };
+        _segments.push_back(segment);
+        return;
+    }
+
+    // Too large for a single segment: resolve this entry serially and split its children.
+    _heads.push_back(index);
+    for (unsigned int child = index + 1; child < index + size; child += _subtreeSizes[child])
+    {
+        split(child, target);
+    }
+}
+
+void TransformStore::update()
+{
+    if (_layoutDirty)
+    {
+        rebuild();
+    }
+    if (_dirtyCount == 0)
+        return;
+
+    unsigned int count = (unsigned int)_nodes.size();
+    unsigned int firstDirty = _firstDirty;
+    unsigned int workers = getThreadCount(_workerCount);
+    if (workers > 1 && _segments.size() > 1 && count - _firstDirty >= PARALLEL_THRESHOLD)
+    {
+        // Resolve the ancestors of the parallel segments first, in parent-sorted order.
+        for (size_t i = 0, headCount = _heads.size(); i < headCount; ++i)
+        {
+            unsigned int head = _heads[i];
+            if (head < _firstDirty)
+                continue;
+            int parent = _parents[head];
+            if (_dirty[head] & ENTRY_DIRTY)
+            {
+                _local[head] = _nodes[head]->getMatrix();
+                updateEntry(head);
+                _dirty[head] = ENTRY_RESOLVED;
+            }
+            else if (parent >= 0 && (_dirty[parent] & ENTRY_RESOLVED))
+            {
+                updateEntry(head);
+                _dirty[head] = ENTRY_RESOLVED | ENTRY_MOVED;
+            }
+        }
+
+        // Distribute the remaining segments evenly (by entry count) across the workers.
+        unsigned int segmentCount = (unsigned int)_segments.size();
+        unsigned int first = 0;
+        while (first < segmentCount && _segments[first].end <= _firstDirty)
+            ++first;
+        unsigned int remaining = 0;
+        for (unsigned int i = first; i < segmentCount; ++i)
+            remaining += _segments[i].end - _segments[i].start;
+        unsigned int chunk = remaining / workers + 1;
+
+        JobSystem* jobSystem = Game::getInstance()->getJobSystem();
+        JobSystem::Counter counter;
+        unsigned int start = first;
+        unsigned int size = 0;
+        for (unsigned int i = first; i < segmentCount; ++i)
+        {
+            size += _segments[i].end - _segments[i].start;
+            if (size >= chunk && i + 1 < segmentCount)
+            {
+                jobSystem->run(std::bind(&TransformStore::updateSegments, this, start, i + 1), &counter);
+                start = i + 1;
+                size = 0;
+            }
+        }
+        updateSegments(start, segmentCount);
+        jobSystem->wait(&counter);
+
+        for (size_t i = 0, headCount = _heads.size(); i < headCount; ++i)
+        {
+            _dirty[_heads[i]] &= ENTRY_MOVED;
+        }
+    }
+    else
+    {
+        updateRange(_firstDirty, count, false);
+    }
+
+    _firstDirty = count;
+    _dirtyCount = 0;
+    _updateStamp = _stamp;
+
+    notifyMoved(firstDirty);
+}
+
+void TransformStore::notifyMoved(unsigned int start)
+{
+    // Nodes in the store do not notify their descendants when they move, so notify the
+    // descendants that were resolved by the update once their world matrices are final.
+    for (unsigned int i = start, count = (unsigned int)_nodes.size(); i < count; ++i)
+    {
+        if (_dirty[i] & ENTRY_MOVED)
+        {
+            _dirty[i] &= ~ENTRY_MOVED;
+            _notifying = (int)i;
+            _nodes[i]->transformChanged();
+        }
+    }
+    _notifying = -1;
+}
+
+void TransformStore::updateSegments(unsigned int first, unsigned int last)
+{
+    for (unsigned int i = first; i < last; ++i)
+    {
+        const Segment& segment = _segments[i];
+        if (segment.end <= _firstDirty)
+            continue;
+        bool force = segment.parent >= 0 && (_dirty[segment.parent] & ENTRY_RESOLVED);
+        updateRange(force ? segment.start : std::max(segment.start, _firstDirty), segment.end, force);
+    }
+}
+
+void TransformStore::updateRange(unsigned int start, unsigned int end, bool force)
+{
+    // Entries are sorted in depth-first order, so the subtree of a dirty entry
+    // is the contiguous range that immediately follows it.
+    unsigned int dirtyEnd = force ? end : start;
+    for (unsigned int i = start; i < end; ++i)
+    {
+        if (_dirty[i] & ENTRY_DIRTY)
+        {
+            _local[i] = _nodes[i]->getMatrix();
+            dirtyEnd = std::max(dirtyEnd, i + _subtreeSizes[i]);
+            _dirty[i] = 0;
+            updateEntry(i);
+        }
+        else if (i < dirtyEnd)
+        {
+            // Moved by an ancestor: the node is notified once the update is complete.
+            _dirty[i] = ENTRY_MOVED;
+            updateEntry(i);
+        }
+    }
+}
+
+void TransformStore::updateEntry(unsigned int index)
+{
+    Node* node = _nodes[index];
+    if (node->isStatic())
+        return;
+
+    // Nodes driven by a non-kinematic collision object are positioned in world space.
+    int parent = _parents[index];
+    PhysicsCollisionObject* collisionObject = node->_collisionObject;
+    if (parent >= 0 && (!collisionObject || collisionObject->isKinematic()))
+    {
+        Matrix::multiply(_world[parent], _local[index], &_world[index]);
+    }
+    else
+    {
+        _world[index] = _local[index];
+    }
+}
+
+}
@@ -0,0 +1,197 @@
+#ifndef TRANSFORMSTORE_H_
+#define TRANSFORMSTORE_H_
+
+#include "Matrix.h"
+
+namespace gameplay
+{
+
+class Scene;
+class Node;
+
+/**
+ * Defines a flat, data-oriented store for the resolved transforms of a scene.
+ *
+ * The store keeps the local and world matrices of every node in a scene in
+ * contiguous arrays, sorted so that each parent precedes all of its descendants
+ * (depth-first pre-order). World matrices are resolved with a single linear pass
+ * that only recomputes the subranges whose local transforms (or ancestors) changed,
+ * instead of lazily recursing through the node hierarchy.
+ *
+ * Node and Transform keep their existing API on top of the store: Node::getWorldMatrix()
+ * returns the matrix held by the store, resolving only the node and its ancestors on
+ * demand. Nodes in the store do not dirty their descendants one by one when they move:
+ * the descendants are notified (their bounds, spatial index proxies and transform
+ * listeners) when the store is updated.
+ *
+ * Independent subtrees of the scene are processed in parallel when the number of
+ * dirty entries is large enough and more than one worker thread is allowed.
+ *
+ * @see Scene::setTransformStoreEnabled
+ * @script{ignore}
+ */
+class TransformStore
+{
+    friend class Scene;
+    friend class Node;
+
+public:
+
+    /**
+     * Gets the number of nodes currently held by the store.
+     *
+     * @return The number of nodes in the store.
+     */
+    unsigned int getNodeCount() const;
+
+    /**
+     * Gets the maximum number of threads used to resolve world matrices.
+     *
+     * @return The worker thread count.
+     * @see JobSystem
+     */
+    unsigned int getWorkerCount() const;
+
+    /**
+     * Sets the maximum number of threads used to resolve world matrices.
+     *
+     * A value of 1 (the default) resolves all transforms on the calling thread.
+     * A value of 0 uses all threads of the game's job system.
+     *
+     * @param count The worker thread count.
+     */
+    void setWorkerCount(unsigned int count);
+
+    /**
+     * Resolves the world matrices of all dirty nodes held by the store.
+     *
+     * This is called automatically by Scene::update(), and notifies the nodes that were
+     * moved by one of their ancestors since the last update.
+     */
+    void update();
+
+private:
+
+    /**
+     * A contiguous range of entries whose root is either a scene root or
+     * the child of an entry resolved in the serial phase.
+     */
+    struct Segment
+    {
+        unsigned int start;
+        unsigned int end;
+        int parent;
+    };
+
+    /**
+     * Constructor.
+     */
+    TransformStore(Scene* scene);
+
+    /**
+     * Hidden copy constructor.
+     */
+    TransformStore(const TransformStore& copy);
+
+    /**
+     * Destructor.
+     */
+    ~TransformStore();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TransformStore& operator=(const TransformStore&);
+
+    /**
+     * Marks the layout of the store as invalid so that it is rebuilt on the next update.
+     */
+    void invalidate();
+
+    /**
+     * Marks the entry at the specified index (and therefore its subtree) as dirty.
+     */
+    void setDirty(int index);
+
+    /**
+     * Gets the resolved world matrix for the entry at the specified index.
+     */
+    const Matrix& getWorldMatrix(int index) const;
+
+    /**
+     * Determines if the store has pending layout or transform changes.
+     */
+    bool isPending() const;
+
+    /**
+     * Resolves the world matrix of the specified node and of its ancestors only.
+     *
+     * The whole store is updated if its layout must be rebuilt first.
+     */
+    const Matrix& resolve(Node* node);
+
+    /**
+     * Resolves the entry at the specified index after its ancestors.
+     *
+     * @return The stamp of the latest change to the entry or one of its ancestors.
+     */
+    unsigned int resolveChain(unsigned int index);
+
+    /**
+     * Notifies the nodes moved by an ancestor during the last update, from the specified index.
+     */
+    void notifyMoved(unsigned int start);
+
+    /**
+     * Rebuilds the parent-sorted arrays from the scene hierarchy.
+     */
+    void rebuild();
+
+    /**
+     * Appends the specified node and its descendants to the arrays.
+     */
+    void add(Node* node, int parent, const std::vector<Matrix>& oldWorld);
+
+    /**
+     * Splits the entries into serial heads and parallel segments.
+     */
+    void split(unsigned int index, unsigned int target);
+
+    /**
+     * Resolves the entries in the range [start, end).
+     */
+    void updateRange(unsigned int start, unsigned int end, bool force);
+
+    /**
+     * Resolves the segments in the range [first, last).
+     */
+    void updateSegments(unsigned int first, unsigned int last);
+
+    /**
+     * Resolves a single entry.
+     */
+    void updateEntry(unsigned int index);
+
+    Scene* _scene;
+    std::vector<Node*> _nodes;
+    std::vector<int> _parents;
+    std::vector<unsigned int> _subtreeSizes;
+    std::vector<Matrix> _local;
+    std::vector<Matrix> _world;
+    std::vector<unsigned char> _dirty;
+    std::vector<unsigned int> _changeStamps;
+    std::vector<unsigned int> _resolveStamps;
+    std::vector<unsigned int> _heads;
+    std::vector<Segment> _segments;
+    unsigned int _firstDirty;
+    unsigned int _dirtyCount;
+    unsigned int _stamp;
+    unsigned int _updateStamp;
+    int _notifying;
+    unsigned int _workerCount;
+    bool _layoutDirty;
+};
+
+}
+
+#endif
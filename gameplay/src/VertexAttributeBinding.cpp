@@ -10,7 +10,7 @@ static GLuint __maxVertexAttribs = 0;
 static std::vector<VertexAttributeBinding*> __vertexAttributeBindingCache;
 
 VertexAttributeBinding::VertexAttributeBinding() :
-    _handle(0), _attributes(NULL), _mesh(NULL), _effect(NULL)
+    _handle(0), _attributes(NULL), _mesh(NULL), _effect(NULL), _instanceBuffer(0)
 {
 }
 
@@ -68,7 +68,26 @@ VertexAttributeBinding* VertexAttributeBinding::create(const VertexFormat& verte
     return create(NULL, vertexFormat, vertexPointer, effect);
 }
 
-VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
+VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effect, const VertexFormat& instanceFormat, VertexBufferHandle instanceBuffer)
+{
+    GP_ASSERT(mesh);
+
+    return create(mesh, mesh->getVertexFormat(), 0, effect, &instanceFormat, instanceBuffer);
+}
+
+bool VertexAttributeBinding::isInstancingSupported()
+{
+#if defined(GP_USE_INSTANCING) && defined(__APPLE__)
+    return true;
+#elif defined(GP_USE_INSTANCING)
+    return glVertexAttribDivisor && glDrawElementsInstanced && glDrawArraysInstanced;
+#else
+    return false;
+#endif
+}
+
+VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect,
+                                                       const VertexFormat* instanceFormat, VertexBufferHandle instanceBuffer)
 {
     GP_ASSERT(effect);
 
@@ -125,6 +144,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
             attribs[i].type = GL_FLOAT;
             attribs[i].normalized = GL_FALSE;
             attribs[i].pointer = 0;
+            attribs[i].instanced = false;
         }
         b->_attributes = attribs;
     }
@@ -138,6 +158,29 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
     b->_effect = effect;
     effect->addRef();
 
+    b->setVertexAttribPointers(vertexFormat, vertexPointer, effect, false);
+
+    // Per-instance elements are read from the instance buffer (when instancing is supported).
+    if (instanceFormat && instanceBuffer && isInstancingSupported())
+    {
+        b->_instanceBuffer = instanceBuffer;
+        if (b->_handle)
+        {
+            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer) );
+        }
+        b->setVertexAttribPointers(*instanceFormat, 0, effect, true);
+    }
+
+    if (b->_handle)
+    {
+        GL_ASSERT( glBindVertexArray(0) );
+    }
+
+    return b;
+}
+
+void VertexAttributeBinding::setVertexAttribPointers(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect, bool instanced)
+{
     // Call setVertexAttribPointer for each vertex element.
     std::string name;
     size_t offset = 0;
@@ -170,6 +213,12 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
         case VertexFormat::BLENDINDICES:
             attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_BLENDINDICES_NAME);
             break;
+        case VertexFormat::INSTANCE_MATRIX:
+            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME);
+            break;
+        case VertexFormat::INSTANCE_COLOR:
+            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_COLOR_NAME);
+            break;
         case VertexFormat::TEXCOORD0:
             if ((attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME)) != -1)
                 break;
@@ -195,24 +244,29 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
         {
             //GP_WARN("Warning: Vertex element with usage '%s' in mesh '%s' does not correspond to an attribute in effect '%s'.", VertexFormat::toString(e.usage), mesh->getUrl(), effect->getId());
         }
+        else if (e.usage == VertexFormat::INSTANCE_MATRIX)
+        {
+            // Matrices are bound one column per attribute.
+            GP_ASSERT(e.size == 16);
+            for (unsigned int column = 0; column < 4; ++column)
+            {
+                size_t columnOffset = offset + column * 4 * sizeof(float);
+                void* pointer = vertexPointer ? (void*)(((unsigned char*)vertexPointer) + columnOffset) : (void*)columnOffset;
+                setVertexAttribPointer(attrib + column, 4, GL_FLOAT, GL_FALSE, (GLsizei)vertexFormat.getVertexSize(), pointer, instanced);
+            }
+        }
         else
         {
             void* pointer = vertexPointer ? (void*)(((unsigned char*)vertexPointer) + offset) : (void*)offset;
-            b->setVertexAttribPointer(attrib, (GLint)e.size, GL_FLOAT, GL_FALSE, (GLsizei)vertexFormat.getVertexSize(), pointer);
+            setVertexAttribPointer(attrib, (GLint)e.size, GL_FLOAT, GL_FALSE, (GLsizei)vertexFormat.getVertexSize(), pointer, instanced);
         }
 
         offset += e.size * sizeof(float);
     }
 
-    if (b->_handle)
-    {
-        GL_ASSERT( glBindVertexArray(0) );
-    }
-
-    return b;
 }
 
-void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer)
+void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer, bool instanced)
 {
     GP_ASSERT(indx < (GLuint)__maxVertexAttribs);
 
@@ -221,6 +275,12 @@ void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLe
         // Hardware mode.
         GL_ASSERT( glVertexAttribPointer(indx, size, type, normalize, stride, pointer) );
         GL_ASSERT( glEnableVertexAttribArray(indx) );
+#ifdef GP_USE_INSTANCING
+        if (instanced)
+        {
+            GL_ASSERT( glVertexAttribDivisor(indx, 1) );
+        }
+#endif
     }
     else
     {
@@ -232,6 +292,7 @@ void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLe
         _attributes[indx].normalized = normalize;
         _attributes[indx].stride = stride;
         _attributes[indx].pointer = pointer;
+        _attributes[indx].instanced = instanced;
     }
 }
 
@@ -258,12 +319,29 @@ void VertexAttributeBinding::bind()
         for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
         {
             VertexAttribute& a = _attributes[i];
-            if (a.enabled)
+            if (a.enabled && !a.instanced)
             {
                 GL_ASSERT( glVertexAttribPointer(i, a.size, a.type, a.normalized, a.stride, a.pointer) );
                 GL_ASSERT( glEnableVertexAttribArray(i) );
             }
         }
+
+#ifdef GP_USE_INSTANCING
+        if (_instanceBuffer)
+        {
+            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer) );
+            for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
+            {
+                VertexAttribute& a = _attributes[i];
+                if (a.enabled && a.instanced)
+                {
+                    GL_ASSERT( glVertexAttribPointer(i, a.size, a.type, a.normalized, a.stride, a.pointer) );
+                    GL_ASSERT( glEnableVertexAttribArray(i) );
+                    GL_ASSERT( glVertexAttribDivisor(i, 1) );
+                }
+            }
+        }
+#endif
     }
 }
 
@@ -277,7 +355,7 @@ void VertexAttributeBinding::unbind()
     else
     {
         // Software mode
-        if (_mesh)
+        if (_mesh || _instanceBuffer)
         {
             GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
         }
@@ -288,6 +366,12 @@ void VertexAttributeBinding::unbind()
             if (_attributes[i].enabled)
             {
                 GL_ASSERT( glDisableVertexAttribArray(i) );
+#ifdef GP_USE_INSTANCING
+                if (_attributes[i].instanced)
+                {
+                    GL_ASSERT( glVertexAttribDivisor(i, 0) );
+                }
+#endif
             }
         }
     }
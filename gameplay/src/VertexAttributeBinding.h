@@ -68,6 +68,36 @@ public:
      */
     static VertexAttributeBinding* create(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
 
+    /**
+     * Creates a new VertexAttributeBinding between the given Mesh, per-instance vertex
+     * buffer and Effect, for instanced drawing.
+     *
+     * The elements of the instance format are read from the instance buffer once per
+     * instance rather than once per vertex. Unlike the bindings of a mesh alone, instanced
+     * bindings are not shared, since every instance buffer needs its own binding.
+     *
+     * If instanced arrays are not supported by the current device, the elements of the
+     * instance format are not bound at all, and their values must be set as constant
+     * vertex attributes before each draw call instead.
+     *
+     * @param mesh The mesh.
+     * @param effect The effect.
+     * @param instanceFormat The vertex format of the instance buffer.
+     * @param instanceBuffer The instance buffer.
+     *
+     * @return A new VertexAttributeBinding for the requested parameters.
+     * @script{ignore}
+     */
+    static VertexAttributeBinding* create(Mesh* mesh, Effect* effect, const VertexFormat& instanceFormat, VertexBufferHandle instanceBuffer);
+
+    /**
+     * Determines if instanced arrays and instanced draw calls are supported by the current device.
+     *
+     * @return true if instancing is supported, false otherwise.
+     * @script{ignore}
+     */
+    static bool isInstancingSupported();
+
     /**
      * Binds this vertex array object.
      */
@@ -89,6 +119,7 @@ private:
         bool normalized;
         unsigned int stride;
         void* pointer;
+        bool instanced;
     };
 
     /**
@@ -106,14 +137,18 @@ private:
      */
     VertexAttributeBinding& operator=(const VertexAttributeBinding&);
 
-    static VertexAttributeBinding* create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
+    static VertexAttributeBinding* create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect,
+                                          const VertexFormat* instanceFormat = NULL, VertexBufferHandle instanceBuffer = 0);
+
+    void setVertexAttribPointers(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect, bool instanced);
 
-    void setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer);
+    void setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer, bool instanced);
 
     GLuint _handle;
     VertexAttribute* _attributes;
     Mesh* _mesh;
     Effect* _effect;
+    VertexBufferHandle _instanceBuffer;
 };
 
 }
@@ -115,6 +115,10 @@ const char* VertexFormat::toString(Usage usage)
         return "TEXCOORD6";
     case TEXCOORD7:
         return "TEXCOORD7";
+    case INSTANCE_MATRIX:
+        return "INSTANCE_MATRIX";
+    case INSTANCE_COLOR:
+        return "INSTANCE_COLOR";
     default:
         return "UNKNOWN";
     }
@@ -32,7 +32,9 @@ public:
         TEXCOORD4 = 12,
         TEXCOORD5 = 13,
         TEXCOORD6 = 14,
-        TEXCOORD7 = 15
+        TEXCOORD7 = 15,
+        INSTANCE_MATRIX = 16,
+        INSTANCE_COLOR = 17
     };
 
     /**
@@ -42,6 +44,11 @@ public:
      * have a varying number of float values (1-4), which is represented
      * by the size attribute. Additionally, vertex elements are assumed
      * to be tightly packed.
+     *
+     * The INSTANCE_MATRIX and INSTANCE_COLOR elements are read once per
+     * instance rather than once per vertex. An INSTANCE_MATRIX element
+     * has 16 values and is bound to four consecutive attributes (one
+     * per matrix column).
      */
     class Element
     {
@@ -11,6 +11,7 @@
 #include "Bundle.h"
 #include "MathUtil.h"
 #include "Logger.h"
+#include "JobSystem.h"
 
 // Math
 #include "Rectangle.h"
@@ -29,6 +30,7 @@
 
 // Graphics
 #include "Image.h"
+#include "ResourceCache.h"
 #include "Texture.h"
 #include "Mesh.h"
 #include "MeshPart.h"
@@ -39,11 +41,16 @@
 #include "VertexAttributeBinding.h"
 #include "Drawable.h"
 #include "Model.h"
+#include "InstancedModel.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "Light.h"
 #include "Node.h"
 #include "Joint.h"
 #include "Scene.h"
+#include "AsyncSceneLoader.h"
+#include "TransformStore.h"
+#include "SpatialIndex.h"
 #include "Font.h"
 #include "SpriteBatch.h"
 #include "Sprite.h"
@@ -1028,6 +1028,8 @@ void luaRegister_lua_Global()
         gameplay::ScriptUtil::registerEnumValue(VertexFormat::TEXCOORD5, "TEXCOORD5", scopePath);
         gameplay::ScriptUtil::registerEnumValue(VertexFormat::TEXCOORD6, "TEXCOORD6", scopePath);
         gameplay::ScriptUtil::registerEnumValue(VertexFormat::TEXCOORD7, "TEXCOORD7", scopePath);
+        gameplay::ScriptUtil::registerEnumValue(VertexFormat::INSTANCE_MATRIX, "INSTANCE_MATRIX", scopePath);
+        gameplay::ScriptUtil::registerEnumValue(VertexFormat::INSTANCE_COLOR, "INSTANCE_COLOR", scopePath);
     }
 }
 
@@ -145,8 +145,10 @@ void SceneCreateSample::render(float elapsedTime)
     // Clear the color and depth buffers
     clear(CLEAR_COLOR_DEPTH, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0);
 
-    // Visit all the nodes in the scene, drawing the models.
-    _scene->visit(this, &SceneCreateSample::drawScene);
+    // Submit the models in the scene to the render queue, which draws them sorted by material.
+    _renderQueue.begin(_scene->getActiveCamera());
+    _renderQueue.submit(_scene);
+    _renderQueue.execute();
 
     drawFrameRate(_font, Vector4(0, 0.5f, 1, 1), 5, 1, getFrameRate());
 }
@@ -167,12 +169,4 @@ void SceneCreateSample::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned
     case Touch::TOUCH_MOVE:
         break;
     };
-}
-
-bool SceneCreateSample::drawScene(Node* node)
-{
-    Drawable* drawable = node->getDrawable();
-    if (drawable)
-        drawable->draw();
-    return true;
 }
\ No newline at end of file
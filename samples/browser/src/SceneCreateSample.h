@@ -29,10 +29,9 @@ protected:
 
 private:
 
-    bool drawScene(Node* node);
-
     Font* _font;
     Scene* _scene;
+    RenderQueue _renderQueue;
     Node* _cubeNode;
 };
 
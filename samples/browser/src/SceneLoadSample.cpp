@@ -58,8 +58,10 @@ void SceneLoadSample::render(float elapsedTime)
     // Clear the color and depth buffers
     clear(CLEAR_COLOR_DEPTH, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0);
 
-    // Visit all the nodes in the scene, drawing the models/mesh.
-    _scene->visit(this, &SceneLoadSample::drawScene);
+    // Submit the models in the scene to the render queue, which draws them sorted by material.
+    _renderQueue.begin(_scene->getActiveCamera());
+    _renderQueue.submit(_scene, _wireFrame);
+    _renderQueue.execute();
 
     drawFrameRate(_font, Vector4(0, 0.5f, 1, 1), 5, 1, getFrameRate());
 }
@@ -96,11 +98,3 @@ void SceneLoadSample::keyEvent(Keyboard::KeyEvent evt, int key)
         }
     }
 }
-
-bool SceneLoadSample::drawScene(Node* node)
-{
-    Drawable* drawable = node->getDrawable();
-    if (drawable)
-        drawable->draw(_wireFrame);
-    return true;
-}
@@ -33,10 +33,9 @@ private:
 
     bool initializeMaterials(Node* node);
 
-    bool drawScene(Node* node);
-
     Font* _font;
     Scene* _scene;
+    RenderQueue _renderQueue;
     bool _wireFrame;
 };
 
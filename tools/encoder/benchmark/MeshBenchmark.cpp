@@ -0,0 +1,148 @@
+#include "../src/Base.h"
+#include "../src/Mesh.h"
+#include "../src/MeshPart.h"
+#include "../src/Vertex.h"
+#include <chrono>
+
+using namespace gameplay;
+
+// Default number of quads along each side of the synthetic grid
+#define DEFAULT_GRID_SIZE   1024
+
+// Number of meshes the grid is split into for the parallel benchmark
+#define MESH_COUNT          16
+
+/**
+ * Creates a mesh with a vertex per triangle corner for the rows [firstRow, lastRow) of a grid,
+ * like the FBX scene encoder does before welding.
+ */
+static Mesh* createGridMesh(unsigned int size, unsigned int firstRow, unsigned int lastRow)
+{
+    Mesh* mesh = new Mesh();
+    MeshPart* part = new MeshPart();
+    mesh->addMeshPart(part);
+    mesh->vertices.reserve((lastRow - firstRow) * size * 6);
+
+    static const unsigned int corners[6][2] = { {0, 0}, {1, 0}, {0, 1}, {0, 1}, {1, 0}, {1, 1} };
+    for (unsigned int z = firstRow; z < lastRow; ++z)
+    {
+        for (unsigned int x = 0; x < size; ++x)
+        {
+            for (unsigned int i = 0; i < 6; ++i)
+            {
+                float u = (float)(x + corners[i][0]) / size;
+                float v = (float)(z + corners[i][1]) / size;
+                Vertex vertex;
+                vertex.position = Vector3(u * 100.0f, sin(u * 20.0f) * cos(v * 20.0f), v * 100.0f);
+                vertex.normal = Vector3(0.0f, 1.0f, 0.0f);
+                vertex.hasNormal = true;
+                vertex.texCoord[0] = Vector2(u, v);
+                vertex.hasTexCoord[0] = true;
+                part->addIndex((unsigned int)mesh->vertices.size());
+                mesh->vertices.push_back(vertex);
+            }
+        }
+    }
+    return mesh;
+}
+
+static void deleteMesh(Mesh* mesh)
+{
+    for (size_t i = 0; i < mesh->parts.size(); ++i)
+    {
+        delete mesh->parts[i];
+    }
+    delete mesh;
+}
+
+/**
+ * Welds the vertices of a mesh with an ordered map, like the encoder used to.
+ */
+static void weldVerticesWithMap(Mesh* mesh)
+{
+    std::vector<Vertex> corners;
+    corners.swap(mesh->vertices);
+    std::map<Vertex, unsigned int> lookup;
+    std::vector<unsigned int> remap(corners.size());
+    for (size_t i = 0; i < corners.size(); ++i)
+    {
+        std::map<Vertex, unsigned int>::iterator it = lookup.find(corners[i]);
+        if (it == lookup.end())
+        {
+            it = lookup.insert(std::make_pair(corners[i], (unsigned int)mesh->vertices.size())).first;
+            mesh->vertices.push_back(corners[i]);
+        }
+        remap[i] = it->second;
+    }
+    for (size_t i = 0; i < mesh->parts.size(); ++i)
+    {
+        mesh->parts[i]->remapIndices(remap);
+    }
+}
+
+static double getSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void report(const char* name, size_t cornerCount, size_t vertexCount, double seconds)
+{
+    printf("%-24s %10lu corners -> %9lu vertices  %8.3f s  %8.2f M vertices/s\n",
+        name, (unsigned long)cornerCount, (unsigned long)vertexCount, seconds, cornerCount / seconds / 1000000.0);
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int size = argc > 1 ? (unsigned int)atoi(argv[1]) : DEFAULT_GRID_SIZE;
+    if (size == 0)
+    {
+        printf("Usage: gameplay-encoder-benchmark [grid size]\n");
+        return 1;
+    }
+    printf("Welding a grid of %ux%u quads.\n", size, size);
+
+    // Ordered map (reference).
+    {
+        Mesh* mesh = createGridMesh(size, 0, size);
+        size_t cornerCount = mesh->vertices.size();
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        weldVerticesWithMap(mesh);
+        report("std::map, 1 mesh", cornerCount, mesh->vertices.size(), getSeconds(start));
+        deleteMesh(mesh);
+    }
+
+    // Hash table, single mesh.
+    {
+        Mesh* mesh = createGridMesh(size, 0, size);
+        size_t cornerCount = mesh->vertices.size();
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        mesh->weldVertices();
+        report("hashed, 1 mesh", cornerCount, mesh->vertices.size(), getSeconds(start));
+        deleteMesh(mesh);
+    }
+
+    // Hash table, independent meshes welded in parallel.
+    {
+        std::vector<Mesh*> meshes;
+        size_t cornerCount = 0;
+        for (unsigned int i = 0; i < MESH_COUNT; ++i)
+        {
+            meshes.push_back(createGridMesh(size, size * i / MESH_COUNT, size * (i + 1) / MESH_COUNT));
+            cornerCount += meshes.back()->vertices.size();
+        }
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        Mesh::weldVertices(meshes);
+        double seconds = getSeconds(start);
+        size_t vertexCount = 0;
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            vertexCount += meshes[i]->vertices.size();
+            deleteMesh(meshes[i]);
+        }
+        char name[32];
+        sprintf(name, "hashed, %u meshes", MESH_COUNT);
+        report(name, cornerCount, vertexCount, seconds);
+    }
+
+    return 0;
+}
@@ -1,12 +1,105 @@
 #include "Base.h"
 #include "AnimationChannel.h"
 #include "Transform.h"
+#include "Quaternion.h"
+
+// The largest number of components of a packed animation channel.
+#define PACKED_MAX_COMPONENTS 16
+
+// The largest quantized value of a component of a packed animation channel.
+#define PACKED_MAX_SAMPLE 65535.0f
 
 namespace gameplay
 {
 
+/**
+ * Gets the offset of the rotation in the values of the given target attribute, or -1 if it has none.
+ */
+static int getRotationOffset(unsigned int targetAttrib)
+{
+    switch (targetAttrib)
+    {
+    case Transform::ANIMATE_ROTATE:
+    case Transform::ANIMATE_ROTATE_TRANSLATE:
+        return 0;
+    case Transform::ANIMATE_SCALE_ROTATE:
+    case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * Interpolates linearly between two values, and spherically for their rotation (like the runtime).
+ */
+static void interpolateValues(const float* from, const float* to, float t, size_t propSize, int rotationOffset, float* dst)
+{
+    for (size_t i = 0; i < propSize; ++i)
+    {
+        if ((int)i == rotationOffset)
+        {
+            Quaternion q;
+            Quaternion::slerp(Quaternion(from[i], from[i+1], from[i+2], from[i+3]), Quaternion(to[i], to[i+1], to[i+2], to[i+3]), t, &q);
+            dst[i] = q.x;
+            dst[i+1] = q.y;
+            dst[i+2] = q.z;
+            dst[i+3] = q.w;
+            i += 3;
+        }
+        else
+        {
+            dst[i] = from[i] + (to[i] - from[i]) * t;
+        }
+    }
+}
+
+/**
+ * Gets the largest difference between the components of two values, where q and -q are the same rotation.
+ */
+static float getValueError(const float* a, const float* b, size_t propSize, int rotationOffset)
+{
+    float sign = 1.0f;
+    if (rotationOffset >= 0)
+    {
+        const float* qa = a + rotationOffset;
+        const float* qb = b + rotationOffset;
+        if (qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3] < 0.0f)
+            sign = -1.0f;
+    }
+
+    float error = 0.0f;
+    for (size_t i = 0; i < propSize; ++i)
+    {
+        bool rotation = rotationOffset >= 0 && (int)i >= rotationOffset && (int)i < rotationOffset + 4;
+        error = std::max(error, std::fabs(a[i] - (rotation ? sign * b[i] : b[i])));
+    }
+    return error;
+}
+
+/**
+ * Evaluates linear key frames at the given time.
+ */
+static void evaluateKeys(const std::vector<float>& keyTimes, const std::vector<float>& keyValues, size_t propSize, int rotationOffset, float time, float* dst)
+{
+    std::vector<float>::const_iterator it = std::upper_bound(keyTimes.begin(), keyTimes.end(), time);
+    if (it == keyTimes.begin())
+    {
+        memcpy(dst, &keyValues[0], propSize * sizeof(float));
+        return;
+    }
+    if (it == keyTimes.end())
+    {
+        memcpy(dst, &keyValues[(keyTimes.size() - 1) * propSize], propSize * sizeof(float));
+        return;
+    }
+    size_t index = (it - keyTimes.begin()) - 1;
+    float t = (time - keyTimes[index]) / (keyTimes[index + 1] - keyTimes[index]);
+    interpolateValues(&keyValues[index * propSize], &keyValues[(index + 1) * propSize], t, propSize, rotationOffset, dst);
+}
+
 AnimationChannel::AnimationChannel(void) :
-    _targetAttrib(0)
+    _targetAttrib(0), _sampleCount(0)
 {
 }
 
@@ -37,6 +130,13 @@ void AnimationChannel::writeBinary(FILE* file)
     write(_tangentsIn, file);
     write(_tangentsOut, file);
     write(_interpolations, file);
+    write(_sampleCount, file);
+    if (_sampleCount > 0)
+    {
+        write(_sampleMinimums, file);
+        write(_sampleExtents, file);
+        write(_samples, file);
+    }
 }
 
 void AnimationChannel::writeText(FILE* file)
@@ -49,6 +149,13 @@ void AnimationChannel::writeText(FILE* file)
     fprintfElement(file, "%f ", "tangentsIn", _tangentsIn);
     fprintfElement(file, "%f ", "tangentsOut", _tangentsOut);
     fprintfElement(file, "%u ", "interpolations", _interpolations);
+    if (_sampleCount > 0)
+    {
+        fprintfElement(file, "sampleCount", _sampleCount);
+        fprintfElement(file, "%f ", "sampleMinimums", _sampleMinimums);
+        fprintfElement(file, "%f ", "sampleExtents", _sampleExtents);
+        fprintfElement(file, "%u ", "samples", _samples);
+    }
     fprintElementEnd(file);
 }
 
@@ -175,6 +282,222 @@ void AnimationChannel::removeDuplicates()
     LOG(3, "      Removed %d duplicate keyframes from channel.\n", startCount- _keytimes.size());
 }
 
+float AnimationChannel::reduceKeys(float tolerance)
+{
+    const size_t propSize = Transform::getPropertySize(_targetAttrib);
+    const size_t keyCount = _keytimes.size();
+    if (_sampleCount > 0 || !isLinear() || propSize == 0 || keyCount <= 2 || _keyValues.size() != keyCount * propSize)
+        return 0.0f;
+
+    const int rotationOffset = getRotationOffset(_targetAttrib);
+    std::vector<float> keyTimes;
+    std::vector<float> keyValues;
+    std::vector<float> value(propSize);
+    float maxError = 0.0f;
+
+    // Extend the segment starting at each kept key frame for as long as the key frames it skips stay within the tolerance.
+    size_t anchor = 0;
+    keyTimes.push_back(_keytimes[0]);
+    keyValues.insert(keyValues.end(), _keyValues.begin(), _keyValues.begin() + propSize);
+    while (anchor < keyCount - 1)
+    {
+        size_t end = anchor + 1;
+        float segmentError = 0.0f;
+        while (end + 1 < keyCount)
+        {
+            const float* from = &_keyValues[anchor * propSize];
+            const float* to = &_keyValues[(end + 1) * propSize];
+            float duration = _keytimes[end + 1] - _keytimes[anchor];
+            if (duration <= 0.0f)
+                break;
+
+            float error = 0.0f;
+            for (size_t k = anchor + 1; k <= end && error <= tolerance; ++k)
+            {
+                interpolateValues(from, to, (_keytimes[k] - _keytimes[anchor]) / duration, propSize, rotationOffset, &value[0]);
+                error = std::max(error, getValueError(&value[0], &_keyValues[k * propSize], propSize, rotationOffset));
+            }
+            if (error > tolerance)
+                break;
+            segmentError = error;
+            ++end;
+        }
+        maxError = std::max(maxError, segmentError);
+        keyTimes.push_back(_keytimes[end]);
+        keyValues.insert(keyValues.end(), _keyValues.begin() + end * propSize, _keyValues.begin() + (end + 1) * propSize);
+        anchor = end;
+    }
+
+    LOG(3, "      Removed %u interpolated keyframes from channel.\n", (unsigned int)(keyCount - keyTimes.size()));
+
+    _keytimes.swap(keyTimes);
+    _keyValues.swap(keyValues);
+    if (_interpolations.size() > 1)
+    {
+        _interpolations.assign(_keytimes.size(), LINEAR);
+    }
+    return maxError;
+}
+
+bool AnimationChannel::pack(float tolerance, float* error)
+{
+    assert(error);
+
+    const size_t propSize = Transform::getPropertySize(_targetAttrib);
+    const size_t keyCount = _keytimes.size();
+    const std::vector<float> keyTimes = _keytimes;
+    const std::vector<float> keyValues = _keyValues;
+
+    // The key frames are reduced first, which is the representation to beat.
+    *error = reduceKeys(tolerance);
+    if (_sampleCount > 0 || !isLinear() || propSize == 0 || propSize > PACKED_MAX_COMPONENTS || keyCount < 2 || keyValues.size() != keyCount * propSize)
+        return false;
+
+    // Sample at the smallest interval between the key frames, which keeps all the key frames of baked animations.
+    float interval = FLT_MAX;
+    for (size_t i = 1; i < keyCount; ++i)
+    {
+        float delta = keyTimes[i] - keyTimes[i - 1];
+        if (delta > 0.0f)
+            interval = std::min(interval, delta);
+    }
+    const float startTime = keyTimes.front();
+    const float duration = keyTimes.back() - startTime;
+    if (duration <= 0.0f)
+        return false;
+    double sampleCount = floor(duration / interval + 0.5) + 1.0;
+    if (sampleCount * propSize * sizeof(unsigned short) + propSize * 2 * sizeof(float) + 3 * sizeof(unsigned int) >= getDataSize())
+        return false;
+
+    const unsigned int count = (unsigned int)sampleCount;
+    const int rotationOffset = getRotationOffset(_targetAttrib);
+    std::vector<float> values(count * propSize);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        float* value = &values[i * propSize];
+        evaluateKeys(keyTimes, keyValues, propSize, rotationOffset, startTime + duration * i / (count - 1), value);
+
+        // Keep consecutive rotations in the same hemisphere, so that they have smaller ranges.
+        if (rotationOffset >= 0 && i > 0)
+        {
+            float* q = value + rotationOffset;
+            const float* p = q - propSize;
+            if (p[0] * q[0] + p[1] * q[1] + p[2] * q[2] + p[3] * q[3] < 0.0f)
+            {
+                q[0] = -q[0];
+                q[1] = -q[1];
+                q[2] = -q[2];
+                q[3] = -q[3];
+            }
+        }
+    }
+
+    // Quantize each component over its range of values.
+    std::vector<float> minimums(propSize, FLT_MAX);
+    std::vector<float> extents(propSize);
+    std::vector<unsigned short> samples(count * propSize);
+    float quantizationError = 0.0f;
+    for (size_t c = 0; c < propSize; ++c)
+    {
+        float maximum = -FLT_MAX;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            minimums[c] = std::min(minimums[c], values[i * propSize + c]);
+            maximum = std::max(maximum, values[i * propSize + c]);
+        }
+        extents[c] = maximum - minimums[c];
+        quantizationError = std::max(quantizationError, extents[c] / PACKED_MAX_SAMPLE);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            float v = extents[c] > 0.0f ? (values[i * propSize + c] - minimums[c]) / extents[c] : 0.0f;
+            samples[i * propSize + c] = (unsigned short)floor(v * PACKED_MAX_SAMPLE + 0.5f);
+        }
+    }
+
+    // Decode the samples like the runtime, and measure their error at the times of the key frames.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        float* value = &values[i * propSize];
+        for (size_t c = 0; c < propSize; ++c)
+        {
+            value[c] = minimums[c] + samples[i * propSize + c] * (extents[c] / PACKED_MAX_SAMPLE);
+        }
+        if (rotationOffset >= 0)
+        {
+            Quaternion q(value[rotationOffset], value[rotationOffset+1], value[rotationOffset+2], value[rotationOffset+3]);
+            q.normalize();
+            value[rotationOffset] = q.x;
+            value[rotationOffset+1] = q.y;
+            value[rotationOffset+2] = q.z;
+            value[rotationOffset+3] = q.w;
+        }
+    }
+    float packedError = 0.0f;
+    std::vector<float> value(propSize);
+    for (size_t k = 0; k < keyCount; ++k)
+    {
+        float position = (keyTimes[k] - startTime) / duration * (count - 1);
+        unsigned int index = std::min((unsigned int)position, count - 2);
+        interpolateValues(&values[index * propSize], &values[(index + 1) * propSize], position - index, propSize, rotationOffset, &value[0]);
+        packedError = std::max(packedError, getValueError(&value[0], &keyValues[k * propSize], propSize, rotationOffset));
+    }
+    if (packedError > tolerance + quantizationError)
+    {
+        LOG(3, "      Not packing channel (error %f).\n", packedError);
+        return false;
+    }
+
+    // Replace the key frames by the samples. The key times only keep the start and end times.
+    _sampleCount = count;
+    _sampleMinimums.swap(minimums);
+    _sampleExtents.swap(extents);
+    _samples.swap(samples);
+    _keytimes.clear();
+    _keytimes.push_back(startTime);
+    _keytimes.push_back(keyTimes.back());
+    _keyValues.clear();
+    setInterpolation(LINEAR);
+    *error = packedError;
+    return true;
+}
+
+bool AnimationChannel::isPacked() const
+{
+    return _sampleCount > 0;
+}
+
+unsigned int AnimationChannel::getKeyCount() const
+{
+    return _sampleCount > 0 ? _sampleCount : (unsigned int)_keytimes.size();
+}
+
+unsigned int AnimationChannel::getDataSize() const
+{
+    // Each array is written with its length.
+    size_t size = 6 * sizeof(unsigned int);
+    size += (_keytimes.size() + _keyValues.size() + _tangentsIn.size() + _tangentsOut.size()) * sizeof(float);
+    size += _interpolations.size() * sizeof(unsigned int);
+    if (_sampleCount > 0)
+    {
+        size += 3 * sizeof(unsigned int);
+        size += (_sampleMinimums.size() + _sampleExtents.size()) * sizeof(float);
+        size += _samples.size() * sizeof(unsigned short);
+    }
+    return (unsigned int)size;
+}
+
+bool AnimationChannel::isLinear() const
+{
+    if (_interpolations.empty() || !_tangentsIn.empty() || !_tangentsOut.empty())
+        return false;
+    for (std::vector<unsigned int>::const_iterator i = _interpolations.begin(); i != _interpolations.end(); ++i)
+    {
+        if (*i != LINEAR)
+            return false;
+    }
+    return true;
+}
+
 unsigned int AnimationChannel::getInterpolationType(const char* str)
 {
     unsigned int value = 0;
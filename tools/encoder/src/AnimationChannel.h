@@ -65,6 +65,45 @@ public:
      */
     void removeDuplicates();
 
+    /**
+     * Removes the key frames of a linear animation channel that can be interpolated
+     * from the key frames kept around them.
+     * 
+     * @param tolerance The maximum error of the values at the times of the removed key frames.
+     * 
+     * @return The largest error of the values at the times of the removed key frames.
+     */
+    float reduceKeys(float tolerance);
+
+    /**
+     * Packs a linear animation channel into samples taken at uniform intervals, with
+     * each component quantized to 16 bits over its range of values.
+     * 
+     * The samples replace the key frames if they are smaller than the key frames left by
+     * reduceKeys and if their error is within the tolerance (plus the quantization error).
+     * 
+     * @param tolerance The maximum error of the values at the times of the key frames.
+     * @param error The largest error of the values of the kept representation.
+     * 
+     * @return True if the channel was packed.
+     */
+    bool pack(float tolerance, float* error);
+
+    /**
+     * Returns true if the animation channel is stored as packed samples.
+     */
+    bool isPacked() const;
+
+    /**
+     * Gets the number of key frames, or of samples if the animation channel is packed.
+     */
+    unsigned int getKeyCount() const;
+
+    /**
+     * Gets the size in bytes of the key frame or sample data written for the animation channel.
+     */
+    unsigned int getDataSize() const;
+
     /**
      * Returns the interpolation type value for the given string or zero if not valid.
      * Example: "LINEAR" returns AnimationChannel::LINEAR
@@ -86,6 +125,11 @@ private:
      */
     void deleteRange(size_t begin, size_t end, size_t propSize);
 
+    /**
+     * Returns true if all the key frames of the animation channel are linear.
+     */
+    bool isLinear() const;
+
 private:
 
     std::string _targetId;
@@ -95,6 +139,10 @@ private:
     std::vector<float> _tangentsIn;
     std::vector<float> _tangentsOut;
     std::vector<unsigned int> _interpolations;
+    unsigned int _sampleCount;
+    std::vector<float> _sampleMinimums;
+    std::vector<float> _sampleExtents;
+    std::vector<unsigned short> _samples;
 };
 
 }
@@ -19,6 +19,7 @@
 #include <list>
 #include <map>
 #include <algorithm>
+#include <atomic>
 #include <sys/stat.h>
 
 
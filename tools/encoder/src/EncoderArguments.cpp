@@ -27,6 +27,10 @@ EncoderArguments::EncoderArguments(size_t argc, const char** argv) :
     _fontFormat(Font::BITMAP),
     _textOutput(false),
     _optimizeAnimations(false),
+    _compressAnimations(false),
+    _animationError(0.0f),
+    _optimizeMeshes(false),
+    _splitMeshes(false),
     _animationGrouping(ANIMATIONGROUP_PROMPT),
     _outputMaterial(false),
     _generateTextureGutter(false)
@@ -275,7 +279,26 @@ void EncoderArguments::printUsage() const
         "\t\tOptimizes animations by analyzing animation channel data and\n" \
         "\t\tremoving any channels that contain default/identity values\n" \
         "\t\tand removing any duplicate contiguous keyframes, which are \n" \
-        "\t\tcommon when exporting baked animation data.\n" \
+        "\t\tcommon when exporting baked animation data. Keyframes that\n" \
+        "\t\tcan be interpolated from their neighbours within the error\n" \
+        "\t\tgiven by -ae are removed as well.\n" \
+    "  -ca\n" \
+        "\t\tCompresses animations (implies -oa). Linear channels are stored\n" \
+        "\t\tas samples taken at uniform intervals and quantized to 16 bits\n" \
+        "\t\twhen it is smaller than their keyframes. A report of the size\n" \
+        "\t\tand error of each channel is printed with -v 2.\n" \
+    "  -ae <error>\n" \
+        "\t\tMaximum error of the animation values when removing keyframes\n" \
+        "\t\tand compressing animations (default 0).\n" \
+    "  -om\n" \
+        "\t\tOptimizes meshes by reordering their triangles for the GPU\n" \
+        "\t\tpost-transform vertex cache, and their vertices in the order\n" \
+        "\t\tthe triangles use them. The average cache miss ratio (ACMR)\n" \
+        "\t\tof each mesh before and after is printed with -v 2.\n" \
+    "  -om:16\n" \
+        "\t\tOptimizes meshes (like -om), and splits the meshes with more\n" \
+        "\t\tthan 65536 vertices into several meshes, on new child nodes,\n" \
+        "\t\tso that they use 16-bit indices. Skinned meshes are not split.\n" \
     "  -h <size> \"<node ids>\" <filename>\n" \
         "\t\tGenerates a single heightmap image using meshes from the \n" \
         "\t\tspecified nodes. \n" \
@@ -334,6 +357,26 @@ bool EncoderArguments::optimizeAnimationsEnabled() const
     return _optimizeAnimations;
 }
 
+bool EncoderArguments::compressAnimationsEnabled() const
+{
+    return _compressAnimations;
+}
+
+float EncoderArguments::getAnimationError() const
+{
+    return _animationError;
+}
+
+bool EncoderArguments::optimizeMeshesEnabled() const
+{
+    return _optimizeMeshes;
+}
+
+bool EncoderArguments::splitMeshesEnabled() const
+{
+    return _splitMeshes;
+}
+
 bool EncoderArguments::outputMaterialEnabled() const
 {
     return _outputMaterial;
@@ -416,6 +459,33 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
     }
     switch (str[1])
     {
+    case 'a':
+        if (str == "-ae")
+        {
+            // Maximum animation error
+            (*index)++;
+            if (*index < options.size())
+            {
+                _animationError = (float)atof(options[*index].c_str());
+                if (_animationError < 0.0f)
+                    _animationError = 0.0f;
+            }
+            else
+            {
+                LOG(1, "Error: missing argument for -ae.\n");
+                _parseError = true;
+                return;
+            }
+        }
+        break;
+    case 'c':
+        if (str == "-ca")
+        {
+            // Compress animations, which optimizes them first
+            _compressAnimations = true;
+            _optimizeAnimations = true;
+        }
+        break;
     case 'f':
         if (str.compare("-f:b") == 0)
         {
@@ -471,6 +541,17 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
             // Optimize animations
             _optimizeAnimations = true;
         }
+        else if (str == "-om")
+        {
+            // Optimize meshes
+            _optimizeMeshes = true;
+        }
+        else if (str == "-om:16")
+        {
+            // Optimize meshes and split them for 16-bit indices
+            _optimizeMeshes = true;
+            _splitMeshes = true;
+        }
         break;
     case 'h':
         {
@@ -174,6 +174,20 @@ public:
 
     bool optimizeAnimationsEnabled() const;
 
+    bool compressAnimationsEnabled() const;
+
+    /**
+     * Gets the maximum error of the animation values allowed when optimizing and compressing animations.
+     */
+    float getAnimationError() const;
+
+    bool optimizeMeshesEnabled() const;
+
+    /**
+     * Returns true if meshes with too many vertices for 16-bit indices should be split when optimizing meshes.
+     */
+    bool splitMeshesEnabled() const;
+
     bool outputMaterialEnabled() const;
 
     bool generateTextureGutter() const;
@@ -222,6 +236,10 @@ private:
     Font::FontFormat _fontFormat;
     bool _textOutput;
     bool _optimizeAnimations;
+    bool _compressAnimations;
+    float _animationError;
+    bool _optimizeMeshes;
+    bool _splitMeshes;
     AnimationGroupOption _animationGrouping;
     bool _outputMaterial;
     bool _generateTextureGutter;
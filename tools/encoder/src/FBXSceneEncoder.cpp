@@ -61,6 +61,8 @@ void FBXSceneEncoder::write(const string& filepath, const EncoderArguments& argu
 
     print("Loading Scene.");
     loadScene(fbxScene);
+    print("Welding vertices.");
+    _gamePlayFile.weldVertices();
     print("Load materials");
     loadMaterials(fbxScene);
     print("Loading animations.");
@@ -1225,17 +1227,9 @@ Mesh* FBXSceneEncoder::loadMesh(FbxMesh* fbxMesh)
                 meshPartIndex = elementMaterial->GetIndexArray().GetAt(polyIndex);
             }
 
-            // Add the vertex to the mesh if it hasn't already been added and find the vertex index.
-            unsigned int index;
-            if (mesh->contains(vertex))
-            {
-                index = mesh->getVertexIndex(vertex);
-            }
-            else
-            {
-                index = mesh->addVertex(vertex);
-            }
-            meshParts[meshPartIndex]->addIndex(index);
+            // Add a vertex for every polygon corner, the equal vertices are welded once all the meshes are loaded.
+            meshParts[meshPartIndex]->addIndex((unsigned int)mesh->vertices.size());
+            mesh->vertices.push_back(vertex);
             vertexIndex++;
         }
     }
@@ -7,6 +7,12 @@
 
 #define EPSILON 1.2e-7f;
 
+// Size of the FIFO post-transform vertex cache used to report the average cache miss ratio of meshes
+#define MESH_CACHE_SIZE 16
+
+// Maximum number of vertices of the meshes split for 16-bit indices
+#define MESH_SPLIT_VERTEX_COUNT 65536
+
 namespace gameplay
 {
 
@@ -103,6 +109,9 @@ bool GPBFile::saveBinary(const std::string& filepath)
     }
 
     _refTable.updateOffsets(_file);
+
+    // index of the refs
+    _refTable.writeIndex(_file);
     
     fclose(_file);
     return true;
@@ -345,6 +354,18 @@ void GPBFile::adjust()
     {
         Heightmap::generate(heightmaps[i].nodeIds, heightmaps[i].width, heightmaps[i].height, heightmaps[i].filename.c_str(), heightmaps[i].isHighPrecision);
     }
+
+    if (EncoderArguments::getInstance()->optimizeMeshesEnabled())
+    {
+        LOG(1, "Optimizing meshes.\n");
+        optimizeMeshes();
+    }
+}
+
+void GPBFile::weldVertices()
+{
+    std::vector<Mesh*> meshes(_geometry.begin(), _geometry.end());
+    Mesh::weldVertices(meshes);
 }
 
 void GPBFile::groupMeshSkinAnimations()
@@ -430,6 +451,189 @@ void GPBFile::optimizeAnimations()
             }
         }
     }
+
+    compressAnimations();
+}
+
+void GPBFile::compressAnimations()
+{
+    const float tolerance = EncoderArguments::getInstance()->getAnimationError();
+    const bool packing = EncoderArguments::getInstance()->compressAnimationsEnabled();
+
+    unsigned int channelTotal = 0;
+    unsigned int packedTotal = 0;
+    unsigned int keysBefore = 0;
+    unsigned int keysAfter = 0;
+    unsigned int sizeBefore = 0;
+    unsigned int sizeAfter = 0;
+    float maxError = 0.0f;
+
+    LOG(2, "Animation compression report (maximum error %f):\n", tolerance);
+    const unsigned int animationCount = _animations.getAnimationCount();
+    for (unsigned int animationIndex = 0; animationIndex < animationCount; ++animationIndex)
+    {
+        Animation* animation = _animations.getAnimation(animationIndex);
+        assert(animation);
+
+        for (unsigned int channelIndex = 0, channelCount = animation->getAnimationChannelCount(); channelIndex < channelCount; ++channelIndex)
+        {
+            AnimationChannel* channel = animation->getAnimationChannel(channelIndex);
+            assert(channel);
+
+            unsigned int keyCount = channel->getKeyCount();
+            unsigned int size = channel->getDataSize();
+            float error = 0.0f;
+            if (packing)
+                channel->pack(tolerance, &error);
+            else
+                error = channel->reduceKeys(tolerance);
+
+            LOG(2, "  %s:%u %s %s: %u keys, %u bytes -> %u %s, %u bytes, error %f\n",
+                animation->getId().c_str(), channelIndex + 1, channel->getTargetId().c_str(), Transform::getPropertyString(channel->getTargetAttribute()),
+                keyCount, size, channel->getKeyCount(), channel->isPacked() ? "samples" : "keys", channel->getDataSize(), error);
+
+            ++channelTotal;
+            if (channel->isPacked())
+                ++packedTotal;
+            keysBefore += keyCount;
+            keysAfter += channel->getKeyCount();
+            sizeBefore += size;
+            sizeAfter += channel->getDataSize();
+            maxError = std::max(maxError, error);
+        }
+    }
+
+    LOG(1, "Animations: %u channel(s), %u packed, %u -> %u keys, %u -> %u bytes (%.1f%%), maximum error %f.\n",
+        channelTotal, packedTotal, keysBefore, keysAfter, sizeBefore, sizeAfter,
+        sizeBefore > 0 ? 100.0f * sizeAfter / sizeBefore : 100.0f, maxError);
+}
+
+void GPBFile::optimizeMeshes()
+{
+    const bool splitting = EncoderArguments::getInstance()->splitMeshesEnabled();
+
+    // The meshes of skinned models are not split, since their skin can't be shared by several models.
+    std::vector<Mesh*> skinnedMeshes;
+    for (std::list<Node*>::const_iterator i = _nodes.begin(); i != _nodes.end(); ++i)
+    {
+        Model* model = (*i)->getModel();
+        if (model && model->getSkin() && model->getMesh())
+            skinnedMeshes.push_back(model->getMesh());
+    }
+
+    unsigned int triangleTotal = 0;
+    unsigned int missesBefore = 0;
+    unsigned int missesAfter = 0;
+    std::map<Mesh*, std::vector<Mesh*> > splitMeshes;
+    std::map<Mesh*, std::vector<std::vector<unsigned int> > > splitPartIndices;
+
+    LOG(2, "Mesh optimization report (vertex cache size %d):\n", MESH_CACHE_SIZE);
+    const std::vector<Mesh*> meshes(_geometry.begin(), _geometry.end());
+    for (std::vector<Mesh*>::const_iterator i = meshes.begin(); i != meshes.end(); ++i)
+    {
+        Mesh* mesh = *i;
+        const unsigned int vertexCount = (unsigned int)mesh->getVertexCount();
+        const unsigned int triangleCount = mesh->getTriangleCount();
+        const unsigned int before = mesh->getCacheMissCount(MESH_CACHE_SIZE);
+        mesh->optimizeVertexCache();
+
+        unsigned int indexCount = 0;
+        for (std::vector<MeshPart*>::const_iterator j = mesh->parts.begin(); j != mesh->parts.end(); ++j)
+        {
+            indexCount += (unsigned int)(*j)->getIndicesCount();
+        }
+
+        // Split the meshes of triangles that have too many vertices for 16-bit indices.
+        std::vector<Mesh*> pieces(1, mesh);
+        if (splitting && vertexCount > MESH_SPLIT_VERTEX_COUNT)
+        {
+            if (std::find(skinnedMeshes.begin(), skinnedMeshes.end(), mesh) != skinnedMeshes.end())
+            {
+                LOG(1, "Warning: Skinned mesh %s has %u vertices and is not split, it uses 32-bit indices.\n", mesh->getId().c_str(), vertexCount);
+            }
+            else if (indexCount != triangleCount * 3)
+            {
+                LOG(1, "Warning: Mesh %s has %u vertices and is not split, since it is not made of triangles.\n", mesh->getId().c_str(), vertexCount);
+            }
+            else
+            {
+                std::vector<Mesh*>& newMeshes = splitMeshes[mesh];
+                mesh->split(MESH_SPLIT_VERTEX_COUNT, &newMeshes, &splitPartIndices[mesh]);
+                for (unsigned int j = 0, count = (unsigned int)newMeshes.size(); j < count; ++j)
+                {
+                    Mesh* newMesh = newMeshes[j];
+                    newMesh->setId(getUniqueId(mesh->getId(), j + 1));
+                    addMesh(newMesh);
+                    pieces.push_back(newMesh);
+                }
+            }
+        }
+
+        unsigned int after = 0;
+        for (std::vector<Mesh*>::const_iterator j = pieces.begin(); j != pieces.end(); ++j)
+        {
+            (*j)->optimizeVertexFetch();
+            after += (*j)->getCacheMissCount(MESH_CACHE_SIZE);
+        }
+
+        if (pieces.size() > 1)
+        {
+            LOG(2, "  %s: %u triangles, %u vertices, ACMR %.3f -> %.3f, split into %lu meshes\n", mesh->getId().c_str(), triangleCount, vertexCount,
+                triangleCount > 0 ? (float)before / triangleCount : 0.0f, triangleCount > 0 ? (float)after / triangleCount : 0.0f, pieces.size());
+        }
+        else
+        {
+            LOG(2, "  %s: %u triangles, %u vertices, ACMR %.3f -> %.3f\n", mesh->getId().c_str(), triangleCount, vertexCount,
+                triangleCount > 0 ? (float)before / triangleCount : 0.0f, triangleCount > 0 ? (float)after / triangleCount : 0.0f);
+        }
+        triangleTotal += triangleCount;
+        missesBefore += before;
+        missesAfter += after;
+    }
+
+    // Draw the meshes split from the mesh of a node with new child nodes.
+    const std::vector<Node*> nodes(_nodes.begin(), _nodes.end());
+    for (std::vector<Node*>::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+    {
+        Node* node = *i;
+        Model* model = node->getModel();
+        if (model == NULL || splitMeshes.find(model->getMesh()) == splitMeshes.end())
+            continue;
+
+        Mesh* mesh = model->getMesh();
+        const std::vector<Mesh*>& newMeshes = splitMeshes[mesh];
+        const std::vector<std::vector<unsigned int> >& partIndices = splitPartIndices[mesh];
+        for (unsigned int j = 0, count = (unsigned int)newMeshes.size(); j < count; ++j)
+        {
+            Model* newModel = new Model();
+            newModel->setMesh(newMeshes[j]);
+            newModel->copyMaterials(model, partIndices[j + 1]);
+            Node* child = new Node();
+            child->setId(getUniqueId(node->getId(), j + 1));
+            child->setModel(newModel);
+            node->addChild(child);
+            addNode(child);
+            computeBounds(child);
+        }
+        model->copyMaterials(model, partIndices[0]);
+        computeBounds(node);
+    }
+
+    LOG(1, "Meshes: %lu mesh(es), %u triangles, ACMR %.3f -> %.3f, %lu mesh(es) split.\n",
+        meshes.size(), triangleTotal, triangleTotal > 0 ? (float)missesBefore / triangleTotal : 0.0f,
+        triangleTotal > 0 ? (float)missesAfter / triangleTotal : 0.0f, splitMeshes.size());
+}
+
+std::string GPBFile::getUniqueId(const std::string& id, unsigned int index)
+{
+    char suffix[16];
+    std::string uniqueId;
+    do
+    {
+        sprintf(suffix, "_%u", index++);
+        uniqueId = id + suffix;
+    } while (idExists(uniqueId));
+    return uniqueId;
 }
 
 void GPBFile::decomposeTransformAnimationChannel(Animation* animation, AnimationChannel* channel, int channelIndex)
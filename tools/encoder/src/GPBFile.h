@@ -21,7 +21,7 @@ namespace gameplay
  * Increment the version number when making a change that break binary compatibility.
  * [0] is major, [1] is minor.
  */
-const unsigned char GPB_VERSION[2] = {1, 5};
+const unsigned char GPB_VERSION[2] = {1, 6};
 
 /**
  * The GamePlay Binary file class handles writing the GamePlay Binary file.
@@ -107,6 +107,11 @@ public:
      */
     void adjust();
 
+    /**
+     * Merges the equal vertices of all the meshes, welding several meshes in parallel.
+     */
+    void weldVertices();
+
     /**
      * Groups the animations of all mesh skins to be under one animation per mesh skin.
      */
@@ -141,6 +146,23 @@ private:
      */
     void decomposeTransformAnimationChannel(Animation* animation, AnimationChannel* channel, int channelIndex);
 
+    /**
+     * Removes the key frames of the animation channels that are within the animation error,
+     * packs them if animation compression is enabled, and reports the resulting size and error.
+     */
+    void compressAnimations();
+
+    /**
+     * Reorders the triangles and vertices of all meshes for the vertex cache, splits the meshes
+     * that need 32-bit indices if enabled, and reports the resulting average cache miss ratios.
+     */
+    void optimizeMeshes();
+
+    /**
+     * Returns an ID made of the given ID and a numbered suffix, that is not in the ref table.
+     */
+    std::string getUniqueId(const std::string& id, unsigned int index);
+
     /**
      * Moves the animation channels that target the given node and its children to be under the given animation.
      * 
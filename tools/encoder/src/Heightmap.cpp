@@ -2,58 +2,93 @@
 #include "Heightmap.h"
 #include "GPBFile.h"
 #include "Thread.h"
+#include <chrono>
 
 namespace gameplay
 {
 
-// Number of threads to spawn for the heightmap generator
-#define THREAD_COUNT 8
+// Maximum number of threads to spawn for the heightmap generator
+#define THREAD_COUNT 64
+
+// Maximum number of triangles in a leaf of the triangle tree
+#define TREE_LEAF_SIZE 4
+
+// Maximum depth of the triangle tree
+#define TREE_MAX_DEPTH 64
+
+// Width and height (in pixels) of the tiles of rays cast together through the triangle tree
+#define TILE_SIZE 16
+
+// A triangle of the meshes, with the bounds of its projection on the XZ plane and its highest point
+struct HeightmapTriangle
+{
+    Vector3 v0;
+    Vector3 v1;
+    Vector3 v2;
+    float minX;
+    float maxX;
+    float minZ;
+    float maxZ;
+    float maxY;
+};
+
+// A node of the bounding volume hierarchy of the triangles.
+// Leaves hold 'count' triangles from 'first', other nodes have their first child right after them and their second child at 'first'.
+struct HeightmapTreeNode
+{
+    float minX;
+    float maxX;
+    float minZ;
+    float maxZ;
+    float maxY;
+    unsigned int first;
+    unsigned int count;
+};
 
 // Thread data structure
 struct HeightmapThreadData
 {
-    float rayHeight;                    // [in]
-    const Vector3* rayDirection;        // [in]
-    const std::vector<Mesh*>* meshes;   // [in]
-    const BoundingVolume* bounds;       // [in]
-    float minX;                         // [in]
-    float maxX;                         // [in]
-    float minZ;                         // [in]
-    float maxZ;                         // [in]
-    float stepX;                        // [in]
-    float stepZ;                        // [in]
-    float minHeight;                    // [out]
-    float maxHeight;                    // [out]
-    float* heights;                     // [in][out]
-    int width;                          // [in]
-    int height;                         // [in]
-    int heightIndex;                    // [in]
+    float rayHeight;                                    // [in]
+    const std::vector<HeightmapTreeNode>* nodes;        // [in]
+    const std::vector<HeightmapTriangle>* triangles;    // [in]
+    float minX;                                         // [in]
+    float minZ;                                         // [in]
+    float stepX;                                        // [in]
+    float stepZ;                                        // [in]
+    int width;                                          // [in]
+    int height;                                         // [in]
+    int tileCountX;                                     // [in]
+    int tileCount;                                      // [in]
+    std::atomic<int>* nextTile;                         // [in][out]
+    std::atomic<int>* processedTiles;                   // [in][out]
+    std::atomic<int>* progress;                         // [in][out]
+    float minHeight;                                    // [out]
+    float maxHeight;                                    // [out]
+    int failedRayCasts;                                 // [out]
+    float* heights;                                     // [in][out]
 };
 
-// Globals used by thread
-int __processedHeightmapScanLines = 0;
-int __totalHeightmapScanlines = 0;
-int __failedRayCasts = 0;
-
 // Forward declarations
-int generateHeightmapChunk(void* threadData);
-bool intersect(const Vector3& rayOrigin, const Vector3& rayDirection, const Vector3& boxMin, const Vector3& boxMax, float* distance = NULL);
+int generateHeightmapTiles(void* threadData);
+unsigned int buildTree(std::vector<HeightmapTreeNode>& nodes, std::vector<HeightmapTriangle>& triangles, unsigned int first, unsigned int last, unsigned int depth);
+void castTile(HeightmapThreadData* data, int tile);
 int intersect_triangle(const float orig[3], const float dir[3], const float vert0[3], const float vert1[3], const float vert2[3], float *t, float *u, float *v);
-bool intersect(const Vector3& rayOrigin, const Vector3& rayDirection, const std::vector<Vertex>& vertices, const std::vector<MeshPart*>& parts, Vector3* point);
+
+// Returns the number of seconds elapsed since the given time.
+static double getElapsedTime(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
 
 void Heightmap::generate(const std::vector<std::string>& nodeIds, int width, int height, const char* filename, bool highP)
 {
     LOG(1, "Generating heightmap: %s...\n", filename);
 
-    // Initialize state variables
-    __processedHeightmapScanLines = 0;
-    __totalHeightmapScanlines = 0;
-    __failedRayCasts = 0;
-
     GPBFile* gpbFile = GPBFile::getInstance();
 
     // Lookup nodes in GPB file and compute a single bounding volume that encapsulates all meshes
     // to be included in the heightmap generation.
+    std::chrono::steady_clock::time_point stageStart = std::chrono::steady_clock::now();
     BoundingVolume bounds;
     bounds.min.set(FLT_MAX, FLT_MAX, FLT_MAX);
     bounds.max.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
@@ -91,12 +126,47 @@ void Heightmap::generate(const std::vector<std::string>& nodeIds, int width, int
         return;
     }
 
+    // Gather the triangles of all the meshes.
+    std::vector<HeightmapTriangle> triangles;
+    for (unsigned int i = 0, count = meshes.size(); i < count; ++i)
+    {
+        const Mesh* mesh = meshes[i];
+        for (unsigned int j = 0, partCount = mesh->parts.size(); j < partCount; ++j)
+        {
+            const MeshPart* part = mesh->parts[j];
+            for (unsigned int k = 0, indexCount = part->getIndicesCount(); k + 2 < indexCount; k += 3)
+            {
+                HeightmapTriangle triangle;
+                triangle.v0 = mesh->vertices[part->getIndex( k )].position;
+                triangle.v1 = mesh->vertices[part->getIndex(k+1)].position;
+                triangle.v2 = mesh->vertices[part->getIndex(k+2)].position;
+                triangle.minX = std::min(triangle.v0.x, std::min(triangle.v1.x, triangle.v2.x));
+                triangle.maxX = std::max(triangle.v0.x, std::max(triangle.v1.x, triangle.v2.x));
+                triangle.minZ = std::min(triangle.v0.z, std::min(triangle.v1.z, triangle.v2.z));
+                triangle.maxZ = std::max(triangle.v0.z, std::max(triangle.v1.z, triangle.v2.z));
+                triangle.maxY = std::max(triangle.v0.y, std::max(triangle.v1.y, triangle.v2.y));
+                triangles.push_back(triangle);
+            }
+        }
+    }
+    double gatherTime = getElapsedTime(stageStart);
+
+    // Build a bounding volume hierarchy of the triangles, so that each ray is only tested
+    // against the triangles right below it.
+    stageStart = std::chrono::steady_clock::now();
+    std::vector<HeightmapTreeNode> nodes;
+    if (!triangles.empty())
+    {
+        nodes.reserve(2 * triangles.size() / TREE_LEAF_SIZE + 1);
+        buildTree(nodes, triangles, 0, triangles.size(), 0);
+    }
+    double buildTime = getElapsedTime(stageStart);
+
     // Shoot rays down from a point just above the max Y position of the mesh.
     // Compute ray-triangle intersection tests against the ray and this mesh to 
     // generate heightmap data.
-    Vector3 rayOrigin(0, bounds.max.y + 10, 0);
-    Vector3 rayDirection(0, -1, 0);
-
+    stageStart = std::chrono::steady_clock::now();
+    float rayHeight = bounds.max.y + 10;
     float minX = bounds.min.x;
     float maxX = bounds.max.x;
     float minZ = bounds.min.z;
@@ -105,49 +175,69 @@ void Heightmap::generate(const std::vector<std::string>& nodeIds, int width, int
     float* heights = new float[size];
     float minHeight = FLT_MAX;
     float maxHeight = -FLT_MAX;
+    int failedRayCasts = 0;
 
-    __totalHeightmapScanlines = height;
+    // The image is split in tiles, which the threads take in turn until there are none left,
+    // to make max use of available cpu cores and speed up computation.
+    int tileCountX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    int tileCount = tileCountX * ((height + TILE_SIZE - 1) / TILE_SIZE);
+    std::atomic<int> nextTile(0);
+    std::atomic<int> processedTiles(0);
+    std::atomic<int> progress(0);
 
     // Determine # of threads to spawn
-    int threadCount = min(THREAD_COUNT, height);
+    int threadCount = std::min(std::min(getProcessorCount(), THREAD_COUNT), tileCount);
 
-    // Split the work into separate threads to make max use of available cpu cores and speed up computation.
     HeightmapThreadData* threadData = new HeightmapThreadData[threadCount];
     THREAD_HANDLE* threads = new THREAD_HANDLE[threadCount];
-    int stepSize = height / threadCount;
-    for (int i = 0, remaining = height; i < threadCount; ++i, remaining -= stepSize)
+    for (int i = 0; i < threadCount; ++i)
     {
         HeightmapThreadData& data = threadData[i];
-        data.rayHeight = rayOrigin.y;
-        data.rayDirection = &rayDirection;
-        data.bounds = &bounds;
-        data.meshes = &meshes;
+        data.rayHeight = rayHeight;
+        data.nodes = &nodes;
+        data.triangles = &triangles;
         data.minX = minX;
-        data.maxX = maxX;
-        data.minZ = minZ + (stepSize * i);
-        data.maxZ = data.minZ + stepSize - 1;
-        if (i == threadCount - 1)
-            data.maxZ = maxZ;
+        data.minZ = minZ;
         data.stepX = (maxX - minX) / width;
         data.stepZ = (maxZ - minZ) / height;
-        data.heights = heights;
         data.width = width;
-        data.height = remaining > stepSize ? stepSize : remaining;
-        data.heightIndex = width * (stepSize * i);
+        data.height = height;
+        data.tileCountX = tileCountX;
+        data.tileCount = tileCount;
+        data.nextTile = &nextTile;
+        data.processedTiles = &processedTiles;
+        data.progress = &progress;
+        data.heights = heights;
+    }
 
-        // Start the processing thread
-        if (!createThread(&threads[i], &generateHeightmapChunk, &data))
+    // Start the processing threads, or process all the tiles on this thread if none can be started.
+    int startedCount = 0;
+    if (threadCount > 1)
+    {
+        for (; startedCount < threadCount; ++startedCount)
         {
-            LOG(1, "ERROR: Failed to spawn worker thread for generation of heightmap: %s\n", filename);
-            return;
+            if (!createThread(&threads[startedCount], &generateHeightmapTiles, &threadData[startedCount]))
+            {
+                LOG(1, "Warning: Failed to spawn worker thread for generation of heightmap: %s\n", filename);
+                break;
+            }
         }
     }
+    if (startedCount == 0)
+    {
+        generateHeightmapTiles(&threadData[0]);
+        threadCount = 1;
+    }
+    else
+    {
+        threadCount = startedCount;
+    }
 
     // Wait for all threads to terminate
-    waitForThreads(threadCount, threads);
+    waitForThreads(startedCount, threads);
 
     // Close all thread handles and free memory allocations.
-    for (int i = 0; i < threadCount; ++i)
+    for (int i = 0; i < startedCount; ++i)
         closeThread(threads[i]);
 
     // Update min/max height from all completed threads
@@ -157,13 +247,15 @@ void Heightmap::generate(const std::vector<std::string>& nodeIds, int width, int
             minHeight = threadData[i].minHeight;
         if (threadData[i].maxHeight > maxHeight)
             maxHeight = threadData[i].maxHeight;
+        failedRayCasts += threadData[i].failedRayCasts;
     }
+    double castTime = getElapsedTime(stageStart);
 
     LOG(1, "\r\tDone.\n");
 
-    if (__failedRayCasts)
+    if (failedRayCasts)
     {
-        LOG(2, "Warning: %d triangle intersections failed for heightmap: %s\n", __failedRayCasts, filename);
+        LOG(2, "Warning: %d triangle intersections failed for heightmap: %s\n", failedRayCasts, filename);
 
         // Go through and clamp any height values that are set to -FLT_MAX to the min recorded height value
         // (otherwise the range of height values will be far too large).
@@ -177,6 +269,7 @@ void Heightmap::generate(const std::vector<std::string>& nodeIds, int width, int
     // Normalize the max height value
     maxHeight = maxHeight - minHeight;
 
+    stageStart = std::chrono::steady_clock::now();
     png_structp png_ptr = NULL;
     png_infop info_ptr = NULL;
     png_bytep row = NULL;
@@ -243,6 +336,11 @@ void Heightmap::generate(const std::vector<std::string>& nodeIds, int width, int
     png_write_end(png_ptr, NULL);
     LOG(1, "Saved heightmap: %s\n", filename);
 
+    LOG(1, "\tGathered %u triangles in %.3f s.\n", (unsigned int)triangles.size(), gatherTime);
+    LOG(1, "\tBuilt tree of %u nodes in %.3f s.\n", (unsigned int)nodes.size(), buildTime);
+    LOG(1, "\tCast %d rays in %d tiles on %d thread(s) in %.3f s.\n", size, tileCount, threadCount, castTime);
+    LOG(1, "\tWrote image in %.3f s.\n", getElapsedTime(stageStart));
+
 error:
     if (threadData)
         delete[] threadData;
@@ -260,73 +358,207 @@ error:
         png_destroy_write_struct(&png_ptr, (png_infopp)NULL);
 }
 
-int generateHeightmapChunk(void* threadData)
+int generateHeightmapTiles(void* threadData)
 {
     HeightmapThreadData* data = (HeightmapThreadData*)threadData;
+    data->minHeight = FLT_MAX;
+    data->maxHeight = -FLT_MAX;
+    data->failedRayCasts = 0;
 
-    Vector3 rayOrigin(0, data->rayHeight, 0);
-    const Vector3& rayDirection = *data->rayDirection;
-    const std::vector<Mesh*>& meshes = *data->meshes;
-    float* heights = data->heights;
+    for (int tile = (*data->nextTile)++; tile < data->tileCount; tile = (*data->nextTile)++)
+    {
+        castTile(data, tile);
 
-    Vector3 intersectionPoint;
-    float minHeight = FLT_MAX;
-    float maxHeight = -FLT_MAX;
-    int index = data->heightIndex;
+        // Report the progress whenever it reaches a new percentage.
+        int percent = (int)((long long)(++(*data->processedTiles)) * 100 / data->tileCount);
+        int reported = data->progress->load();
+        if (percent > reported && data->progress->compare_exchange_strong(reported, percent))
+        {
+            LOG(1, "\r\t%d%%", percent);
+        }
+    }
+
+    return 0;
+}
 
-    int zi = 0;
-    for (float z = data->minZ; zi < data->height; z += data->stepZ, ++zi)
+// Orders triangles along the X axis by the center of their bounds.
+static bool compareCenterX(const HeightmapTriangle& a, const HeightmapTriangle& b)
+{
+    return a.minX + a.maxX < b.minX + b.maxX;
+}
+
+// Orders triangles along the Z axis by the center of their bounds.
+static bool compareCenterZ(const HeightmapTriangle& a, const HeightmapTriangle& b)
+{
+    return a.minZ + a.maxZ < b.minZ + b.maxZ;
+}
+
+unsigned int buildTree(std::vector<HeightmapTreeNode>& nodes, std::vector<HeightmapTriangle>& triangles, unsigned int first, unsigned int last, unsigned int depth)
+{
+    unsigned int index = nodes.size();
+    nodes.resize(index + 1);
+
+    // Compute the bounds of the triangles, and of their centers on the XZ plane.
+    HeightmapTreeNode node;
+    node.minX = node.minZ = FLT_MAX;
+    node.maxX = node.maxZ = node.maxY = -FLT_MAX;
+    float centerMinX = FLT_MAX, centerMaxX = -FLT_MAX, centerMinZ = FLT_MAX, centerMaxZ = -FLT_MAX;
+    for (unsigned int i = first; i < last; ++i)
     {
-        LOG(1, "\r\t%d%%", (int)(((float)__processedHeightmapScanLines / __totalHeightmapScanlines) * 100.0f));
+        const HeightmapTriangle& triangle = triangles[i];
+        node.minX = std::min(node.minX, triangle.minX);
+        node.maxX = std::max(node.maxX, triangle.maxX);
+        node.minZ = std::min(node.minZ, triangle.minZ);
+        node.maxZ = std::max(node.maxZ, triangle.maxZ);
+        node.maxY = std::max(node.maxY, triangle.maxY);
+        float centerX = (triangle.minX + triangle.maxX) * 0.5f;
+        float centerZ = (triangle.minZ + triangle.maxZ) * 0.5f;
+        centerMinX = std::min(centerMinX, centerX);
+        centerMaxX = std::max(centerMaxX, centerX);
+        centerMinZ = std::min(centerMinZ, centerZ);
+        centerMaxZ = std::max(centerMaxZ, centerZ);
+    }
 
-        rayOrigin.z = z;
+    // Make a leaf of few triangles, or of triangles that can't be told apart.
+    bool splitX = (centerMaxX - centerMinX) >= (centerMaxZ - centerMinZ);
+    float extent = splitX ? centerMaxX - centerMinX : centerMaxZ - centerMinZ;
+    if (last - first <= TREE_LEAF_SIZE || extent <= 0.0f || depth + 1 >= TREE_MAX_DEPTH)
+    {
+        node.first = first;
+        node.count = last - first;
+        nodes[index] = node;
+        return index;
+    }
 
-        int xi = 0;
-        for (float x = data->minX; xi < data->width; x += data->stepX, ++xi)
-        {
-            float h = -FLT_MAX;
-            rayOrigin.x = x;
+    // Otherwise split the triangles in two halves along the longest axis of their centers.
+    unsigned int middle = first + (last - first) / 2;
+    std::vector<HeightmapTriangle>::iterator begin = triangles.begin();
+    if (splitX)
+    {
+        std::nth_element(begin + first, begin + middle, begin + last, compareCenterX);
+    }
+    else
+    {
+        std::nth_element(begin + first, begin + middle, begin + last, compareCenterZ);
+    }
+    buildTree(nodes, triangles, first, middle, depth + 1);
+    node.first = buildTree(nodes, triangles, middle, last, depth + 1);
+    node.count = 0;
+    nodes[index] = node;
+    return index;
+}
 
-            for (unsigned int i = 0, count = meshes.size(); i < count; ++i)
-            {
-                // Pick the highest intersecting Y value of all meshes
-                Mesh* mesh = meshes[i];
+void castTile(HeightmapThreadData* data, int tile)
+{
+    const std::vector<HeightmapTreeNode>& nodes = *data->nodes;
+    const std::vector<HeightmapTriangle>& triangles = *data->triangles;
+
+    // The pixels and the area of the tile.
+    int x0 = (tile % data->tileCountX) * TILE_SIZE;
+    int z0 = (tile / data->tileCountX) * TILE_SIZE;
+    int x1 = std::min(x0 + TILE_SIZE, data->width);
+    int z1 = std::min(z0 + TILE_SIZE, data->height);
+    float tileMinX = data->minX + x0 * data->stepX;
+    float tileMaxX = data->minX + (x1 - 1) * data->stepX;
+    float tileMinZ = data->minZ + z0 * data->stepZ;
+    float tileMaxZ = data->minZ + (z1 - 1) * data->stepZ;
+
+    float heights[TILE_SIZE * TILE_SIZE];
+    for (int i = 0; i < TILE_SIZE * TILE_SIZE; ++i)
+        heights[i] = -FLT_MAX;
+
+    // The lowest height found by the rays of the tile so far: nodes that are not higher can't be hit any higher.
+    float lowestHeight = -FLT_MAX;
+
+    // Traverse the tree with all the rays of the tile at once, visiting the highest child of each node first.
+    float orig[3] = { 0.0f, data->rayHeight, 0.0f };
+    const float dir[3] = { 0.0f, -1.0f, 0.0f };
+    unsigned int stack[TREE_MAX_DEPTH + 1];
+    int stackSize = 0;
+    if (!nodes.empty())
+        stack[stackSize++] = 0;
+    while (stackSize > 0)
+    {
+        unsigned int index = stack[--stackSize];
+        const HeightmapTreeNode& node = nodes[index];
+        if (node.maxX < tileMinX || node.minX > tileMaxX || node.maxZ < tileMinZ || node.minZ > tileMaxZ || node.maxY <= lowestHeight)
+            continue;
 
-                // Perform a quick ray/bounding box test to quick-out
-                if (!intersect(rayOrigin, rayDirection, mesh->bounds.min, mesh->bounds.max))
-                    continue;
+        if (node.count == 0)
+        {
+            unsigned int first = index + 1;
+            unsigned int second = node.first;
+            if (nodes[first].maxY > nodes[second].maxY)
+                std::swap(first, second);
+            stack[stackSize++] = first;
+            stack[stackSize++] = second;
+            continue;
+        }
 
-                // Compute the intersection point of ray with mesh
-                if (intersect(rayOrigin, rayDirection, mesh->vertices, mesh->parts, &intersectionPoint))
+        bool hit = false;
+        for (unsigned int i = node.first, end = node.first + node.count; i < end; ++i)
+        {
+            const HeightmapTriangle& triangle = triangles[i];
+            if (triangle.maxY <= lowestHeight)
+                continue;
+
+            // Only the rays within the bounds of the triangle (with a pixel of margin) are tested against it.
+            int startX = std::max(x0, (int)floorf((triangle.minX - data->minX) / data->stepX));
+            int endX = std::min(x1 - 1, (int)ceilf((triangle.maxX - data->minX) / data->stepX));
+            int startZ = std::max(z0, (int)floorf((triangle.minZ - data->minZ) / data->stepZ));
+            int endZ = std::min(z1 - 1, (int)ceilf((triangle.maxZ - data->minZ) / data->stepZ));
+            for (int z = startZ; z <= endZ; ++z)
+            {
+                orig[2] = data->minZ + z * data->stepZ;
+                float* row = &heights[(z - z0) * TILE_SIZE];
+                for (int x = startX; x <= endX; ++x)
                 {
-                    if (intersectionPoint.y > h)
-                    {
-                        h = intersectionPoint.y;
+                    if (row[x - x0] >= triangle.maxY)
+                        continue;
 
-                        // Update min/max height values
-                        if (h < minHeight)
-                            minHeight = h;
-                        if (h > maxHeight)
-                            maxHeight = h;
+                    // Perform a full ray/traingle intersection test in 3D to get the intersection point
+                    float t, u, v;
+                    orig[0] = data->minX + x * data->stepX;
+                    if (intersect_triangle(orig, dir, &triangle.v0.x, &triangle.v1.x, &triangle.v2.x, &t, &u, &v))
+                    {
+                        float h = data->rayHeight - t;
+                        if (h > row[x - x0])
+                        {
+                            row[x - x0] = h;
+                            hit = true;
+                        }
                     }
                 }
             }
+        }
 
-            // Update the glboal height array
-            heights[index++] = h;
+        if (hit)
+        {
+            lowestHeight = FLT_MAX;
+            for (int z = 0; z < z1 - z0; ++z)
+                for (int x = 0; x < x1 - x0; ++x)
+                    lowestHeight = std::min(lowestHeight, heights[z * TILE_SIZE + x]);
+        }
+    }
 
+    // Copy the heights of the tile to the image and update the min/max height values.
+    for (int z = z0; z < z1; ++z)
+    {
+        for (int x = x0; x < x1; ++x)
+        {
+            float h = heights[(z - z0) * TILE_SIZE + x - x0];
+            data->heights[z * data->width + x] = h;
             if (h == -FLT_MAX)
-                ++__failedRayCasts;
+            {
+                ++data->failedRayCasts;
+                continue;
+            }
+            if (h < data->minHeight)
+                data->minHeight = h;
+            if (h > data->maxHeight)
+                data->maxHeight = h;
         }
-
-        ++__processedHeightmapScanLines;
     }
-
-    // Update min/max height for this thread data
-    data->minHeight = minHeight;
-    data->maxHeight = maxHeight;
-
-    return 0;
 }
 
 /////////////////////////////////////////////////////////////
@@ -393,154 +625,4 @@ int intersect_triangle(const float orig[3], const float dir[3], const float vert
    return 1;
 }
 
-// Performs an intersection test between a ray and the given mesh part and stores the result in "point".
-bool intersect(const Vector3& rayOrigin, const Vector3& rayDirection, const std::vector<Vertex>& vertices, const std::vector<MeshPart*>& parts, Vector3* point)
-{
-    const float* orig = &rayOrigin.x;
-    const float* dir = &rayDirection.x;
-
-    float minT = FLT_MAX;
-
-    for (unsigned int i = 0, partCount = parts.size(); i < partCount; ++i)
-    {
-        MeshPart* part = parts[i];
-
-        for (unsigned int j = 0, indexCount = part->getIndicesCount(); j < indexCount; j += 3)
-        {
-            const float* v0 = &vertices[part->getIndex( j )].position.x;
-            const float* v1 = &vertices[part->getIndex(j+1)].position.x;
-            const float* v2 = &vertices[part->getIndex(j+2)].position.x;
-
-            // Perform a quick check (in 2D) to determine if the point is definitely NOT in the triangle
-            float xmin, xmax, zmin, zmax;
-            xmin = v0[0] < v1[0] ? v0[0] : v1[0]; xmin = xmin < v2[0] ? xmin : v2[0];
-            xmax = v0[0] > v1[0] ? v0[0] : v1[0]; xmax = xmax > v2[0] ? xmax : v2[0];
-            zmin = v0[2] < v1[2] ? v0[2] : v1[2]; zmin = zmin < v2[2] ? zmin : v2[2];
-            zmax = v0[2] > v1[2] ? v0[2] : v1[2]; zmax = zmax > v2[2] ? zmax : v2[2];
-            if (orig[0] < xmin || orig[0] > xmax || orig[2] < zmin || orig[2] > zmax)
-                continue;
-
-            // Perform a full ray/traingle intersection test in 3D to get the intersection point
-            float t, u, v;
-            if (intersect_triangle(orig, dir, v0, v1, v2, &t, &u, &v))
-            {
-                // Found an intersection!
-                if (t < minT)
-                {
-                    minT = t;
-
-                    if (point)
-                    {
-                        Vector3 rd(rayDirection);
-                        rd.scale(t);
-                        Vector3::add(rayOrigin, rd, point);
-                    }
-                }
-                //return true;
-            }
-        }
-    }
-
-    return (minT != FLT_MAX);//false;
-}
-
-// Ray/Box intersection test.
-bool intersect(const Vector3& rayOrigin, const Vector3& rayDirection, const Vector3& boxMin, const Vector3& boxMax, float* distance)
-{
-    const Vector3& origin = rayOrigin;
-    const Vector3& direction = rayDirection;
-    const Vector3& min = boxMin;
-    const Vector3& max = boxMax;
-
-    // Intermediate calculation variables.
-    float dnear = 0.0f;
-    float dfar = 0.0f;
-    float tmin = 0.0f;
-    float tmax = 0.0f;
-
-    // X direction.
-    float div = 1.0f / direction.x;
-    if (div >= 0.0f)
-    {
-        tmin = (min.x - origin.x) * div;
-        tmax = (max.x - origin.x) * div;
-    }
-    else
-    {
-        tmin = (max.x - origin.x) * div;
-        tmax = (min.x - origin.x) * div;
-    }
-    dnear = tmin;
-    dfar = tmax;
-
-    // Check if the ray misses the box.
-    if (dnear > dfar || dfar < 0.0f)
-    {
-        return false;
-    }
-
-    // Y direction.
-    div = 1.0f / direction.y;
-    if (div >= 0.0f)
-    {
-        tmin = (min.y - origin.y) * div;
-        tmax = (max.y - origin.y) * div;
-    }
-    else
-    {
-        tmin = (max.y - origin.y) * div;
-        tmax = (min.y - origin.y) * div;
-    }
-
-    // Update the near and far intersection distances.
-    if (tmin > dnear)
-    {
-        dnear = tmin;
-    }
-    if (tmax < dfar)
-    {
-        dfar = tmax;
-    }
-    // Check if the ray misses the box.
-    if (dnear > dfar || dfar < 0.0f)
-    {
-        return false;
-    }
-
-    // Z direction.
-    div = 1.0f / direction.z;
-    if (div >= 0.0f)
-    {
-        tmin = (min.z - origin.z) * div;
-        tmax = (max.z - origin.z) * div;
-    }
-    else
-    {
-        tmin = (max.z - origin.z) * div;
-        tmax = (min.z - origin.z) * div;
-    }
-
-    // Update the near and far intersection distances.
-    if (tmin > dnear)
-    {
-        dnear = tmin;
-    }
-    if (tmax < dfar)
-    {
-        dfar = tmax;
-    }
-
-    // Check if the ray misses the box.
-    if (dnear > dfar || dfar < 0.0f)
-    {
-        return false;
-    }
-
-    // The ray intersects the box
-    if (distance)
-        *distance = dnear;
-
-    return true;
-}
-
 }
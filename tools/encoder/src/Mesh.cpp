@@ -1,10 +1,34 @@
 #include "Base.h"
 #include "Mesh.h"
 #include "Model.h"
+#include "Thread.h"
+
+// Number of threads to spawn for welding the vertices of meshes
+#define WELD_THREAD_COUNT 8
+
+// Marks an empty slot of the vertex lookup table
+#define VERTEX_SLOT_EMPTY 0xFFFFFFFF
 
 namespace gameplay
 {
 
+// Thread data structure
+struct WeldThreadData
+{
+    const std::vector<Mesh*>* meshes;   // [in]
+    std::atomic<size_t>* next;          // [in][out]
+};
+
+static int weldMeshes(void* threadData)
+{
+    WeldThreadData* data = (WeldThreadData*)threadData;
+    for (size_t i = (*data->next)++; i < data->meshes->size(); i = (*data->next)++)
+    {
+        (*data->meshes)[i]->weldVertices();
+    }
+    return 0;
+}
+
 Mesh::Mesh(void) : model(NULL)
 {
 }
@@ -148,22 +172,315 @@ const VertexElement& Mesh::getVertexElement(unsigned int index) const
 
 bool Mesh::contains(const Vertex& vertex) const
 {
-    return vertexLookupTable.count(vertex) > 0;
+    return !_vertexTable.empty() && _vertexTable[findVertexSlot(vertex, vertex.hash())] != VERTEX_SLOT_EMPTY;
 }
 
 unsigned int Mesh::addVertex(const Vertex& vertex)
 {
     unsigned int index = getVertexCount();
     vertices.push_back(vertex);
-    vertexLookupTable[vertex] = index;
+    insertVertex(index, vertex.hash());
     return index;
 }
 
 unsigned int Mesh::getVertexIndex(const Vertex& vertex)
 {
-    std::map<Vertex,unsigned int>::iterator it;
-    it = vertexLookupTable.find(vertex);
-    return it->second;
+    assert(contains(vertex));
+    return _vertexTable[findVertexSlot(vertex, vertex.hash())];
+}
+
+unsigned int Mesh::addUniqueVertex(const Vertex& vertex)
+{
+    unsigned int hash = vertex.hash();
+    if (!_vertexTable.empty())
+    {
+        unsigned int index = _vertexTable[findVertexSlot(vertex, hash)];
+        if (index != VERTEX_SLOT_EMPTY)
+            return index;
+    }
+    unsigned int index = getVertexCount();
+    vertices.push_back(vertex);
+    insertVertex(index, hash);
+    return index;
+}
+
+void Mesh::weldVertices()
+{
+    const unsigned int cornerCount = (unsigned int)vertices.size();
+    _vertexTable.clear();
+    _vertexHashes.clear();
+    _vertexHashes.reserve(cornerCount);
+    reserveVertexTable(cornerCount);
+
+    // Compact the unique vertices in place, to the front of the vertex list, so that each is copied at most once.
+    std::vector<unsigned int> remap(cornerCount);
+    unsigned int vertexCount = 0;
+    for (unsigned int i = 0; i < cornerCount; ++i)
+    {
+        unsigned int hash = vertices[i].hash();
+        unsigned int slot = findVertexSlot(vertices[i], hash);
+        unsigned int index = _vertexTable[slot];
+        if (index == VERTEX_SLOT_EMPTY)
+        {
+            // The table was sized for all the corners, so it never needs to grow here.
+            index = vertexCount++;
+            if (index != i)
+                vertices[index] = vertices[i];
+            _vertexHashes.push_back(hash);
+            _vertexTable[slot] = index;
+        }
+        remap[i] = index;
+    }
+    vertices.resize(vertexCount);
+
+    for (std::vector<MeshPart*>::iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        (*i)->remapIndices(remap);
+    }
+
+    LOG(3, "  Welded %u vertices into %u for mesh: %s\n", cornerCount, vertexCount, getId().c_str());
+}
+
+void Mesh::weldVertices(const std::vector<Mesh*>& meshes)
+{
+    if (meshes.empty())
+        return;
+
+    // The threads take the next mesh to weld until there are none left.
+    std::atomic<size_t> next(0);
+    int threadCount = (int)std::min(meshes.size(), (size_t)WELD_THREAD_COUNT);
+    WeldThreadData data;
+    data.meshes = &meshes;
+    data.next = &next;
+    if (threadCount == 1)
+    {
+        weldMeshes(&data);
+        return;
+    }
+
+    THREAD_HANDLE* threads = new THREAD_HANDLE[threadCount];
+    int startedCount = 0;
+    for (; startedCount < threadCount; ++startedCount)
+    {
+        if (!createThread(&threads[startedCount], &weldMeshes, &data))
+        {
+            LOG(1, "Warning: Failed to spawn worker thread for welding vertices.\n");
+            break;
+        }
+    }
+
+    // Weld the remaining meshes on this thread if no thread could be started.
+    if (startedCount == 0)
+        weldMeshes(&data);
+
+    waitForThreads(startedCount, threads);
+    for (int i = 0; i < startedCount; ++i)
+        closeThread(threads[i]);
+    delete[] threads;
+}
+
+void Mesh::optimizeVertexCache()
+{
+    const unsigned int vertexCount = (unsigned int)vertices.size();
+    for (std::vector<MeshPart*>::iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        (*i)->optimizeVertexCache(vertexCount);
+    }
+}
+
+void Mesh::optimizeVertexFetch()
+{
+    const unsigned int vertexCount = (unsigned int)vertices.size();
+    std::vector<unsigned int> remap(vertexCount, VERTEX_SLOT_EMPTY);
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertexCount);
+    for (std::vector<MeshPart*>::const_iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        const MeshPart* part = *i;
+        for (unsigned int j = 0, count = (unsigned int)part->getIndicesCount(); j < count; ++j)
+        {
+            unsigned int index = part->getIndex(j);
+            if (remap[index] == VERTEX_SLOT_EMPTY)
+            {
+                remap[index] = (unsigned int)ordered.size();
+                ordered.push_back(vertices[index]);
+            }
+        }
+    }
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        if (remap[i] == VERTEX_SLOT_EMPTY)
+        {
+            remap[i] = (unsigned int)ordered.size();
+            ordered.push_back(vertices[i]);
+        }
+    }
+
+    vertices.swap(ordered);
+    for (std::vector<MeshPart*>::iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        (*i)->remapIndices(remap);
+    }
+    rebuildVertexTable();
+}
+
+void Mesh::split(unsigned int maxVertexCount, std::vector<Mesh*>* meshes, std::vector<std::vector<unsigned int> >* partIndices)
+{
+    assert(maxVertexCount >= 3);
+    assert(meshes && partIndices);
+
+    std::vector<Vertex> sourceVertices;
+    sourceVertices.swap(vertices);
+    std::vector<MeshPart*> sourceParts;
+    sourceParts.swap(parts);
+
+    // The index of each source vertex in the current mesh, and the source vertices it holds.
+    std::vector<unsigned int> remap(sourceVertices.size(), VERTEX_SLOT_EMPTY);
+    std::vector<unsigned int> used;
+
+    Mesh* mesh = this;
+    partIndices->resize(partIndices->size() + 1);
+    for (unsigned int p = 0, partCount = (unsigned int)sourceParts.size(); p < partCount; ++p)
+    {
+        MeshPart* sourcePart = sourceParts[p];
+        MeshPart* part = NULL;
+        for (unsigned int i = 0, count = sourcePart->getTriangleCount() * 3; i < count; i += 3)
+        {
+            const unsigned int triangle[3] = { sourcePart->getIndex(i), sourcePart->getIndex(i + 1), sourcePart->getIndex(i + 2) };
+            unsigned int newVertexCount = 0;
+            for (unsigned int k = 0; k < 3; ++k)
+            {
+                if (remap[triangle[k]] == VERTEX_SLOT_EMPTY && std::find(triangle, triangle + k, triangle[k]) == triangle + k)
+                    ++newVertexCount;
+            }
+
+            // Start a new mesh when the vertices of the triangle do not fit.
+            if (mesh->vertices.size() + newVertexCount > maxVertexCount)
+            {
+                for (std::vector<unsigned int>::iterator j = used.begin(); j != used.end(); ++j)
+                {
+                    remap[*j] = VERTEX_SLOT_EMPTY;
+                }
+                used.clear();
+                mesh->rebuildVertexTable();
+
+                mesh = new Mesh();
+                mesh->_vertexFormat = _vertexFormat;
+                meshes->push_back(mesh);
+                partIndices->resize(partIndices->size() + 1);
+                part = NULL;
+            }
+            if (part == NULL)
+            {
+                part = new MeshPart();
+                mesh->addMeshPart(part);
+                partIndices->back().push_back(p);
+            }
+
+            for (unsigned int k = 0; k < 3; ++k)
+            {
+                unsigned int& index = remap[triangle[k]];
+                if (index == VERTEX_SLOT_EMPTY)
+                {
+                    index = (unsigned int)mesh->vertices.size();
+                    mesh->vertices.push_back(sourceVertices[triangle[k]]);
+                    used.push_back(triangle[k]);
+                }
+                part->addIndex(index);
+            }
+        }
+        delete sourcePart;
+    }
+    mesh->rebuildVertexTable();
+
+    LOG(3, "  Split mesh %s into %lu meshes.\n", getId().c_str(), meshes->size() + 1);
+}
+
+unsigned int Mesh::getTriangleCount() const
+{
+    unsigned int triangleCount = 0;
+    for (std::vector<MeshPart*>::const_iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        triangleCount += (*i)->getTriangleCount();
+    }
+    return triangleCount;
+}
+
+unsigned int Mesh::getCacheMissCount(unsigned int cacheSize) const
+{
+    unsigned int missCount = 0;
+    for (std::vector<MeshPart*>::const_iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        missCount += (*i)->getCacheMissCount((unsigned int)vertices.size(), cacheSize);
+    }
+    return missCount;
+}
+
+unsigned int Mesh::findVertexSlot(const Vertex& vertex, unsigned int hash) const
+{
+    const unsigned int mask = (unsigned int)_vertexTable.size() - 1;
+    for (unsigned int slot = hash & mask; ; slot = (slot + 1) & mask)
+    {
+        unsigned int index = _vertexTable[slot];
+        if (index == VERTEX_SLOT_EMPTY || (_vertexHashes[index] == hash && vertices[index] == vertex))
+            return slot;
+    }
+}
+
+void Mesh::insertVertex(unsigned int index, unsigned int hash)
+{
+    assert(index == _vertexHashes.size());
+    _vertexHashes.push_back(hash);
+
+    // Keep the table at most half full.
+    if (_vertexHashes.size() * 2 > _vertexTable.size())
+    {
+        reserveVertexTable(_vertexHashes.size());
+        return;
+    }
+    const unsigned int mask = (unsigned int)_vertexTable.size() - 1;
+    unsigned int slot = hash & mask;
+    while (_vertexTable[slot] != VERTEX_SLOT_EMPTY)
+        slot = (slot + 1) & mask;
+    _vertexTable[slot] = index;
+}
+
+void Mesh::reserveVertexTable(size_t vertexCount)
+{
+    size_t size = 16;
+    while (size < vertexCount * 2)
+        size <<= 1;
+    if (size <= _vertexTable.size())
+        return;
+
+    // Rehash the vertices already in the table.
+    _vertexTable.assign(size, VERTEX_SLOT_EMPTY);
+    const unsigned int mask = (unsigned int)size - 1;
+    for (unsigned int i = 0, count = (unsigned int)_vertexHashes.size(); i < count; ++i)
+    {
+        unsigned int slot = _vertexHashes[i] & mask;
+        while (_vertexTable[slot] != VERTEX_SLOT_EMPTY)
+            slot = (slot + 1) & mask;
+        _vertexTable[slot] = i;
+    }
+}
+
+void Mesh::rebuildVertexTable()
+{
+    _vertexTable.clear();
+    _vertexHashes.clear();
+    _vertexHashes.reserve(vertices.size());
+    reserveVertexTable(vertices.size());
+    const unsigned int mask = (unsigned int)_vertexTable.size() - 1;
+    for (unsigned int i = 0, count = (unsigned int)vertices.size(); i < count; ++i)
+    {
+        unsigned int hash = vertices[i].hash();
+        unsigned int slot = hash & mask;
+        while (_vertexTable[slot] != VERTEX_SLOT_EMPTY)
+            slot = (slot + 1) & mask;
+        _vertexTable[slot] = i;
+        _vertexHashes.push_back(hash);
+    }
 }
 
 bool Mesh::hasNormals() const
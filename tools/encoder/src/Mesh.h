@@ -60,6 +60,60 @@ public:
 
     unsigned int getVertexIndex(const Vertex& vertex);
 
+    /**
+     * Adds a vertex to this mesh unless an equal vertex was already added, and returns its index.
+     */
+    unsigned int addUniqueVertex(const Vertex& vertex);
+
+    /**
+     * Merges the equal vertices of this mesh, and remaps the indices of its parts.
+     * 
+     * This lets meshes be built with a vertex per polygon corner and welded later.
+     */
+    void weldVertices();
+
+    /**
+     * Welds the vertices of the given meshes, processing several meshes in parallel.
+     * 
+     * @param meshes The meshes to weld.
+     */
+    static void weldVertices(const std::vector<Mesh*>& meshes);
+
+    /**
+     * Reorders the triangles of each part of this mesh for the post-transform vertex cache.
+     */
+    void optimizeVertexCache();
+
+    /**
+     * Reorders the vertices of this mesh in the order they are first used by its parts,
+     * so that the vertices are fetched sequentially. Unused vertices are moved to the end.
+     */
+    void optimizeVertexFetch();
+
+    /**
+     * Splits this mesh so that none of the meshes have more than the given number of vertices,
+     * moving the triangles that do not fit into new meshes, in their current order.
+     *
+     * The new meshes have the vertex format of this mesh but no ID.
+     * 
+     * @param maxVertexCount The maximum number of vertices of each mesh.
+     * @param meshes The vector the new meshes are appended to.
+     * @param partIndices Receives, for this mesh and then each new mesh, the index of the original
+     *        part of this mesh that each of its parts comes from.
+     */
+    void split(unsigned int maxVertexCount, std::vector<Mesh*>* meshes, std::vector<std::vector<unsigned int> >* partIndices);
+
+    /**
+     * Returns the number of triangles of the parts of this mesh.
+     */
+    unsigned int getTriangleCount() const;
+
+    /**
+     * Returns the number of vertices that miss a FIFO post-transform vertex cache of the given size
+     * when drawing all the parts of this mesh, starting each part with an empty cache.
+     */
+    unsigned int getCacheMissCount(unsigned int cacheSize) const;
+
     bool hasNormals() const;
     bool hasVertexColors() const;
 
@@ -69,11 +123,35 @@ public:
     std::vector<Vertex> vertices;
     std::vector<MeshPart*> parts;
     BoundingVolume bounds;
-    std::map<Vertex, unsigned int> vertexLookupTable;
 
 private:
+
+    /**
+     * Returns the slot of the vertex lookup table holding the given vertex, or the empty slot where it belongs.
+     */
+    unsigned int findVertexSlot(const Vertex& vertex, unsigned int hash) const;
+
+    /**
+     * Inserts the vertex at the given index in the vertex lookup table, growing the table if needed.
+     */
+    void insertVertex(unsigned int index, unsigned int hash);
+
+    /**
+     * Resizes the vertex lookup table to hold at least the given number of vertices.
+     */
+    void reserveVertexTable(size_t vertexCount);
+
+    /**
+     * Rebuilds the vertex lookup table from the vertices of this mesh.
+     */
+    void rebuildVertexTable();
+
     std::vector<VertexElement> _vertexFormat;
 
+    // Open-addressed hash table of the indices of the vertices (with linear probing), and the hash of each vertex.
+    std::vector<unsigned int> _vertexTable;
+    std::vector<unsigned int> _vertexHashes;
+
 };
 
 }
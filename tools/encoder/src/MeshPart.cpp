@@ -1,9 +1,45 @@
 #include "Base.h"
 #include "MeshPart.h"
 
+// Size of the LRU vertex cache modelled when reordering triangles, and the weights of the vertex scores
+#define FORSYTH_CACHE_SIZE 32
+#define FORSYTH_CACHE_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0f
+#define FORSYTH_VALENCE_BOOST_POWER 0.5f
+
 namespace gameplay
 {
 
+/**
+ * Returns the score of a vertex at the given position in the cache (-1 if it is not in the cache),
+ * with the given number of triangles left to draw.
+ */
+static float vertexScore(int cachePosition, unsigned int remainingTriangles)
+{
+    if (remainingTriangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+        {
+            // The vertices of the last triangle get a fixed score, so that the next triangle does not prefer any of them.
+            score = FORSYTH_LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            const float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = powf(1.0f - (cachePosition - 3) * scale, FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+
+    // Boost the vertices with few triangles left, so that they are finished off rather than left for later.
+    score += FORSYTH_VALENCE_BOOST_SCALE * powf((float)remainingTriangles, -FORSYTH_VALENCE_BOOST_POWER);
+    return score;
+}
+
 MeshPart::MeshPart(void) :
     _primitiveType(TRIANGLES),
     _indexFormat(INDEX16)
@@ -86,6 +122,171 @@ unsigned int MeshPart::getIndex(unsigned int i) const
     return _indices[i];
 }
 
+void MeshPart::remapIndices(const std::vector<unsigned int>& table)
+{
+    _indexFormat = INDEX16;
+    for (std::vector<unsigned int>::iterator i = _indices.begin(); i != _indices.end(); ++i)
+    {
+        assert(*i < table.size());
+        *i = table[*i];
+        updateIndexFormat(*i);
+    }
+}
+
+unsigned int MeshPart::getTriangleCount() const
+{
+    return _primitiveType == TRIANGLES ? (unsigned int)_indices.size() / 3 : 0;
+}
+
+void MeshPart::optimizeVertexCache(unsigned int vertexCount)
+{
+    const unsigned int triangleCount = getTriangleCount();
+    if (triangleCount < 2)
+        return;
+
+    // Build the lists of the triangles left to draw that use each vertex.
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int i = 0; i < triangleCount * 3; ++i)
+    {
+        assert(_indices[i] < vertexCount);
+        ++remaining[_indices[i]];
+    }
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<unsigned int> triangles(triangleCount * 3);
+    std::vector<unsigned int> ends(offsets.begin(), offsets.end() - 1);
+    for (unsigned int i = 0; i < triangleCount * 3; ++i)
+    {
+        triangles[ends[_indices[i]]++] = i / 3;
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        vertexScores[v] = vertexScore(-1, remaining[v]);
+    }
+
+    // Start with the triangle of the highest score.
+    int best = 0;
+    float bestScore = -FLT_MAX;
+    for (unsigned int t = 0; t < triangleCount; ++t)
+    {
+        const unsigned int* triangle = &_indices[t * 3];
+        float score = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+        if (score > bestScore)
+        {
+            best = t;
+            bestScore = score;
+        }
+    }
+
+    std::vector<bool> drawn(triangleCount, false);
+    std::vector<unsigned int> indices;
+    indices.reserve(_indices.size());
+    unsigned int cache[FORSYTH_CACHE_SIZE + 3];
+    unsigned int cacheCount = 0;
+    unsigned int nextTriangle = 0;
+    while (best >= 0)
+    {
+        const unsigned int* triangle = &_indices[best * 3];
+        drawn[best] = true;
+        indices.insert(indices.end(), triangle, triangle + 3);
+
+        // Remove the triangle from the lists of its vertices, and move them to the front of the cache.
+        unsigned int newCache[FORSYTH_CACHE_SIZE + 3];
+        unsigned int newCount = 0;
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            unsigned int v = triangle[k];
+            unsigned int* list = &triangles[offsets[v]];
+            for (unsigned int j = 0; j < remaining[v]; ++j)
+            {
+                if (list[j] == (unsigned int)best)
+                {
+                    list[j] = list[remaining[v] - 1];
+                    break;
+                }
+            }
+            --remaining[v];
+            if (std::find(newCache, newCache + newCount, v) == newCache + newCount)
+                newCache[newCount++] = v;
+        }
+        for (unsigned int i = 0; i < cacheCount; ++i)
+        {
+            if (std::find(triangle, triangle + 3, cache[i]) == triangle + 3)
+                newCache[newCount++] = cache[i];
+        }
+
+        // Update the scores of the vertices in the cache, and of those that were just pushed out of it.
+        for (unsigned int i = 0; i < newCount; ++i)
+        {
+            unsigned int v = newCache[i];
+            cachePositions[v] = i < FORSYTH_CACHE_SIZE ? (int)i : -1;
+            vertexScores[v] = vertexScore(cachePositions[v], remaining[v]);
+        }
+        cacheCount = std::min(newCount, (unsigned int)FORSYTH_CACHE_SIZE);
+        memcpy(cache, newCache, cacheCount * sizeof(unsigned int));
+
+        // The next triangle is the best of the triangles using the vertices in the cache.
+        best = -1;
+        bestScore = -FLT_MAX;
+        for (unsigned int i = 0; i < cacheCount; ++i)
+        {
+            unsigned int v = cache[i];
+            for (unsigned int j = 0; j < remaining[v]; ++j)
+            {
+                unsigned int t = triangles[offsets[v] + j];
+                const unsigned int* candidate = &_indices[t * 3];
+                float score = vertexScores[candidate[0]] + vertexScores[candidate[1]] + vertexScores[candidate[2]];
+                if (score > bestScore)
+                {
+                    best = t;
+                    bestScore = score;
+                }
+            }
+        }
+
+        // Otherwise, carry on with the next triangle in the original order that was not drawn yet.
+        if (best < 0)
+        {
+            while (nextTriangle < triangleCount && drawn[nextTriangle])
+                ++nextTriangle;
+            if (nextTriangle < triangleCount)
+                best = nextTriangle;
+        }
+    }
+    assert(indices.size() == triangleCount * 3);
+
+    // Keep any trailing indices that do not make a whole triangle.
+    indices.insert(indices.end(), _indices.begin() + triangleCount * 3, _indices.end());
+    _indices.swap(indices);
+}
+
+unsigned int MeshPart::getCacheMissCount(unsigned int vertexCount, unsigned int cacheSize) const
+{
+    if (_primitiveType != TRIANGLES)
+        return 0;
+
+    // A vertex is still in the FIFO cache if fewer than cacheSize vertices missed the cache since it was added.
+    std::vector<unsigned int> cacheTimes(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    unsigned int missCount = 0;
+    for (std::vector<unsigned int>::const_iterator i = _indices.begin(); i != _indices.end(); ++i)
+    {
+        assert(*i < vertexCount);
+        if (time - cacheTimes[*i] > cacheSize)
+        {
+            cacheTimes[*i] = time++;
+            ++missCount;
+        }
+    }
+    return missCount;
+}
+
 void MeshPart::writeBinaryIndex(unsigned int index, FILE* file)
 {
     switch (_indexFormat)
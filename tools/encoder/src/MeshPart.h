@@ -62,6 +62,35 @@ public:
      */
     unsigned int getIndex(unsigned int i) const;
 
+    /**
+     * Replaces each index by its entry in the given table, and updates the index format.
+     */
+    void remapIndices(const std::vector<unsigned int>& table);
+
+    /**
+     * Returns the number of triangles of this part, if its primitives are triangles.
+     */
+    unsigned int getTriangleCount() const;
+
+    /**
+     * Reorders the triangles of this part for the post-transform vertex cache of the GPU,
+     * using Tom Forsyth's linear-speed vertex cache optimisation.
+     *
+     * Only parts of triangles are reordered.
+     *
+     * @param vertexCount The number of vertices of the mesh.
+     */
+    void optimizeVertexCache(unsigned int vertexCount);
+
+    /**
+     * Returns the number of vertices that miss a FIFO post-transform vertex cache of the
+     * given size, when drawing the triangles of this part.
+     *
+     * @param vertexCount The number of vertices of the mesh.
+     * @param cacheSize The number of vertices in the cache.
+     */
+    unsigned int getCacheMissCount(unsigned int vertexCount, unsigned int cacheSize) const;
+
 private:
 
     /**
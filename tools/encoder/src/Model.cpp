@@ -152,4 +152,25 @@ void Model::setMaterial(Material* material, int partIndex)
     }
 }
 
+void Model::copyMaterials(const Model* model, const std::vector<unsigned int>& partIndices)
+{
+    assert(model);
+    _material = model->_material;
+    if (model->_materials.empty())
+    {
+        _materials.clear();
+        return;
+    }
+
+    std::vector<Material*> materials(partIndices.size(), (Material*)NULL);
+    for (size_t i = 0, count = partIndices.size(); i < count; ++i)
+    {
+        if (partIndices[i] < model->_materials.size())
+        {
+            materials[i] = model->_materials[partIndices[i]];
+        }
+    }
+    _materials.swap(materials);
+}
+
 }
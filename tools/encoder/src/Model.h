@@ -34,6 +34,14 @@ public:
     void setSkin(MeshSkin* skin);
     void setMaterial(Material* material, int partIndex = -1);
 
+    /**
+     * Sets the materials of the parts of this model to the materials of the given parts of a model.
+     *
+     * @param model The model to copy the materials from, which may be this model.
+     * @param partIndices The index of the part of the given model for each part of this model.
+     */
+    void copyMaterials(const Model* model, const std::vector<unsigned int>& partIndices);
+
 private:
 
     Mesh* _mesh;
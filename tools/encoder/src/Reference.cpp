@@ -84,4 +84,9 @@ Object* Reference::getObj()
     return _ref;
 }
 
+unsigned int Reference::getOffset() const
+{
+    return _offset;
+}
+
 }
@@ -44,6 +44,11 @@ public:
 
     Object* getObj();
 
+    /**
+     * Returns the file offset of the referenced object, as written by updateOffset().
+     */
+    unsigned int getOffset() const;
+
 private:
     std::string _xref;
     unsigned int _type;
@@ -1,9 +1,32 @@
 #include "Base.h"
 #include "ReferenceTable.h"
 
+// Signature at the end of the index section
+#define INDEX_SIGNATURE "GPBI"
+
 namespace gameplay
 {
 
+// FNV-1a hash of a reference id, which must match the hash used by the runtime (Bundle.cpp).
+static unsigned int hashId(const std::string& id)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < id.length(); ++i)
+    {
+        hash ^= (unsigned char)id[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Orders references by their offset in the file.
+struct OffsetLess
+{
+    OffsetLess(const std::vector<const Reference*>& refs) : refs(refs) { }
+    bool operator()(unsigned int a, unsigned int b) const { return refs[a]->getOffset() < refs[b]->getOffset(); }
+    const std::vector<const Reference*>& refs;
+};
+
 ReferenceTable::ReferenceTable(void)
 {
 }
@@ -56,6 +79,57 @@ void ReferenceTable::updateOffsets(FILE* file)
     }
 }
 
+void ReferenceTable::writeIndex(FILE* file)
+{
+    // References are numbered in the order they are written by writeBinary().
+    std::vector<const Reference*> refs;
+    std::vector<std::string> ids;
+    for (std::map<std::string, Reference>::iterator i = _table.begin(); i != _table.end(); ++i)
+    {
+        ids.push_back(i->first);
+        refs.push_back(&i->second);
+    }
+    unsigned int refCount = (unsigned int)refs.size();
+
+    // Open-addressed hash table of reference index + 1 (0 for empty buckets), at most half full.
+    unsigned int bucketCount = 1;
+    while (bucketCount < refCount * 2)
+    {
+        bucketCount <<= 1;
+    }
+    std::vector<unsigned int> buckets(bucketCount, 0);
+    for (unsigned int i = 0; i < refCount; ++i)
+    {
+        unsigned int slot = hashId(ids[i]) & (bucketCount - 1);
+        while (buckets[slot] != 0)
+        {
+            slot = (slot + 1) & (bucketCount - 1);
+        }
+        buckets[slot] = i + 1;
+    }
+
+    // Reference indices sorted by offset.
+    std::vector<unsigned int> offsetIndex(refCount);
+    for (unsigned int i = 0; i < refCount; ++i)
+    {
+        offsetIndex[i] = i;
+    }
+    std::stable_sort(offsetIndex.begin(), offsetIndex.end(), OffsetLess(refs));
+
+    fseek(file, 0, SEEK_END);
+    write(bucketCount, file);
+    for (unsigned int i = 0; i < bucketCount; ++i)
+    {
+        write(buckets[i], file);
+    }
+    for (unsigned int i = 0; i < refCount; ++i)
+    {
+        write(offsetIndex[i], file);
+    }
+    write((unsigned int)(4 * (bucketCount + refCount + 1)), file);
+    fwrite(INDEX_SIGNATURE, 1, 4, file);
+}
+
 std::map<std::string, Reference>::iterator ReferenceTable::begin()
 {
     return _table.begin();
@@ -46,6 +46,15 @@ public:
      */
     void updateOffsets(FILE* file);
 
+    /**
+     * Writes the index section that lets the runtime look up references by id and
+     * by offset without building its own indices when the file is opened.
+     * This needs to be called at the end of the file, after updateOffsets().
+     * 
+     * @param file The file pointer.
+     */
+    void writeIndex(FILE* file);
+
     std::map<std::string, Reference>::iterator begin();
     std::map<std::string, Reference>::iterator end();
 
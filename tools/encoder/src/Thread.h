@@ -16,7 +16,7 @@ namespace gameplay
         void* arg;
     };
 
-    DWORD WINAPI WindowsThreadProc(LPVOID lpParam)
+    static DWORD WINAPI WindowsThreadProc(LPVOID lpParam)
     {
         WindowsThreadData* data = (WindowsThreadData*)lpParam;
         int(*threadFunction)(void*) = data->threadFunction;
@@ -45,9 +45,17 @@ namespace gameplay
         CloseHandle(thread);
     }
 
+    static int getProcessorCount()
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (int)info.dwNumberOfProcessors;
+    }
+
 #else
 
     #include <pthread.h>
+    #include <unistd.h>
 
     typedef pthread_t THREAD_HANDLE;
 
@@ -57,7 +65,7 @@ namespace gameplay
         void* arg;
     };
 
-    void* PThreadProc(void* threadData)
+    static void* PThreadProc(void* threadData)
     {
         PThreadData* data = (PThreadData*)threadData;
         int(*threadFunction)(void*) = data->threadFunction;
@@ -92,6 +100,12 @@ namespace gameplay
         // nothing to do... waitForThreads (which calls join) cleans up
     }
 
+    static int getProcessorCount()
+    {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (int)count : 1;
+    }
+
 #endif
 
 }
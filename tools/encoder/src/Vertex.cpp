@@ -1,9 +1,34 @@
 #include "Base.h"
 #include "Vertex.h"
 
+// Number of steps per unit of the grid the vertex attributes are quantized to for hashing
+#define VERTEX_HASH_GRID 1024.0f
+
 namespace gameplay
 {
 
+/**
+ * Quantizes a vertex attribute to the hashing grid. Values outside the range of the grid share one key.
+ */
+static unsigned int quantize(float value)
+{
+    float q = floor(value * VERTEX_HASH_GRID);
+    return (q > -2147483648.0f && q < 2147483648.0f) ? (unsigned int)(int)q : 0u;
+}
+
+/**
+ * Mixes a key into a hash.
+ */
+static unsigned int mix(unsigned int hash, unsigned int key)
+{
+    key *= 0xcc9e2d51u;
+    key = (key << 15) | (key >> 17);
+    key *= 0x1b873593u;
+    hash ^= key;
+    hash = (hash << 13) | (hash >> 19);
+    return hash * 5 + 0xe6546b64u;
+}
+
 Vertex::Vertex(void)
     : hasNormal(false), hasTangent(false), hasBinormal(false), hasDiffuse(false), hasWeights(false)
 {
@@ -15,6 +40,27 @@ Vertex::~Vertex(void)
 {
 }
 
+unsigned int Vertex::hash() const
+{
+    unsigned int h = 0;
+    h = mix(h, quantize(position.x));
+    h = mix(h, quantize(position.y));
+    h = mix(h, quantize(position.z));
+    h = mix(h, quantize(normal.x));
+    h = mix(h, quantize(normal.y));
+    h = mix(h, quantize(normal.z));
+    h = mix(h, quantize(texCoord[0].x));
+    h = mix(h, quantize(texCoord[0].y));
+
+    // Final avalanche, since the table is indexed with the low bits of the hash.
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
 unsigned int Vertex::byteSize() const
 {
     unsigned int count = POSITION_COUNT;
@@ -96,6 +96,12 @@ public:
             diffuse==v.diffuse && blendWeights==v.blendWeights && blendIndices==v.blendIndices;
     }
 
+    /**
+     * Returns a hash of this vertex, computed from its quantized position, normal and
+     * first texture coordinates. Equal vertices have equal hashes.
+     */
+    unsigned int hash() const;
+
     /**
      * Returns the size of this vertex in bytes.
      */